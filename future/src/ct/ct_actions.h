@@ -44,6 +44,7 @@ public:
         _pCtMainWin = pCtMainWin;
         _find_init();
     }
+    ~CtActions();
 
 public:
     CtCodebox*      curr_codebox_anchor{nullptr};
@@ -56,9 +57,15 @@ private:
     CtDialogs::CtLinkEntry _link_entry;
 
 private:
-    size_t                          _next_opened_emb_file_id{1};
-    std::map<fs::path, time_t>      _embfiles_opened;
-    sigc::connection                _embfiles_timeout_connection;
+    struct CtEmbFileOpened
+    {
+        Glib::RefPtr<Gio::FileMonitor>  rFileMonitor;
+        Glib::RefPtr<Gio::Cancellable>  rCancellable; // of the read in progress
+        sigc::connection                debounceConnection;
+        time_t                          modTime{0};
+    };
+    size_t                                 _next_opened_emb_file_id{1};
+    std::map<fs::path, CtEmbFileOpened>    _embfiles_opened;
 
 private:
     CtMainWin*   _pCtMainWin;
@@ -158,8 +165,8 @@ public:
 private:
     void          _node_move_after(Gtk::TreeIter iter_to_move, Gtk::TreeIter father_iter,
                                    Gtk::TreeIter brother_iter = Gtk::TreeIter(), bool set_first = false);
-    bool          _need_node_swap(Gtk::TreeIter& leftIter, Gtk::TreeIter& rightIter, bool ascendings);
-    bool          _tree_sort_level_and_sublevels(const Gtk::TreeNodeChildren& children, bool ascending);
+    std::string   _node_sort_key(const Gtk::TreeIter& treeIter);
+    bool          _tree_sort_level_and_sublevels(Gtk::TreeIter father_iter, bool ascending);
 
 public:
     // tree actions
@@ -337,7 +344,10 @@ public:
 private:
     // helper for others actions
     void _anchor_edit_dialog(CtImageAnchor* anchor, Gtk::TextIter insert_iter, Gtk::TextIter* iter_bound);
-    bool _on_embfiles_sentinel_timeout();
+    void _on_embfile_changed(const fs::path& filepath, Gio::FileMonitorEvent event_type);
+    void _embfile_reload(const fs::path& filepath);
+    void _embfile_update(const fs::path& filepath, char* pContents, size_t length);
+    static void _embfile_unwatch(CtEmbFileOpened& embfileOpened);
 
 public:
     // others actions
@@ -107,22 +107,40 @@ void CtActions::table_handle()
         Glib::ustring filename = CtDialogs::file_select_dialog(args);
         if (filename.empty()) return;
         _pCtMainWin->get_ct_config()->pickDirCsv = Glib::path_get_dirname(filename);
-        // todo: find good csv lib
         std::ifstream infile(filename);
-        pCtTable = CtTable::from_csv(infile, _pCtMainWin, CtConst::TABLE_CELL_TEXT_ID, 40, 60, _curr_buffer()->get_insert()->get_iter().get_offset(), "").release();
-        
+        const int insert_offset = _curr_buffer()->get_insert()->get_iter().get_offset();
+        const gint64 node_id = _pCtMainWin->curr_tree_iter().get_node_id();
+
+        CtStatusBar& ctStatusBar = _pCtMainWin->get_status_bar();
+        ctStatusBar.progressBar.set_fraction(0);
+        ctStatusBar.progressBar.set_text("0");
+        ctStatusBar.progressBar.show();
+        ctStatusBar.stopButton.show();
+        ctStatusBar.set_progress_stop(false);
+        auto progress_cb = [&ctStatusBar](size_t rows_read, double fraction) {
+            ctStatusBar.progressBar.set_fraction(fraction);
+            ctStatusBar.progressBar.set_text(std::to_string(rows_read));
+            while (gtk_events_pending()) gtk_main_iteration();
+            return !ctStatusBar.is_progress_stop();
+        };
+        pCtTable = CtTable::from_csv(infile, _pCtMainWin, 40, 60, insert_offset, "", progress_cb).release();
+        ctStatusBar.progressBar.hide();
+        ctStatusBar.stopButton.hide();
+        ctStatusBar.set_progress_stop(false);
+        if (!pCtTable) return;
+        // the ui was alive during the import, the user may have left the node
+        if (_pCtMainWin->curr_tree_iter().get_node_id() != node_id) {
+            delete pCtTable;
+            return;
+        }
     }
 
     if (!pCtTable) {
-        CtTableMatrix tableMatrix;
-        for(auto& row: rows)
-        {
-            tableMatrix.push_back(CtTableRow{});
-            for (auto& cell: row)
-                tableMatrix.back().push_back(new CtTableCell(_pCtMainWin, cell, CtConst::TABLE_CELL_TEXT_ID));
-        }
+        CtTableTexts tableTexts;
+        for (auto& row: rows)
+            tableTexts.emplace_back(row.begin(), row.end());
 
-        pCtTable = new CtTable(_pCtMainWin, tableMatrix, col_min, col_max, _curr_buffer()->get_insert()->get_iter().get_offset(), "");
+        pCtTable = CtTable::create(_pCtMainWin, std::move(tableTexts), col_min, col_max, _curr_buffer()->get_insert()->get_iter().get_offset(), "");
     }
     Glib::RefPtr<Gsv::Buffer> gsv_buffer = Glib::RefPtr<Gsv::Buffer>::cast_dynamic(_curr_buffer());
     pCtTable->insertInTextBuffer(gsv_buffer);
@@ -246,7 +264,7 @@ std::optional<Glib::ustring> iter_in_tag(const Gtk::TextIter& iter, const Glib::
     for (const auto& iter_tag : iter.get_tags()) {
         Glib::ustring tag_name;
         iter_tag->get_property("name", tag_name);
-        spdlog::debug("TAG: {}", tag_name);
+        SPDLOG_DEBUG("TAG: {}", tag_name);
         if (str::startswith(tag_name, tag)) {
             return tag_name;
         }
@@ -307,7 +325,7 @@ TocEntry find_toc_entries(CtActions& actions, CtTreeIter& node, int depth)
                 
                 text_iter = mark->get_iter();
                 text_buffer->delete_mark(mark);
-                spdlog::debug("INSERT DONE");
+                SPDLOG_DEBUG("INSERT DONE");
                 entry.children.emplace_back(fmt::format("node {} {}", node_id, anchor_txt), false, txt, depth + 1, h_lvl);
             } catch(std::invalid_argument&) {
                 spdlog::error("Could not convert [{}] to an integer", h_level_str);
@@ -65,22 +65,22 @@ void CtActions::export_to_ctd()
 
 void CtActions::export_to_pdf_auto(const std::string& dir, bool overwrite)
 {
-    spdlog::debug("pdf export to: {}", dir);
-    spdlog::debug("overwrite: {}", overwrite);
+    SPDLOG_DEBUG("pdf export to: {}", dir);
+    SPDLOG_DEBUG("overwrite: {}", overwrite);
     _export_print(true, dir, overwrite);
 }
 
 void CtActions::export_to_html_auto(const std::string& dir, bool overwrite)
 {
-    spdlog::debug("html export to: {}", dir);
-    spdlog::debug("overwrite: {}", overwrite);
+    SPDLOG_DEBUG("html export to: {}", dir);
+    SPDLOG_DEBUG("overwrite: {}", overwrite);
     _export_to_html(dir, overwrite);
 }
 
 void CtActions::export_to_txt_auto(const std::string& dir, bool overwrite)
 {
-    spdlog::debug("txt export to: {}", dir);
-    spdlog::debug("overwrite: {}", overwrite);
+    SPDLOG_DEBUG("txt export to: {}", dir);
+    SPDLOG_DEBUG("overwrite: {}", overwrite);
     _export_to_txt(false, dir, overwrite);
 }
 
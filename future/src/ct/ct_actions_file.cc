@@ -32,7 +32,7 @@ void CtActions::_file_save(bool need_vacuum)
     if (_pCtMainWin->get_ct_storage()->get_file_path().empty())
         file_save_as();
     else
-        _pCtMainWin->file_save(need_vacuum);
+        _pCtMainWin->file_save_in_background(need_vacuum);
 }
 
 void CtActions::file_new()
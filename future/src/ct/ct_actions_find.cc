@@ -29,6 +29,7 @@
 #include "ct_image.h"
 #include "ct_dialogs.h"
 #include "ct_logging.h"
+#include "ct_trace.h"
 
 
 void CtActions::_find_init()
@@ -114,6 +115,7 @@ static int _count_nodes(const Gtk::TreeNodeChildren& children) {
 
 void CtActions::_find_in_all_nodes(bool for_current_node)
 {
+    CT_TRACE_SCOPE("search all nodes");
     if (!_is_there_selected_node_or_error()) return;
     Glib::RefPtr<Gtk::TextBuffer> curr_buffer = _pCtMainWin->get_text_view().get_buffer();
     CtStatusBar& ctStatusBar = _pCtMainWin->get_status_bar();
@@ -184,7 +186,7 @@ void CtActions::_find_in_all_nodes(bool for_current_node)
         ctStatusBar.set_progress_stop(false);
         while (gtk_events_pending()) gtk_main_iteration();
     }
-    std::time_t search_start_time = std::time(nullptr);
+    [[maybe_unused]] std::time_t search_start_time = std::time(nullptr);
     while (node_iter) {
         s_state.all_matches_first_in_node = true;
         CtTreeIter ct_node_iter = _pCtMainWin->get_tree_store().to_ct_tree_iter(node_iter);
@@ -214,8 +216,7 @@ void CtActions::_find_in_all_nodes(bool for_current_node)
         if (all_matches)
             _update_all_matches_progress();
     }
-    std::time_t search_end_time = std::time(nullptr);
-    spdlog::debug("Search took {} sec", search_end_time - search_start_time);
+    SPDLOG_DEBUG("Search took {} sec", std::time(nullptr) - search_start_time);
 
     _pCtMainWin->user_active() = user_active_restore;
     _pCtMainWin->get_tree_store().treeview_set_tree_expanded_collapsed_string(tree_expanded_collapsed_string, _pCtMainWin->get_tree_view(), _pCtMainWin->get_ct_config()->nodesBookmExp);
@@ -649,6 +650,7 @@ bool CtActions::_parse_node_name(CtTreeIter node_iter, Glib::RefPtr<Glib::Regex>
 // Returns True if pattern was found, False otherwise
 bool CtActions::_parse_given_node_content(CtTreeIter node_iter, Glib::RefPtr<Glib::Regex> re_pattern, bool forward, bool first_fromsel, bool all_matches)
 {
+    CT_TRACE_SCOPE("search node");
     auto text_buffer = node_iter.get_node_text_buffer();
     if (!s_state.first_useful_node) {
         // first_fromsel plus first_node not already parsed
@@ -899,9 +901,9 @@ Glib::ustring CtActions::_check_pattern_in_object(Glib::RefPtr<Glib::Regex> patt
     }
     else if (CtTable* table = dynamic_cast<CtTable*>(obj))
     {
-        for (auto& row: table->get_table_matrix())
-            for (auto& col: row)
-                if (pattern->match(col->get_text_content()))
+        for (size_t row = 0; row < table->get_num_rows(); ++row)
+            for (size_t col = 0; col < table->get_num_columns(); ++col)
+                if (pattern->match(table->get_cell_text(row, col)))
                     return "<table>";
     }
     else if (CtCodebox* codebox = dynamic_cast<CtCodebox*>(obj))
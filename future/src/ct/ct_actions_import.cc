@@ -27,6 +27,7 @@
 #include "ct_storage_xml.h"
 
 #include "ct_logging.h"
+#include "ct_trace.h"
 #include <fstream>
 
 // Import a node from a html file
@@ -168,6 +169,7 @@ void CtActions::_import_from_file(CtImporterInterface* importer)
 
     try
     {
+       CT_TRACE_SCOPE("import file");
        std::unique_ptr<ct_imported_node> node = importer->import_file(filepath);
        if (!node) return;
        _create_imported_nodes(node.get());
@@ -186,10 +188,37 @@ void CtActions::_import_from_dir(CtImporterInterface* importer, const std::strin
     if (custom_dir.empty())
         _pCtMainWin->get_ct_config()->pickDirImport = import_dir;
 
+    CtStatusBar& ctStatusBar = _pCtMainWin->get_status_bar();
+    ctStatusBar.progressBar.set_fraction(0);
+    ctStatusBar.progressBar.set_text("0");
+    ctStatusBar.progressBar.show();
+    ctStatusBar.stopButton.show();
+    ctStatusBar.set_progress_stop(false);
+    auto progress_cb = [&ctStatusBar](size_t files_done, size_t files_total) {
+        if (files_total > 0)
+            ctStatusBar.progressBar.set_fraction(double(files_done)/double(files_total));
+        ctStatusBar.progressBar.set_text(std::to_string(files_done) + "/" + std::to_string(files_total));
+        while (gtk_events_pending()) gtk_main_iteration();
+        return !ctStatusBar.is_progress_stop();
+    };
+
+    std::unique_ptr<ct_imported_node> dir_node;
+    try
+    {
+        dir_node = CtImports::traverse_dir(import_dir, importer, progress_cb);
+    }
+    catch (std::exception& ex)
+    {
+        spdlog::error("import exception: {}", ex.what());
+    }
+    ctStatusBar.progressBar.hide();
+    ctStatusBar.stopButton.hide();
+    ctStatusBar.set_progress_stop(false);
+
     try
     {
-        auto dir_node = CtImports::traverse_dir(import_dir, importer);
-        _create_imported_nodes(dir_node.get());
+        if (dir_node)
+            _create_imported_nodes(dir_node.get());
     }
     catch (std::exception& ex)
     {
@@ -226,6 +255,7 @@ static Gtk::TreeIter select_parent_dialog(CtMainWin* pCtMainWin)
 
 void CtActions::_create_imported_nodes(ct_imported_node* imported_nodes)
 {
+    CT_TRACE_SCOPE("import create nodes");
     // to apply functions to nodes
     std::function<void(ct_imported_node*, std::function<void(ct_imported_node*)>)> foreach_nodes;
     foreach_nodes = [&](ct_imported_node* imported_node, std::function<void(ct_imported_node*)> fun_apply) {
@@ -302,6 +332,10 @@ void CtActions::_create_imported_nodes(ct_imported_node* imported_nodes)
     };
 
     Gtk::TreeIter parent_iter = select_parent_dialog(_pCtMainWin);
+    const Gtk::TreeNodeChildren& parent_children = parent_iter ? parent_iter->children() : _pCtMainWin->get_tree_store().get_store()->children();
+    Gtk::TreeIter first_new_iter = _pCtMainWin->get_tree_store().get_tree_iter_last_sibling(parent_children);
+    _pCtMainWin->get_tree_store().bulk_load_begin();
+    auto on_scope_exit = scope_guard([&](void*) { _pCtMainWin->get_tree_store().bulk_load_end(); });
     if (imported_nodes->has_content())
         create_nodes(parent_iter, imported_nodes);
     else // skip top if it's dir
@@ -310,7 +344,12 @@ void CtActions::_create_imported_nodes(ct_imported_node* imported_nodes)
             create_nodes(parent_iter, child.get());
     }
 
-    _pCtMainWin->get_tree_store().nodes_sequences_fix(parent_iter, true);
+    // the existing siblings keep their sequences, only the new nodes are numbered
+    first_new_iter = first_new_iter ? ++first_new_iter : parent_children.begin();
+    for (Gtk::TreeIter new_iter = first_new_iter; new_iter; ++new_iter)
+        _pCtMainWin->get_tree_store().nodes_sequences_fix(new_iter, true);
+    if (first_new_iter)
+        _pCtMainWin->get_tree_store().node_sequence_fix(first_new_iter);
     _pCtMainWin->update_window_save_needed();
 }
 
@@ -32,6 +32,17 @@
 #include "ct_logging.h"
 #include <spdlog/fmt/bundled/printf.h>
 
+// an editor saving an embedded file gives a burst of events, the file is read once they stop
+constexpr unsigned EMBFILE_DEBOUNCE_MS{300};
+
+CtActions::~CtActions()
+{
+    for (auto& [filepath, embfileOpened] : _embfiles_opened)
+    {
+        _embfile_unwatch(embfileOpened);
+    }
+}
+
 // Cut Link
 void CtActions::link_cut()
 {
@@ -162,13 +173,30 @@ void CtActions::embfile_open()
     file.write(curr_file_anchor->get_raw_blob().c_str(), size);
     file.close();
 
-    spdlog::debug("embfile_open {}", filepath);
+    SPDLOG_DEBUG("embfile_open {}", filepath);
 
     fs::open_filepath(filepath.c_str(), false, _pCtMainWin->get_ct_config());
-    _embfiles_opened[filepath] = fs::getmtime(filepath);
-
-    if (not _embfiles_timeout_connection)
-        _embfiles_timeout_connection = Glib::signal_timeout().connect(sigc::mem_fun(*this, &CtActions::_on_embfiles_sentinel_timeout), 500);
+    if (_embfiles_opened.count(filepath))
+    {
+        // opened again, already watched
+        _embfiles_opened[filepath].modTime = fs::getmtime(filepath);
+        return;
+    }
+    CtEmbFileOpened& embfileOpened = _embfiles_opened[filepath];
+    embfileOpened.modTime = fs::getmtime(filepath);
+    try
+    {
+        embfileOpened.rFileMonitor = Gio::File::create_for_path(filepath.string())->monitor_file();
+        embfileOpened.rFileMonitor->signal_changed().connect(
+            [this, filepath](const Glib::RefPtr<Gio::File>&/*file*/, const Glib::RefPtr<Gio::File>&/*other_file*/, Gio::FileMonitorEvent event_type)
+            {
+                _on_embfile_changed(filepath, event_type);
+            });
+    }
+    catch (Glib::Error& e)
+    {
+        spdlog::error("cannot watch {}: {}", filepath, e.what());
+    }
 }
 
 // Save to Disk the selected Image
@@ -316,6 +344,7 @@ void CtActions::link_clicked(const Glib::ustring& tag_property_value, bool from_
          _pCtMainWin->get_text_view().grab_focus();
          _pCtMainWin->get_text_view().get_window(Gtk::TEXT_WINDOW_TEXT)->set_cursor(Gdk::Cursor::create(Gdk::XTERM));
          _pCtMainWin->get_text_view().set_tooltip_text("");
+         _pCtMainWin->get_text_view().cursor_and_tooltips_invalidate();
          if (vec.size() >= 3)
          {
              Glib::ustring anchor_name;
@@ -716,51 +745,100 @@ void CtActions::_anchor_edit_dialog(CtImageAnchor* anchor, Gtk::TextIter insert_
     image_insert_anchor(insert_iter, ret_anchor_name, image_justification);
 }
 
-// Iteration of the Modification Time Sentinel
-bool CtActions::_on_embfiles_sentinel_timeout()
+void CtActions::_on_embfile_changed(const fs::path& filepath, Gio::FileMonitorEvent event_type)
 {
-    for(auto& item : _embfiles_opened)
+    if (event_type == Gio::FILE_MONITOR_EVENT_ATTRIBUTE_CHANGED or
+        event_type == Gio::FILE_MONITOR_EVENT_PRE_UNMOUNT or
+        event_type == Gio::FILE_MONITOR_EVENT_UNMOUNTED)
+    {
+        return;
+    }
+    auto iterOpened = _embfiles_opened.find(filepath);
+    if (iterOpened == _embfiles_opened.end()) return;
+    iterOpened->second.debounceConnection.disconnect();
+    iterOpened->second.debounceConnection = Glib::signal_timeout().connect([this, filepath]()
     {
-        const fs::path& filepath = item.first;
-        if (not fs::is_regular_file(filepath))
+        _embfile_reload(filepath);
+        return false;
+    }, EMBFILE_DEBOUNCE_MS);
+}
+
+void CtActions::_embfile_reload(const fs::path& filepath)
+{
+    auto iterOpened = _embfiles_opened.find(filepath);
+    if (iterOpened == _embfiles_opened.end()) return;
+    CtEmbFileOpened& embfileOpened = iterOpened->second;
+    if (not fs::is_regular_file(filepath))
+    {
+        SPDLOG_DEBUG("embdrop {}", filepath);
+        _embfile_unwatch(embfileOpened);
+        _embfiles_opened.erase(iterOpened);
+        return;
+    }
+    const time_t modTime = fs::getmtime(filepath);
+    if (modTime == embfileOpened.modTime) return;
+    embfileOpened.modTime = modTime;
+
+    // read in a gio worker thread, the callback runs back in the main loop
+    if (embfileOpened.rCancellable) embfileOpened.rCancellable->cancel();
+    embfileOpened.rCancellable = Gio::Cancellable::create();
+    Glib::RefPtr<Gio::File> rFile = Gio::File::create_for_path(filepath.string());
+    rFile->load_contents_async([this, rFile, filepath](Glib::RefPtr<Gio::AsyncResult>& rResult)
+    {
+        char* pContents{nullptr};
+        gsize length{0};
+        try
         {
-            spdlog::debug("embdrop{}", filepath);
-            _embfiles_opened.erase(filepath);
-            break;
+            rFile->load_contents_finish(rResult, pContents, length);
         }
-        if (item.second != fs::getmtime(filepath))
+        catch (Gio::Error& e)
         {
-           _embfiles_opened[filepath] = fs::getmtime(filepath);
-           auto data_vec = str::split(filepath.filename().string(), CtConst::CHAR_MINUS);
-           gint64 node_id = std::stoll(data_vec[0]);
-           size_t embfile_id = std::stol(data_vec[1]);
-
-            CtTreeIter tree_iter = _pCtMainWin->get_tree_store().get_node_from_node_id(node_id);
-            if (not tree_iter) continue;
-            if (tree_iter.get_node_read_only())
+            // cancelled also when CtActions is gone
+            if (e.code() != Gio::Error::CANCELLED)
+                spdlog::error("cannot read {}: {}", filepath, e.what());
+            return;
+        }
+        auto on_scope_exit = scope_guard([&](void*) { g_free(pContents); });
+        _embfile_update(filepath, pContents, length);
+    }, embfileOpened.rCancellable);
+}
+
+void CtActions::_embfile_update(const fs::path& filepath, char* pContents, size_t length)
+{
+    auto data_vec = str::split(filepath.filename().string(), CtConst::CHAR_MINUS);
+    const gint64 node_id = std::stoll(data_vec[0]);
+    const size_t embfile_id = std::stol(data_vec[1]);
+
+    // usually the file was opened from the current node
+    CtTreeIter tree_iter = _pCtMainWin->curr_tree_iter();
+    if (tree_iter.get_node_id() != node_id)
+        tree_iter = _pCtMainWin->get_tree_store().get_node_from_node_id(node_id);
+    if (not tree_iter) return;
+    if (tree_iter.get_node_read_only())
+    {
+        CtDialogs::warning_dialog(_("Cannot Edit Embedded File in Read Only Node"), *_pCtMainWin);
+        return;
+    }
+    _pCtMainWin->get_tree_view().set_cursor_safe(tree_iter);
+    for (auto& widget: tree_iter.get_embedded_pixbufs_tables_codeboxes_fast())
+    {
+        if (CtImageEmbFile* embFile = dynamic_cast<CtImageEmbFile*>(widget))
+            if (((size_t)embFile->get_data("open_id")) == embfile_id)
             {
-                CtDialogs::warning_dialog(_("Cannot Edit Embedded File in Read Only Node"), *_pCtMainWin);
-                continue;
+                embFile->set_raw_blob(pContents, length);
+                embFile->set_time(std::time(nullptr));
+                embFile->update_tooltip();
+
+                _pCtMainWin->update_window_save_needed(CtSaveNeededUpdType::nbuf);
+                _pCtMainWin->get_status_bar().update_status(_("Embedded File Automatically Updated:") + std::string(CtConst::CHAR_SPACE) + embFile->get_file_name().string());
+                break;
             }
-            _pCtMainWin->get_tree_view().set_cursor_safe(tree_iter);
-            for (auto& widget: tree_iter.get_embedded_pixbufs_tables_codeboxes_fast())
-            {
-                if (CtImageEmbFile* embFile = dynamic_cast<CtImageEmbFile*>(widget))
-                    if (((size_t)embFile->get_data("open_id")) == embfile_id)
-                    {
-                        auto file = std::fstream(filepath.string(), std::ios::in | std::ios::binary);
-                        std::vector<char> buffer(std::istreambuf_iterator<char>(file), {});
-                        file.close();
-                        embFile->set_raw_blob(buffer.data(), buffer.size());
-                        embFile->set_time(std::time(nullptr));
-                        embFile->update_tooltip();
-
-                        _pCtMainWin->update_window_save_needed(CtSaveNeededUpdType::nbuf);
-                        _pCtMainWin->get_status_bar().update_status(_("Embedded File Automatically Updated:") + std::string(CtConst::CHAR_SPACE) + embFile->get_file_name().string());
-                        break;
-                    }
-           }
-        }
     }
-    return true; // this way we keep the timer alive
+}
+
+/*static*/ void CtActions::_embfile_unwatch(CtEmbFileOpened& embfileOpened)
+{
+    if (embfileOpened.rFileMonitor) embfileOpened.rFileMonitor->cancel();
+    if (embfileOpened.rCancellable) embfileOpened.rCancellable->cancel();
+    embfileOpened.debounceConnection.disconnect();
 }
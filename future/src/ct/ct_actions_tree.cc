@@ -106,23 +106,27 @@ void CtActions::node_subnodes_duplicate()
     _node_add(true, false);
     Gtk::TreeIter new_top_iter = _pCtMainWin->curr_tree_iter();
 
-    // function to duplicate a node
+    // the new nodes are all after the current max id, scan the tree only once
+    gint64 new_node_id = _pCtMainWin->get_tree_store().node_id_get();
+
+    // function to duplicate a node, its text buffer is created from the content snapshot at first use
     auto duplicate_subnode = [&](CtTreeIter old_iter, Gtk::TreeIter new_parent) {
         CtNodeData node_data;
-        std::shared_ptr<CtNodeState> node_state;
         _pCtMainWin->get_tree_store().get_node_data(old_iter, node_data);
         if (node_data.syntax != CtConst::RICH_TEXT_ID) {
-            node_data.rTextBuffer = _pCtMainWin->get_new_text_buffer(node_data.rTextBuffer->get_text());
-            node_data.anchoredWidgets.clear();
+            node_data.rTextBuffer = _pCtMainWin->get_new_text_buffer(old_iter.get_node_text_buffer()->get_text());
+            node_data.cloneSource.reset();
         } else {
-            _pCtMainWin->get_state_machine().update_state(old_iter);
-            node_state = _pCtMainWin->get_state_machine().requested_state_current(old_iter.get_node_id());
-            node_data.anchoredWidgets.clear();
-            node_data.rTextBuffer = _pCtMainWin->get_new_text_buffer();
+            // a duplicate not yet opened already has a content snapshot to share
+            if (not node_data.cloneSource) {
+                node_data.cloneSource = _pCtMainWin->get_state_machine().get_node_snapshot(old_iter);
+            }
+            node_data.rTextBuffer.reset();
         }
+        node_data.anchoredWidgets.clear();
         node_data.tsCreation = std::time(nullptr);
         node_data.tsLastSave = node_data.tsCreation;
-        node_data.nodeId = _pCtMainWin->get_tree_store().node_id_get();
+        node_data.nodeId = new_node_id++;
         auto new_iter = _pCtMainWin->get_tree_store().append_node(&node_data, &new_parent /* as parent */);
         _pCtMainWin->get_tree_store().to_ct_tree_iter(new_iter).pending_new_db_node();
         return new_iter;
@@ -136,9 +140,13 @@ void CtActions::node_subnodes_duplicate()
             duplicate_subnodes(child, new_child);
         }
     };
-    duplicate_subnodes(top_iter, new_top_iter);
+    {
+        _pCtMainWin->get_tree_store().bulk_load_begin();
+        auto on_scope_exit = scope_guard([&](void*) { _pCtMainWin->get_tree_store().bulk_load_end(); });
+        duplicate_subnodes(top_iter, new_top_iter);
+    }
 
-    _pCtMainWin->get_tree_store().nodes_sequences_fix(new_top_iter->parent(), true);
+    _pCtMainWin->get_tree_store().node_sequence_fix(new_top_iter);
     _pCtMainWin->get_tree_view().set_cursor_safe(new_top_iter);
     _pCtMainWin->get_text_view().grab_focus();
 }
@@ -151,13 +159,13 @@ void CtActions::_node_add(bool duplicate, bool add_child)
     {
         if (!_is_there_selected_node_or_error()) return;
         _pCtMainWin->get_tree_store().get_node_data(_pCtMainWin->curr_tree_iter(), nodeData);
+        nodeData.cloneSource.reset();
 
         if (nodeData.syntax != CtConst::RICH_TEXT_ID) {
             nodeData.rTextBuffer = _pCtMainWin->get_new_text_buffer(nodeData.rTextBuffer->get_text());
             nodeData.anchoredWidgets.clear();
         } else {
-            _pCtMainWin->get_state_machine().update_state(_pCtMainWin->curr_tree_iter());
-            node_state = _pCtMainWin->get_state_machine().requested_state_current(_pCtMainWin->curr_tree_iter().get_node_id());
+            node_state = _pCtMainWin->get_state_machine().get_node_snapshot(_pCtMainWin->curr_tree_iter());
             nodeData.anchoredWidgets.clear();
             nodeData.rTextBuffer = _pCtMainWin->get_new_text_buffer();
         }
@@ -198,7 +206,7 @@ void CtActions::_node_add_with_data(Gtk::TreeIter curr_iter, CtNodeData& nodeDat
     if (node_state)
         _pCtMainWin->load_buffer_from_state(node_state, _pCtMainWin->get_tree_store().to_ct_tree_iter(nodeIter));
     _pCtMainWin->get_tree_store().to_ct_tree_iter(nodeIter).pending_new_db_node();
-    _pCtMainWin->get_tree_store().nodes_sequences_fix(curr_iter ? curr_iter->parent() : Gtk::TreeIter(), false);
+    _pCtMainWin->get_tree_store().node_sequence_fix(nodeIter);
     _pCtMainWin->get_tree_store().update_node_aux_icon(nodeIter);
     _pCtMainWin->get_tree_view().set_cursor_safe(nodeIter);
     _pCtMainWin->get_text_view().grab_focus();
@@ -248,7 +256,7 @@ void CtActions::_node_move_after(Gtk::TreeIter iter_to_move, Gtk::TreeIter fathe
     _pCtMainWin->get_tree_store().get_store()->erase(iter_to_move);
     _pCtMainWin->get_tree_store().to_ct_tree_iter(new_node_iter).pending_edit_db_node_hier();
 
-    _pCtMainWin->get_tree_store().nodes_sequences_fix(Gtk::TreeIter(), true);
+    _pCtMainWin->get_tree_store().node_sequence_fix(new_node_iter);
     if (father_iter)
         _pCtMainWin->get_tree_view().expand_row(_pCtMainWin->get_tree_store().get_path(father_iter), false);
     else
@@ -259,24 +267,22 @@ void CtActions::_node_move_after(Gtk::TreeIter iter_to_move, Gtk::TreeIter fathe
     _pCtMainWin->update_window_save_needed();
 }
 
-bool CtActions::_need_node_swap(Gtk::TreeIter& leftIter, Gtk::TreeIter& rightIter, bool ascending)
+std::string CtActions::_node_sort_key(const Gtk::TreeIter& treeIter)
 {
-    Glib::ustring left_node_name = _pCtMainWin->get_tree_store().to_ct_tree_iter(leftIter).get_node_name().lowercase();
-    Glib::ustring right_node_name = _pCtMainWin->get_tree_store().to_ct_tree_iter(rightIter).get_node_name().lowercase();
-    //int cmp = left_node_name.compare(right_node_name);
-    int cmp = CtStrUtil::natural_compare(left_node_name, right_node_name);
-
-    return ascending ? cmp > 0 : cmp < 0;
+    return CtStrUtil::natural_sort_key(_pCtMainWin->get_tree_store().to_ct_tree_iter(treeIter).get_node_name().lowercase());
 }
 
-bool CtActions::_tree_sort_level_and_sublevels(const Gtk::TreeNodeChildren& children, bool ascending)
+bool CtActions::_tree_sort_level_and_sublevels(Gtk::TreeIter father_iter, bool ascending)
 {
-    auto need_swap = [this,&ascending](Gtk::TreeIter& l, Gtk::TreeIter& r) { return _need_node_swap(l, r, ascending); };
-    bool swap_excecuted = CtMiscUtil::node_siblings_sort_iteration(_pCtMainWin->get_tree_store().get_store(), children, need_swap);
+    const Gtk::TreeNodeChildren& children = father_iter ? father_iter->children() : _pCtMainWin->get_tree_store().get_store()->children();
+    auto get_sort_key = [this](const Gtk::TreeIter& iter) { return _node_sort_key(iter); };
+    bool sort_executed = CtMiscUtil::node_siblings_sort(_pCtMainWin->get_tree_store().get_store(), children, get_sort_key, ascending);
+    if (sort_executed)
+        _pCtMainWin->get_tree_store().nodes_sequences_fix(father_iter, false);
     for (auto& child: children)
-        if (_tree_sort_level_and_sublevels(child.children(), ascending))
-            swap_excecuted = true;
-    return swap_excecuted;
+        if (_tree_sort_level_and_sublevels(child, ascending))
+            sort_executed = true;
+    return sort_executed;
 }
 
 void CtActions::node_edit()
@@ -569,8 +575,7 @@ bool CtActions::node_move(Gtk::TreeModel::Path src_path, Gtk::TreeModel::Path de
 //"""Sorts the Tree Ascending"""
 void CtActions::tree_sort_ascending()
 {
-    if (_tree_sort_level_and_sublevels(_pCtMainWin->get_tree_store().get_store()->children(), true)) {
-        _pCtMainWin->get_tree_store().nodes_sequences_fix(Gtk::TreeIter(), true);
+    if (_tree_sort_level_and_sublevels(Gtk::TreeIter(), true)) {
         _pCtMainWin->update_window_save_needed();
     }
 }
@@ -578,8 +583,7 @@ void CtActions::tree_sort_ascending()
 //"""Sorts the Tree Ascending"""
 void CtActions::tree_sort_descending()
 {
-    if (_tree_sort_level_and_sublevels(_pCtMainWin->get_tree_store().get_store()->children(), false)) {
-        _pCtMainWin->get_tree_store().nodes_sequences_fix(Gtk::TreeIter(), true);
+    if (_tree_sort_level_and_sublevels(Gtk::TreeIter(), false)) {
         _pCtMainWin->update_window_save_needed();
     }
 }
@@ -590,9 +594,9 @@ void CtActions::node_siblings_sort_ascending()
     if (!_is_there_selected_node_or_error()) return;
     Gtk::TreeIter father_iter = _pCtMainWin->curr_tree_iter()->parent();
     const Gtk::TreeNodeChildren& children = father_iter ? father_iter->children() : _pCtMainWin->get_tree_store().get_store()->children();
-    auto need_swap = [this](Gtk::TreeIter& l, Gtk::TreeIter& r) { return _need_node_swap(l, r, true); };
-    if (CtMiscUtil::node_siblings_sort_iteration(_pCtMainWin->get_tree_store().get_store(), children, need_swap)) {
-        _pCtMainWin->get_tree_store().nodes_sequences_fix(father_iter, true);
+    auto get_sort_key = [this](const Gtk::TreeIter& iter) { return _node_sort_key(iter); };
+    if (CtMiscUtil::node_siblings_sort(_pCtMainWin->get_tree_store().get_store(), children, get_sort_key, true)) {
+        _pCtMainWin->get_tree_store().nodes_sequences_fix(father_iter, false);
         _pCtMainWin->update_window_save_needed();
     }
 }
@@ -603,9 +607,9 @@ void CtActions::node_siblings_sort_descending()
     if (!_is_there_selected_node_or_error()) return;
     Gtk::TreeIter father_iter = _pCtMainWin->curr_tree_iter()->parent();
     const Gtk::TreeNodeChildren& children = father_iter ? father_iter->children() : _pCtMainWin->get_tree_store().get_store()->children();
-    auto need_swap = [this](Gtk::TreeIter& l, Gtk::TreeIter& r) { return _need_node_swap(l, r, false); };
-    if (CtMiscUtil::node_siblings_sort_iteration(_pCtMainWin->get_tree_store().get_store(), children, need_swap)) {
-        _pCtMainWin->get_tree_store().nodes_sequences_fix(father_iter, true);
+    auto get_sort_key = [this](const Gtk::TreeIter& iter) { return _node_sort_key(iter); };
+    if (CtMiscUtil::node_siblings_sort(_pCtMainWin->get_tree_store().get_store(), children, get_sort_key, false)) {
+        _pCtMainWin->get_tree_store().nodes_sequences_fix(father_iter, false);
         _pCtMainWin->update_window_save_needed();
     }
 }
@@ -25,12 +25,18 @@
 #include "ct_app.h"
 #include "ct_pref_dlg.h"
 #include "ct_storage_control.h"
+#include "ct_storage_convert.h"
 #include "config.h"
 #include "ct_logging.h"
+#include "ct_thread_pool.h"
+#include <libxml/parser.h>
+#include <atomic>
 
 CtApp::CtApp() : Gtk::Application("com.giuspen.cherrytree", Gio::APPLICATION_HANDLES_OPEN)
 {
     Gsv::init();
+    // the main loop dispatcher of the shared thread pool belongs to the main thread
+    (void)CtThreadPool::get();
 
     std::string config_dir = Glib::build_filename(Glib::get_user_config_dir(), CtConst::APP_NAME);
     if (g_mkdir_with_parents(config_dir.c_str(), 0755) < 0)
@@ -137,15 +143,67 @@ void CtApp::on_activate()
 
 void CtApp::on_open(const Gio::Application::type_vec_files& files, const Glib::ustring& /*hint*/)
 {
+    // convert from console without creating any window and close app after
+    if (_convert)
+    {
+        if (files.size() % 2 != 0) {
+            spdlog::error("--convert expects pairs of files: source destination");
+            _exitStatus = EXIT_FAILURE;
+            return;
+        }
+        std::vector<std::pair<fs::path, fs::path>> conversions;
+        for (size_t i = 0; i < files.size(); i += 2) {
+            conversions.emplace_back(files[i]->get_path(), files[i+1]->get_path());
+        }
+        // the pairs run in parallel, a destination is removed before its source is read
+        for (size_t i = 0; i < conversions.size(); ++i) {
+            const auto& [file_from, file_to] = conversions[i];
+            if (fs::equivalent(file_from, file_to)) {
+                spdlog::error("{} is both source and destination", file_from);
+                _exitStatus = EXIT_FAILURE;
+                return;
+            }
+            for (size_t j = 0; j < conversions.size(); ++j) {
+                if (j != i and (fs::equivalent(file_to, conversions[j].second) or fs::equivalent(file_to, conversions[j].first))) {
+                    spdlog::error("{} is also used by another pair", file_to);
+                    _exitStatus = EXIT_FAILURE;
+                    return;
+                }
+            }
+        }
+        const Glib::ustring& new_password = _new_password.empty() ? _password : _new_password;
+        // libxml2 must be initialised by the main thread before parsing in parallel
+        xmlInitParser();
+        std::atomic<bool> any_failed{false};
+        CtMiscUtil::parallel_for(0, conversions.size(), [&](size_t i) {
+            const auto& [file_from, file_to] = conversions[i];
+            if (not _export_overwrite and fs::exists(file_to)) {
+                spdlog::error("{} already exists, use --export_overwrite", file_to);
+                any_failed = true;
+                return;
+            }
+            Glib::ustring error;
+            if (not CtStorageConvert::convert(file_from, _password, file_to, new_password, error)) {
+                spdlog::error("couldn't convert {} to {}: {}", file_from, file_to, error);
+                any_failed = true;
+            }
+        });
+        if (any_failed) {
+            _exitStatus = EXIT_FAILURE;
+        }
+        SPDLOG_DEBUG("convert is done, closing app");
+        return;
+    }
+
     // do some export stuff from console and close app after
     if ( not _export_to_txt_dir.empty() or
          not _export_to_html_dir.empty() or
          not _export_to_pdf_file.empty() )
     {
-        spdlog::debug("export arguments are detected");
+        SPDLOG_DEBUG("export arguments are detected");
         for (const Glib::RefPtr<Gio::File>& r_file : files)
         {
-            spdlog::debug("file to export: {}", r_file->get_path());
+            SPDLOG_DEBUG("file to export: {}", r_file->get_path());
             CtMainWin* pWin = _create_window(true/*no_gui*/);
             if (pWin->file_open(r_file->get_path(), "")) {
                 try {
@@ -166,7 +224,7 @@ void CtApp::on_open(const Gio::Application::type_vec_files& files, const Glib::u
             pWin->force_exit() = true;
             remove_window(*pWin);
         }
-        spdlog::debug("export is done, closing app");
+        SPDLOG_DEBUG("export is done, closing app");
         // exit app
         return;
     }
@@ -318,13 +376,17 @@ void CtApp::_add_main_option_entries()
     add_main_option_entry(Gio::Application::OPTION_TYPE_FILENAME, "export_to_txt_dir",  't', _("Export to Text at specified directory path"));
     add_main_option_entry(Gio::Application::OPTION_TYPE_FILENAME, "export_to_pdf_file", 'p', _("Export to PDF at specified file path"));
     add_main_option_entry(Gio::Application::OPTION_TYPE_BOOL,     "export_overwrite",   'w', _("Overwrite if export path already exists"));
+    add_main_option_entry(Gio::Application::OPTION_TYPE_BOOL,     "convert",            'c', _("Convert each pair of files: source destination, the document type from the file extension"));
+    add_main_option_entry(Gio::Application::OPTION_TYPE_STRING,   "password",           'P', _("Password of the source documents to convert"));
+    add_main_option_entry(Gio::Application::OPTION_TYPE_STRING,   "new_password",       'N', _("Password of the converted documents, defaults to the source password"));
+    add_main_option_entry(Gio::Application::OPTION_TYPE_STRING,   "log_level",          'l', _("Log level: trace, debug, info, warning, error, critical or off"));
 }
 
 void CtApp::_print_gresource_icons()
 {
     for (const std::string& str_icon : Gio::Resource::enumerate_children_global("/icons/", Gio::ResourceLookupFlags::RESOURCE_LOOKUP_FLAGS_NONE))
     {
-        spdlog::debug(str_icon);
+        SPDLOG_DEBUG(str_icon);
     }
 }
 
@@ -340,6 +402,20 @@ int CtApp::_on_handle_local_options(const Glib::RefPtr<Glib::VariantDict>& rOpti
     rOptions->lookup_value("export_to_txt_dir", _export_to_txt_dir);
     rOptions->lookup_value("export_to_pdf_file", _export_to_pdf_file);
     rOptions->lookup_value("export_overwrite", _export_overwrite);
+    rOptions->lookup_value("convert", _convert);
+    rOptions->lookup_value("password", _password);
+    rOptions->lookup_value("new_password", _new_password);
+
+    Glib::ustring log_level;
+    if (rOptions->lookup_value("log_level", log_level)) {
+        const spdlog::level::level_enum level = spdlog::level::from_str(log_level.raw());
+        if (level != spdlog::level::off or log_level == "off") {
+            spdlog::set_level(level);
+        }
+        else {
+            spdlog::warn("unknown log level '{}'", log_level);
+        }
+    }
 
     return -1; // Keep going
 }
@@ -47,6 +47,9 @@ protected:
 public:
     static Glib::RefPtr<CtApp> create();
 
+    // of the work done from console, to be returned by main
+    int get_exit_status() const { return _exitStatus; }
+
 private:
     std::unique_ptr<CtConfig> _uCtCfg;
     std::unique_ptr<CtTmp> _uCtTmp;
@@ -63,6 +66,10 @@ protected:
     std::string   _export_to_txt_dir;
     std::string   _export_to_pdf_file;
     bool          _export_overwrite{false};
+    bool          _convert{false};
+    Glib::ustring _password;
+    Glib::ustring _new_password;
+    int           _exitStatus{EXIT_SUCCESS};
 
 protected:
     void on_activate() override;
@@ -556,23 +556,19 @@ void CtClipboard::_on_received_to_table(const Gtk::SelectionData& selection_data
 
     if (parentTable)
     {
-        CtTableMatrix tableMatrix;
-        CtStorageXmlHelper(_pCtMainWin).populate_table_matrix(tableMatrix, static_cast<xmlpp::Element*>(doc->get_root_node()->get_first_child("table")));
+        CtTableTexts tableTexts;
+        CtStorageXmlHelper(_pCtMainWin).populate_table_matrix(tableTexts, static_cast<xmlpp::Element*>(doc->get_root_node()->get_first_child("table")));
 
-        int col_num = (int)parentTable->get_table_matrix()[0].size();
+        int col_num = (int)parentTable->get_num_columns();
         int insert_after = parentTable->current_row() - 1;
         if (insert_after < 0) insert_after = 0;
-        for (int row = 1 /*skip header*/; row < (int)tableMatrix.size(); ++row)
+        for (int row = 1 /*skip header*/; row < (int)tableTexts.size(); ++row)
         {
-            std::vector<Glib::ustring> new_row;
-            std::transform(tableMatrix[row].begin(), tableMatrix[row].end(), std::back_inserter(new_row), [](CtTableCell* cell) { return cell->get_text_content(); });
+            std::vector<Glib::ustring>& new_row = tableTexts[row];
             while ((int)new_row.size() > col_num) new_row.pop_back();
             while ((int)new_row.size() < col_num) new_row.push_back("");
             parentTable->row_add(insert_after + (row-1), &new_row);
         }
-        for (auto row: tableMatrix)
-            for (auto cell: row)
-                delete cell;
         _pCtMainWin->update_window_save_needed(CtSaveNeededUpdType::nbuf, true /*new_machine_state*/);
     }
     else
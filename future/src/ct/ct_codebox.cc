@@ -134,7 +134,7 @@ CtCodebox::CtCodebox(CtMainWin* pCtMainWin,
         _ctTextview.set_editable(!_pCtMainWin->get_ct_actions()->getCtMainWin()->curr_tree_iter().get_node_read_only());
         int x, y;
         _ctTextview.window_to_buffer_coords(Gtk::TEXT_WINDOW_TEXT, int(event->x), int(event->y), x, y);
-        _ctTextview.cursor_and_tooltips_handler(x, y);
+        _ctTextview.cursor_and_tooltips_queue(x, y);
         return false;
     });
     _ctTextview.signal_scroll_event().connect([this](GdkEventScroll* event){
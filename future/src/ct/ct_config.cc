@@ -50,7 +50,7 @@ bool CtConfig::load_from_file(const fs::path& filepath)
         _uKeyFile->load_from_file(filepath.string());
         _populate_data_from_keyfile();
         _uKeyFile.reset(nullptr);
-        spdlog::debug("{} parsed", filepath);
+        SPDLOG_DEBUG("{} parsed", filepath);
         return true;
     }
     spdlog::warn("{} missing", filepath);
@@ -273,6 +273,8 @@ void CtConfig::_populate_keyfile_from_data()
     _uKeyFile->set_integer(_currentGroup, "table_col_mode", static_cast<int>(tableColMode));
     _uKeyFile->set_integer(_currentGroup, "table_col_min", tableColMin);
     _uKeyFile->set_integer(_currentGroup, "table_col_max", tableColMax);
+    _uKeyFile->set_integer(_currentGroup, "table_cells_go_light", tableCellsGoLight);
+    _uKeyFile->set_integer(_currentGroup, "table_csv_max_rows", tableCsvMaxRows);
 
     // [fonts]
     _currentGroup = "fonts";
@@ -538,6 +540,8 @@ void CtConfig::_populate_data_from_keyfile()
     }
     _populate_int_from_keyfile("table_col_min", &tableColMin);
     _populate_int_from_keyfile("table_col_max", &tableColMax);
+    _populate_int_from_keyfile("table_cells_go_light", &tableCellsGoLight);
+    _populate_int_from_keyfile("table_csv_max_rows", &tableCsvMaxRows);
 
     // [fonts]
     _currentGroup = "fonts";
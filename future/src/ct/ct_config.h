@@ -142,6 +142,8 @@ public:
     CtTableColMode                              tableColMode{CtTableColMode::RENAME};
     int                                         tableColMin{40};
     int                                         tableColMax{60};
+    int                                         tableCellsGoLight{500};
+    int                                         tableCsvMaxRows{100000};
 
     // [fonts]
     std::string                                 rtFont{"Sans 9"};
@@ -241,10 +241,24 @@ bool CtDialogs::question_dialog(const Glib::ustring& message,
     return (Gtk::RESPONSE_OK == dialog.run());
 }
 
+// Without gui (export from the command line) a modal dialog would never be answered, log instead
+static bool _no_gui_log(const Glib::ustring& message, const spdlog::level::level_enum level, Gtk::Window& parent)
+{
+    CtMainWin* pCtMainWin = dynamic_cast<CtMainWin*>(&parent);
+    if (not pCtMainWin or not pCtMainWin->no_gui()) {
+        return false;
+    }
+    spdlog::log(level, "{}", message);
+    return true;
+}
+
 // The Info dialog
 void CtDialogs::info_dialog(const Glib::ustring& message,
                             Gtk::Window& parent)
 {
+    if (_no_gui_log(message, spdlog::level::info, parent)) {
+        return;
+    }
     Gtk::MessageDialog dialog(parent,
                               message,
                               true/* use_markup */,
@@ -260,6 +274,9 @@ void CtDialogs::info_dialog(const Glib::ustring& message,
 void CtDialogs::warning_dialog(const Glib::ustring& message,
                                Gtk::Window& parent)
 {
+    if (_no_gui_log(message, spdlog::level::warn, parent)) {
+        return;
+    }
     Gtk::MessageDialog dialog(parent,
                               message,
                               true/* use_markup */,
@@ -275,6 +292,9 @@ void CtDialogs::warning_dialog(const Glib::ustring& message,
 void CtDialogs::error_dialog(const Glib::ustring& message,
                              Gtk::Window& parent)
 {
+    if (_no_gui_log(message, spdlog::level::error, parent)) {
+        return;
+    }
     Gtk::MessageDialog dialog(parent,
                               message,
                               true/* use_markup */,
@@ -499,21 +519,13 @@ void CtDialogs::bookmarks_handle_dialog(CtMainWin* pCtMainWin)
     });
     button_sort_asc.signal_clicked().connect([&rModel]()
     {
-        auto need_swap = [&rModel](Gtk::TreeIter& l, Gtk::TreeIter& r)
-        {
-            int cmp = l->get_value(rModel->columns.desc).compare(r->get_value(rModel->columns.desc));
-            return (cmp > 0);
-        };
-        CtMiscUtil::node_siblings_sort_iteration(rModel, rModel->children(), need_swap);
+        auto get_sort_key = [&rModel](const Gtk::TreeIter& iter) { return iter->get_value(rModel->columns.desc).collate_key(); };
+        CtMiscUtil::node_siblings_sort(rModel, rModel->children(), get_sort_key, true);
     });
     button_sort_desc.signal_clicked().connect([&rModel]()
     {
-        auto need_swap = [&rModel](Gtk::TreeIter& l, Gtk::TreeIter& r)
-        {
-            int cmp = l->get_value(rModel->columns.desc).compare(r->get_value(rModel->columns.desc));
-            return (cmp < 0);
-        };
-        CtMiscUtil::node_siblings_sort_iteration(rModel, rModel->children(), need_swap);
+        auto get_sort_key = [&rModel](const Gtk::TreeIter& iter) { return iter->get_value(rModel->columns.desc).collate_key(); };
+        CtMiscUtil::node_siblings_sort(rModel, rModel->children(), get_sort_key, false);
     });
 
     if (dialog.run() != Gtk::RESPONSE_ACCEPT)
@@ -2184,6 +2196,21 @@ void CtDialogs::summary_info_dialog(CtMainWin* pCtMainWin, const CtSummaryInfo&
     grid.attach(label_an_key, 0, 7, 1, 1);
     Gtk::Label label_an_val{std::to_string(summaryInfo.anchors_num)};
     grid.attach(label_an_val, 1, 7, 1, 1);
+    Gtk::Label label_wo_key;
+    label_wo_key.set_markup(Glib::ustring{"<b>"} + _("Number of Words") + "</b>");
+    grid.attach(label_wo_key, 0, 8, 1, 1);
+    Gtk::Label label_wo_val{std::to_string(summaryInfo.words_num)};
+    grid.attach(label_wo_val, 1, 8, 1, 1);
+    Gtk::Label label_ch_key;
+    label_ch_key.set_markup(Glib::ustring{"<b>"} + _("Number of Characters") + "</b>");
+    grid.attach(label_ch_key, 0, 9, 1, 1);
+    Gtk::Label label_ch_val{std::to_string(summaryInfo.chars_num)};
+    grid.attach(label_ch_val, 1, 9, 1, 1);
+    Gtk::Label label_li_key;
+    label_li_key.set_markup(Glib::ustring{"<b>"} + _("Number of Lines") + "</b>");
+    grid.attach(label_li_key, 0, 10, 1, 1);
+    Gtk::Label label_li_val{std::to_string(summaryInfo.lines_num)};
+    grid.attach(label_li_val, 1, 10, 1, 1);
     Gtk::Box* pContentArea = dialog.get_content_area();
     pContentArea->pack_start(grid);
     pContentArea->show_all();
@@ -27,6 +27,7 @@
 #include "ct_dialogs.h"
 #include "ct_storage_control.h"
 #include "ct_logging.h"
+#include "ct_trace.h"
 #include "ct_process.h"
 #include <fstream>
 #include <filesystem>
@@ -83,7 +84,9 @@ bool CtExport2Html::prepare_html_folder(fs::path dir_place, fs::path new_folder,
 // Export a Node To HTML
 void CtExport2Html::node_export_to_html(CtTreeIter tree_iter, const CtExportOptions& options, const Glib::ustring& index, int sel_start, int sel_end)
 {
-    Glib::ustring html_text = str::format(HTML_HEADER, tree_iter.get_node_name());
+    CT_TRACE_SCOPE("export html node");
+    CtStringBuilder html_text;
+    html_text.append(str::format(HTML_HEADER, tree_iter.get_node_name()));
     if (index != "" && options.index_in_page)
     {
         auto script = R"HTML(
@@ -94,13 +97,13 @@ void CtExport2Html::node_export_to_html(CtTreeIter tree_iter, const CtExportOpti
                     window.location = 'index.html#' + page;
                 }
             </script>)HTML";
-        html_text = str::replace(html_text, "<script></script>", script);
+        html_text.replace_all({{"<script></script>", script}});
     }
-    html_text += "<div class='page'>";
+    html_text << "<div class='page'>";
     if (options.include_node_name)
-        html_text += "<h1 class='title'>" + tree_iter.get_node_name() + "</h1><br/>";
+        html_text << "<h1 class='title'>" << tree_iter.get_node_name() << "</h1><br/>";
 
-    std::vector<Glib::ustring> html_slots;
+    std::vector<std::string> html_slots;
     std::vector<CtAnchoredWidget*> widgets;
     if (tree_iter.get_node_is_rich_text())
     {
@@ -108,37 +111,38 @@ void CtExport2Html::node_export_to_html(CtTreeIter tree_iter, const CtExportOpti
         int images_count = 0;
         for (size_t i = 0; i < html_slots.size(); ++i)
         {
-            html_text += html_slots[i];
+            html_text << html_slots[i];
             if (i < widgets.size())
             {
                 if (CtImageEmbFile* embfile = dynamic_cast<CtImageEmbFile*>(widgets[i]))
-                    html_text += _get_embfile_html(embfile, tree_iter, _embed_dir);
+                    html_text << _get_embfile_html(embfile, tree_iter, _embed_dir);
                 else if (CtImage* image = dynamic_cast<CtImage*>(widgets[i]))
-                    html_text += _get_image_html(image, _images_dir, images_count, &tree_iter);
+                    html_text << _get_image_html(image, _images_dir, images_count, &tree_iter);
                 else if (CtTable* table = dynamic_cast<CtTable*>(widgets[i]))
-                    html_text += _get_table_html(table);
+                    html_text << _get_table_html(table);
                 else if (CtCodebox* codebox = dynamic_cast<CtCodebox*>(widgets[i]))
-                    html_text += _get_codebox_html(codebox);
+                    html_text << _get_codebox_html(codebox);
             }
         }
     }
     else
-        html_text += _html_get_from_code_buffer(tree_iter.get_node_text_buffer(), sel_start, sel_end, tree_iter.get_node_syntax_highlighting());
+        html_text << _html_get_from_code_buffer(tree_iter.get_node_text_buffer(), sel_start, sel_end, tree_iter.get_node_syntax_highlighting());
 
     if (index != "" && !options.index_in_page)
-        html_text += Glib::ustring("<p align=\"center\">") + Glib::build_filename("images", "home.png") +
-                "<img src=\"" "\" height=\"22\" width=\"22\">" +
-                CtConst::CHAR_SPACE + CtConst::CHAR_SPACE + "<a href=\"index.html\">\"" + _("Index") + "</a></p>";
-    html_text += "</div>"; // div class='page'
-    html_text += HTML_FOOTER;
+        html_text << "<p align=\"center\">" << Glib::build_filename("images", "home.png") <<
+                "<img src=\"" "\" height=\"22\" width=\"22\">" <<
+                CtConst::CHAR_SPACE << CtConst::CHAR_SPACE << "<a href=\"index.html\">\"" << _("Index") << "</a></p>";
+    html_text << "</div>"; // div class='page'
+    html_text << HTML_FOOTER;
 
     fs::path node_html_filepath = _export_dir / _get_html_filename(tree_iter);
-    g_file_set_contents(node_html_filepath.c_str(), html_text.c_str(), (gssize)html_text.bytes(), nullptr);
+    g_file_set_contents(node_html_filepath.c_str(), html_text.c_str(), (gssize)html_text.size(), nullptr);
 }
 
 // Export All Nodes To HTML
 void CtExport2Html::nodes_all_export_to_html(bool all_tree, const CtExportOptions& options)
 {
+    CT_TRACE_SCOPE("export html");
     // todo: shutil.copy(os.path.join(cons.GLADE_PATH, "home.png"), self.images_dir)
 
     // create tree links text
@@ -159,21 +163,22 @@ void CtExport2Html::nodes_all_export_to_html(bool all_tree, const CtExportOption
     tree_links_text += "</div>\n";
 
     // create index html page
-    Glib::ustring html_text = str::format(HTML_HEADER, _pCtMainWin->get_ct_storage()->get_file_name());
+    CtStringBuilder html_text;
+    html_text << str::format(HTML_HEADER, _pCtMainWin->get_ct_storage()->get_file_name());
     if (options.index_in_page)
     {
-        html_text += "<div class='two-panels'>\n<div class='tree-panel'>\n";
-        html_text += tree_links_text;
-        html_text += "</div>\n";
-        html_text += "<div class='page-panel'><iframe src='' id='page_frame'></iframe></div>";
-        html_text += "</div>"; // two-panels
+        html_text << "<div class='two-panels'>\n<div class='tree-panel'>\n";
+        html_text << tree_links_text;
+        html_text << "</div>\n";
+        html_text << "<div class='page-panel'><iframe src='' id='page_frame'></iframe></div>";
+        html_text << "</div>"; // two-panels
     }
     else
-        html_text += "<div class='page'>" + tree_links_text + "</div>";
-    html_text += "<script src='res/script3.js'></script>\n";
-    html_text += HTML_FOOTER;
+        html_text << "<div class='page'>" << tree_links_text << "</div>";
+    html_text << "<script src='res/script3.js'></script>\n";
+    html_text << HTML_FOOTER;
     fs::path node_html_filepath = _export_dir / "index.html";
-    g_file_set_contents(node_html_filepath.c_str(), html_text.c_str(), (gssize)html_text.bytes(), nullptr);
+    g_file_set_contents(node_html_filepath.c_str(), html_text.c_str(), (gssize)html_text.size(), nullptr);
 
     // create html pages
     // function to iterate nodes
@@ -221,7 +226,8 @@ void CtExport2Html::_tree_links_text_iter(CtTreeIter tree_iter, Glib::ustring& t
 Glib::ustring CtExport2Html::selection_export_to_html(Glib::RefPtr<Gtk::TextBuffer> text_buffer, Gtk::TextIter start_iter,
                                                       Gtk::TextIter end_iter, const Glib::ustring& syntax_highlighting)
 {
-    Glib::ustring html_text = str::format(HTML_HEADER, "");
+    CtStringBuilder html_text;
+    html_text << str::format(HTML_HEADER, "");
     if (syntax_highlighting == CtConst::RICH_TEXT_ID)
     {
         int images_count = 0;
@@ -232,39 +238,37 @@ Glib::ustring CtExport2Html::selection_export_to_html(Glib::RefPtr<Gtk::TextBuff
         for (CtAnchoredWidget* widget: widgets)
         {
             int end_offset = widget->getOffset();
-            html_text +=_html_process_slot(start_offset, end_offset, text_buffer);
-            if (CtImage* image = dynamic_cast<CtImage*>(widget)) html_text += _get_image_html(image, tempFolder, images_count, nullptr);
-            else if (CtTable* table = dynamic_cast<CtTable*>(widget)) html_text += _get_table_html(table);
-            else if (CtCodebox* codebox = dynamic_cast<CtCodebox*>(widget)) html_text += _get_codebox_html(codebox);
+            html_text << _html_process_slot(start_offset, end_offset, text_buffer);
+            if (CtImage* image = dynamic_cast<CtImage*>(widget)) html_text << _get_image_html(image, tempFolder, images_count, nullptr);
+            else if (CtTable* table = dynamic_cast<CtTable*>(widget)) html_text << _get_table_html(table);
+            else if (CtCodebox* codebox = dynamic_cast<CtCodebox*>(widget)) html_text << _get_codebox_html(codebox);
             start_offset = end_offset;
         }
-        html_text += _html_process_slot(start_offset, end_iter.get_offset(), text_buffer);
+        html_text << _html_process_slot(start_offset, end_iter.get_offset(), text_buffer);
     }
     else
     {
         Glib::RefPtr<Gsv::Buffer> gsv_buffer = Glib::RefPtr<Gsv::Buffer>::cast_dynamic(text_buffer);
-        html_text += _html_get_from_code_buffer(gsv_buffer, start_iter.get_offset(), end_iter.get_offset(), syntax_highlighting);
+        html_text << _html_get_from_code_buffer(gsv_buffer, start_iter.get_offset(), end_iter.get_offset(), syntax_highlighting);
     }
-    html_text += HTML_FOOTER;
-    return html_text;
+    html_text << HTML_FOOTER;
+    return html_text.str();
 }
 
 // Returns the HTML given the table
 Glib::ustring CtExport2Html::table_export_to_html(CtTable* table)
 {
-    Glib::ustring html_text = str::format(HTML_HEADER, "");
-    html_text += _get_table_html(table);
-    html_text += HTML_FOOTER;
-    return html_text;
+    CtStringBuilder html_text;
+    html_text << str::format(HTML_HEADER, "") << _get_table_html(table) << HTML_FOOTER;
+    return html_text.str();
 }
 
 // Returns the HTML given the codebox
 Glib::ustring CtExport2Html::codebox_export_to_html(CtCodebox* codebox)
 {
-    Glib::ustring html_text = str::format(HTML_HEADER, "");
-    html_text += _get_codebox_html(codebox);
-    html_text += HTML_FOOTER;
-    return html_text;
+    CtStringBuilder html_text;
+    html_text << str::format(HTML_HEADER, "") << _get_codebox_html(codebox) << HTML_FOOTER;
+    return html_text.str();
 }
 
 // Returns the HTML embedded file
@@ -315,42 +319,42 @@ Glib::ustring CtExport2Html::_get_image_html(CtImage* image, const fs::path& ima
 }
 
 // Returns the HTML CodeBox
-Glib::ustring CtExport2Html::_get_codebox_html(CtCodebox* codebox)
+std::string CtExport2Html::_get_codebox_html(CtCodebox* codebox)
 {
-    Glib::ustring codebox_html = "<div class=\"codebox\">";
-    codebox_html += _html_get_from_code_buffer(codebox->get_buffer(), -1, -1, codebox->get_syntax_highlighting());
-    codebox_html += "</div>";
-    return codebox_html;
+    CtStringBuilder codebox_html;
+    codebox_html << "<div class=\"codebox\">";
+    codebox_html << _html_get_from_code_buffer(codebox->get_buffer(), -1, -1, codebox->get_syntax_highlighting());
+    codebox_html << "</div>";
+    return codebox_html.release();
 }
 
 // Returns the HTML Table
-Glib::ustring CtExport2Html::_get_table_html(CtTable* table)
+std::string CtExport2Html::_get_table_html(CtTable* table)
 {
-    Glib::ustring table_html = "<table class=\"table\">";
+    CtStringBuilder table_html;
+    table_html << "<table class=\"table\">";
+    CtTableTexts tableTexts;
+    table->write_strings_matrix(tableTexts);
     bool first = true;
-    for (const auto& row: table->get_table_matrix())
+    for (const auto& row: tableTexts)
     {
-        table_html += "<tr>";
-        for (auto cell: row) {
-            Glib::ustring content = str::xml_escape(cell->get_text_content());
-            if (content.empty()) content = " "; // Otherwise the table will render with squashed cells
-    
-            if (first) {
-                table_html += "<th>" + content + "</th>";
-            } else {
-                table_html += "<td>" + content + "</td>";
-            }
+        table_html << "<tr>";
+        for (const Glib::ustring& content: row) {
+            table_html << (first ? "<th>" : "<td>");
+            if (content.empty()) table_html << " "; // Otherwise the table will render with squashed cells
+            else table_html.append_xml_escaped(content.raw());
+            table_html << (first ? "</th>" : "</td>");
         }
         
         if (first) first = false;
-        table_html += "</tr>";
+        table_html << "</tr>";
     }
-    table_html += "</table>";
-    return table_html;
+    table_html << "</table>";
+    return table_html.release();
 }
 
 // Get rich text from syntax highlighted code node
-Glib::ustring CtExport2Html::_html_get_from_code_buffer(const Glib::RefPtr<Gsv::Buffer>& code_buffer, int sel_start, int sel_end, const std::string& syntax_highlighting)
+std::string CtExport2Html::_html_get_from_code_buffer(const Glib::RefPtr<Gsv::Buffer>& code_buffer, int sel_start, int sel_end, const std::string& syntax_highlighting)
 {
     Gtk::TextIter curr_iter = sel_start >= 0 ? code_buffer->get_iter_at_offset(sel_start) : code_buffer->begin();
     code_buffer->ensure_highlight(curr_iter, code_buffer->end());
@@ -367,7 +371,8 @@ Glib::ustring CtExport2Html::_html_get_from_code_buffer(const Glib::RefPtr<Gsv::
         }
     }
     
-    Glib::ustring html_text      = "";
+    CtStringBuilder html_text;
+    html_text << "<div class=\"codebox\">";
     Glib::ustring former_tag_str = CtConst::COLOR_48_BLACK;
     bool span_opened = false;
     for (;;)
@@ -383,7 +388,7 @@ Glib::ustring CtExport2Html::_html_get_from_code_buffer(const Glib::RefPtr<Gsv::
                 {
                     former_tag_str = curr_tag_str;
                     // end of tag
-                    html_text += "</span>";
+                    html_text << "</span>";
                     span_opened = false;
                 }
             }
@@ -392,11 +397,11 @@ Glib::ustring CtExport2Html::_html_get_from_code_buffer(const Glib::RefPtr<Gsv::
                 if (former_tag_str != curr_tag_str)
                 {
                     former_tag_str = curr_tag_str;
-                    if (span_opened) html_text += "</span>";
+                    if (span_opened) html_text << "</span>";
                     // start of tag
                     Glib::ustring color = CtRgbUtil::rgb_to_no_white(curr_tag_str);
                     color = CtRgbUtil::get_rgb24str_from_str_any(color);
-                    html_text += "<span style=\"color:" + color + ";font-weight:" + std::to_string(font_weight) + "\">";
+                    html_text << "<span style=\"color:" << color << ";font-weight:" << std::to_string(font_weight) << "\">";
                     span_opened = true;
                 }
             }
@@ -405,24 +410,22 @@ Glib::ustring CtExport2Html::_html_get_from_code_buffer(const Glib::RefPtr<Gsv::
         {
             span_opened = false;
             former_tag_str = CtConst::COLOR_48_BLACK;
-            html_text += "</span>";
+            html_text << "</span>";
         }
-        Glib::ustring sym = str::xml_escape(Glib::ustring(1, curr_iter.get_char()));
-        html_text += str::replace(sym, " ", "&nbsp;");
+        html_text.append_xml_escaped_unichar(curr_iter.get_char(), true/*newline_to_br*/, true/*space_to_nbsp*/);
         if (!curr_iter.forward_char() || (sel_end >= 0 && curr_iter.get_offset() > sel_end))
         {
-            if (span_opened) html_text += "</span>";
+            if (span_opened) html_text << "</span>";
             break;
         }
     }
-
-    html_text = str::replace(html_text, CtConst::CHAR_NEWLINE, "<br />");
-    return "<div class=\"codebox\">" + html_text + "</div>";
+    html_text << "</div>";
+    return html_text.release();
 }
 
 // Given a treestore iter returns the HTML rich text
 void CtExport2Html::_html_get_from_treestore_node(CtTreeIter node_iter, int sel_start, int sel_end,
-                                                  std::vector<Glib::ustring>& out_slots, std::vector<CtAnchoredWidget*>& out_widgets)
+                                                  std::vector<std::string>& out_slots, std::vector<CtAnchoredWidget*>& out_widgets)
 {
     auto curr_buffer = node_iter.get_node_text_buffer();
     auto widgets = node_iter.get_embedded_pixbufs_tables_codeboxes(sel_start, sel_end);
@@ -444,28 +447,29 @@ void CtExport2Html::_html_get_from_treestore_node(CtTreeIter node_iter, int sel_
 
 
 // Process a Single HTML Slot
-Glib::ustring CtExport2Html::_html_process_slot(int start_offset, int end_offset, Glib::RefPtr<Gtk::TextBuffer> curr_buffer)
+std::string CtExport2Html::_html_process_slot(int start_offset, int end_offset, Glib::RefPtr<Gtk::TextBuffer> curr_buffer)
 {
-    Glib::ustring curr_html_text = "";
+    CtStringBuilder curr_html_text;
     CtTextIterUtil::generic_process_slot(start_offset, end_offset, curr_buffer,
                                          [&](Gtk::TextIter& start_iter, Gtk::TextIter& curr_iter, std::map<std::string_view, std::string>& curr_attributes) {
-        curr_html_text += _html_text_serialize(start_iter, curr_iter, curr_attributes);
+        _html_text_serialize(start_iter, curr_iter, curr_attributes, curr_html_text);
     });
 
-    curr_html_text = str::replace(curr_html_text, "<br/><p ", "<p ");
-    curr_html_text = str::replace(curr_html_text, "</p><br/>", "</p>");
-    for (auto header: {CtConst::TAG_PROP_VAL_H1, CtConst::TAG_PROP_VAL_H2, CtConst::TAG_PROP_VAL_H3})
-        curr_html_text = str::replace(curr_html_text, ("</" + Glib::ustring(header) + "><" + Glib::ustring(header) + " >").c_str(), "");
-
-    return curr_html_text;
+    curr_html_text.replace_all({{"<br/><p ", "<p "},
+                                {"</p><br/>", "</p>"},
+                                {"</h1><h1 >", ""},
+                                {"</h2><h2 >", ""},
+                                {"</h3><h3 >", ""}});
+    return curr_html_text.release();
 }
 
 // Adds a slice to the HTML Text
-Glib::ustring CtExport2Html::_html_text_serialize(Gtk::TextIter start_iter, Gtk::TextIter end_iter, const std::map<std::string_view, std::string>& curr_attributes)
+void CtExport2Html::_html_text_serialize(Gtk::TextIter start_iter, Gtk::TextIter end_iter, const std::map<std::string_view, std::string>& curr_attributes,
+                                         CtStringBuilder& html_out)
 {
-    Glib::ustring inner_text = str::xml_escape(start_iter.get_text(end_iter));
-    if (inner_text == "") return "";
-    inner_text = str::replace(inner_text, CtConst::CHAR_NEWLINE, "<br />");
+    CtStringBuilder inner_text;
+    inner_text.append_xml_escaped(start_iter.get_text(end_iter).raw(), true/*newline_to_br*/);
+    if (inner_text.empty()) return;
 
     Glib::ustring html_attrs = "";
     bool superscript_active = false;
@@ -558,34 +562,37 @@ Glib::ustring CtExport2Html::_html_text_serialize(Gtk::TextIter start_iter, Gtk:
             Glib::ustring href = _get_href_from_link_prop_val(property_value);
             if (href == "")
                 continue;
-            Glib::ustring html_text = "<a href=\"" + href + "\">" + inner_text + "</a>";
-            return html_text;
+            html_out << "<a href=\"" << href << "\">" << inner_text << "</a>";
+            return;
         }
         html_attrs += Glib::ustring(tag_property.data()) + ":" + property_value + ";";
     }
-    Glib::ustring tagged_text;
-    if (html_attrs == "" || inner_text == "<br />")
-        tagged_text = inner_text;
+    // the wrapping tags, from the outermost
+    if (italic_active) html_out << "<em>";
+    if (bold_active) html_out << "<strong>";
+    if (monospace_active) html_out << "<code>";
+    if (subscript_active) html_out << "<sub>";
+    if (superscript_active) html_out << "<sup>";
+    if (html_attrs == "" || inner_text.str() == "<br />")
+        html_out << inner_text;
     else
     {
         if (html_attrs.find("xx-large") != Glib::ustring::npos)
-            tagged_text = "<h1>" + inner_text + "</h1>";
+            html_out << "<h1>" << inner_text << "</h1>";
         else if (html_attrs.find("x-large") != Glib::ustring::npos)
-            tagged_text = "<h2>" + inner_text + "</h2>";
+            html_out << "<h2>" << inner_text << "</h2>";
         else if (html_attrs.find("large") != Glib::ustring::npos)
-            tagged_text = "<h3>" + inner_text + "</h3>";
+            html_out << "<h3>" << inner_text << "</h3>";
         else if (html_attrs.find("x-small") != Glib::ustring::npos)
-            tagged_text = "<small>" + inner_text + "</small>";
+            html_out << "<small>" << inner_text << "</small>";
         else
-            tagged_text = "<span style=\"" + html_attrs + "\">" + inner_text + "</span>";
+            html_out << "<span style=\"" << html_attrs << "\">" << inner_text << "</span>";
     }
-    if (superscript_active) tagged_text = "<sup>" + tagged_text + "</sup>";
-    if (subscript_active) tagged_text = "<sub>" + tagged_text + "</sub>";
-    if (monospace_active) tagged_text = "<code>" + tagged_text + "</code>";
-    if (bold_active) tagged_text = "<strong>" + tagged_text + "</strong>";
-    if (italic_active) tagged_text = "<em>" + tagged_text + "</em>";
-
-    return tagged_text;
+    if (superscript_active) html_out << "</sup>";
+    if (subscript_active) html_out << "</sub>";
+    if (monospace_active) html_out << "</code>";
+    if (bold_active) html_out << "</strong>";
+    if (italic_active) html_out << "</em>";
 }
 
 std::string CtExport2Html::_get_href_from_link_prop_val(Glib::ustring link_prop_val)
@@ -56,14 +56,15 @@ public:
 private:
     Glib::ustring _get_embfile_html(CtImageEmbFile* embfile, CtTreeIter tree_iter, fs::path embed_dir);
     Glib::ustring _get_image_html(CtImage* image, const fs::path& images_dir, int& images_count, CtTreeIter* tree_iter);
-    Glib::ustring _get_codebox_html(CtCodebox* codebox);
-    Glib::ustring _get_table_html(CtTable* table);
+    std::string   _get_codebox_html(CtCodebox* codebox);
+    std::string   _get_table_html(CtTable* table);
 
-    Glib::ustring _html_get_from_code_buffer(const Glib::RefPtr<Gsv::Buffer>& code_buffer, int sel_start, int sel_end, const std::string &syntax_highlighting);
+    std::string   _html_get_from_code_buffer(const Glib::RefPtr<Gsv::Buffer>& code_buffer, int sel_start, int sel_end, const std::string &syntax_highlighting);
     void          _html_get_from_treestore_node(CtTreeIter node_iter, int sel_start, int sel_end,
-                                       std::vector<Glib::ustring>& out_slots, std::vector<CtAnchoredWidget*>& out_widgets);
-    Glib::ustring _html_process_slot(int start_offset, int end_offset, Glib::RefPtr<Gtk::TextBuffer> curr_buffer);
-    Glib::ustring _html_text_serialize(Gtk::TextIter start_iter, Gtk::TextIter end_iter, const std::map<std::string_view, std::string>& curr_attributes);
+                                       std::vector<std::string>& out_slots, std::vector<CtAnchoredWidget*>& out_widgets);
+    std::string   _html_process_slot(int start_offset, int end_offset, Glib::RefPtr<Gtk::TextBuffer> curr_buffer);
+    void          _html_text_serialize(Gtk::TextIter start_iter, Gtk::TextIter end_iter, const std::map<std::string_view, std::string>& curr_attributes,
+                                       CtStringBuilder& html_out);
     std::string _get_href_from_link_prop_val(Glib::ustring link_prop_val);
     Glib::ustring _get_object_alignment_string(Glib::ustring alignment);
 
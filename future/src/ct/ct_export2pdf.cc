@@ -22,9 +22,13 @@
 #include "ct_export2pdf.h"
 #include "ct_dialogs.h"
 #include "ct_logging.h"
+#include "ct_trace.h"
 
 #include <numeric>
 #include <utility>
+#include <atomic>
+#include <thread>
+#include <pango/pangocairo.h>
 
 namespace {
 using tbl_grid_t = CtWidgetTablePrintable::tbl_grid_t;
@@ -185,20 +189,39 @@ std::pair<std::vector<double>, std::vector<double>> get_table_grid(std::vector<s
 }
 
 
-std::vector<std::vector<Glib::RefPtr<Pango::Layout>>> get_table_layouts(const CtPrintable::PrintInfo& print_info, const CtPrintTableProxy& tbl_proxy)
+// Read the cells text from the table buffers (main thread only)
+std::vector<std::vector<Glib::ustring>> get_table_cells_markup(const CtPrintTableProxy& tbl_proxy)
 {
-    std::vector<std::vector<Glib::RefPtr<Pango::Layout>>> table_layouts;
+    std::vector<std::vector<Glib::ustring>> cells_markup;
+    cells_markup.reserve(tbl_proxy.get_row_num());
     for (int i = 0; i < tbl_proxy.get_row_num(); ++i) {
-        std::vector<Glib::RefPtr<Pango::Layout>> layouts;
-
+        std::vector<Glib::ustring> row_markup;
+        row_markup.reserve(tbl_proxy.get_col_num());
         for (std::size_t j = 0; j < tbl_proxy.get_col_num(); ++j) {
             Glib::ustring text = str::xml_escape(tbl_proxy.get_cell(i, j));
             if (i == 0) text = "<b>" + text + "</b>";
-            auto layout = print_info.print_context->create_pango_layout();
+            row_markup.push_back(std::move(text));
+        }
+        cells_markup.push_back(std::move(row_markup));
+    }
+    return cells_markup;
+}
+
+std::vector<std::vector<Glib::RefPtr<Pango::Layout>>> get_table_layouts(const CtPrintable::PrintInfo& print_info,
+                                                                        const std::vector<std::vector<Glib::ustring>>& cells_markup,
+                                                                        int col_max)
+{
+    std::vector<std::vector<Glib::RefPtr<Pango::Layout>>> table_layouts;
+    table_layouts.reserve(cells_markup.size());
+    for (const auto& row_markup : cells_markup) {
+        std::vector<Glib::RefPtr<Pango::Layout>> layouts;
+        layouts.reserve(row_markup.size());
+        for (const auto& cell_markup : row_markup) {
+            auto layout = print_info.create_pango_layout();
             layout->set_font_description(print_info.font);
-            layout->set_width(static_cast<int>(tbl_proxy.get_table()->get_col_max() * Pango::SCALE));
+            layout->set_width(static_cast<int>(col_max * Pango::SCALE));
             layout->set_wrap(Pango::WRAP_WORD_CHAR);
-            layout->set_markup(text);
+            layout->set_markup(cell_markup);
             layouts.push_back(layout);
         }
         table_layouts.push_back(std::move(layouts));
@@ -208,11 +231,27 @@ std::vector<std::vector<Glib::RefPtr<Pango::Layout>>> get_table_layouts(const Ct
 
 
 
+// Same setup as Gtk::PrintContext::create_pango_layout() but on a private font map,
+// so that the context can be used by a worker thread while the others do the same
+Glib::RefPtr<Pango::Context> create_worker_pango_context(double dpi_y, const PangoMatrix* pMatrix)
+{
+    PangoFontMap* pFontMap = pango_cairo_font_map_new();
+    PangoContext* pPangoContext = pango_font_map_create_context(pFontMap);
+    g_object_unref(pFontMap); // the context holds its own reference
+    cairo_font_options_t* pFontOptions = cairo_font_options_create();
+    cairo_font_options_set_hint_metrics(pFontOptions, CAIRO_HINT_METRICS_OFF);
+    pango_cairo_context_set_font_options(pPangoContext, pFontOptions);
+    cairo_font_options_destroy(pFontOptions);
+    pango_cairo_context_set_resolution(pPangoContext, dpi_y);
+    pango_context_set_matrix(pPangoContext, pMatrix);
+    return Glib::wrap(pPangoContext);
+}
+
+// Pagination only, the printables heights are precomputed by CtPrint::setup_printables
 int calculate_nb_pages(const CtPrintable::PrintInfo& p_info, const CtPrintableVector& printables) 
 {
     long double total = 0;
     for (const auto& printable : printables) {
-        printable->setup(p_info);
         auto curr_y = fmod(total, p_info.page_height);
         total += printable->height_when_wrapped(p_info.page_height - curr_y);
         
@@ -253,9 +292,10 @@ void draw_codebox_code(const Cairo::RefPtr<Cairo::Context>& cairo_context, CtPri
     }
 }
 
-Glib::RefPtr<Pango::Layout> calc_codebox_layout(const CtPrintable::PrintInfo& print_info, const CtPrintCodeboxProxy& proxy)
+Glib::RefPtr<Pango::Layout> calc_codebox_layout(const CtPrintable::PrintInfo& print_info, const CtPrintCodeboxProxy& proxy,
+                                                const Glib::ustring& text_content)
 {
-    auto layout = print_info.print_context->create_pango_layout();
+    auto layout = print_info.create_pango_layout();
     layout->set_font_description(print_info.codebox_font);
     double codebox_width = proxy.get_width_in_pixels() ? proxy.get_frame_width() : print_info.text_window_width * proxy.get_frame_width()/100.;
     if (codebox_width > print_info.page_width) {
@@ -264,7 +304,7 @@ Glib::RefPtr<Pango::Layout> calc_codebox_layout(const CtPrintable::PrintInfo& pr
 
     layout->set_width(static_cast<int>(codebox_width * Pango::SCALE));
     layout->set_wrap(Pango::WRAP_WORD_CHAR);
-    layout->set_markup(proxy.get_text_content());
+    layout->set_markup(text_content);
     return layout;
 }
 
@@ -318,6 +358,7 @@ std::unique_ptr<CtDestPrintable> generate_node_name_printable(Glib::ustring node
 
 void CtExport2Pdf::node_export_print(const fs::path& pdf_filepath, CtTreeIter tree_iter, const CtExportOptions& options, int sel_start, int sel_end)
 {
+    CT_TRACE_SCOPE("export pdf");
     CtPrintableVector printable_slots;
     Glib::ustring text_font;
     if (tree_iter.get_node_is_rich_text())
@@ -336,21 +377,23 @@ void CtExport2Pdf::node_export_print(const fs::path& pdf_filepath, CtTreeIter tr
     }
 
     _pCtMainWin->get_ct_print().print_text(_pCtMainWin, pdf_filepath, printable_slots, text_font, _pCtMainWin->get_ct_config()->codeFont,
-                                            _pCtMainWin->get_text_view().get_allocation().get_width());
+                                            _pCtMainWin->get_text_view_width());
 }
 
 void CtExport2Pdf::node_and_subnodes_export_print(const fs::path& pdf_filepath, CtTreeIter tree_iter, const CtExportOptions& options)
 {
+    CT_TRACE_SCOPE("export pdf");
     CtPrintableVector tree_pango_slots;
     Glib::ustring text_font = _pCtMainWin->get_ct_config()->codeFont;
     _nodes_all_export_print_iter(tree_iter, options, tree_pango_slots, text_font);
 
     _pCtMainWin->get_ct_print().print_text(_pCtMainWin, pdf_filepath, tree_pango_slots, text_font, _pCtMainWin->get_ct_config()->codeFont,
-                                            _pCtMainWin->get_text_view().get_allocation().get_width());
+                                            _pCtMainWin->get_text_view_width());
 }
 
 void CtExport2Pdf::tree_export_print(const fs::path& pdf_filepath, CtTreeIter tree_iter, const CtExportOptions& options)
 {
+    CT_TRACE_SCOPE("export pdf");
     CtPrintableVector tree_printables;
     Glib::ustring text_font = _pCtMainWin->get_ct_config()->codeFont;
     while (tree_iter)
@@ -359,7 +402,7 @@ void CtExport2Pdf::tree_export_print(const fs::path& pdf_filepath, CtTreeIter tr
         ++tree_iter;
     }
     _pCtMainWin->get_ct_print().print_text(_pCtMainWin, pdf_filepath, tree_printables, text_font, _pCtMainWin->get_ct_config()->codeFont, 
-                                            _pCtMainWin->get_text_view().get_allocation().get_width());
+                                            _pCtMainWin->get_text_view_width());
 }
 
 void CtExport2Pdf::_nodes_all_export_print_iter(const CtTreeIter& tree_iter, const CtExportOptions& options,
@@ -413,6 +456,11 @@ Glib::ustring CtPrintCodeboxProxy::pango_from_code_buffer(CtCodebox* codebox) co
     return CtExport2Pango().pango_get_from_code_buffer(codebox->get_buffer(), -1, -1); 
 }
 
+Glib::RefPtr<Pango::Layout> CtPrintable::PrintInfo::create_pango_layout() const
+{
+    return pango_context ? Pango::Layout::create(pango_context) : print_context->create_pango_layout();
+}
+
 CtPrint::CtPrint()
 {
     _pPrintSettings = Gtk::PrintSettings::create();
@@ -430,6 +478,7 @@ void CtPrint::print_text(CtMainWin* pCtMainWin, const fs::path& pdf_filepath,
                          CtPrintableVector printables, const Glib::ustring& text_font, const Glib::ustring& code_font,
                          int text_window_width)
 {
+    CT_TRACE_SCOPE("export pdf print");
     _pCtMainWin = pCtMainWin;
     _print_info.font = Pango::FontDescription(text_font);
     _print_info.codebox_font = Pango::FontDescription(code_font);
@@ -464,7 +513,10 @@ void CtPrint::print_text(CtMainWin* pCtMainWin, const fs::path& pdf_filepath,
     } 
 
     if (!print_data.warning.empty()){
-        _pCtMainWin->get_status_bar().update_status(print_data.warning);
+        if (_pCtMainWin->no_gui())
+            spdlog::warn("{}", print_data.warning);
+        else
+            _pCtMainWin->get_status_bar().update_status(print_data.warning);
     }
 }
 
@@ -479,9 +531,11 @@ void CtPrint::_on_begin_print_text(const Glib::RefPtr<Gtk::PrintContext>& contex
     _print_info.newline_height = calculate_newline_height(context, _print_info.font, _print_info.page_width);
     _print_info.print_context = context;
 
+    spdlog::info("Calculating layouts...");
+    setup_printables(_print_info, print_data->printables);
     spdlog::info("Calculating number of pages...");
     print_data->nb_pages = calculate_nb_pages(_print_info, print_data->printables);
-    spdlog::debug("\n-- Print Info --\nPages: {}\nPage width: {}\nPage height: {}\nNewline height: {}\nNum. printables: {}\n-- = --", print_data->nb_pages, _print_info.page_width, _print_info.page_height, _print_info.newline_height, print_data->printables.size());
+    SPDLOG_DEBUG("\n-- Print Info --\nPages: {}\nPage width: {}\nPage height: {}\nNewline height: {}\nNum. printables: {}\n-- = --", print_data->nb_pages, _print_info.page_width, _print_info.page_height, _print_info.newline_height, print_data->printables.size());
     print_data->operation->set_n_pages(print_data->nb_pages);
 }
 
@@ -533,13 +587,52 @@ void CtPrint::_on_draw_page_text(const Glib::RefPtr<Gtk::PrintContext>& context,
             }
 
         }
-        spdlog::debug("Finished, page num: {}/{}", page_nr + 1, print_data->nb_pages);
+        SPDLOG_DEBUG("Finished, page num: {}/{}", page_nr + 1, print_data->nb_pages);
     } catch(const std::exception& e) {
         report_print_exception(e.what(), *_pCtMainWin);
         print_data->operation->cancel(); // If an error has got this far it is fatal
     }
 }
 
+// Layout stage: the printables are independent so their Pango layouts are computed concurrently,
+// every worker thread with its own Pango context; what needs GTK is collected first on the main thread
+void CtPrint::setup_printables(const CtPrintable::PrintInfo& print_info, const CtPrintableVector& printables)
+{
+    for (const auto& printable : printables) {
+        printable->prepare();
+    }
+    if (printables.empty()) return;
+
+    PangoMatrix matrix = PANGO_MATRIX_INIT;
+    const PangoMatrix* pMatrix = pango_context_get_matrix(print_info.create_pango_layout()->get_context()->gobj());
+    if (pMatrix) matrix = *pMatrix;
+    const double dpi_y = print_info.print_context->get_dpi_y();
+
+    const size_t workers_num = std::min<size_t>(std::max(1u, std::thread::hardware_concurrency()), printables.size());
+    std::atomic<size_t> next_printable{0};
+    std::vector<char> setup_failed(printables.size(), false);
+    CtMiscUtil::parallel_for(0, workers_num, [&](size_t /*worker*/) {
+        CtPrintable::PrintInfo worker_print_info = print_info;
+        worker_print_info.pango_context = create_worker_pango_context(dpi_y, pMatrix ? &matrix : nullptr);
+        // the printables are taken one by one as big tables and codeboxes make static slices unbalanced
+        for (size_t i = next_printable++; i < printables.size(); i = next_printable++) {
+            try {
+                printables[i]->setup(worker_print_info);
+            }
+            catch (std::exception& e) {
+                spdlog::error("Exception caught in layout worker: {}", e.what());
+                setup_failed[i] = true;
+            }
+        }
+    });
+    // second chance on the main thread
+    for (size_t i = 0; i < printables.size(); ++i) {
+        if (setup_failed[i]) {
+            printables[i]->setup(print_info);
+        }
+    }
+}
+
 // Returns Width and Height of a layout line
 Cairo::Rectangle CtPrint::layout_line_get_width_height(Glib::RefPtr<const Pango::LayoutLine> line)
 {
@@ -586,7 +679,7 @@ Glib::ustring CtExport2Pango::pango_get_from_code_buffer(Glib::RefPtr<Gsv::Buffe
     Gtk::TextIter curr_iter = sel_start < 0 ? code_buffer->begin() : code_buffer->get_iter_at_offset(sel_start);
     Gtk::TextIter end_iter = sel_start < 0 ? code_buffer->end() : code_buffer->get_iter_at_offset(sel_end);
     code_buffer->ensure_highlight(curr_iter, end_iter);
-    Glib::ustring pango_text = "";
+    CtStringBuilder pango_text;
     Glib::ustring former_tag_str = CtConst::COLOR_48_BLACK;
     bool span_opened = false;
     while (true)
@@ -602,7 +695,7 @@ Glib::ustring CtExport2Pango::pango_get_from_code_buffer(Glib::RefPtr<Gsv::Buffe
                 {
                     former_tag_str = curr_tag_str;
                     // end of tag
-                    pango_text += "</span>";
+                    pango_text << "</span>";
                     span_opened = false;
                 }
             }
@@ -611,10 +704,10 @@ Glib::ustring CtExport2Pango::pango_get_from_code_buffer(Glib::RefPtr<Gsv::Buffe
                 if (former_tag_str != curr_tag_str)
                 {
                     former_tag_str = curr_tag_str;
-                    if (span_opened) pango_text += "</span>";
+                    if (span_opened) pango_text << "</span>";
                     // start of tag
                     Glib::ustring color = CtRgbUtil::get_rgb24str_from_str_any(CtRgbUtil::rgb_to_no_white(curr_tag_str));
-                    pango_text += "<span foreground=\"" + curr_tag_str + "\" font_weight=\"" + std::to_string(font_weight) + "\">";
+                    pango_text << "<span foreground=\"" << curr_tag_str << "\" font_weight=\"" << std::to_string(font_weight) << "\">";
                     span_opened = true;
                 }
             }
@@ -623,18 +716,18 @@ Glib::ustring CtExport2Pango::pango_get_from_code_buffer(Glib::RefPtr<Gsv::Buffe
         {
             span_opened = false;
             former_tag_str = CtConst::COLOR_48_BLACK;
-            pango_text += "</span>";
+            pango_text << "</span>";
         }
-        pango_text += str::xml_escape(Glib::ustring(1, curr_iter.get_char()));
+        pango_text.append_xml_escaped_unichar(curr_iter.get_char());
         if (!curr_iter.forward_char() || (sel_end >= 0 && curr_iter.get_offset() > sel_end))
         {
-            if (span_opened) pango_text += "</span>";
+            if (span_opened) pango_text << "</span>";
             break;
         }
     }
-    if (pango_text.empty() || pango_text[pango_text.size()-1] != g_utf8_get_char(CtConst::CHAR_NEWLINE))
-        pango_text += CtConst::CHAR_NEWLINE;
-    return pango_text;
+    if (pango_text.empty() || pango_text.back() != '\n')
+        pango_text << CtConst::CHAR_NEWLINE;
+    return pango_text.release();
 }
 
 
@@ -647,7 +740,7 @@ std::unique_ptr<CtPrintable> printable_from_widget(CtAnchoredWidget* widget, int
 
     if (auto* img_anchor = dynamic_cast<CtImageAnchor*>(widget)) return std::make_unique<CtDestPrintable>(img_anchor, node_id);
     else if (auto* image = dynamic_cast<CtImage*>(widget))       return std::make_unique<CtWidgetImagePrintable>(std::make_shared<CtPrintImageProxy>(image));
-    else if (auto* table = dynamic_cast<CtTable*>(widget))       return std::make_unique<CtWidgetTablePrintable>(std::make_shared<CtPrintTableProxy>(table, 1, table->get_table_matrix().size()));
+    else if (auto* table = dynamic_cast<CtTable*>(widget))       return std::make_unique<CtWidgetTablePrintable>(std::make_shared<CtPrintTableProxy>(table, 1, table->get_num_rows()));
     else if (auto* codebox = dynamic_cast<CtCodebox*>(widget))   return std::make_unique<CtWidgetCodeboxPrintable>(std::make_shared<CtPrintCodeboxProxy>(codebox));
 
     else {
@@ -752,19 +845,21 @@ CtExport2Pango::_pango_text_serialize(const Gtk::TextIter& start_iter, Gtk::Text
             link_url = curr_attributes.at(tag_property);
         }
     }
-    Glib::ustring tagged_text;
-    if (pango_attrs.empty())
-        tagged_text = str::xml_escape(start_iter.get_text(end_iter));
-    else
-        tagged_text = "<span" + pango_attrs + ">" + str::xml_escape(start_iter.get_text(end_iter)) + "</span>";
-    if (superscript_active) tagged_text = "<sup>" + tagged_text + "</sup>";
-    if (subscript_active) tagged_text = "<sub>" + tagged_text + "</sub>";
-    if (monospace_active) tagged_text = "<tt>" + tagged_text + "</tt>";
+    CtStringBuilder tagged_text;
+    if (monospace_active) tagged_text << "<tt>";
+    if (subscript_active) tagged_text << "<sub>";
+    if (superscript_active) tagged_text << "<sup>";
+    if (!pango_attrs.empty()) tagged_text << "<span" << pango_attrs << ">";
+    tagged_text.append_xml_escaped(start_iter.get_text(end_iter).raw());
+    if (!pango_attrs.empty()) tagged_text << "</span>";
+    if (superscript_active) tagged_text << "</sup>";
+    if (subscript_active) tagged_text << "</sub>";
+    if (monospace_active) tagged_text << "</tt>";
 
     if (!link_url.empty()) {
-        return std::make_unique<CtLinkPrintable>(std::move(tagged_text), std::move(link_url));
+        return std::make_unique<CtLinkPrintable>(tagged_text.release(), std::move(link_url));
     }
-    return std::make_unique<CtTextPrintable>(tagged_text);
+    return std::make_unique<CtTextPrintable>(tagged_text.release());
 }
 
 
@@ -829,16 +924,29 @@ double CtWidgetImagePrintable::height() const
 
 
 
+void CtWidgetTablePrintable::prepare()
+{
+    _tbl_cells_markup = get_table_cells_markup(*_widget_proxy);
+}
+
 void CtWidgetTablePrintable::setup(const PrintInfo& print_info)
 {
-    _tbl_layouts = get_table_layouts(print_info, *_widget_proxy);
+    _tbl_layouts = get_table_layouts(print_info, _tbl_cells_markup, _widget_proxy->get_table()->get_col_max());
     _tbl_grid = get_table_grid(_tbl_layouts, _widget_proxy->get_table()->get_col_min());
 }
 
 
+void CtWidgetCodeboxPrintable::prepare()
+{
+    _text_content = _widget_proxy->get_text_content();
+}
+
 void CtWidgetCodeboxPrintable::setup(const PrintInfo& print_info)
 {
-    _layout = calc_codebox_layout(print_info, *_widget_proxy);
+    _layout = calc_codebox_layout(print_info, *_widget_proxy, _text_content);
+    // line breaking is lazy in Pango, force it here to keep it in the layout stage
+    _width = CtPrint::get_width_from_layout(_layout);
+    _height = CtPrint::get_height_from_layout(_layout);
 }
 
 CtPrintable::PrintPosition CtWidgetCodeboxPrintable::print(const CtPrintable::PrintingContext& context)
@@ -850,7 +958,7 @@ CtPrintable::PrintPosition CtWidgetCodeboxPrintable::print(const CtPrintable::Pr
     if (!_done) {
         const auto& ph = context.print_info.page_height;
         if (pos.y >  ph && c_height < ph && pos.y != 0) {
-           spdlog::debug("Codebox wrapping: {}/{}", pos.y, ph);
+           SPDLOG_DEBUG("Codebox wrapping: {}/{}", pos.y, ph);
            return pos;
         }
         
@@ -885,31 +993,30 @@ CtPrintable::PrintPosition CtWidgetCodeboxPrintable::print(const CtPrintable::Pr
 
 double CtWidgetCodeboxPrintable::width() const
 {
-    return CtPrint::get_width_from_layout(_layout);
+    return _width;
 }
 
 double CtWidgetCodeboxPrintable::height() const
 {
-    return CtPrint::get_height_from_layout(_layout);
+    return _height;
 }
 
 
 void CtTextPrintable::setup(const PrintInfo& print_info)
 {
-    auto& print_context = print_info.print_context;
     _is_newline = _text == CtConst::CHAR_NEWLINE;
 
-    _layout = print_context->create_pango_layout();
+    _layout = print_info.create_pango_layout();
     _layout->set_font_description(print_info.font);
     auto page_width = static_cast<int>(print_info.page_width);
     _layout->set_width(page_width * Pango::SCALE);
     _layout->set_markup(_text);
+    _height = _calc_lines_heights();
 }
 
 double CtTextPrintable::height() const
 {
-    double height = _calc_lines_heights();
-    return height;
+    return _height;
 }
 
 double CtTextPrintable::_calc_lines_heights() const 
@@ -939,7 +1046,7 @@ CtPrintable::PrintPosition CtTextPrintable::print(const PrintingContext& context
         }
         if (pos.y >= context.print_info.page_height) {
             // Out of space
-            spdlog::debug("Out of space on pos: {}/{}", pos.y, context.print_info.page_height);
+            SPDLOG_DEBUG("Out of space on pos: {}/{}", pos.y, context.print_info.page_height);
             break;
         }
         context.cairo_context->move_to(pos.x, pos.y);
@@ -989,7 +1096,7 @@ CtPrintable::PrintPosition CtWidgetTablePrintable::print(const CtPrintable::Prin
 
     if (!done()) {
         if (pos.y > context.print_info.page_height && context.position.y != 0 && height() < context.print_info.page_height) {
-            spdlog::debug("Table too big for page: {}/{}", pos.y, context.print_info.page_height);
+            SPDLOG_DEBUG("Table too big for page: {}/{}", pos.y, context.print_info.page_height);
             return pos;
         }
         auto rem_h = context.print_info.page_height - context.position.y;
@@ -1076,7 +1183,7 @@ CtLinkPrintable::CtLinkPrintable(Glib::ustring title, std::string url) : CtTextP
 
             _url = dest_id_from_node_and_anchor(std::stoi(node_id), sect_id);
             _is_internal = true;
-            spdlog::debug("Created link to: {}", _url);
+            SPDLOG_DEBUG("Created link to: {}", _url);
         } else {
             // Unknown, try and unwrap it
             _url = CtStrUtil::external_uri_from_internal(_url);
@@ -1109,7 +1216,7 @@ CtPrintable::PrintPosition CtLinkPrintable::print(const PrintingContext& context
     if (!done()) {
         try {
             std::string attrs = fmt::format("{}='{}'", _is_internal ? "dest" : "uri", _url);
-            spdlog::debug("Printed link: {}", attrs);
+            SPDLOG_DEBUG("Printed link: {}", attrs);
             pos = print_with_cairo_tag(context.cairo_context->cobj(), [this, &context]() {
                 return CtTextPrintable::print(context);
             }, CAIRO_TAG_LINK, attrs);
@@ -1133,7 +1240,7 @@ CtPrintable::PrintPosition CtDestPrintable::print(const PrintingContext& context
     auto pos = context.position;
     if (!_done) {
         try {
-            spdlog::debug("Printed dest: {}", _id);
+            SPDLOG_DEBUG("Printed dest: {}", _id);
             
             pos = print_with_cairo_tag(context.cairo_context->cobj(), [this, &context]{
                 return CtTextPrintable::print(context); 
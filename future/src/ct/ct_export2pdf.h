@@ -43,6 +43,9 @@ public:
         double newline_height;
         int table_line_thickness;
         int text_window_width;
+        Glib::RefPtr<Pango::Context> pango_context; // if set, layouts are created from it instead of print_context
+
+        Glib::RefPtr<Pango::Layout> create_pango_layout() const;
     };
     struct PrintPosition {
         double x;
@@ -55,6 +58,9 @@ public:
         PrintPosition position;
     };
 
+    /// Collect what setup() needs from GTK buffers/widgets, always called on the main thread
+    virtual void prepare() {}
+    /// Compute the Pango layouts, can run on a worker thread with its own print_info.pango_context
     virtual void setup(const PrintInfo& print_info) = 0;
     virtual PrintPosition print(const PrintingContext& context) = 0;
     [[nodiscard]] virtual double height() const = 0;
@@ -88,6 +94,7 @@ public:
 private:
     Glib::ustring _text;
     Glib::RefPtr<Pango::Layout> _layout;
+    double _height = 0;
     bool _is_newline = false;
     int _line_index = 0;
 
@@ -209,16 +216,11 @@ public:
     void     remove_first_rows(int remove_row_num) { _startRow += remove_row_num; _rowNum -= remove_row_num; }
     constexpr CtTable* get_table()   const            { return _table; }
     constexpr int      get_row_num() const            { return _rowNum; }
-    std::size_t      get_col_num() const            { return _table->get_table_matrix().begin()->size(); }
-    // todo: it can work slow because of moving iterators every time; to fix: replace list by vector or use cache
+    std::size_t      get_col_num() const            { return _table->get_num_columns(); }
     Glib::ustring get_cell(int row, int col) const {
         // 0 row is always header row, 1 row starts from _startRow
         row = (row == 0) ? 0 : row - 1 + _startRow;
-        auto tableRow = _table->get_table_matrix().begin();
-        std::advance(tableRow, row);
-        auto tableCell = tableRow->begin();
-        std::advance(tableCell, col);
-        return (*tableCell)->get_text_content();
+        return _table->get_cell_text(row, col);
     }
 
 private:
@@ -286,9 +288,11 @@ public:
 
     double height() const override;
 
+    void prepare() override;
     void setup(const PrintInfo& print_info) override;
 private:
     std::size_t _printed_rows = 0;
+    std::vector<std::vector<Glib::ustring>> _tbl_cells_markup;
     tbl_layouts_t _tbl_layouts;
     tbl_grid_t _tbl_grid;
 
@@ -298,6 +302,7 @@ class CtWidgetCodeboxPrintable: public CtWidgetPrintable<CtPrintCodeboxProxy> {
 public:
     using CtWidgetPrintable::CtWidgetPrintable;
 
+    void prepare() override;
     void setup(const PrintInfo& print_info) override;
 
     PrintPosition print(const PrintingContext& context) override;
@@ -308,7 +313,10 @@ public:
 
 
 private:
+    Glib::ustring _text_content;
     Glib::RefPtr<Pango::Layout> _layout;
+    double _height = 0;
+    double _width = 0;
     std::size_t _drawn_lines = 0;
 };
 
@@ -338,6 +346,7 @@ public:
     static          Cairo::Rectangle layout_line_get_width_height(Glib::RefPtr<const Pango::LayoutLine> line);
     static double   get_height_from_layout(Glib::RefPtr<Pango::Layout> layout);
     static  double  get_width_from_layout(Glib::RefPtr<Pango::Layout> layout);
+    static void     setup_printables(const CtPrintable::PrintInfo& print_info, const CtPrintableVector& printables);
 
 public:
     void run_page_setup_dialog(Gtk::Window* pMainWin);
@@ -21,6 +21,7 @@
 
 #include "ct_export2txt.h"
 #include "ct_main_win.h"
+#include "ct_trace.h"
 
 CtExport2Txt::CtExport2Txt(CtMainWin* pCtMainWin)
  : _pCtMainWin(pCtMainWin)
@@ -30,25 +31,27 @@ CtExport2Txt::CtExport2Txt(CtMainWin* pCtMainWin)
 // Export the Selected Node To Txt
 Glib::ustring CtExport2Txt::node_export_to_txt(CtTreeIter tree_iter, fs::path filepath, CtExportOptions export_options, int sel_start, int sel_end)
 {
-    Glib::ustring plain_text;
+    CT_TRACE_SCOPE("export txt node");
+    CtStringBuilder plain_text;
     if (export_options.include_node_name)
-        plain_text = tree_iter.get_node_name().uppercase() + CtConst::CHAR_NEWLINE;
-    plain_text += selection_export_to_txt(tree_iter.get_node_text_buffer(), sel_start, sel_end, false);
-    plain_text += str::repeat(CtConst::CHAR_NEWLINE, 2);
+        plain_text << tree_iter.get_node_name().uppercase() << CtConst::CHAR_NEWLINE;
+    plain_text << selection_export_to_txt(tree_iter.get_node_text_buffer(), sel_start, sel_end, false);
+    plain_text << CtConst::CHAR_NEWLINE << CtConst::CHAR_NEWLINE;
     if (filepath != "")
-        g_file_set_contents(filepath.c_str(), plain_text.c_str(), (gssize)plain_text.bytes(), nullptr);
-    return plain_text;
+        g_file_set_contents(filepath.c_str(), plain_text.c_str(), (gssize)plain_text.size(), nullptr);
+    return plain_text.release();
 }
 
 // Export All Nodes To Txt
 void CtExport2Txt::nodes_all_export_to_txt(bool all_tree, fs::path export_dir, fs::path single_txt_filepath, CtExportOptions export_options)
 {
+    CT_TRACE_SCOPE("export txt");
     // function to iterate nodes
-    Glib::ustring tree_plain_text;
+    CtStringBuilder tree_plain_text;
     std::function<void(CtTreeIter)> traverseFunc;
     traverseFunc = [this, &traverseFunc, &export_options, &tree_plain_text, &export_dir](CtTreeIter tree_iter) {
         if (export_dir == "")
-            tree_plain_text += node_export_to_txt(tree_iter, "", export_options, -1, -1);
+            tree_plain_text << node_export_to_txt(tree_iter, "", export_options, -1, -1);
         else
         {
             fs::path filepath = export_dir / (CtMiscUtil::get_node_hierarchical_name(tree_iter) + ".txt");
@@ -66,50 +69,54 @@ void CtExport2Txt::nodes_all_export_to_txt(bool all_tree, fs::path export_dir, f
     }
 
     if (single_txt_filepath != "")
-        g_file_set_contents(single_txt_filepath.c_str(), tree_plain_text.c_str(), (gssize)tree_plain_text.bytes(), nullptr);
+        g_file_set_contents(single_txt_filepath.c_str(), tree_plain_text.c_str(), (gssize)tree_plain_text.size(), nullptr);
 }
 
 // Export the Buffer To Txt
 Glib::ustring CtExport2Txt::selection_export_to_txt(Glib::RefPtr<Gtk::TextBuffer> text_buffer, int sel_start, int sel_end, bool check_link_target)
 {
-    Glib::ustring plain_text;
+    CtStringBuilder plain_text;
     std::list<CtAnchoredWidget*> widgets = _pCtMainWin->curr_tree_iter().get_embedded_pixbufs_tables_codeboxes(sel_start, sel_end);
 
     int start_offset = sel_start >= 0 ? sel_start : 0;
     for (CtAnchoredWidget* widget: widgets)
     {
         int end_offset = widget->getOffset();
-        Glib::ustring text_slot = _plain_process_slot(start_offset, end_offset, text_buffer, false);
-        plain_text += text_slot;
-        if (CtTable* ctTable = dynamic_cast<CtTable*>(widget)) plain_text += get_table_plain(ctTable);
-        else if (CtCodebox* ctCodebox = dynamic_cast<CtCodebox*>(widget)) plain_text += get_codebox_plain(ctCodebox);
+        plain_text << _plain_process_slot(start_offset, end_offset, text_buffer, false);
+        if (CtTable* ctTable = dynamic_cast<CtTable*>(widget)) plain_text << get_table_plain(ctTable);
+        else if (CtCodebox* ctCodebox = dynamic_cast<CtCodebox*>(widget)) plain_text << get_codebox_plain(ctCodebox);
         start_offset = end_offset;
     }
-    plain_text += _plain_process_slot(start_offset, sel_end, text_buffer, check_link_target && widgets.empty());
-    return plain_text;
+    plain_text << _plain_process_slot(start_offset, sel_end, text_buffer, check_link_target && widgets.empty());
+    return plain_text.release();
 }
 
 // Returns the plain Table
 Glib::ustring CtExport2Txt::get_table_plain(CtTable* table_orig)
 {
-    Glib::ustring table_plain = CtConst::CHAR_NEWLINE;
-    for (const auto& row: table_orig->get_table_matrix())
+    CtStringBuilder table_plain;
+    table_plain << CtConst::CHAR_NEWLINE;
+    CtTableTexts tableTexts;
+    table_orig->write_strings_matrix(tableTexts);
+    for (const auto& row: tableTexts)
     {
-        table_plain += CtConst::CHAR_PIPE;
+        table_plain << CtConst::CHAR_PIPE;
         for (const auto& cell: row)
-            table_plain += CtConst::CHAR_SPACE + cell->get_text_content() + CtConst::CHAR_SPACE + CtConst::CHAR_PIPE;
-        table_plain += CtConst::CHAR_NEWLINE;
+            table_plain << CtConst::CHAR_SPACE << cell << CtConst::CHAR_SPACE << CtConst::CHAR_PIPE;
+        table_plain << CtConst::CHAR_NEWLINE;
     }
-    return table_plain;
+    return table_plain.release();
 }
 
 // Returns the plain CodeBox
 Glib::ustring CtExport2Txt::get_codebox_plain(CtCodebox* codebox)
 {
-    Glib::ustring codebox_plain = CtConst::CHAR_NEWLINE + _pCtMainWin->get_ct_config()->hRule + CtConst::CHAR_NEWLINE;
-    codebox_plain += codebox->get_text_content();
-    codebox_plain += CtConst::CHAR_NEWLINE + _pCtMainWin->get_ct_config()->hRule + CtConst::CHAR_NEWLINE;
-    return codebox_plain;
+    const Glib::ustring& hRule = _pCtMainWin->get_ct_config()->hRule;
+    CtStringBuilder codebox_plain;
+    codebox_plain << CtConst::CHAR_NEWLINE << hRule << CtConst::CHAR_NEWLINE;
+    codebox_plain << codebox->get_text_content();
+    codebox_plain << CtConst::CHAR_NEWLINE << hRule << CtConst::CHAR_NEWLINE;
+    return codebox_plain.release();
 }
 
 // Process a Single plain Slot
@@ -26,6 +26,14 @@
 #include <curl/curl.h>
 #include <spdlog/fmt/bundled/printf.h>
 #include <system_error>
+#if defined(__linux__)
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <linux/fs.h>
+#elif defined(__APPLE__)
+#include <sys/clonefile.h>
+#endif
 
 #include "ct_filesystem.h"
 #include "ct_misc_utils.h"
@@ -72,6 +80,33 @@ bool copy_file(const path& from, const path& to)
     return rFileFrom->copy(rFileTo, Gio::FILE_COPY_OVERWRITE);
 }
 
+bool clone_file(const path& from, const path& to)
+{
+#if defined(__linux__) && defined(FICLONE)
+    const int fd_from = ::open(from.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd_from < 0) return false;
+    const int fd_to = ::open(to.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (fd_to < 0) {
+        ::close(fd_from);
+        return false;
+    }
+    // btrfs, xfs, bcachefs...
+    const bool cloned = ioctl(fd_to, FICLONE, fd_from) == 0;
+    ::close(fd_to);
+    ::close(fd_from);
+    if (not cloned) g_remove(to.c_str());
+    return cloned;
+#elif defined(__APPLE__)
+    // apfs
+    g_remove(to.c_str());
+    return clonefile(from.c_str(), to.c_str(), 0) == 0;
+#else
+    (void)from;
+    (void)to;
+    return false;
+#endif
+}
+
 bool move_file(const path& from, const path& to)
 {
     Glib::RefPtr<Gio::File> rFileFrom = Gio::File::create_for_path(from.string());
@@ -138,7 +173,7 @@ void open_weblink(const std::string& link)
 // Open Filepath with External App
 void open_filepath(const fs::path& filepath, bool open_folder_if_file_not_exists, CtConfig* config)
 {
-    spdlog::debug("fs::open_filepath {}", filepath);
+    SPDLOG_DEBUG("fs::open_filepath {}", filepath);
     if (config->filelinkCustomOn) {
         std::string cmd = fmt::sprintf(config->filelinkCustomAct, filepath.string());
         const int retVal = std::system(cmd.c_str());
@@ -166,7 +201,7 @@ void open_filepath(const fs::path& filepath, bool open_folder_if_file_not_exists
 // Open Folderpath with External App
 void open_folderpath(const fs::path& folderpath, CtConfig* config)
 {
-    spdlog::debug("fs::open_folderpath {}", folderpath);
+    SPDLOG_DEBUG("fs::open_folderpath {}", folderpath);
     if (config->folderlinkCustomOn) {
         std::string cmd = fmt::sprintf(config->folderlinkCustomAct, folderpath.string());
         const int retVal = std::system(cmd.c_str());
@@ -194,7 +229,7 @@ path prepare_export_folder(const path& dir_place, path new_folder, bool overwrit
     {
         // todo:
         if (overwrite_existing) {
-            spdlog::debug("fs::prepare_export_folder: removing dir {}", dir_place / new_folder);
+            SPDLOG_DEBUG("fs::prepare_export_folder: removing dir {}", dir_place / new_folder);
             remove_all(dir_place / new_folder);
         }
         else {
@@ -263,7 +298,7 @@ std::string download_file(const std::string& filepath)
         }
     };
 
-    spdlog::debug("fs::download_file: start downloading {}", filepath);
+    SPDLOG_DEBUG("fs::download_file: start downloading {}", filepath);
 
     std::string buffer;
     buffer.reserve(3 * 1024 * 1024); // preallocate 3mb
@@ -326,6 +361,18 @@ path canonical(const path& path)
     return Glib::canonicalize_filename(path.string());
 }
 
+bool equivalent(const path& path1, const path& path2)
+{
+    if (canonical(path1) == canonical(path2)) return true;
+    GStatBuf st1, st2;
+    if (g_stat(path1.c_str(), &st1) != 0 or g_stat(path2.c_str(), &st2) != 0) return false;
+#ifdef _WIN32
+    return false; // no inode numbers
+#else
+    return st1.st_dev == st2.st_dev and st1.st_ino == st2.st_ino;
+#endif
+}
+
 path path::extension() const
 {
     std::string name = filename().string();
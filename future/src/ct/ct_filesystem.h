@@ -40,6 +40,9 @@ class path;
 
 bool copy_file(const path& from, const path& to);
 
+// copy sharing the data blocks of the source (reflink), false where the filesystem can't
+bool clone_file(const path& from, const path& to);
+
 bool move_file(const path& from, const path& to);
 
 bool is_regular_file(const path& file);
@@ -50,6 +53,9 @@ path absolute(const path& path);
 
 path canonical(const path& path);
 
+// the same file, also through a link; false if one doesn't exist and the paths differ
+bool equivalent(const path& path1, const path& path2);
+
 bool exists(const path& filepath);
 
 time_t getmtime(const path& path);
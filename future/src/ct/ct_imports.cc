@@ -25,9 +25,15 @@
 #include "ct_main_win.h"
 #include "ct_export2html.h"
 #include "ct_logging.h"
+#include "ct_trace.h"
+#include "ct_thread_pool.h"
 #include <libxml2/libxml/SAX.h>
 #include <fstream>
 #include <sstream>
+#include <atomic>
+#include <future>
+#include <mutex>
+#include <thread>
 
 namespace {
 xmlpp::Element* create_root_plaintext_text_el(xmlpp::Document& doc, const Glib::ustring& text) {
@@ -36,6 +42,76 @@ xmlpp::Element* create_root_plaintext_text_el(xmlpp::Document& doc, const Glib::
     return el;
 }
 
+struct import_dir_item
+{
+    fs::path                          path;
+    size_t                            parent_idx;
+    bool                              is_dir;
+    std::unique_ptr<ct_imported_node> node;
+};
+
+// List the directory tree, depth first, the directory before its entries
+void enumerate_dir(const fs::path& dir, size_t parent_idx, std::vector<import_dir_item>& out_items)
+{
+    const size_t dir_idx = out_items.size();
+    out_items.push_back(import_dir_item{dir, parent_idx, true, nullptr});
+    for (const auto& dir_item: fs::get_dir_entries(dir))
+    {
+        if (fs::is_directory(dir_item))
+            enumerate_dir(dir_item, dir_idx, out_items);
+        else
+            out_items.push_back(import_dir_item{dir_item, dir_idx, false, nullptr});
+    }
+}
+
+// If there are node (dir) with subnodes and node with content, both with the same name, join them
+void join_dir_and_content_nodes(ct_imported_node* dir_node)
+{
+    for (auto child_it = dir_node->children.begin(); child_it != dir_node->children.end(); ++child_it)
+    {
+        if ((*child_it)->has_content() && (*child_it)->children.empty()) // node with content
+        {
+            for (auto dir_it = dir_node->children.begin(); dir_it != dir_node->children.end(); ++dir_it)
+            {
+                if (!(*dir_it)->has_content()) // dir node
+                {
+                    if (child_it->get() == dir_it->get()) continue;
+                    if ((*child_it)->node_name == (*dir_it)->node_name)
+                    {
+                        std::swap((*child_it)->children, (*dir_it)->children);
+                        dir_node->children.erase(dir_it);
+                        break;
+                    }
+                }
+            }
+        }
+    }
+}
+
+// Build the imported nodes tree out of the imported files
+std::unique_ptr<ct_imported_node> assemble_dir(std::vector<import_dir_item>& items, const std::vector<std::vector<size_t>>& items_children, size_t dir_idx)
+{
+    const fs::path& dir = items[dir_idx].path;
+    auto dir_node = std::make_unique<ct_imported_node>(dir, dir.filename().string());
+    for (size_t child_idx: items_children[dir_idx])
+    {
+        if (items[child_idx].is_dir)
+        {
+            if (auto node = assemble_dir(items, items_children, child_idx))
+                dir_node->children.emplace_back(std::move(node));
+        }
+        else if (items[child_idx].node)
+            dir_node->children.emplace_back(std::move(items[child_idx].node));
+    }
+
+    // skip empty dirs
+    if (dir_node->children.empty())
+        return nullptr;
+
+    join_dir_and_content_nodes(dir_node.get());
+    return dir_node;
+}
+
 }
 
 namespace CtXML {
@@ -173,48 +249,93 @@ std::vector<std::pair<int, int>> CtImports::get_web_links_offsets_from_plain_tex
     return web_links;
 }
 
-std::unique_ptr<ct_imported_node> CtImports::traverse_dir(const fs::path& dir, CtImporterInterface* importer)
+std::unique_ptr<ct_imported_node> CtImports::traverse_dir(const fs::path& dir, CtImporterInterface* importer, const progress_cb_t& progress_cb)
 {
-    auto dir_node = std::make_unique<ct_imported_node>(dir, dir.filename().string());
-    for (const auto& dir_item: fs::get_dir_entries(dir))
+    CT_TRACE_SCOPE("import dir");
+    importer->prepare_dir(dir);
+
+    // list all the files first, they are then parsed into independent documents
+    std::vector<import_dir_item> items;
+    enumerate_dir(dir, 0, items);
+    std::vector<size_t> files_idx;
+    std::vector<std::vector<size_t>> items_children(items.size());
+    for (size_t i = 1; i < items.size(); ++i)
     {
-        if (fs::is_directory(dir_item))
+        items_children[items[i].parent_idx].push_back(i);
+        if (!items[i].is_dir)
+            files_idx.push_back(i);
+    }
+    const size_t files_total = files_idx.size();
+    CT_TRACE_COUNT("import dir files", files_total);
+
+    std::vector<std::unique_ptr<CtImporterInterface>> thread_importers;
+    const size_t threads_num = std::min<size_t>(std::max(1u, std::thread::hardware_concurrency()), files_total);
+    if (threads_num > 1)
+    {
+        for (size_t i = 0; i < threads_num; ++i)
         {
-            if (auto node = traverse_dir(dir_item, importer))
-              dir_node->children.emplace_back(std::move(node));
+            auto thread_importer = importer->clone_for_thread();
+            if (!thread_importer) break;
+            thread_importers.push_back(std::move(thread_importer));
         }
-        else if (auto node = importer->import_file(dir_item))
-            dir_node->children.emplace_back(std::move(node));
     }
 
-    // skip empty dirs
-    if (dir_node->children.empty())
-        return nullptr;
-
-    // not the best place but
-    // if there are node (dir) with subnodes  and node with content, both with the same name, join them
-    for (auto child_it = dir_node->children.begin(); child_it != dir_node->children.end(); ++child_it)
+    std::atomic<size_t> files_done{0};
+    std::atomic<bool> cancelled{false};
+    if (thread_importers.size() > 1)
     {
-        if ((*child_it)->has_content() && (*child_it)->children.empty()) // node with content
-        {
-            for (auto dir_it = dir_node->children.begin(); dir_it != dir_node->children.end(); ++dir_it)
+        xmlInitParser(); // libxml2 has to be initialised on the main thread
+        std::atomic<size_t> next_file{0};
+        std::mutex error_mutex;
+        std::exception_ptr first_error;
+        auto import_files = [&](CtImporterInterface* thread_importer) {
+            for (size_t i = next_file++; i < files_total && !cancelled; i = next_file++)
             {
-                if (!(*dir_it)->has_content()) // dir node
-                {
-                    if (child_it->get() == dir_it->get()) continue;
-                    if ((*child_it)->node_name == (*dir_it)->node_name)
-                    {
-                        std::swap((*child_it)->children, (*dir_it)->children);
-                        dir_node->children.erase(dir_it);
-                        break;
-                    }
+                try {
+                    items[files_idx[i]].node = thread_importer->import_file(items[files_idx[i]].path);
+                }
+                catch (...) {
+                    std::lock_guard<std::mutex> lock(error_mutex);
+                    if (!first_error) first_error = std::current_exception();
+                    cancelled = true;
                 }
+                ++files_done;
             }
+        };
+        // the workers run in the background so that the caller can keep the ui alive with progress_cb
+        auto workers = CtThreadPool::get().submit([&]() {
+            CtMiscUtil::parallel_for(0, thread_importers.size(), [&](size_t thread_idx) {
+                import_files(thread_importers[thread_idx].get());
+            });
+        });
+        while (workers.wait_for(std::chrono::milliseconds(100)) != std::future_status::ready)
+        {
+            if (progress_cb && !progress_cb(files_done, files_total))
+                cancelled = true;
         }
+        workers.get();
+        if (first_error)
+            std::rethrow_exception(first_error);
     }
+    else
+    {
+        for (size_t file_idx: files_idx)
+        {
+            if (progress_cb && !progress_cb(files_done, files_total))
+            {
+                cancelled = true;
+                break;
+            }
+            items[file_idx].node = importer->import_file(items[file_idx].path);
+            ++files_done;
+        }
+    }
+    if (cancelled)
+        return nullptr;
+    if (progress_cb)
+        progress_cb(files_done, files_total);
 
-
-    return dir_node;
+    return assemble_dir(items, items_children, 0);
 }
 
 
@@ -370,7 +491,7 @@ void CtTomboyImport::_iterate_tomboy_note(xmlpp::Element* iter, std::unique_ptr<
             _iterate_tomboy_note(dom_iter_el, node);
             _is_link_to_node = false;
         } else {
-            spdlog::debug(dom_iter->get_name());
+            SPDLOG_DEBUG(dom_iter->get_name());
             _iterate_tomboy_note(dom_iter_el, node);
         }
     }
@@ -390,7 +511,14 @@ xmlpp::Element* CtTomboyImport::_rich_text_serialize(const Glib::ustring& text_d
 
 
 
-CtZimImport::CtZimImport(CtConfig* config) : _zim_parser{std::make_unique<CtZimParser>(config)} {}
+CtZimImport::CtZimImport(CtConfig* config) : _config{config}, _zim_parser{std::make_unique<CtZimParser>(config)} {}
+
+std::unique_ptr<CtImporterInterface> CtZimImport::clone_for_thread()
+{
+    auto importer = std::make_unique<CtZimImport>(_config);
+    importer->_has_notebook_file = _has_notebook_file;
+    return importer;
+}
 
 std::unique_ptr<ct_imported_node> CtZimImport::import_file(const fs::path& file)
 {
@@ -459,7 +587,7 @@ std::unique_ptr<ct_imported_node> CtPlainTextImport::import_file(const fs::path&
 
 
 
-CtMDImport::CtMDImport(CtConfig* config) : _parser{std::make_unique<CtMDParser>(config)}
+CtMDImport::CtMDImport(CtConfig* config) : _config{config}, _parser{std::make_unique<CtMDParser>(config)}
 {
 
 }
@@ -469,10 +597,12 @@ std::unique_ptr<ct_imported_node> CtMDImport::import_file(const fs::path& file)
     if (file.extension() != ".md")
         return nullptr;
 
-    std::ifstream infile(file.string());
-    if (!infile) throw std::runtime_error(fmt::format("CtMDImport: cannot open file, what: {}, file: {}", strerror(errno), file));
+    // the parser tokens are views on the text, so no copy of the file contents is needed
+    g_autoptr(GError) pError{nullptr};
+    g_autoptr(GMappedFile) pMappedFile = g_mapped_file_new(file.c_str(), FALSE/*writable*/, &pError);
+    if (!pMappedFile) throw std::runtime_error(fmt::format("CtMDImport: cannot open file, what: {}, file: {}", pError ? pError->message : "", file));
     _parser->wipe_doc();
-    _parser->feed(infile);
+    _parser->feed(std::string_view{g_mapped_file_get_contents(pMappedFile), g_mapped_file_get_length(pMappedFile)});
 
     std::unique_ptr<ct_imported_node> node = std::make_unique<ct_imported_node>(file, file.stem().string());
     node->xml_content = _parser->doc().document();
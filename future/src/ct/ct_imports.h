@@ -31,6 +31,7 @@
 #include <utility>
 #include <glibmm/i18n.h>
 #include <memory>
+#include <functional>
 
 namespace {
 using TableMatrx = std::queue<std::queue<std::string>>;
@@ -55,16 +56,28 @@ struct ct_imported_node
 class CtImporterInterface
 {
 public:
+    virtual ~CtImporterInterface() = default;
+
     virtual std::unique_ptr<ct_imported_node> import_file(const fs::path& file) = 0;
     virtual std::string                       file_pattern_name() { return ""; }
     virtual std::vector<std::string>          file_patterns() { return {}; }
+
+    // called once with the top directory before importing the files of a directory
+    virtual void                              prepare_dir(const fs::path& /*dir*/) {}
+    // a new importer with its own parsing state, to import files from a worker thread;
+    // nullptr if the importer has to run on the main thread
+    virtual std::unique_ptr<CtImporterInterface> clone_for_thread() { return nullptr; }
 };
 
 
 namespace CtImports {
 
+    // files imported, files total; return false to cancel the import
+    using progress_cb_t = std::function<bool(size_t, size_t)>;
+
     std::vector<std::pair<int, int>> get_web_links_offsets_from_plain_text(const Glib::ustring& plain_text);
-    std::unique_ptr<ct_imported_node> traverse_dir(const fs::path& dir, CtImporterInterface* importer);
+    // returns nullptr if there is nothing to import or if cancelled
+    std::unique_ptr<ct_imported_node> traverse_dir(const fs::path& dir, CtImporterInterface* importer, const progress_cb_t& progress_cb = nullptr);
 
 }
 
@@ -102,6 +115,7 @@ public:
     std::unique_ptr<ct_imported_node> import_file(const fs::path& file) override;
     std::string                       file_pattern_name() override { return _("Html Document"); }
     std::vector<std::string>          file_patterns() override { return {"*.html", "*.htm"}; };
+    std::unique_ptr<CtImporterInterface> clone_for_thread() override { return std::make_unique<CtHtmlImport>(_config); }
 
 private:
     CtConfig* _config;
@@ -145,11 +159,14 @@ public:
 public:
     // virtuals of CtImporterInterface
     std::unique_ptr<ct_imported_node> import_file(const fs::path& file) override;
+    void                              prepare_dir(const fs::path& dir) override { _ensure_notebook_file_in_dir(dir); }
+    std::unique_ptr<CtImporterInterface> clone_for_thread() override;
 
     ~CtZimImport();
 private:
     void _ensure_notebook_file_in_dir(const fs::path& dir);
 
+    CtConfig*         _config;
     bool              _has_notebook_file {false};
     std::unique_ptr<CtZimParser> _zim_parser;
 };
@@ -166,6 +183,7 @@ public:
     std::unique_ptr<ct_imported_node> import_file(const fs::path& file) override;
     std::string                       file_pattern_name() override { return _("Plain Text Document"); }
     std::vector<std::string>          file_patterns() override { return {"*.txt"}; };
+    std::unique_ptr<CtImporterInterface> clone_for_thread() override { return std::make_unique<CtPlainTextImport>(nullptr); }
 };
 
 
@@ -183,7 +201,9 @@ public:
     std::unique_ptr<ct_imported_node> import_file(const fs::path& file) override;
     std::vector<std::string>          file_patterns() override { return {"*.md"}; };
     std::string                       file_pattern_name() override { return _("Markdown Document"); }
+    std::unique_ptr<CtImporterInterface> clone_for_thread() override { return std::make_unique<CtMDImport>(_config); }
 private:
+    CtConfig*                   _config;
     std::unique_ptr<CtMDParser> _parser;
 };
 
@@ -24,7 +24,12 @@
 #pragma once
 
 
-#define SPDLOG_ACTIVE_LEVEL SPDLOG_LEVEL_DEBUG
+// SPDLOG_DEBUG/SPDLOG_TRACE calls below SPDLOG_ACTIVE_LEVEL are compiled out
+// together with the formatting of their arguments; cmake sets the level from
+// the build type (trace for Debug, info otherwise)
+#ifndef SPDLOG_ACTIVE_LEVEL
+#define SPDLOG_ACTIVE_LEVEL SPDLOG_LEVEL_INFO
+#endif
 #include <spdlog/spdlog.h>
 #include <spdlog/fmt/fmt.h>
 #include <glibmm/ustring.h>
@@ -25,11 +25,17 @@
 #include "ct_misc_utils.h"
 #include "config.h"
 #include "ct_logging.h"
+#include "ct_trace.h"
+#include <spdlog/async.h>
 #include <spdlog/sinks/stdout_color_sinks.h>
+#include <spdlog/sinks/rotating_file_sink.h>
 
 void glib_log_handler(const gchar*, GLogLevelFlags log_level, const gchar* msg, gpointer)
 {
     auto gtk_logger = spdlog::get("GTK Logger");
+    if (not gtk_logger) {
+        return; // after spdlog::shutdown
+    }
     switch (log_level) {
         case G_LOG_LEVEL_ERROR:
             gtk_logger->error(msg);
@@ -55,6 +61,36 @@ void glib_log_handler(const gchar*, GLogLevelFlags log_level, const gchar* msg,
     }
 }
 
+// the loggers hand the messages to a background thread that writes them to
+// the console and to a rotating file in the config dir, so logging never blocks the gui
+void setup_logging()
+{
+    const size_t queue_size{8192};
+    const size_t log_file_max_size{1024 * 1024};
+    const size_t log_files_max_num{3};
+    spdlog::init_thread_pool(queue_size, 1/*threads*/);
+
+    std::vector<spdlog::sink_ptr> sinks{std::make_shared<spdlog::sinks::stdout_color_sink_mt>()};
+    try {
+        const fs::path log_filepath = fs::get_cherrytree_configdir() / "cherrytree.log";
+        sinks.push_back(std::make_shared<spdlog::sinks::rotating_file_sink_mt>(log_filepath.string(), log_file_max_size, log_files_max_num));
+    }
+    catch (spdlog::spdlog_ex& e) {
+        g_printerr("log file not available: %s\n", e.what());
+    }
+
+    for (const char* logger_name : {"cherrytree", "GTK Logger"}) {
+        // when the queue is full drop the oldest message rather than waiting
+        auto logger = std::make_shared<spdlog::async_logger>(logger_name, sinks.begin(), sinks.end(), spdlog::thread_pool(),
+                                                             spdlog::async_overflow_policy::overrun_oldest);
+        spdlog::register_logger(logger);
+    }
+    spdlog::set_default_logger(spdlog::get("cherrytree"));
+    spdlog::flush_on(spdlog::level::err);
+    // can be changed with --log_level (-l)
+    spdlog::set_level(spdlog::level::info);
+}
+
 int main(int argc, char *argv[])
 {
     std::locale::global(std::locale("")); // Set the global C++ locale to the user-specified locale
@@ -74,14 +110,23 @@ int main(int argc, char *argv[])
     textdomain(GETTEXT_PACKAGE);
 #endif
 
-    // Setup spdlog, use debug level by default for now
-    spdlog::set_level(spdlog::level::debug);
+    setup_logging();
 
     // Redirect Gtk log messages to spdlog
-    auto gtk_logger = spdlog::stdout_color_mt("GTK Logger");
     g_log_set_default_handler(glib_log_handler, nullptr);
 
-    Glib::RefPtr<CtApp> r_app = CtApp::create();
+    int retVal{0};
+    {
+        // the app and what it owns still log while destroyed, before the loggers are dropped
+        Glib::RefPtr<CtApp> r_app = CtApp::create();
+        retVal = r_app->run(argc, argv);
+        if (EXIT_SUCCESS == retVal) {
+            retVal = r_app->get_exit_status();
+        }
+    }
 
-    return r_app->run(argc, argv);
+    CT_TRACE_DUMP();
+    // flush and join the logging thread
+    spdlog::shutdown();
+    return retVal;
 }
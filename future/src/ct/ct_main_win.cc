@@ -155,6 +155,7 @@ CtMainWin::CtMainWin(bool             no_gui,
 CtMainWin::~CtMainWin()
 {
     _autosave_timout_connection.disconnect();
+    _prefetchIdleConnection.disconnect();
     //std::cout << "~CtMainWin" << std::endl;
 }
 
@@ -224,6 +225,26 @@ Glib::RefPtr<Gsv::Buffer> CtMainWin::get_new_text_buffer(const Glib::ustring& te
     return rRetTextBuffer;
 }
 
+Glib::RefPtr<Gsv::Buffer> CtMainWin::get_new_text_buffer_from_state(std::shared_ptr<CtNodeState> state, std::list<CtAnchoredWidget*>& widgets)
+{
+    Glib::RefPtr<Gsv::Buffer> rRetTextBuffer = get_new_text_buffer();
+    rRetTextBuffer->begin_not_undoable_action();
+    for (xmlpp::Node* text_node: state->buffer_xml.get_root_node()->get_children())
+    {
+        CtStorageXmlHelper(this).get_text_buffer_one_slot_from_xml(rRetTextBuffer, text_node, widgets, nullptr, -1);
+    }
+    // xml state doesn't have widgets, so load them separately
+    std::list<CtAnchoredWidget*> stateWidgets;
+    for (auto widgetState: state->widgetStates)
+        stateWidgets.push_back(widgetState->to_widget(this));
+    for (auto widget: stateWidgets)
+        widget->insertInTextBuffer(rRetTextBuffer);
+    widgets.splice(widgets.end(), stateWidgets);
+    rRetTextBuffer->end_not_undoable_action();
+    rRetTextBuffer->set_modified(false);
+    return rRetTextBuffer;
+}
+
 const std::string CtMainWin::get_text_tag_name_exist_or_create(const std::string& propertyName, const std::string& propertyValue)
 {
     const std::string tagName{propertyName + "_" + propertyValue};
@@ -929,7 +950,6 @@ bool CtMainWin::file_open(const fs::path& filepath, const std::string& node_to_f
         } break;
         case CtRestoreExpColl::ALL_COLL:
         {
-            _uCtTreeview->expand_all();
             _uCtTreestore->treeview_set_tree_expanded_collapsed_string("", *_uCtTreeview, _pCtConfig->nodesBookmExp);
         } break;
         default:
@@ -969,6 +989,12 @@ bool CtMainWin::file_open(const fs::path& filepath, const std::string& node_to_f
 
 bool CtMainWin::file_save_ask_user()
 {
+    // a save still running in the background clears the save needed before it is done
+    if (!_uCtStorage->wait_save_in_background())
+    {
+        // the error is shown and the save is needed again, ask again
+        update_window_save_needed();
+    }
     if (get_file_save_needed())
     {
         const CtYesNoCancel yesNoCancel = [this]() {
@@ -985,6 +1011,8 @@ bool CtMainWin::file_save_ask_user()
         if (CtYesNoCancel::Yes == yesNoCancel)
         {
             _uCtActions->file_save();
+            // the save is not left running in the background
+            _uCtStorage->wait_save_in_background();
             if (get_file_save_needed())
             {
                 // something went wrong in the save
@@ -997,6 +1025,8 @@ bool CtMainWin::file_save_ask_user()
 
 void CtMainWin::file_save(bool need_vacuum)
 {
+    // a failed autosave sets the save needed again
+    _uCtStorage->wait_save_in_background();
     if (_uCtStorage->get_file_path().empty())
         return;
     if (!get_file_save_needed())
@@ -1017,6 +1047,33 @@ void CtMainWin::file_save(bool need_vacuum)
     }
 }
 
+void CtMainWin::file_save_in_background(bool need_vacuum)
+{
+    // the next snapshot is taken after the previous save
+    _uCtStorage->wait_save_in_background();
+    if (_uCtStorage->get_file_path().empty())
+        return;
+    if (!get_file_save_needed())
+        if (!need_vacuum)
+            return;
+    if (!get_tree_store().get_iter_first())
+        return;
+
+    // the edits from now on are for the next save
+    update_window_save_not_needed();
+    _uCtStorage->save_in_background(need_vacuum, [this](const bool success, const Glib::ustring& error) {
+        if (success)
+        {
+            get_state_machine().update_state();
+        }
+        else
+        {
+            update_window_save_needed();
+            CtDialogs::error_dialog(error, *this);
+        }
+    });
+}
+
 void CtMainWin::file_save_as(const std::string& new_filepath, const Glib::ustring& password)
 {
     Glib::ustring error;
@@ -1054,7 +1111,7 @@ void CtMainWin::file_autosave_restart()
     bool was_connected = !_autosave_timout_connection.empty();
     _autosave_timout_connection.disconnect();
     if (!get_ct_config()->autosaveOn) {
-        if (was_connected) spdlog::debug("autosave was stopped");
+        if (was_connected) SPDLOG_DEBUG("autosave was stopped");
         return;
     }
     if (get_ct_config()->autosaveVal < 1) {
@@ -1062,13 +1119,15 @@ void CtMainWin::file_autosave_restart()
         return;
     }
 
-    spdlog::debug("autosave is started");
+    SPDLOG_DEBUG("autosave is started");
     _autosave_timout_connection = Glib::signal_timeout().connect_seconds([this]() {        
-        if (get_file_save_needed()) {
-            spdlog::debug("autosave: time to save file");
-            file_save(false);
+        if (_uCtStorage->is_saving_in_background()) {
+            SPDLOG_DEBUG("autosave: the previous save is still running");
+        } else if (get_file_save_needed()) {
+            SPDLOG_DEBUG("autosave: time to save file");
+            file_save_in_background(false/*need_vacuum*/);
         } else {
-            spdlog::debug("autosave: no needs to save file");
+            SPDLOG_DEBUG("autosave: no needs to save file");
         }
         return true;
     }, get_ct_config()->autosaveVal * 60);
@@ -1076,7 +1135,7 @@ void CtMainWin::file_autosave_restart()
 
 bool CtMainWin::file_insert_plain_text(const fs::path& filepath)
 {
-    spdlog::debug("trying to insert text file as node: {}", filepath);
+    SPDLOG_DEBUG("trying to insert text file as node: {}", filepath);
 
     gchar *text = nullptr;
     gsize length = 0;
@@ -1125,6 +1184,19 @@ void CtMainWin::reset()
     }
 }
 
+int CtMainWin::get_text_view_width()
+{
+    if (_no_gui or not _ctTextview.get_realized()) {
+        // the paned position is the width of the left side, the tree or the text view
+        int width = _pCtConfig->winRect[2];
+        if (_pCtConfig->treeVisible) {
+            width = _pCtConfig->treeRightSide ? _pCtConfig->hpanedPos : _pCtConfig->winRect[2] - _pCtConfig->hpanedPos;
+        }
+        return std::max(1, width);
+    }
+    return _ctTextview.get_allocation().get_width();
+}
+
 bool CtMainWin::get_file_save_needed()
 {
     return (_fileSaveNeeded or (curr_tree_iter() and curr_tree_iter().get_node_text_buffer()->get_modified()));
@@ -1165,7 +1237,18 @@ void CtMainWin::update_selected_node_statusbar_info()
         }
         if (get_ct_config()->wordCountOn)
         {
-            statusbar_text += separator_text + _("Word Count") + _(": ") + std::to_string(CtTextIterUtil::get_words_count(get_text_view().get_buffer()));
+            std::shared_ptr<CtTextStats> pTextStats = treeIter.get_node_text_stats();
+            _textStatsReadyConnection.disconnect();
+            if (pTextStats->is_ready())
+            {
+                statusbar_text += separator_text + _("Word Count") + _(": ") + std::to_string(pTextStats->get_counts().words);
+            }
+            else
+            {
+                // counted in background, refresh when done
+                statusbar_text += separator_text + _("Word Count") + _(": ") + "...";
+                _textStatsReadyConnection = pTextStats->signal_ready().connect(sigc::mem_fun(*this, &CtMainWin::update_selected_node_statusbar_info));
+            }
         }
         if (treeIter.get_node_creating_time() > 0)
         {
@@ -1321,6 +1404,8 @@ void CtMainWin::switch_buffer_text_source(Glib::RefPtr<Gsv::Buffer> text_buffer,
 
 void CtMainWin::_on_treeview_cursor_changed()
 {
+    if (_uCtTreestore->is_bulk_loading())
+        return; // the model is detached from the tree view
     if (_prevTreeIter)
     {
         if (_prevTreeIter.get_node_id() == curr_tree_iter().get_node_id())
@@ -1345,6 +1430,62 @@ void CtMainWin::_on_treeview_cursor_changed()
     get_state_machine().node_selected_changed(treeIter.get_node_id());
 
     _prevTreeIter = treeIter;
+    _prefetch_likely_next_nodes();
+}
+
+void CtMainWin::_prefetch_likely_next_nodes()
+{
+    // once the selected node is shown, a later selection change replaces the request
+    _prefetchIdleConnection.disconnect();
+    _prefetchIdleConnection = Glib::signal_idle().connect([this]() {
+        CtTreeIter treeIter = curr_tree_iter();
+        if (not treeIter) return false;
+
+        const size_t maxNodes{16};
+        const size_t maxVisited{5};
+        std::vector<gint64> node_ids;
+        auto add_node = [&](const CtTreeIter& ctTreeIter) {
+            if (ctTreeIter and not ctTreeIter.get_node_buffer_already_loaded() and node_ids.size() < maxNodes
+                and not vec::exists(node_ids, ctTreeIter.get_node_id()))
+                node_ids.push_back(ctTreeIter.get_node_id());
+        };
+
+        // the neighbours, next and previous first as from the keyboard
+        Gtk::TreeIter nextIter = treeIter;
+        add_node(_uCtTreestore->to_ct_tree_iter(++nextIter));
+        add_node(_uCtTreestore->to_ct_tree_iter(_uCtTreestore->get_tree_iter_prev_sibling(treeIter)));
+        add_node(treeIter.first_child());
+        add_node(treeIter.parent());
+
+        // then the recently visited and the bookmarked, found in one pass over the tree
+        std::vector<gint64> far_ids;
+        const std::vector<gint64>& visited_ids = get_state_machine().get_visited_nodes_list();
+        for (auto it = visited_ids.rbegin(); it != visited_ids.rend() and far_ids.size() < maxVisited; ++it)
+            if (*it != treeIter.get_node_id())
+                far_ids.push_back(*it);
+        for (const gint64 node_id : _uCtTreestore->bookmarks_get())
+            far_ids.push_back(node_id);
+        std::unordered_map<gint64, CtTreeIter> far_iters;
+        for (const gint64 node_id : far_ids)
+            far_iters.emplace(node_id, CtTreeIter{});
+        size_t found_num{0};
+        if (not far_iters.empty())
+        {
+            _uCtTreestore->get_store()->foreach_iter([&](const Gtk::TreeIter& iter) {
+                auto found = far_iters.find(iter->get_value(_uCtTreestore->get_columns().colNodeUniqueId));
+                if (found != far_iters.end()) {
+                    found->second = _uCtTreestore->to_ct_tree_iter(iter);
+                    ++found_num;
+                }
+                return found_num == far_iters.size(); /* stop when all found */
+            });
+        }
+        for (const gint64 node_id : far_ids)
+            add_node(far_iters.at(node_id));
+
+        _uCtStorage->prefetch_delayed_text_buffers(node_ids);
+        return false;
+    });
 }
 
 bool CtMainWin::_on_treeview_button_release_event(GdkEventButton* event)
@@ -1623,7 +1764,7 @@ bool CtMainWin::_on_textview_motion_notify_event(GdkEventMotion* event)
     }
     int x, y;
     get_text_view().window_to_buffer_coords(Gtk::TEXT_WINDOW_TEXT, (int)event->x, (int)event->y, x, y);
-    get_text_view().cursor_and_tooltips_handler(x, y);
+    get_text_view().cursor_and_tooltips_queue(x, y);
     return false;
 }
 
@@ -1640,6 +1781,7 @@ bool CtMainWin::_on_textview_visibility_notify_event(GdkEventVisibility*)
     Gdk::ModifierType mask;
     get_text_view().get_window(Gtk::TEXT_WINDOW_TEXT)->get_pointer(x, y, mask);
     get_text_view().window_to_buffer_coords(Gtk::TEXT_WINDOW_TEXT, x, y, bx, by);
+    get_text_view().cursor_and_tooltips_invalidate();
     get_text_view().cursor_and_tooltips_handler(bx, by);
     return false;
 }
@@ -98,6 +98,7 @@ public:
     bool file_open(const fs::path& filepath, const std::string& node_to_focus, const Glib::ustring password = "");
     bool file_save_ask_user();
     void file_save(bool need_vacuum);
+    void file_save_in_background(bool need_vacuum);
     void file_save_as(const std::string& new_filepath, const Glib::ustring& password);
     void file_autosave_restart();
     bool file_insert_plain_text(const fs::path& filepath);
@@ -112,6 +113,8 @@ public:
     bool get_file_save_needed();
 
     void update_selected_node_statusbar_info();
+    // text view width also without gui (the width it would have from the saved window geometry)
+    int  get_text_view_width();
 
     Glib::RefPtr<Gtk::TextBuffer>     curr_buffer() { return _ctTextview.get_buffer(); }
     CtTreeIter                        curr_tree_iter()  { return _uCtTreestore->to_ct_tree_iter(_uCtTreeview->get_selection()->get_selected()); }
@@ -144,6 +147,7 @@ public:
     Gtk::Image*               new_image_from_stock(const std::string& stockImage, Gtk::BuiltinIconSize size);
     void                      apply_syntax_highlighting(Glib::RefPtr<Gsv::Buffer> text_buffer, const std::string& syntax);
     Glib::RefPtr<Gsv::Buffer> get_new_text_buffer(const Glib::ustring& textContent=""); // pygtk: buffer_create
+    Glib::RefPtr<Gsv::Buffer> get_new_text_buffer_from_state(std::shared_ptr<CtNodeState> state, std::list<CtAnchoredWidget*>& widgets);
     const std::string         get_text_tag_name_exist_or_create(const std::string& propertyName, const std::string& propertyValue);
     Glib::ustring             sourceview_hovering_link_get_tooltip(const Glib::ustring& link);
     bool                      apply_tag_try_automatic_bounds(Glib::RefPtr<Gtk::TextBuffer> text_buffer, Gtk::TextIter iter_start);
@@ -182,6 +186,7 @@ private:
     bool                _on_window_key_press_event(GdkEventKey* event);
 
     void                _on_treeview_cursor_changed(); // pygtk: on_node_changed
+    void                _prefetch_likely_next_nodes();
     bool                _on_treeview_button_release_event(GdkEventButton* event);
     void                _on_treeview_event_after(GdkEvent* event); // pygtk: on_event_after_tree
     void                _on_treeview_row_activated(const Gtk::TreeModel::Path&, Gtk::TreeViewColumn*);
@@ -252,6 +257,8 @@ private:
     int                 _savedXpos{-1};
     int                 _savedYpos{-1};
     sigc::connection    _autosave_timout_connection;
+    sigc::connection    _textStatsReadyConnection;
+    sigc::connection    _prefetchIdleConnection;
     bool                _tree_just_auto_expanded{false};
 
 public:
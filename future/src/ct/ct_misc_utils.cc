@@ -28,6 +28,7 @@
 #include "ct_const.h"
 #include "ct_main_win.h"
 #include "ct_logging.h"
+#include "ct_thread_pool.h"
 #include <ctime>
 #include <regex>
 #include <glib/gstdio.h> // to get stats
@@ -44,86 +45,115 @@
 
 namespace CtCSV {
 
-CtStringTable table_from_csv(std::istream& input)
+constexpr char cell_tag = '"';
+constexpr char cell_sep = ',';
+constexpr char esc = '\\';
+
+CtCsvReader::CtCsvReader(std::istream& input, const size_t max_rows)
+ : _input(input),
+   _exceptionsBefore(input.exceptions()),
+   _maxRows(max_rows)
 {
-    // Disable exceptions
-    auto except_bit_before = input.exceptions();
-    input.exceptions(std::ios::goodbit);
+    // Disable exceptions, the end of input is checked on gcount
+    _input.exceptions(std::ios::goodbit);
+}
 
-    CtStringTable tbl_matrix;
-    std::string line;
+CtCsvReader::~CtCsvReader()
+{
+    _input.clear();
+    _input.exceptions(_exceptionsBefore);
+}
 
-    std::array<char, 256> chunk_buff{};
-    input.read(chunk_buff.data(), chunk_buff.size());
-    std::streamsize pos;
-    std::vector<std::string> tbl_row;
-    std::ostringstream cell_buff;
-    constexpr char cell_tag = '"';
-    constexpr char cell_sep = ',';
-    constexpr char esc = '\\';
+bool CtCsvReader::_next_char(char& ch)
+{
+    if (_chunkPos == _chunkSize) {
+        _input.read(_chunk.data(), _chunk.size());
+        _chunkSize = _input.gcount();
+        _chunkPos = 0;
+        if (_chunkSize <= 0) return false;
+    }
+    ch = _chunk[_chunkPos++];
+    ++_bytesRead;
+    return true;
+}
+
+bool CtCsvReader::next_row(std::vector<std::string>& row)
+{
+    row.clear();
+    if (_maxRows > 0 && _rowsRead == _maxRows) {
+        char ch;
+        _truncated = _next_char(ch);
+        return false;
+    }
+    std::string cell;
     bool in_string = false;
     bool escape_next = false;
-    while (input || (pos = input.gcount()) != 0) {
-        for (auto ch : chunk_buff) {
-
-            if (ch == '\0') break;
-            if (escape_next) {
-                escape_next = false;
-                cell_buff << ch;
-                continue;
-            }
-            if (ch == esc ) {
-                // `\` escapes anything `"` escapes a quote
-                escape_next = true;
-                continue;
-            }
-            bool is_newline = ch == '\n';
-            if ((ch == cell_sep || is_newline) && !in_string) {
-                // Close the cell
-                tbl_row.emplace_back(cell_buff.str());
-                std::ostringstream tmp_buff;
-                cell_buff.swap(tmp_buff);
-
-                if (is_newline) {
-                    tbl_matrix.emplace_back(tbl_row);
-                    tbl_row.clear();
-                    continue;
-                }
-
-            } else if (ch == cell_tag) {
-                in_string = !in_string;
-            } else {
-                cell_buff << ch;
+    bool got_chars = false; // a blank line is no record
+    char ch;
+    while (_next_char(ch)) {
+        if ((ch == '\n' || ch == '\r') && !got_chars) continue;
+        got_chars = true;
+        if (escape_next) {
+            escape_next = false;
+            cell += ch;
+            continue;
+        }
+        if (ch == esc) {
+            // `\` escapes anything `"` escapes a quote
+            escape_next = true;
+            continue;
+        }
+        if (ch == '\r' && !in_string) continue;
+        bool is_newline = ch == '\n';
+        if ((ch == cell_sep || is_newline) && !in_string) {
+            // Close the cell
+            row.push_back(std::move(cell));
+            cell.clear();
+            if (is_newline) {
+                ++_rowsRead;
+                return true;
             }
+        } else if (ch == cell_tag) {
+            in_string = !in_string;
+        } else {
+            cell += ch;
         }
-
-        if (pos != 0) input.read(chunk_buff.data(), chunk_buff.size());
     }
-
-    // Reset exception bit
-    input.exceptions(except_bit_before);
-    return tbl_matrix;
+    if (!got_chars) return false;
+    // last record without a newline
+    row.push_back(std::move(cell));
+    ++_rowsRead;
+    return true;
 }
 
-std::string escape_to_csv(const std::string& input) {
-    std::ostringstream out;
-    for (const auto ch : input) {
-        if (ch == '"') {
-            out << '\\';
+void CtCsvWriter::_write_cell(const std::string& cell)
+{
+    _output << cell_tag;
+    for (const char ch : cell) {
+        if (ch == cell_tag || ch == esc) {
+            _output << esc;
         }
-        out << ch;
+        _output << ch;
     }
-    return out.str();
+    _output << cell_tag;
 }
 
-void table_to_csv(const CtStringTable& table, std::ostream& output) {
-    for (const auto& row : table) {
-        for (const auto& cell : row) {
-            output << fmt::format("\"{}\"", escape_to_csv(cell));
+CtStringTable table_from_csv(std::istream& input, const size_t max_rows)
+{
+    CtStringTable tbl_matrix;
+    CtCsvReader reader(input, max_rows);
+    std::vector<std::string> tbl_row;
+    while (reader.next_row(tbl_row)) {
+        tbl_matrix.push_back(std::move(tbl_row));
+    }
+    return tbl_matrix;
+}
 
-            if (cell != row.back()) output << ",";
-        }
-        output << "\n";
+void table_to_csv(const CtStringTable& table, std::ostream& output)
+{
+    CtCsvWriter writer(output);
+    for (const auto& row : table) {
+        writer.write_row(row);
     }
 }
 
@@ -197,30 +227,29 @@ void CtMiscUtil::widget_set_colors(Gtk::Widget& widget, const std::string& fg, c
     widget.override_background_color(style->get_background_color(Gtk::StateFlags::STATE_FLAG_SELECTED), Gtk::StateFlags::STATE_FLAG_ACTIVE);
 }
 
-bool CtMiscUtil::node_siblings_sort_iteration(Glib::RefPtr<Gtk::TreeStore> model, const Gtk::TreeNodeChildren& children,
-                                              std::function<bool(Gtk::TreeIter&, Gtk::TreeIter&)> need_swap)
+bool CtMiscUtil::node_siblings_sort(Glib::RefPtr<Gtk::TreeStore> model, const Gtk::TreeNodeChildren& children,
+                                    std::function<std::string(const Gtk::TreeIter&)> get_sort_key, const bool ascending)
 {
     if (children.empty()) return false;
-    auto next_iter = [](Gtk::TreeIter iter) { return ++iter; };
-    auto sort_iteration = [&need_swap, &model, &next_iter](Gtk::TreeIter curr_sibling) -> bool {
-        bool swap_executed = false;
-        Gtk::TreeIter next_sibling = next_iter(curr_sibling);
-        while (next_sibling) {
-            if (need_swap(curr_sibling, next_sibling)) {
-                model->iter_swap(curr_sibling, next_sibling);
-                swap_executed = true;
-            } else {
-                curr_sibling = next_sibling;
-            }
-            next_sibling = next_iter(curr_sibling);
-        }
-        return swap_executed;
-    };
+    std::vector<std::pair<std::string, int>> sort_keys;
+    sort_keys.reserve(children.size());
+    for (Gtk::TreeIter iter = children.begin(); iter; ++iter)
+        sort_keys.emplace_back(get_sort_key(iter), static_cast<int>(sort_keys.size()));
+    std::stable_sort(sort_keys.begin(), sort_keys.end(), [ascending](const auto& l, const auto& r) {
+        return ascending ? l.first < r.first : r.first < l.first;
+    });
 
-    bool swap_executed = false;
-    while (sort_iteration(children.begin()))
-        swap_executed = true;
-    return swap_executed;
+    // new_order[new position] = old position
+    std::vector<int> new_order(sort_keys.size());
+    bool order_changed{false};
+    for (size_t i = 0; i < sort_keys.size(); ++i) {
+        new_order[i] = sort_keys[i].second;
+        if (new_order[i] != static_cast<int>(i))
+            order_changed = true;
+    }
+    if (order_changed)
+        model->reorder(children, new_order);
+    return order_changed;
 }
 
 //"""Get the Node Hierarchical Name"""
@@ -299,24 +328,27 @@ URI_TYPE get_uri_type(const std::string &uri) {
 // analog to tbb::parallel_for
 void CtMiscUtil::parallel_for(size_t first, size_t last, std::function<void(size_t)> f)
 {
-    size_t concur_num = std::thread::hardware_concurrency();
-    if (first == last) return;
-    if (last < first) return;
+    if (first >= last) return;
+    CtThreadPool& threadPool = CtThreadPool::get();
+    // the waits below help only with these slices
+    const size_t group = threadPool.new_group();
+    // the calling thread takes a slice too
+    size_t concur_num = threadPool.get_workers_num() + 1;
     if (last - first < concur_num) // to make slice calc simpler
         concur_num = last - first;
     size_t slice_item_num = (last - first) / concur_num;
     size_t slice_leftover = (last - first) % concur_num;
 
-    std::list<std::thread> td_tasks;
+    auto run_slice = [&f](size_t slice_start, size_t slice_end)
+    {
+        for (size_t index = slice_start; index < slice_end; ++index)
+            f(index);
+    };
+    std::vector<std::future<void>> td_futures;
     size_t td_first = first;
-    for  (size_t thread_index = 0; thread_index < concur_num; ++thread_index)
+    size_t caller_first = first, caller_last = first;
+    for (size_t slice_index = 0; slice_index < concur_num; ++slice_index)
     {
-        std::packaged_task<void(size_t, size_t)> task([f](size_t slice_start, size_t slice_end)
-        {
-            for (size_t index = slice_start; index < slice_end; ++index)
-                f(index);
-        });
-
         size_t td_slice = slice_item_num;
         if (slice_leftover != 0) {
             td_slice += 1;
@@ -325,12 +357,30 @@ void CtMiscUtil::parallel_for(size_t first, size_t last, std::function<void(size
         if (td_first + td_slice > last)
             td_slice = last - td_first;
 
-        td_tasks.emplace_back(std::thread(std::move(task), td_first, td_first + td_slice));
+        if (slice_index == 0) {
+            caller_first = td_first;
+            caller_last = td_first + td_slice;
+        }
+        else {
+            td_futures.push_back(threadPool.submit_to_group(group, [run_slice, td_first, td_slice]() { run_slice(td_first, td_first + td_slice); }));
+        }
         td_first += td_slice;
     }
+    std::exception_ptr caller_error;
+    try {
+        run_slice(caller_first, caller_last);
+    }
+    catch (...) {
+        caller_error = std::current_exception();
+    }
 
-    for (auto& task: td_tasks)
-        task.join();
+    // a nested call waits by running its queued slices, never idles a worker
+    for (auto& td_future : td_futures)
+        threadPool.wait(td_future, group);
+    if (caller_error)
+        std::rethrow_exception(caller_error);
+    for (auto& td_future : td_futures)
+        td_future.get();
 }
 
 // Returns True if the characters compose a camel case word
@@ -535,9 +585,13 @@ const gchar* CtTextIterUtil::get_text_iter_alignment(const Gtk::TextIter& textIt
 }
 
 int CtTextIterUtil::get_words_count(const Glib::RefPtr<Gtk::TextBuffer>& text_buffer)
+{
+    return CtStrUtil::get_words_count(text_buffer->get_text(true));
+}
+
+int CtStrUtil::get_words_count(const Glib::ustring& text)
 {
     int words = 0;
-    Glib::ustring text = text_buffer->get_text(true);
     if (!text.empty())
     {
         int text_size = text.size();
@@ -667,6 +721,79 @@ int CtStrUtil::natural_compare(const Glib::ustring& left, const Glib::ustring& r
     return 0;
 }
 
+std::string CtStrUtil::natural_sort_key(const Glib::ustring& text)
+{
+    // a run of digits is 0x01, its length and its digits without leading zeros, so it comes before any other
+    // character; any other character is 0x02 and its collation key up to the terminating 0x00
+    std::string sort_key;
+    for (auto iter = text.begin(); iter != text.end(); )
+    {
+        if (g_unichar_digit_value(*iter) != -1)
+        {
+            std::string digits;
+            for (; iter != text.end() && g_unichar_digit_value(*iter) != -1; ++iter)
+                if (not digits.empty() or g_unichar_digit_value(*iter) != 0)
+                    digits += static_cast<char>('0' + g_unichar_digit_value(*iter));
+            sort_key += '\x01';
+            sort_key += fmt::format("{:010d}", digits.size());
+            sort_key += digits;
+        }
+        else
+        {
+            sort_key += '\x02';
+            sort_key += Glib::ustring(1, *iter).collate_key();
+            sort_key += '\0';
+            ++iter;
+        }
+    }
+    return sort_key;
+}
+
+std::string CtStrUtil::ids_to_ranges(std::vector<gint64> ids)
+{
+    std::sort(ids.begin(), ids.end());
+    ids.erase(std::unique(ids.begin(), ids.end()), ids.end());
+    std::string ranges;
+    for (size_t first = 0; first < ids.size(); )
+    {
+        size_t last = first;
+        while (last + 1 < ids.size() and ids[last + 1] == ids[last] + 1)
+            ++last;
+        if (not ranges.empty())
+            ranges += ',';
+        ranges += std::to_string(ids[first]);
+        if (last > first)
+            ranges += '-' + std::to_string(ids[last]);
+        first = last + 1;
+    }
+    return ranges;
+}
+
+std::unordered_set<gint64> CtStrUtil::ranges_to_ids(const std::string& ranges, const gint64 max_id)
+{
+    std::unordered_set<gint64> ids;
+    const gchar* pChar = ranges.c_str();
+    while (*pChar)
+    {
+        gchar* pEnd{nullptr};
+        const gint64 first_id = g_ascii_strtoll(pChar, &pEnd, 10);
+        if (pEnd == pChar) break; // not a number
+        gint64 last_id = first_id;
+        if (*pEnd == '-')
+        {
+            pChar = pEnd + 1;
+            last_id = g_ascii_strtoll(pChar, &pEnd, 10);
+            if (pEnd == pChar) break;
+        }
+        // a corrupt range, e.g. 1-9999999999, would insert billions of ids
+        for (gint64 id = std::max(first_id, (gint64)0); id <= std::min(last_id, max_id); ++id)
+            ids.insert(id);
+        if (*pEnd != ',') break;
+        pChar = pEnd + 1;
+    }
+    return ids;
+}
+
 Glib::ustring CtStrUtil::highlight_words(const Glib::ustring& text, std::vector<Glib::ustring> words, const Glib::ustring& markup_tag /* = "b" */)
 {
     if (words.empty())
@@ -893,19 +1020,9 @@ int str::indexOf(const Glib::ustring& str, const gunichar& uc)
 
 std::string str::xml_escape(const std::string& text)
 {
-    std::string buffer;
-    buffer.reserve(text.size());
-    for(size_t pos = 0; pos != text.size(); ++pos) {
-        switch(text[pos]) {
-            case '&':  buffer.append("&amp;");       break;
-            case '\"': buffer.append("&quot;");      break;
-            case '\'': buffer.append("&apos;");      break;
-            case '<':  buffer.append("&lt;");        break;
-            case '>':  buffer.append("&gt;");        break;
-            default:   buffer.append(&text[pos], 1); break;
-        }
-    }
-    return buffer;
+    CtStringBuilder buffer;
+    buffer.append_xml_escaped(text);
+    return buffer.release();
 }
 
 Glib::ustring str::sanitize_bad_symbols(const Glib::ustring& xml_content)
@@ -969,6 +1086,80 @@ Glib::ustring str::repeat(const Glib::ustring& input, int num)
     return ret;
 }
 
+CtStringBuilder& CtStringBuilder::append_unichar(const gunichar uc)
+{
+    char utf8[6];
+    _buffer.append(utf8, (size_t)g_unichar_to_utf8(uc, utf8));
+    return *this;
+}
+
+CtStringBuilder& CtStringBuilder::append_xml_escaped(std::string_view text, const bool newline_to_br, const bool space_to_nbsp)
+{
+    _buffer.reserve(_buffer.size() + text.size());
+    size_t run_start = 0;
+    for (size_t pos = 0; pos < text.size(); ++pos) {
+        const char* replacement{nullptr};
+        switch (text[pos]) {
+            case '&':  replacement = "&amp;";  break;
+            case '\"': replacement = "&quot;"; break;
+            case '\'': replacement = "&apos;"; break;
+            case '<':  replacement = "&lt;";   break;
+            case '>':  replacement = "&gt;";   break;
+            case '\n': if (newline_to_br) replacement = "<br />"; break;
+            case ' ':  if (space_to_nbsp) replacement = "&nbsp;"; break;
+            default: break;
+        }
+        if (replacement) {
+            // copy the untouched bytes in one go
+            _buffer.append(text.data() + run_start, pos - run_start);
+            _buffer.append(replacement);
+            run_start = pos + 1;
+        }
+    }
+    _buffer.append(text.data() + run_start, text.size() - run_start);
+    return *this;
+}
+
+CtStringBuilder& CtStringBuilder::append_xml_escaped_unichar(const gunichar uc, const bool newline_to_br, const bool space_to_nbsp)
+{
+    char utf8[6];
+    return append_xml_escaped(std::string_view(utf8, (size_t)g_unichar_to_utf8(uc, utf8)), newline_to_br, space_to_nbsp);
+}
+
+void CtStringBuilder::replace_all(std::initializer_list<std::pair<std::string_view, std::string_view>> search_replace)
+{
+    // UTF-8 is self-synchronising so a byte match of a valid UTF-8 string is also a characters match
+    std::string result;
+    result.reserve(_buffer.size());
+    size_t run_start = 0;
+    size_t pos = 0;
+    while (pos < _buffer.size()) {
+        const std::pair<std::string_view, std::string_view>* pMatch{nullptr};
+        for (const auto& curr_pair : search_replace) {
+            const std::string_view& search = curr_pair.first;
+            if (not search.empty() and
+                search[0] == _buffer[pos] and
+                0 == _buffer.compare(pos, search.size(), search.data(), search.size()))
+            {
+                pMatch = &curr_pair;
+                break;
+            }
+        }
+        if (pMatch) {
+            result.append(_buffer, run_start, pos - run_start);
+            result.append(pMatch->second.data(), pMatch->second.size());
+            pos += pMatch->first.size();
+            run_start = pos;
+        }
+        else {
+            ++pos;
+        }
+    }
+    if (run_start == 0) return; // nothing replaced
+    result.append(_buffer, run_start, std::string::npos);
+    _buffer.swap(result);
+}
+
 
 
 
@@ -29,6 +29,9 @@
 #include <gtkmm/treestore.h>
 #include <spdlog/fmt/fmt.h>
 #include <unordered_set>
+#include <array>
+#include <istream>
+#include <ostream>
 #include <type_traits>
 
 class CtConfig;
@@ -40,7 +43,59 @@ template<class F> auto scope_guard(F&& f) {
 
 namespace CtCSV {
     using CtStringTable = std::vector<std::vector<std::string>>;
-    CtStringTable table_from_csv(std::istream& input);
+
+    // reads the records one at a time, only the current chunk of the input is in memory
+    class CtCsvReader
+    {
+    public:
+        // max_rows 0 means no limit
+        CtCsvReader(std::istream& input, const size_t max_rows = 0);
+        ~CtCsvReader();
+
+        // false at the end of the input or after max_rows rows
+        bool next_row(std::vector<std::string>& row);
+        std::streamoff get_bytes_read() const { return _bytesRead; }
+        // true if the rows limit stopped the reading before the end of the input
+        bool is_truncated() const { return _truncated; }
+
+    private:
+        bool _next_char(char& ch);
+
+        std::istream&            _input;
+        const std::ios::iostate  _exceptionsBefore;
+        const size_t             _maxRows;
+        size_t                   _rowsRead{0};
+        bool                     _truncated{false};
+        std::array<char, 4096>   _chunk{};
+        std::streamsize          _chunkSize{0};
+        std::streamsize          _chunkPos{0};
+        std::streamoff           _bytesRead{0};
+    };
+
+    // writes the records one at a time
+    class CtCsvWriter
+    {
+    public:
+        CtCsvWriter(std::ostream& output) : _output(output) {}
+
+        template<class ROW> void write_row(const ROW& row)
+        {
+            bool first{true};
+            for (const auto& cell : row) {
+                if (not first) _output << ',';
+                first = false;
+                _write_cell(cell);
+            }
+            _output << '\n';
+        }
+
+    private:
+        void _write_cell(const std::string& cell);
+
+        std::ostream& _output;
+    };
+
+    CtStringTable table_from_csv(std::istream& input, const size_t max_rows = 0);
     void table_to_csv(const CtStringTable& table, std::ostream& output);
 }
 
@@ -55,8 +110,10 @@ void filepath_extension_fix(const CtDocType ctDocType, const CtDocEncrypt ctDocE
 void widget_set_colors(Gtk::Widget& widget, const std::string& fg, const std::string& bg,
                        bool syntax_highl, const std::string& gdk_col_fg);
 
-bool node_siblings_sort_iteration(Glib::RefPtr<Gtk::TreeStore> model, const Gtk::TreeNodeChildren& children,
-                                  std::function<bool(Gtk::TreeIter&, Gtk::TreeIter&)> need_swap);
+// the key of each sibling is computed once, the keys are compared as bytes and the new order goes to the model
+// with a single reorder; equal keys keep their order; returns false if the order was already that
+bool node_siblings_sort(Glib::RefPtr<Gtk::TreeStore> model, const Gtk::TreeNodeChildren& children,
+                        std::function<std::string(const Gtk::TreeIter&)> get_sort_key, const bool ascending);
 
 std::string get_node_hierarchical_name(CtTreeIter tree_iter, const char* separator="--",
                                        bool for_filename=true, bool root_to_leaf=true, const char* trailer="");
@@ -142,6 +199,9 @@ namespace CtStrUtil {
 
 bool is_str_true(const Glib::ustring& inStr);
 
+// pango word starts, thread safe
+int get_words_count(const Glib::ustring& text);
+
 gint64 gint64_from_gstring(const gchar* inGstring, bool hexPrefix=false);
 
 guint32 guint32_from_hex_chars(const char* hexChars, guint8 numChars);
@@ -190,6 +250,14 @@ bool contains_words(const String& text, const std::vector<String>& words, bool r
 // https://stackoverflow.com/questions/642213/how-to-implement-a-natural-sort-algorithm-in-c
 int natural_compare(const Glib::ustring& left, const Glib::ustring& right);
 
+// the bytes comparison of the keys gives the order of natural_compare
+std::string natural_sort_key(const Glib::ustring& text);
+
+// the ids sorted and joined in ranges, e.g. "2,5-9,12"
+std::string ids_to_ranges(std::vector<gint64> ids);
+// the ids outside of 0..max_id are dropped, so are the ranges ending before they start
+std::unordered_set<gint64> ranges_to_ids(const std::string& ranges, const gint64 max_id);
+
 // Returns a version of text in which all occurrences of words
 // are highlighted using Pango markup
 Glib::ustring highlight_words(const Glib::ustring& text, std::vector<Glib::ustring> words, const Glib::ustring& markup_tag = "b");
@@ -345,6 +413,43 @@ Glib::ustring repeat(const Glib::ustring& input, int num);
 
 } // namespace str
 
+/**
+ * @brief Byte oriented output buffer for the exporters
+ * Appending and replacing work on the UTF-8 bytes, never on character indexes as Glib::ustring does
+ */
+class CtStringBuilder
+{
+public:
+    void   reserve(size_t bytes) { _buffer.reserve(bytes); }
+    void   clear() { _buffer.clear(); }
+    size_t size() const { return _buffer.size(); }
+    bool   empty() const { return _buffer.empty(); }
+    char   back() const { return _buffer.back(); }
+    const char*        c_str() const { return _buffer.c_str(); }
+    const std::string& str() const { return _buffer; }
+    std::string        release() { return std::move(_buffer); }
+
+    CtStringBuilder& append(std::string_view text) { _buffer.append(text.data(), text.size()); return *this; }
+    CtStringBuilder& append(const std::string& text) { _buffer.append(text); return *this; }
+    CtStringBuilder& append(const Glib::ustring& text) { _buffer.append(text.raw()); return *this; }
+    CtStringBuilder& append(const char* text) { _buffer.append(text); return *this; }
+    CtStringBuilder& append(const char ch) { _buffer.push_back(ch); return *this; }
+    CtStringBuilder& append(const CtStringBuilder& other) { _buffer.append(other._buffer); return *this; }
+    CtStringBuilder& append_unichar(const gunichar uc);
+    template<class T> CtStringBuilder& operator<<(const T& text) { return append(text); }
+
+    // same as str::xml_escape, optionally with newlines to "<br />" and spaces to "&nbsp;" for html
+    CtStringBuilder& append_xml_escaped(std::string_view text, const bool newline_to_br = false, const bool space_to_nbsp = false);
+    CtStringBuilder& append_xml_escaped_unichar(const gunichar uc, const bool newline_to_br = false, const bool space_to_nbsp = false);
+
+    // replace all the occurrences of all the search strings in one pass,
+    // at each position the first matching search string wins
+    void replace_all(std::initializer_list<std::pair<std::string_view, std::string_view>> search_replace);
+
+private:
+    std::string _buffer;
+};
+
 namespace vec {
 
 template<class VEC, class VAL>
@@ -249,22 +249,22 @@ void CtHtmlParser::feed(const std::string& html)
 
 void CtHtmlParser::handle_starttag(std::string_view /*tag*/, const char **/*atts*/)
 {
-    // spdlog::debug("SAX tag: {}", tag);
+    // SPDLOG_DEBUG("SAX tag: {}", tag);
 }
 
 void CtHtmlParser::handle_endtag(std::string_view /*tag*/)
 {
-    // spdlog::debug("SAX endtag: {}", tag);
+    // SPDLOG_DEBUG("SAX endtag: {}", tag);
 }
 
 void CtHtmlParser::handle_data(std::string_view /*tag*/)
 {
-    // spdlog::debug("SAX data: {}", text);
+    // SPDLOG_DEBUG("SAX data: {}", text);
 }
 
 void CtHtmlParser::handle_charref(std::string_view /*tag*/)
 {
-    // spdlog::debug("SAX ref: {}", name);
+    // SPDLOG_DEBUG("SAX ref: {}", name);
 }
 
 /*static*/ std::list<CtHtmlParser::html_attr> CtHtmlParser::char2list_attrs(const char** atts)
@@ -936,7 +936,7 @@ void CtMarkdownFilter::_on_buffer_erase(const Gtk::TextIter& begin, const Gtk::T
         bool is_all = (begin == _buffer->begin()) && (end == _buffer->end());
         if (is_all && active()) {
             reset();
-            spdlog::debug("Reset markdown matchers due to buffer clear");
+            SPDLOG_DEBUG("Reset markdown matchers due to buffer clear");
             return;
         }
         if (active()) {
@@ -952,7 +952,7 @@ void CtMarkdownFilter::_on_buffer_erase(const Gtk::TextIter& begin, const Gtk::T
                     if (!start.forward_char()) break;
                     ++offset;
                 }
-                spdlog::debug("Found erase offset: <{}>", offset);
+                SPDLOG_DEBUG("Found erase offset: <{}>", offset);
                 if (offset < matcher.raw_str().size()) matcher.erase(offset);
             };
 
@@ -1035,7 +1035,7 @@ void CtMarkdownFilter::_on_buffer_insert(const Gtk::TextBuffer::iterator& pos, c
                 _apply_tag(tag_name, back_iter, pos);
 
                 if (!has_mark) {
-                    spdlog::debug("Creating new tag: {}", tag_name);
+                    SPDLOG_DEBUG("Creating new tag: {}", tag_name);
                     md_parser = std::make_shared<CtMDParser>(_config);
                     md_matcher = std::make_unique<CtTokenMatcher>(md_parser->text_parser());
 
@@ -1056,7 +1056,7 @@ void CtMarkdownFilter::_on_buffer_insert(const Gtk::TextBuffer::iterator& pos, c
                         if (for_iter.get_char() == '\n') break;
                         ++offset;
                     }
-                    spdlog::trace("Inserting: <{}> at offset: <{}>", std::string(1, insert_ch), offset);
+                    SPDLOG_TRACE("Inserting: <{}> at offset: <{}>", std::string(1, insert_ch), offset);
                     md_matcher->insert(insert_ch, offset);
 
 
@@ -1079,7 +1079,7 @@ void CtMarkdownFilter::_on_buffer_insert(const Gtk::TextBuffer::iterator& pos, c
 }
 
 void CtMarkdownFilter::_apply_tag(const Glib::ustring& tag, const Gtk::TextIter& start, const Gtk::TextIter& end) {
-    spdlog::debug("Applying tag: {}", tag);
+    SPDLOG_DEBUG("Applying tag: {}", tag);
     bool has_tag = static_cast<bool>(_buffer->get_tag_table()->lookup(tag));
     if (!has_tag) {
         // create if not exists
@@ -1317,14 +1317,15 @@ std::vector<CtTextParser::token_schema> CtZimParser::_token_schemas()
 
 void CtZimParser::_parse_body_line(const std::string& line)
 {
-    auto tokens_raw = _text_parser->tokenize(line);
-    auto tokens = _text_parser->parse_tokens(tokens_raw);
+    std::list<std::string> captures_storage;
+    const auto tokens_raw = _text_parser->tokenize(line);
+    const auto tokens = _text_parser->parse_tokens(tokens_raw, captures_storage);
 
     for (const auto& token : tokens) {
         if (token.first) {
-            token.first->action(token.second);
+            token.first->action(std::string{token.second});
         } else {
-            doc_builder().add_text(token.second);
+            doc_builder().add_text(std::string{token.second});
         }
 
     }
@@ -157,6 +157,7 @@ public:
 
     using tags_map_t = std::unordered_map<std::string_view, const token_schema *>;
     using pos_tokens_t = std::unordered_map<char, std::vector<std::string_view>>;
+    using token_stream_t = std::vector<std::pair<const token_schema *, std::string_view>>;
 
 
     explicit CtTextParser(std::vector<token_schema>&& token_schemas);
@@ -174,15 +175,21 @@ public:
     const std::vector<token_schema>& token_schemas() const { return _token_schemas; }
     const pos_tokens_t& pos_tokens() const { return _possible_tokens; }
      /**
-     * @brief Transform an input string into a token stream
-     * @param tokens
+     * @brief Transform the tokens of a text into a token stream
+     * @param tokens views on the text, which has to outlive the token stream
+     * @param captures_storage holds the captured data that is not contiguous in the text (escaped chars)
      * @return
      */
-    std::vector<std::pair<const token_schema *, std::string>> parse_tokens(const std::vector<std::string>& tokens) const;
+    token_stream_t parse_tokens(const std::vector<std::string_view>& tokens, std::list<std::string>& captures_storage) const;
 
-    std::vector<std::string> tokenize(const std::string& text) const;
+    /// Split the text into tokens, the tokens are views on the text
+    std::vector<std::string_view> tokenize(std::string_view text) const;
 
 private:
+    using tokens_iter_t = std::vector<std::string_view>::const_iterator;
+    void _parse_tokens(tokens_iter_t begin, tokens_iter_t end, token_stream_t& token_stream, std::list<std::string>& captures_storage) const;
+
+
     /// Tokens to be cached by the parser
     const std::vector<token_schema> _token_schemas;
   
@@ -221,6 +228,7 @@ public:
     CtMDParser(CtConfig* config, std::shared_ptr<CtTextParser> parser) : CtDocBuildingParser{config} , _text_parser{std::move(parser)}{}
 
     void feed(std::istream& stream) override;
+    void feed(std::string_view text);
 
  
     virtual ~CtMDParser() = default;
@@ -243,7 +251,7 @@ private:
     TableMatrix _current_table;
 
     const CtTextParser::token_schema* _last_encountered_token = nullptr;
-    std::ostringstream _free_text;
+    std::string _free_text;
 
     uint8_t _list_level = 0;
     std::shared_ptr<CtTextParser> _text_parser;
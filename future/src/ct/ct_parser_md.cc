@@ -47,7 +47,7 @@ std::vector<CtTextParser::token_schema> CtMDParser::_token_schemas()
             lang.append(data.begin(), data_iter);
 
         }
-        spdlog::debug("CODEBOX: {}, lang: {}", text, lang);
+        SPDLOG_DEBUG("CODEBOX: {}, lang: {}", text, lang);
         doc_builder().add_codebox(lang, text);
         
     };
@@ -58,8 +58,7 @@ std::vector<CtTextParser::token_schema> CtMDParser::_token_schemas()
     };
     auto add_list = [this](const std::string& text) {
         doc_builder().add_list(_list_level, "");
-        std::istringstream ss(text);
-        feed(ss);
+        feed(std::string_view{text});
         doc_builder().add_newline();
         _list_level = 0;
     };
@@ -162,7 +161,7 @@ std::vector<CtTextParser::token_schema> CtMDParser::_token_schemas()
         
         // Table row
         {"|", true, false, [this](const std::string& data){
-            spdlog::debug("Got end: {}", data);
+            SPDLOG_DEBUG("Got end: {}", data);
             _add_table_cell(data);
         }, "\n"},
         // Table header divider
@@ -195,34 +194,27 @@ std::vector<CtTextParser::token_schema> CtMDParser::_token_schemas()
 
 void CtMDParser::_place_free_text() 
 {
-    std::string free_txt = _free_text.str();
-    if (!free_txt.empty()) {
-        auto iter = free_txt.crbegin();
-        for (;iter != free_txt.crend(); ++iter) {
-            if (*iter == '\n') break;
-        }
-        std::string last_line(iter.base(), free_txt.cend());
-        std::string other_txt(free_txt.cbegin(), iter.base());
-        doc_builder().add_text(other_txt);
-        doc_builder().add_text(last_line); // This may be needed for headers
-
-        std::ostringstream tmp_ss;
-        _free_text.swap(tmp_ss);
+    if (!_free_text.empty()) {
+        const auto last_line_pos = _free_text.find_last_of('\n');
+        const auto other_txt_len = last_line_pos == std::string::npos ? 0 : last_line_pos + 1;
+        doc_builder().add_text(_free_text.substr(0, other_txt_len));
+        doc_builder().add_text(_free_text.substr(other_txt_len)); // This may be needed for headers
+        _free_text.clear();
     }
 }
 
 void CtMDParser::feed(std::istream& stream)
 {
+    const std::string text{std::istreambuf_iterator<char>{stream}, std::istreambuf_iterator<char>{}};
+    feed(std::string_view{text});
+}
 
-    
-    std::string line;
-    std::ostringstream in_stream;
-    in_stream << stream.rdbuf();
-    
-    // Feed the line
+void CtMDParser::feed(std::string_view text)
+{
     try {
-        auto tokens_raw = _text_parser->tokenize(in_stream.str());
-        auto tokens     = _text_parser->parse_tokens(tokens_raw);
+        std::list<std::string> captures_storage;
+        const auto tokens_raw = _text_parser->tokenize(text);
+        const auto tokens     = _text_parser->parse_tokens(tokens_raw, captures_storage);
         
         for (auto iter = tokens.begin(); iter != tokens.end(); ++iter) {
             if (iter->first) {
@@ -231,7 +223,9 @@ void CtMDParser::feed(std::istream& stream)
                 if ((iter + 1) != tokens.end()) {
                     if (!(iter + 1)->first && ((iter + 1)->second == ")")) {
                         // Excess bracket from link
-                        iter->first->action(iter->second + ")");
+                        std::string data{iter->second};
+                        data += ")";
+                        iter->first->action(data);
                         ++iter;
                         if ((iter + 1) != tokens.end()) ++iter;
     
@@ -239,18 +233,18 @@ void CtMDParser::feed(std::istream& stream)
                     }
                 }
                 
-                iter->first->action(iter->second);
+                iter->first->action(std::string{iter->second});
             } else {
                 if (!iter->second.empty()) {
                     if (!_current_table.empty() && iter->second == "\n") _pop_table();
-                    _free_text.write(iter->second.c_str(), iter->second.size());
+                    _free_text.append(iter->second.data(), iter->second.size());
                 }
             }
             _last_encountered_token = iter->first;
         }
         _place_free_text();
     } catch (std::exception& e) {
-        spdlog::error("Exception while parsing line: '{}': {}", line, e.what());
+        spdlog::error("Exception while parsing markdown: {}", e.what());
     }
     
 }
@@ -84,6 +84,49 @@ CtTextParser::tags_map_t build_tags_map(const std::vector<CtTextParser::token_sc
     return tags_map;
 }
 
+// Length of the longest of the possible tokens found at pos, 0 if none
+std::size_t longest_token_at(std::string_view text, std::size_t pos, const std::vector<std::string_view>& options) {
+    std::size_t largest_len = 0;
+    for (const auto& opt : options) {
+        if (opt.length() > largest_len && text.compare(pos, opt.length(), opt) == 0) {
+            largest_len = opt.length();
+        }
+    }
+    return largest_len;
+}
+
+// Concatenation of tokens, a view on the source text as long as the tokens are contiguous in it
+class tokens_capture
+{
+public:
+    void append(std::string_view token) {
+        if (!_is_copy && (_view.empty() || _view.data() + _view.size() == token.data())) {
+            _view = _view.empty() ? token : std::string_view{_view.data(), _view.size() + token.size()};
+        } else {
+            if (!_is_copy) {
+                _copy.assign(_view.data(), _view.size());
+                _is_copy = true;
+            }
+            _copy.append(token.data(), token.size());
+        }
+    }
+    std::string_view get(std::list<std::string>& captures_storage) {
+        if (!_is_copy) return _view;
+        captures_storage.push_back(std::move(_copy));
+        return captures_storage.back();
+    }
+    void clear() {
+        _view = std::string_view{};
+        _copy.clear();
+        _is_copy = false;
+    }
+
+private:
+    std::string_view _view;
+    std::string      _copy;
+    bool             _is_copy{false};
+};
+
 template<typename ITER>
 void feed_tags(ITER start, ITER end, CtTokenMatcher::pos_tokens_t& to) {
     static const std::unordered_set<std::string_view> ignored_tags = {"|", "|\n", "\n==", "\n----"};
@@ -102,72 +145,76 @@ CtTextParser::CtTextParser(std::vector<token_schema>&& token_schemas) : _token_s
 
 
 
-std::vector<std::string> CtTextParser::tokenize(const std::string& text) const
+std::vector<std::string_view> CtTextParser::tokenize(std::string_view text) const
 {
-
-    std::vector<std::string> tokens;
-    std::string::const_iterator last_pos = text.begin();
-    for (auto ch = text.begin(); ch != text.end(); ++ch) {
-
-        if (*ch == ' ') {
-            if (last_pos != ch) tokens.emplace_back(last_pos, ch);
-            last_pos = ch;
+    std::vector<std::string_view> tokens;
+    std::size_t last_pos = 0;
+    for (std::size_t pos = 0; pos < text.size(); ++pos) {
+        const char ch = text[pos];
+        if (ch == ' ') {
+            if (last_pos != pos) tokens.push_back(text.substr(last_pos, pos - last_pos));
+            last_pos = pos;
             continue;
         }
-        if (*ch == '\\') {
+        if (ch == '\\') {
             // Escape next char
-            if (last_pos != ch) tokens.emplace_back(last_pos, ch);
-            ++ch;
-            last_pos = ch;
-            if (ch == text.end()) break;
+            if (last_pos != pos) tokens.push_back(text.substr(last_pos, pos - last_pos));
+            ++pos;
+            last_pos = pos;
+            if (pos == text.size()) break;
             continue;
         }
 
-        auto pos_token = _possible_tokens.find(*ch);
-        if (pos_token != _possible_tokens.end()){
-            auto found_token = branch_token(ch, text.end(), pos_token->second);
-            if (found_token) {
-                spdlog::debug("TOKEN: {}", *found_token);
-                tokens.emplace_back(last_pos, ch);
-                tokens.emplace_back(*found_token);
-                ch += found_token->length() - 1;
-                last_pos = ch + 1;
+        auto pos_token = _possible_tokens.find(ch);
+        if (pos_token != _possible_tokens.end()) {
+            const std::size_t token_len = longest_token_at(text, pos, pos_token->second);
+            if (token_len > 0) {
+                tokens.push_back(text.substr(last_pos, pos - last_pos));
+                tokens.push_back(text.substr(pos, token_len));
+                pos += token_len - 1;
+                last_pos = pos + 1;
             }
-
-            if (ch == text.end()) break;
         }
     }
-    if (last_pos != text.end()) {
-        tokens.emplace_back(last_pos, text.end());
+    if (last_pos < text.size()) {
+        tokens.push_back(text.substr(last_pos));
     }
     return tokens;
 }
 
-std::vector<std::pair<const CtTextParser::token_schema *, std::string>> CtTextParser::parse_tokens(const std::vector<std::string>& tokens) const
+CtTextParser::token_stream_t CtTextParser::parse_tokens(const std::vector<std::string_view>& tokens, std::list<std::string>& captures_storage) const
+{
+    token_stream_t token_stream;
+    token_stream.reserve(tokens.size());
+    _parse_tokens(tokens.begin(), tokens.end(), token_stream, captures_storage);
+    return token_stream;
+}
+
+void CtTextParser::_parse_tokens(tokens_iter_t begin, tokens_iter_t end, token_stream_t& token_stream, std::list<std::string>& captures_storage) const
 {
-    std::vector<std::pair<const token_schema *, std::string>> token_stream;
-    std::unordered_map<std::string_view, bool>                open_tags;
-    std::pair<std::vector<const token_schema *>, std::string> curr_open_tags;
-    bool                                                      keep_parsing     = true;
-    auto                                                      &token_map_open  = open_tokens_map();
-    auto                                                      &token_map_close = close_tokens_map();
+    std::unordered_map<std::string_view, bool>    open_tags;
+    std::vector<const token_schema *>             curr_open_tags;
+    tokens_capture                                curr_capture;
+    bool                                          keep_parsing     = true;
+    auto                                          &token_map_open  = open_tokens_map();
+    auto                                          &token_map_close = close_tokens_map();
     int  nb_open_tags = 0;
 
-    for (auto token = tokens.begin(); token != tokens.end(); ++token) {
+    for (auto token = begin; token != end; ++token) {
 
         if (token->empty()) continue;
 
         auto tokens_iter = token_map_open.find(*token);
         if (tokens_iter != token_map_open.end()) {
 
-            if (!curr_open_tags.first.empty() && !keep_parsing) {
-                if (tokens_iter->second->open_tag == curr_open_tags.first.front()->open_tag) {
+            if (!curr_open_tags.empty() && !keep_parsing) {
+                if (tokens_iter->second->open_tag == curr_open_tags.front()->open_tag) {
                     ++nb_open_tags;
                 }
             }
 
             if (!(tokens_iter->second->is_symmetrical && open_tags[tokens_iter->first]) && keep_parsing) {
-                curr_open_tags.first.emplace_back(tokens_iter->second);
+                curr_open_tags.emplace_back(tokens_iter->second);
                 keep_parsing = !tokens_iter->second->capture_all;
 
                 if (!tokens_iter->second->has_closetag) {
@@ -175,19 +222,16 @@ std::vector<std::pair<const CtTextParser::token_schema *, std::string>> CtTextPa
                     ++token;
                     if (keep_parsing) {
                         // Parse the other data in the stream
-                        token_stream.emplace_back(tokens_iter->second, "");
-                        std::vector<std::string> rem_tokens(token, tokens.end());
-                        auto tokonised_stream = parse_tokens(rem_tokens);
-                        token_stream.insert(token_stream.end(), tokonised_stream.begin(), tokonised_stream.end());
+                        token_stream.emplace_back(tokens_iter->second, std::string_view{});
+                        _parse_tokens(token, end, token_stream, captures_storage);
                     } else {
-                        std::string buff;
-                        while (token != tokens.end()) {
-                            buff += *token;
-                            ++token;
+                        tokens_capture capture;
+                        for (; token != end; ++token) {
+                            capture.append(*token);
                         }
-                        token_stream.emplace_back(tokens_iter->second, buff);
+                        token_stream.emplace_back(tokens_iter->second, capture.get(captures_storage));
                     }
-                    return token_stream;
+                    return;
                 }
                 open_tags[tokens_iter->first] = true;
                 continue;
@@ -197,48 +241,46 @@ std::vector<std::pair<const CtTextParser::token_schema *, std::string>> CtTextPa
 
         auto token_iter  = token_map_close.find(*token);
         if (token_iter != token_map_close.end()) {
-            if (curr_open_tags.first.empty()) {
-                spdlog::debug("Found close tag without open: {}, assuming escaped", *token);
+            if (curr_open_tags.empty()) {
+                SPDLOG_DEBUG("Found close tag without open: {}, assuming escaped", *token);
                 token_stream.emplace_back(nullptr, *token);
                 continue;
             }
 
             if (!keep_parsing) {
-                if (curr_open_tags.first.front()->close_tag != *token) {
-                    curr_open_tags.second += *token;
+                if (curr_open_tags.front()->close_tag != *token) {
+                    curr_capture.append(*token);
                     continue;
-                } else if (curr_open_tags.first.front()->close_tag == *token) {
+                } else if (curr_open_tags.front()->close_tag == *token) {
                     if (nb_open_tags > 1) {
                         --nb_open_tags;
-                        curr_open_tags.second += *token;
+                        curr_capture.append(*token);
                         continue;
                     }
                 }
             }
 
 
-            token_stream.emplace_back(curr_open_tags.first.front(), curr_open_tags.second);
+            token_stream.emplace_back(curr_open_tags.front(), curr_capture.get(captures_storage));
 
-            if (curr_open_tags.first.size() >= 2) {
+            if (curr_open_tags.size() >= 2) {
                 // Found more than one tag
-                for (auto iter = curr_open_tags.first.begin() + 1; iter != curr_open_tags.first.end(); ++iter) {
-                    if ((*iter)->open_tag != curr_open_tags.first.front()->open_tag) token_stream.emplace_back(*iter, "");
+                for (auto iter = curr_open_tags.begin() + 1; iter != curr_open_tags.end(); ++iter) {
+                    if ((*iter)->open_tag != curr_open_tags.front()->open_tag) token_stream.emplace_back(*iter, std::string_view{});
                 }
             }
             open_tags[token_iter->first] = false;
             keep_parsing = true;
 
             nb_open_tags = 0;
-            curr_open_tags.second.clear();
-            curr_open_tags.first.clear();
-        } else if (curr_open_tags.first.empty()) {
+            curr_capture.clear();
+            curr_open_tags.clear();
+        } else if (curr_open_tags.empty()) {
             token_stream.emplace_back(nullptr, *token);
-        } else if (!curr_open_tags.first.empty()) {
-            curr_open_tags.second += *token;
+        } else if (!curr_open_tags.empty()) {
+            curr_capture.append(*token);
         }
     }
-
-    return token_stream;
 }
 
 std::unordered_set<char> shred(const std::vector<std::string>& strings) {
@@ -336,14 +378,14 @@ void CtTokenMatcher::erase(int offset) {
         if (offset == 0) pop_back();
         else if (offset >= static_cast<int>(contents_end_offset()) && offset <= static_cast<int>(contents_start_offset())) {
             // Contents
-            spdlog::debug("Erase contents");
+            SPDLOG_DEBUG("Erase contents");
             int erase_offset = lr_offset - static_cast<int>(_open_token.size());
-            spdlog::debug("Erased <{}>", std::string(_token_contents.begin() + erase_offset, _token_contents.begin() + erase_offset + 1));
+            SPDLOG_DEBUG("Erased <{}>", std::string(_token_contents.begin() + erase_offset, _token_contents.begin() + erase_offset + 1));
             _token_contents.erase(_token_contents.begin() + erase_offset, _token_contents.begin() + erase_offset + 1);
         }
         else if (offset >= static_cast<int>(raw_end_offset() + _token_contents.size()) && lr_offset < static_cast<int>(_open_token.size())) {
             // Open
-            spdlog::debug("Erase open");
+            SPDLOG_DEBUG("Erase open");
             _open_token.erase(_open_token.begin() + lr_offset, _open_token.begin() + lr_offset + 1);
 
             // Update tokens
@@ -353,7 +395,7 @@ void CtTokenMatcher::erase(int offset) {
         }
         else if (offset >= static_cast<int>((_open_token.size() + _token_contents.size()))) {
             // Close
-            spdlog::debug("Erase close");
+            SPDLOG_DEBUG("Erase close");
             int erase_offset = static_cast<int>(_close_token.size()) - offset;
             if (erase_offset >= 0) {
                 _close_token.erase(_close_token.begin() + erase_offset, _close_token.begin() + erase_offset + 1);
@@ -395,20 +437,20 @@ void CtTokenMatcher::insert(char ch, int offset) {
         if (offset == 0) feed(ch);
         else if (offset >= static_cast<int>(contents_start_offset())) {
             // Open token
-            spdlog::trace("Insert open_token");
+            SPDLOG_TRACE("Insert open_token");
             _open_token.insert(_open_token.begin() + lr_offset, ch);
 
             _reset_and_refeed();
         }
         else if (offset <= static_cast<int>(contents_end_offset())) {
             // Close token
-            spdlog::trace("Insert close token");
+            SPDLOG_TRACE("Insert close token");
             _close_token.insert(_close_token.begin() + (_close_token.size() - offset), ch);
 
             _reset_and_refeed();
         } else if (offset > static_cast<int>(contents_end_offset()) && offset < static_cast<int>(contents_start_offset())) {
             // Edit to contents, no need to reset
-            spdlog::trace("Insert contents");
+            SPDLOG_TRACE("Insert contents");
             _token_contents.insert(_token_contents.begin() + lr_offset - _open_token.size(), ch);
         }
         else {
@@ -437,7 +479,7 @@ void CtTokenMatcher::_update_tokens() {
                         break;
                     }
                 }
-                spdlog::debug("TOKEN MATCHER: FOUND OPEN");
+                SPDLOG_DEBUG("TOKEN MATCHER: FOUND OPEN");
                 _pos_chars.clear();
             } else if (!_found_open) {
                 // Open tag
@@ -455,7 +497,7 @@ void CtTokenMatcher::_update_tokens() {
                 if (*pos_token == open_token->close_tag || (open_token->is_symmetrical && *pos_token == open_token->open_tag)) {
                     _finished = true;
                     _close_token = _token_buff;
-                    spdlog::debug("Finished, open: <{}> contents: <{}> close: <{}> ", _open_token, _token_contents, _close_token);
+                    SPDLOG_DEBUG("Finished, open: <{}> contents: <{}> close: <{}> ", _open_token, _token_contents, _close_token);
                 }
             }
         }
@@ -475,7 +517,7 @@ std::pair<Gtk::TextIter, Gtk::TextIter> CtTextParser::find_formatting_boundaries
 
     Glib::ustring token_str(start_bounds, word_end);
 
-    auto tokens = tokenize(token_str);
+    auto tokens = tokenize(token_str.raw());
     auto& close_tags = close_tokens_map();
 
     // Forward match
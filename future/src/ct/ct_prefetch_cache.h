@@ -0,0 +1,105 @@
+/*
+ * ct_prefetch_cache.h
+ *
+ * Copyright 2009-2020
+ * Giuseppe Penone <giuspen@gmail.com>
+ * Evgenii Gurianov <https://github.com/txe>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA 02110-1301, USA.
+ */
+
+#pragma once
+
+#include <glib.h>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <unordered_set>
+
+/**
+ * @brief The nodes content read ahead by a worker, handed out to the main thread
+ * Once over the budget the least recently read go first. A node is handed out once,
+ * and not read ahead any more after it was asked for. CONTENT has a bytesNum member
+ */
+template<class CONTENT>
+class CtPrefetchCache
+{
+public:
+    explicit CtPrefetchCache(const size_t budgetBytes) : _budgetBytes{budgetBytes} {}
+
+    bool is_wanted(const gint64 node_id)
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        return 0 == _taken.count(node_id) and 0 == _contents.count(node_id);
+    }
+    size_t get_generation()
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        return _generation;
+    }
+    // dropped if the cache was cleared since the reading started
+    void put(const gint64 node_id, std::unique_ptr<CONTENT> pContent, const size_t generation)
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        if (generation != _generation or _taken.count(node_id) or _contents.count(node_id)) return;
+        if (pContent->bytesNum > _budgetBytes) return;
+        while (_bytesNum + pContent->bytesNum > _budgetBytes)
+        {
+            _bytesNum -= _contents.at(_lru.front()).first->bytesNum;
+            _contents.erase(_lru.front());
+            _lru.pop_front();
+        }
+        _bytesNum += pContent->bytesNum;
+        _lru.push_back(node_id);
+        _contents.emplace(node_id, std::make_pair(std::move(pContent), std::prev(_lru.end())));
+    }
+    // nullptr if not read ahead; also to forget a node whose content is about to change
+    std::unique_ptr<CONTENT> take(const gint64 node_id)
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _taken.insert(node_id);
+        auto it = _contents.find(node_id);
+        if (it == _contents.end()) return nullptr;
+        std::unique_ptr<CONTENT> pContent = std::move(it->second.first);
+        _bytesNum -= pContent->bytesNum;
+        _lru.erase(it->second.second);
+        _contents.erase(it);
+        return pContent;
+    }
+    void clear()
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        ++_generation;
+        _contents.clear();
+        _lru.clear();
+        _bytesNum = 0;
+    }
+    size_t get_bytes_num()
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        return _bytesNum;
+    }
+
+private:
+    const size_t               _budgetBytes;
+    std::mutex                 _mutex;
+    size_t                     _generation{0};
+    size_t                     _bytesNum{0};
+    std::list<gint64>          _lru; // the most recently read at the back
+    std::unordered_map<gint64, std::pair<std::unique_ptr<CONTENT>, typename std::list<gint64>::iterator>> _contents;
+    std::unordered_set<gint64> _taken;
+};
@@ -22,6 +22,7 @@
 #include "ct_state_machine.h"
 #include "ct_main_win.h"
 #include "ct_storage_xml.h"
+#include "ct_trace.h"
 
 // ImagePng
 CtAnchoredWidgetState_ImagePng::CtAnchoredWidgetState_ImagePng(CtImagePng* image)
@@ -112,11 +113,7 @@ CtAnchoredWidget* CtAnchoredWidgetState_Codebox::to_widget(CtMainWin* pCtMainWin
 CtAnchoredWidgetState_Table::CtAnchoredWidgetState_Table(CtTable* table)
     :CtAnchoredWidgetState(table->getOffset(), table->getJustification()), colMin(table->get_col_min()), colMax(table->get_col_max())
 {
-    for (auto& row: table->get_table_matrix())
-    {
-        rows.push_back(std::vector<Glib::ustring>());
-        for (auto& cell: row)  rows.back().push_back(cell->get_text_content());
-    }
+    table->write_strings_matrix(rows);
 }
 
 bool CtAnchoredWidgetState_Table::equal(std::shared_ptr<CtAnchoredWidgetState> state)
@@ -128,13 +125,7 @@ bool CtAnchoredWidgetState_Table::equal(std::shared_ptr<CtAnchoredWidgetState> s
 
 CtAnchoredWidget* CtAnchoredWidgetState_Table::to_widget(CtMainWin* pCtMainWin)
 {
-    CtTableMatrix tableMatrix;
-    for (auto& row: rows)
-    {
-        tableMatrix.push_back(CtTableRow());
-        for (auto& cell: row) tableMatrix.back().push_back(new CtTableCell(pCtMainWin, cell, CtConst::TABLE_CELL_TEXT_ID));
-    }
-    return new CtTable(pCtMainWin, tableMatrix, colMin, colMax, charOffset, justification);
+    return CtTable::create(pCtMainWin, rows, colMin, colMax, charOffset, justification);
 }
 
 
@@ -298,12 +289,7 @@ void CtStateMachine::update_state(CtTreeIter tree_iter)
         node_states.states.erase(node_states.states.begin() + node_states.index + 1, node_states.states.end());
     }
 
-    auto new_state = std::shared_ptr<CtNodeState>(new CtNodeState());
-    CtStorageXmlHelper(_pCtMainWin).save_buffer_no_widgets_to_xml(new_state->buffer_xml.get_root_node(), tree_iter.get_node_text_buffer(), 0, -1, 'n');
-    new_state->buffer_xml_string = new_state->buffer_xml.write_to_string();
-    for (auto widget: tree_iter.get_embedded_pixbufs_tables_codeboxes())
-        new_state->widgetStates.push_back(widget->get_state());
-    new_state->cursor_pos = tree_iter.get_node_text_buffer()->property_cursor_position();
+    auto new_state = get_node_snapshot(tree_iter);
 
     if (node_states.states.size() > 0)
     {
@@ -327,6 +313,19 @@ void CtStateMachine::update_state(CtTreeIter tree_iter)
     node_states.indicator = 0; // the current buffer state is saved
 }
 
+// Get the node content as a state, without storing it in the node history
+std::shared_ptr<CtNodeState> CtStateMachine::get_node_snapshot(CtTreeIter tree_iter)
+{
+    CT_TRACE_SCOPE("node snapshot");
+    auto new_state = std::shared_ptr<CtNodeState>(new CtNodeState());
+    CtStorageXmlHelper(_pCtMainWin).save_buffer_no_widgets_to_xml(new_state->buffer_xml.get_root_node(), tree_iter.get_node_text_buffer(), 0, -1, 'n');
+    new_state->buffer_xml_string = new_state->buffer_xml.write_to_string();
+    for (auto widget: tree_iter.get_embedded_pixbufs_tables_codeboxes())
+        new_state->widgetStates.push_back(widget->get_state());
+    new_state->cursor_pos = tree_iter.get_node_text_buffer()->property_cursor_position();
+    return new_state;
+}
+
 // If the buffer is still not modified update cursor pos
 void CtStateMachine::update_curr_state_cursor_pos(gint64 node_id)
 {
@@ -151,6 +151,7 @@ public:
     bool not_undoable_timeslot_get();
     void update_state();
     void update_state(CtTreeIter tree_iter);
+    std::shared_ptr<CtNodeState> get_node_snapshot(CtTreeIter tree_iter);
     void update_curr_state_cursor_pos(gint64 node_id);
 
     void set_go_bk_fw_click(bool val) { _go_bk_fw_click = val; }
@@ -28,6 +28,7 @@
 #include "ct_p7za_iface.h"
 #include "ct_main_win.h"
 #include "ct_logging.h"
+#include "ct_trace.h"
 #include <glib/gstdio.h>
 
 
@@ -71,6 +72,8 @@ std::unique_ptr<CtStorageEntity> get_entity_by_type(CtMainWin* pCtMainWin, CtDoc
         storage = get_entity_by_type(pCtMainWin, fs::get_doc_type(file_path));
 
         // load from file
+        pCtMainWin->get_tree_store().bulk_load_begin();
+        auto on_scope_exit = scope_guard([&](void*) { pCtMainWin->get_tree_store().bulk_load_end(); });
         if (!storage->populate_treestore(extracted_file_path, error)) throw std::runtime_error(error);
 
         // it's ready
@@ -117,13 +120,11 @@ std::unique_ptr<CtStorageEntity> get_entity_by_type(CtMainWin* pCtMainWin, CtDoc
         if (!storage->save_treestore(extracted_file_path, fakePanding, error))
             throw std::runtime_error(error);
 
-        // encrypt the file
+        // encrypt the file, with the storage connection open as for the saves that follow
         if (file_path != extracted_file_path)
         {
-            storage->close_connect(); // temporary, because of sqlite keepig the file
             if (!_package_file(extracted_file_path, file_path, password))
                 throw std::runtime_error("couldn't encrypt the file");
-            storage->reopen_connect();
         }
 
         // it's ready
@@ -147,84 +148,223 @@ std::unique_ptr<CtStorageEntity> get_entity_by_type(CtMainWin* pCtMainWin, CtDoc
     }
 }
 
+CtStorageControl::CtStorageControl()
+{
+    _saveDoneDispatcher.connect(sigc::mem_fun(*this, &CtStorageControl::_on_save_in_background_done));
+}
+
+CtStorageControl::~CtStorageControl()
+{
+    if (_saveThread.joinable())
+    {
+        _saveThread.join();
+        // too late for on_done, the window can be already gone
+        if (!_saveSuccess)
+            spdlog::error("!! save of {} failed, the last changes are lost: {}", _file_path.string(), _saveError);
+    }
+}
+
 bool CtStorageControl::save(bool need_vacuum, Glib::ustring &error)
 {
-    // backup system
-    // before writing make a main backup as file.ext!
-    // then write changes (and encrypt) into the original. If it's OK, then put the main backup to backup rotate
-    // if it's not, copy file.ext! back;
-
-    fs::path main_backup = _file_path;
-    main_backup += "!";
-    bool need_backup = _need_backup && _pCtMainWin->get_ct_config()->backupCopy and _pCtMainWin->get_ct_config()->backupNum > 0;
+    CT_TRACE_SCOPE("save");
+    wait_save_in_background();
     try
     {
-        if (_file_path == "")
-            throw std::runtime_error("storage is not initialized");
+        _snapshot_save(need_vacuum)();
+
+        _savingPending = CtStorageSyncPending{};
+        _need_backup = false;
+        return true;
+    }
+    catch (std::exception& e)
+    {
+        _restore_saving_pending();
+        spdlog::error(e.what());
+        error = e.what();
+        return false;
+    }
+}
+
+void CtStorageControl::save_in_background(bool need_vacuum, std::function<void(bool, const Glib::ustring&)> on_done)
+{
+    CT_TRACE_SCOPE("save snapshot");
+    if (_saveThread.joinable())
+    {
+        SPDLOG_DEBUG("the previous save is still running");
+        return;
+    }
+    std::function<void()> save_job;
+    try
+    {
+        save_job = _snapshot_save(need_vacuum);
+    }
+    catch (std::exception& e)
+    {
+        _restore_saving_pending();
+        spdlog::error(e.what());
+        on_done(false, e.what());
+        return;
+    }
+
+    _saveOnDone = std::move(on_done);
+    _saveFinished = false;
+    _saveThread = std::thread([this, save_job]() {
+        CT_TRACE_SCOPE("save in background");
+        try
+        {
+            save_job();
+            _saveSuccess = true;
+        }
+        catch (std::exception& e)
+        {
+            _saveSuccess = false;
+            _saveError = e.what();
+        }
+        _saveFinished = true;
+        _saveDoneDispatcher.emit();
+    });
+}
+
+bool CtStorageControl::wait_save_in_background()
+{
+    if (_saveThread.joinable())
+    {
+        _saveThread.join();
+        const bool success = _saveSuccess;
+        _finish_save_in_background();
+        return success;
+    }
+    return true;
+}
+
+void CtStorageControl::_on_save_in_background_done()
+{
+    // the thread could be already collected by wait_save_in_background, or be a newer one still running
+    if (_saveThread.joinable() && _saveFinished)
+    {
+        _saveThread.join();
+        _finish_save_in_background();
+    }
+}
 
-        // sqlite could lost connection
-        _storage->test_connection();
+void CtStorageControl::_finish_save_in_background()
+{
+    if (_saveSuccess)
+    {
+        _savingPending = CtStorageSyncPending{};
+        _need_backup = false;
+    }
+    else
+    {
+        _restore_saving_pending();
+        spdlog::error(_saveError);
+    }
+    auto on_done = std::move(_saveOnDone);
+    _saveOnDone = nullptr;
+    if (on_done)
+        on_done(_saveSuccess, _saveError);
+    _saveError.clear();
+}
 
-        if (need_backup)
+std::function<void()> CtStorageControl::_snapshot_save(bool need_vacuum)
+{
+    if (_file_path == "")
+        throw std::runtime_error("storage is not initialized");
+
+    // sqlite could lost connection
+    _storage->test_connection();
+
+    // the changes from now on are for the next save
+    _savingPending = std::move(_syncPending);
+    _syncPending = CtStorageSyncPending{};
+    std::function<void()> write_job = _storage->snapshot_treestore(_extracted_file_path, _savingPending, need_vacuum);
+
+    // from here on nothing is shared with the tree, it can run on another thread
+    const bool need_backup = _need_backup && _pCtMainWin->get_ct_config()->backupCopy and _pCtMainWin->get_ct_config()->backupNum > 0;
+    const int backup_num = _pCtMainWin->get_ct_config()->backupNum;
+    return [write_job, need_backup, backup_num, file_path = _file_path, extracted_file_path = _extracted_file_path, password = _password]() {
+        // backup system
+        // before writing make a main backup as file.ext!
+        // then write changes (and encrypt) into the original. If it's OK, then put the main backup to backup rotate
+        // if it's not, copy file.ext! back;
+        fs::path main_backup = file_path;
+        main_backup += "!";
+        try
         {
-            // move is faster but the file is used by sqlite without encrypt
-            if (_file_path == _extracted_file_path && fs::get_doc_type(_file_path) == CtDocType::SQLite)
+            if (need_backup)
             {
-                _storage->close_connect();    // temporary, because of sqlite keepig the file
-                if (!fs::copy_file(_file_path, main_backup))
-                    throw std::runtime_error(str::format(_("You Have No Write Access to %s"), _file_path.parent_path().string()));
-                _storage->reopen_connect();
+                // move is faster but the file is used by sqlite without encrypt:
+                // a reflink costs nothing where the filesystem has them, else the sqlite online backup
+                if (file_path == extracted_file_path && fs::get_doc_type(file_path) == CtDocType::SQLite)
+                {
+                    if (!fs::clone_file(file_path, main_backup))
+                        CtStorageSqlite::backup_db_file(file_path, main_backup);
+                }
+                else
+                {
+                    if (!fs::move_file(file_path, main_backup))
+                        throw std::runtime_error(str::format(_("You Have No Write Access to %s"), file_path.parent_path().string()));
+                }
             }
-            else
+            // save changes
+            write_job();
+
+            // encrypt the file; the storage connection stays open: it only reads, with no transaction
+            // left open, and the sqlite writes were committed to the file by the connection of write_job
+            // (rollback journal, nothing left aside in a -wal), so the file packaged is the one saved
+            if (file_path != extracted_file_path)
             {
-                if (!fs::move_file(_file_path, main_backup))
-                    throw std::runtime_error(str::format(_("You Have No Write Access to %s"), _file_path.parent_path().string()));
+                if (!_package_file(extracted_file_path, file_path, password))
+                    throw std::runtime_error("couldn't encrypt the file");
             }
+            if (need_backup)
+                _put_in_backup(file_path, main_backup, backup_num);
         }
-        // save changes
-        if (!_storage->save_treestore(_extracted_file_path, _syncPending, error))
-            throw std::runtime_error(error);
-        if (need_vacuum)
-            _storage->vacuum();
-
-        // encrypt the file
-        if (_file_path != _extracted_file_path)
+        catch (std::exception&)
         {
-            _storage->close_connect(); // temporary, because of sqlite keepig the file
-            if (!_package_file(_extracted_file_path, _file_path, _password))
-                throw std::runtime_error("couldn't encrypt the file");
-            _storage->reopen_connect();
+            // recover from backup; sqlite rolled back the changes on the file in use, so its copy is just dropped
+            try {
+                if (need_backup && fs::is_regular_file(main_backup)) {
+                    if (file_path == extracted_file_path && fs::get_doc_type(file_path) == CtDocType::SQLite) fs::remove(main_backup);
+                    else fs::move_file(main_backup, file_path);
+                }
+            }
+            catch (std::exception& e2) { spdlog::error(e2.what()); }
+            throw;
         }
-        if (need_backup)
-            _put_in_backup(main_backup);
-
-        _syncPending.bookmarks_to_write = false;
-        _syncPending.nodes_to_rm_set.clear();
-        _syncPending.nodes_to_write_dict.clear();
-        _need_backup = false;
+    };
+}
 
-        return true;
-    }
-    catch (std::exception& e)
+void CtStorageControl::_restore_saving_pending()
+{
+    // the failed changes are merged with the ones done in the meanwhile
+    if (_savingPending.bookmarks_to_write)
+        _syncPending.bookmarks_to_write = true;
+    for (const auto& node_pair : _savingPending.nodes_to_write_dict)
     {
-        // recover from backup
-        try {
-            _storage->close_connect();
-            if (need_backup && fs::is_regular_file(main_backup)) fs::move_file(main_backup, _file_path);
-            _storage->reopen_connect();
+        if (0 != _syncPending.nodes_to_rm_set.count(node_pair.first))
+            continue; // removed in the meanwhile
+        auto it = _syncPending.nodes_to_write_dict.find(node_pair.first);
+        if (it == _syncPending.nodes_to_write_dict.end())
+        {
+            _syncPending.nodes_to_write_dict[node_pair.first] = node_pair.second;
+            continue;
         }
-        catch (std::exception& e2) { spdlog::error(e2.what()); }
-
-        spdlog::error(e.what());
-        error = e.what();
-        return false;
+        // a new node is still not in the file
+        it->second.upd = it->second.upd && node_pair.second.upd;
+        it->second.prop = it->second.prop || node_pair.second.prop;
+        it->second.buff = it->second.buff || node_pair.second.buff;
+        it->second.hier = it->second.hier || node_pair.second.hier;
     }
+    _syncPending.nodes_to_rm_set.insert(_savingPending.nodes_to_rm_set.begin(), _savingPending.nodes_to_rm_set.end());
+    _savingPending = CtStorageSyncPending{};
 }
 
 Glib::RefPtr<Gsv::Buffer> CtStorageControl::get_delayed_text_buffer(const gint64& node_id,
                                                                     const std::string& syntax,
                                                                     std::list<CtAnchoredWidget*>& widgets) const
 {
+    CT_TRACE_SCOPE("node load");
     if (!_storage) {
         spdlog::error("!! storage is not initialized");
         return Glib::RefPtr<Gsv::Buffer>();
@@ -232,6 +372,22 @@ Glib::RefPtr<Gsv::Buffer> CtStorageControl::get_delayed_text_buffer(const gint64
     return _storage->get_delayed_text_buffer(node_id, syntax, widgets);
 }
 
+void CtStorageControl::prefetch_delayed_text_buffers(const std::vector<gint64>& node_ids)
+{
+    if (_storage) {
+        _storage->prefetch_delayed_text_buffers(node_ids);
+    }
+}
+
+size_t CtStorageControl::get_node_summary(const gint64& node_id, Glib::ustring& text, CtSummaryInfo& summaryInfo) const
+{
+    if (!_storage) {
+        spdlog::error("!! storage is not initialized");
+        return 0;
+    }
+    return _storage->get_node_summary(node_id, text, summaryInfo);
+}
+
 /*static*/ fs::path CtStorageControl::_extract_file(CtMainWin* pCtMainWin, const fs::path& file_path, Glib::ustring& password)
 {
     fs::path temp_dir = pCtMainWin->get_ct_tmp()->getHiddenDirPath(file_path);
@@ -260,21 +416,21 @@ Glib::RefPtr<Gsv::Buffer> CtStorageControl::get_delayed_text_buffer(const gint64
             && fs::is_regular_file(file_to);
 }
 
-void CtStorageControl::_put_in_backup(const fs::path& main_backup)
+/*static*/ void CtStorageControl::_put_in_backup(const fs::path& file_path, const fs::path& main_backup, const int backup_num)
 {
-    fs::path tilda_filepath = _file_path;
-    tilda_filepath += std::string(_pCtMainWin->get_ct_config()->backupNum - 1, '~');
+    fs::path tilda_filepath = file_path;
+    tilda_filepath += std::string(backup_num - 1, '~');
     while (str::endswith(tilda_filepath.string(), CtConst::CHAR_TILDE))
     {
         if (fs::is_regular_file(tilda_filepath)) {
             if (!fs::move_file(tilda_filepath, tilda_filepath.string() + CtConst::CHAR_TILDE))
                 throw std::runtime_error(
-                        str::format(_("You Have No Write Access to %s"), _file_path.parent_path().string()));
+                        str::format(_("You Have No Write Access to %s"), file_path.parent_path().string()));
         }
         tilda_filepath = tilda_filepath.string().substr(0, tilda_filepath.string().size()-1);
     }
-    if (!fs::move_file(main_backup, _file_path.string() + CtConst::CHAR_TILDE))
-        throw std::runtime_error(str::format(_("You Have No Write Access to %s"), _file_path.parent_path().string()));
+    if (!fs::move_file(main_backup, file_path.string() + CtConst::CHAR_TILDE))
+        throw std::runtime_error(str::format(_("You Have No Write Access to %s"), file_path.parent_path().string()));
 }
 
 void CtStorageControl::pending_edit_db_node_prop(gint64 node_id)
@@ -367,9 +523,15 @@ void CtStorageControl::add_nodes_from_storage(const fs::path& path)
     }
 
     std::unique_ptr<CtStorageEntity> storage = get_entity_by_type(_pCtMainWin, fs::get_doc_type(extracted_file_path));
+    Gtk::TreeIter last_top_iter = _pCtMainWin->get_tree_store().get_tree_iter_last_sibling(_pCtMainWin->get_tree_store().get_store()->children());
+    _pCtMainWin->get_tree_store().bulk_load_begin();
+    auto on_scope_exit = scope_guard([&](void*) { _pCtMainWin->get_tree_store().bulk_load_end(); });
     storage->import_nodes(extracted_file_path);
 
-    _pCtMainWin->get_tree_store().nodes_sequences_fix(Gtk::TreeIter(), false);
+    // the imported top nodes are numbered after the existing ones
+    Gtk::TreeIter first_new_iter = last_top_iter ? ++last_top_iter : _pCtMainWin->get_tree_store().get_iter_first();
+    if (first_new_iter)
+        _pCtMainWin->get_tree_store().node_sequence_fix(first_new_iter);
     _pCtMainWin->update_window_save_needed();
 }
 
@@ -411,10 +573,9 @@ void CtStorageCache::generate_cache(CtMainWin* pCtMainWin, const CtStorageSyncPe
 
 void CtStorageCache::parallel_fetch_pixbufers(const std::vector<CtImagePng*>& image_widgets, bool xml)
 {
+    CT_TRACE_SCOPE("save images encode");
     _cached_images.clear();
 
-    // auto start = std::chrono::steady_clock::now();
-
     std::vector<std::pair<CtImagePng*, std::string>> image_pair(image_widgets.size());
     for (size_t i = 0; i < image_widgets.size(); ++i)
         image_pair[i].first = image_widgets[i];
@@ -428,10 +589,7 @@ void CtStorageCache::parallel_fetch_pixbufers(const std::vector<CtImagePng*>& im
 
     for (auto& pair: image_pair)
         _cached_images.emplace(pair);
-
-    //auto end = std::chrono::steady_clock::now();
-    //std::chrono::duration<double> elapsed_seconds = end-start;
-    //spdlog::debug("parallel_fetch_pixbufers amount: , {} sec.", elapsed_seconds.count());
+    CT_TRACE_COUNT("save images", image_pair.size());
 }
 
 bool CtStorageCache::get_cached_image(CtImagePng* image, std::string& cached_image)
@@ -25,6 +25,9 @@
 
 #include "ct_types.h"
 #include <glibmm/miscutils.h>
+#include <glibmm/dispatcher.h>
+#include <atomic>
+#include <thread>
 
 class CtMainWin;
 class CtStorageControl
@@ -41,26 +44,48 @@ public:
                                      Glib::ustring& error);
 
 public:
+    ~CtStorageControl();
+
     bool save(bool need_vacuum, Glib::ustring& error);
+    // only the snapshot of the changes is taken here, the writing, backup and encryption go on in a thread
+    // and on_done is called back on the main loop; nothing is done if the previous one is still running
+    void save_in_background(bool need_vacuum, std::function<void(bool success, const Glib::ustring& error)> on_done);
+    bool is_saving_in_background() const { return _saveThread.joinable(); }
+    // false if the save waited for failed, its on_done has already run
+    bool wait_save_in_background();
 
  private:
-    CtStorageControl() = default;
+    CtStorageControl();
 
     static fs::path _extract_file(CtMainWin* pCtMainWin, const fs::path& file_path, Glib::ustring& password);
     static bool     _package_file(const fs::path& file_from, const fs::path& file_to, const Glib::ustring& password);
+    static void     _put_in_backup(const fs::path& file_path, const fs::path& main_backup, const int backup_num);
 
-    void _put_in_backup(const fs::path& main_backup);
+    std::function<void()> _snapshot_save(bool need_vacuum);
+    void _restore_saving_pending();
+    void _on_save_in_background_done();
+    void _finish_save_in_background();
 
 public:
     Glib::RefPtr<Gsv::Buffer> get_delayed_text_buffer(const gint64& node_id,
                                                       const std::string& syntax,
                                                       std::list<CtAnchoredWidget*>& widgets) const;
+    // reads ahead in the background the nodes likely to be selected next, the most likely first
+    void prefetch_delayed_text_buffers(const std::vector<gint64>& node_ids);
+    // the text and the widgets of a node not loaded, for the tree summary
+    size_t get_node_summary(const gint64& node_id, Glib::ustring& text, CtSummaryInfo& summaryInfo) const;
 
     const fs::path& get_file_path() { return _file_path; }
     fs::path get_file_name() { return _file_path.empty() ? "" : _file_path.filename(); }
     fs::path get_file_dir()  { return _file_path.empty() ? "" : _file_path.parent_path(); }
 
-    std::set<gint64> get_nodes_pending_rm() { return _syncPending.nodes_to_rm_set; }
+    std::set<gint64> get_nodes_pending_rm()
+    {
+        // also the ones of a save still running
+        std::set<gint64> nodes_pending_rm = _syncPending.nodes_to_rm_set;
+        nodes_pending_rm.insert(_savingPending.nodes_to_rm_set.begin(), _savingPending.nodes_to_rm_set.end());
+        return nodes_pending_rm;
+    }
 
     void pending_edit_db_node_prop(gint64 node_id);
     void pending_edit_db_node_buff(gint64 node_id);
@@ -85,6 +110,14 @@ private:
     bool                             _need_backup{true};   // create a backup once, on the first saving
     std::unique_ptr<CtStorageEntity> _storage;
     CtStorageSyncPending             _syncPending;
+    CtStorageSyncPending             _savingPending;       // taken by the save running, given back if it fails
+
+    std::thread                      _saveThread;
+    Glib::Dispatcher                 _saveDoneDispatcher;
+    std::atomic<bool>                _saveFinished{false};
+    bool                             _saveSuccess{false};
+    Glib::ustring                    _saveError;
+    std::function<void(bool, const Glib::ustring&)> _saveOnDone;
 };
 
 class CtImagePng;
@@ -0,0 +1,115 @@
+/*
+ * ct_storage_convert.cc
+ *
+ * Copyright 2009-2020
+ * Giuseppe Penone <giuspen@gmail.com>
+ * Evgenii Gurianov <https://github.com/txe>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA 02110-1301, USA.
+ */
+
+#include "ct_storage_convert.h"
+#include "ct_storage_sqlite.h"
+#include "ct_storage_xml.h"
+#include "ct_p7za_iface.h"
+#include "ct_widgets.h"
+#include "ct_misc_utils.h"
+#include "ct_const.h"
+#include "ct_logging.h"
+#include "ct_trace.h"
+#include <glibmm/i18n.h>
+#include <mutex>
+
+// the p7za code is not reentrant
+static std::mutex p7zaMutex;
+
+bool CtConvertNode::is_rich_text() const
+{
+    return nodeData.syntax == CtConst::RICH_TEXT_ID;
+}
+
+/*static*/ bool CtStorageConvert::convert(const fs::path& file_from,
+                                          const Glib::ustring& password_from,
+                                          const fs::path& file_to,
+                                          const Glib::ustring& password_to,
+                                          Glib::ustring& error)
+{
+    CT_TRACE_SCOPE("convert");
+    // own temporary dirs, removed at the end of the conversion
+    CtTmp ctTmp;
+    const fs::path extracted_file_to = fs::get_doc_encrypt(file_to) == CtDocEncrypt::True ? ctTmp.getHiddenFilePath(file_to) : file_to;
+    bool written_to{false};
+    try
+    {
+        if (not fs::is_regular_file(file_from)) throw std::runtime_error(str::format(_("%s is not a file"), file_from.string()));
+        if (fs::get_doc_type(file_from) == CtDocType::None) throw std::runtime_error(str::format(_("%s is not a CherryTree document"), file_from.string()));
+        if (fs::get_doc_type(file_to) == CtDocType::None) throw std::runtime_error(str::format(_("%s is not a CherryTree document"), file_to.string()));
+        // the destination is removed before reading the source
+        if (fs::equivalent(file_from, file_to)) throw std::runtime_error(str::format(_("%s is both source and destination"), file_from.string()));
+
+        fs::path extracted_file_from = file_from;
+        if (fs::get_doc_encrypt(file_from) == CtDocEncrypt::True) {
+            extracted_file_from = ctTmp.getHiddenFilePath(file_from);
+            std::lock_guard<std::mutex> lock(p7zaMutex);
+            if (0 != CtP7zaIface::p7za_extract(file_from.c_str(), ctTmp.getHiddenDirPath(file_from).c_str(), password_from.c_str()) or
+                not fs::is_regular_file(extracted_file_from))
+            {
+                throw std::runtime_error(str::format(_("Couldn't extract %s, wrong password?"), file_from.string()));
+            }
+        }
+        // from here on the destination is ours to remove on failure
+        written_to = true;
+        if (fs::is_regular_file(extracted_file_to)) {
+            fs::remove(extracted_file_to);
+        }
+
+        std::unique_ptr<CtConvertReader> pReader = fs::get_doc_type(file_from) == CtDocType::SQLite ?
+            CtStorageSqlite::get_convert_reader(extracted_file_from) : CtStorageXml::get_convert_reader(extracted_file_from);
+        std::unique_ptr<CtConvertWriter> pWriter = fs::get_doc_type(file_to) == CtDocType::SQLite ?
+            CtStorageSqlite::get_convert_writer(extracted_file_to) : CtStorageXml::get_convert_writer(extracted_file_to);
+
+        pWriter->write_bookmarks(pReader->read_bookmarks());
+        size_t nodes_num{0};
+        pReader->read_nodes([&](CtConvertNode& node) {
+            pWriter->write_node(node);
+            ++nodes_num;
+        });
+        pWriter->finish();
+        // sqlite keeps the file until closed
+        pWriter.reset();
+        pReader.reset();
+
+        if (extracted_file_to != file_to) {
+            if (fs::is_regular_file(file_to)) {
+                fs::remove(file_to);
+            }
+            std::lock_guard<std::mutex> lock(p7zaMutex);
+            if (0 != CtP7zaIface::p7za_archive(extracted_file_to.c_str(), file_to.c_str(), password_to.c_str()) or
+                not fs::is_regular_file(file_to))
+            {
+                throw std::runtime_error("couldn't encrypt the file");
+            }
+        }
+        spdlog::info("converted {} to {}, {} nodes", file_from, file_to, nodes_num);
+        return true;
+    }
+    catch (std::exception& e)
+    {
+        if (written_to and fs::is_regular_file(extracted_file_to)) fs::remove(extracted_file_to);
+        error = e.what();
+        return false;
+    }
+}
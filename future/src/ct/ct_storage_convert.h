@@ -0,0 +1,104 @@
+/*
+ * ct_storage_convert.h
+ *
+ * Copyright 2009-2020
+ * Giuseppe Penone <giuspen@gmail.com>
+ * Evgenii Gurianov <https://github.com/txe>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA 02110-1301, USA.
+ */
+
+#pragma once
+
+#include "ct_filesystem.h"
+#include "ct_treestore.h"
+#include <glibmm/ustring.h>
+#include <functional>
+#include <list>
+#include <vector>
+
+// an anchored widget as stored, shared by the sqlite rows and the xml elements
+struct CtConvertWidget
+{
+    enum class Type { Image, Table, Codebox };
+
+    Type        type{Type::Image};
+    gint64      offset{0};
+    std::string justification;
+    std::string text; // table: the rows xml as in the sqlite grid table, codebox: the code
+    // image
+    std::string anchor;
+    std::string rawBlob;
+    std::string filename;
+    std::string link;
+    double      time{0};
+    // table
+    gint64      colMin{0};
+    gint64      colMax{0};
+    // codebox
+    std::string syntax;
+    gint64      frameWidth{0};
+    gint64      frameHeight{0};
+    bool        widthInPixels{false};
+    bool        highlightBrackets{false};
+    bool        showLineNumbers{false};
+};
+
+// a node as stored, the properties in nodeData (no text buffer nor anchored widgets there)
+struct CtConvertNode
+{
+    CtNodeData  nodeData;
+    gint64      fatherId{0}; // 0 = top level
+    std::string text; // rich text: the rich_text slots xml as in the sqlite node table, otherwise the plain text
+    std::vector<CtConvertWidget> widgets; // sorted by offset
+
+    bool is_rich_text() const;
+};
+
+// implemented by each storage, the readers pass every node to on_node, a parent always before its children
+class CtConvertReader
+{
+public:
+    virtual ~CtConvertReader() = default;
+    virtual std::list<gint64> read_bookmarks() = 0;
+    virtual void read_nodes(const std::function<void(CtConvertNode&)>& on_node) = 0;
+};
+
+class CtConvertWriter
+{
+public:
+    virtual ~CtConvertWriter() = default;
+    virtual void write_bookmarks(const std::list<gint64>& bookmarks) = 0;
+    virtual void write_node(const CtConvertNode& node) = 0;
+    virtual void finish() = 0;
+};
+
+/**
+ * @brief Conversion between the document types .ctb/.ctd/.ctz/.ctx without a window:
+ * the nodes are streamed from the reader of the source storage straight into the writer
+ * of the destination one, never creating text buffers or anchored widgets
+ * (the rich text is already stored as the same xml in both backends)
+ */
+class CtStorageConvert
+{
+public:
+    // password_from/password_to are used only by .ctz/.ctx; thread safe, for batches in parallel
+    static bool convert(const fs::path& file_from,
+                        const Glib::ustring& password_from,
+                        const fs::path& file_to,
+                        const Glib::ustring& password_to,
+                        Glib::ustring& error);
+};
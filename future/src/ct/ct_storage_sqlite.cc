@@ -23,10 +23,14 @@
 
 #include "ct_storage_sqlite.h"
 #include "ct_storage_xml.h"
+#include "ct_storage_convert.h"
 #include "ct_storage_control.h"
 #include "ct_main_win.h"
 #include <unistd.h>
 #include "ct_logging.h"
+#include "ct_trace.h"
+#include <algorithm>
+#include <atomic>
 
 
 const char CtStorageSqlite::TABLE_NODE_CREATE[]{"CREATE TABLE node ("
@@ -123,6 +127,82 @@ struct sqlite3_stmt_auto
     sqlite3_stmt *p_stmt{nullptr};
 };
 
+// a named in-memory database, while it is open the other connections of the process can attach it
+struct CtSqliteStaging
+{
+    CtSqliteStaging()
+    {
+        static std::atomic<int> next_id{0};
+        uri = "file:ct_staging_" + std::to_string(next_id++) + "?mode=memory&cache=shared";
+        if (sqlite3_open_v2(uri.c_str(), &pDb, SQLITE_OPEN_READWRITE | SQLITE_OPEN_CREATE | SQLITE_OPEN_URI, nullptr) != SQLITE_OK)
+        {
+            const std::string error = sqlite3_errmsg(pDb);
+            sqlite3_close(pDb);
+            throw std::runtime_error(std::string("sqlite3_open: ") + error);
+        }
+    }
+    ~CtSqliteStaging() { sqlite3_close(pDb); }
+
+    std::string uri;
+    sqlite3*    pDb{nullptr};
+};
+
+// the node properties read by _node_props_from_stmt, the first columns of the select
+const char NODE_PROPS_COLUMNS[]{"name, syntax, tags, is_ro, is_richtxt, ts_creation, ts_lastsave"};
+
+// the connection of the storage and the one writing in the background wait for each other
+constexpr int BUSY_TIMEOUT_MS{10000};
+// 4 MB with the default page size
+constexpr int BACKUP_PAGES_PER_STEP{1024};
+constexpr int BACKUP_BUSY_SLEEP_MS{10};
+// memory for the nodes read ahead and not yet selected
+constexpr size_t PREFETCH_BUDGET_BYTES{64 * 1024 * 1024};
+constexpr int PREFETCH_BUSY_TIMEOUT_MS{100};
+
+// the content of a node as read from the db, with what can be parsed off the main thread
+// already parsed, so that only the text buffer and the widgets are left to create
+struct CtSqliteNodeContent
+{
+    struct Codebox
+    {
+        int           charOffset;
+        Glib::ustring justification;
+        Glib::ustring textContent;
+        Glib::ustring syntaxHighlighting;
+        int           frameWidth;
+        int           frameHeight;
+        bool          widthInPixels;
+        bool          highlightBrackets;
+        bool          showLineNumbers;
+    };
+    struct Table
+    {
+        int           charOffset;
+        Glib::ustring justification;
+        CtTableTexts  tableTexts;
+        int           colMin;
+        int           colMax;
+    };
+    struct Image
+    {
+        int                       charOffset;
+        Glib::ustring             justification;
+        Glib::ustring             anchorName; // set for an anchor
+        fs::path                  fileName;   // set for an embedded file, with rawBlob and timeDouble
+        std::string               rawBlob;
+        double                    timeDouble{0};
+        Glib::RefPtr<Gdk::Pixbuf> rPixbuf;    // else the png, already decoded
+        Glib::ustring             link;
+    };
+
+    std::string                       txt;
+    bool                              isRichText{false}; // as in the db
+    std::unique_ptr<xmlpp::DomParser> pRichTextParser;   // if rich text
+    std::vector<Codebox>              codeboxes;
+    std::vector<Table>                tables;
+    std::vector<Image>                images;
+    size_t                            bytesNum{0}; // roughly, for the prefetch budget
+};
 
 std::optional<std::vector<std::string>> get_quick_check_issues(sqlite3* db) {
     if (!db) throw std::logic_error("get_quick_check_issues passed invalid database object");
@@ -158,7 +238,9 @@ bool CtStorageSqlite::_check_database_integrity() {
     return false;
 }
 
-CtStorageSqlite::CtStorageSqlite(CtMainWin* pCtMainWin) : _pCtMainWin(pCtMainWin)
+CtStorageSqlite::CtStorageSqlite(CtMainWin* pCtMainWin)
+ : _pCtMainWin(pCtMainWin),
+   _pPrefetchCache(std::make_shared<CtSqlitePrefetchCache>(PREFETCH_BUDGET_BYTES))
 {
 
 }
@@ -185,8 +267,8 @@ void CtStorageSqlite::test_connection()
     auto test_readwrite = [&]() {
         try
         {
-            _exec_no_callback("CREATE TABLE IF NOT EXISTS test_table (id)");
-            _exec_no_callback("DROP TABLE IF EXISTS test_table");
+            _exec_no_callback(_pDb, "CREATE TABLE IF NOT EXISTS test_table (id)");
+            _exec_no_callback(_pDb, "DROP TABLE IF EXISTS test_table");
             return true;
         } catch (std::exception&) { return false; }
         return true;
@@ -220,7 +302,7 @@ bool CtStorageSqlite::populate_treestore(const fs::path& file_path, Glib::ustrin
         // open db
         _open_db(file_path);
         _file_path = file_path;
-        _fix_db_tables();
+        _fix_db_tables(_pDb);
 
         if (!_check_database_integrity()) return false;
 
@@ -233,16 +315,24 @@ bool CtStorageSqlite::populate_treestore(const fs::path& file_path, Glib::ustrin
                _pCtMainWin->get_tree_store().bookmarks_add(sqlite3_column_int64(stmt, 0));
 
         // load node tree
+        // the sequences are kept as in the db, where they can have gaps, since the later saves only
+        // write the sequences of the moved nodes; a repeated sequence is moved after the previous one
         std::function<void(guint node_id, const gint64, Gtk::TreeIter)> nodes_from_db;
         nodes_from_db = [&](guint node_id, const gint64 sequence, Gtk::TreeIter parent_iter) {
             Gtk::TreeIter new_iter = _node_from_db(node_id, sequence, parent_iter, -1);
             gint64 child_sequence = 0;
-            for (gint64 child_node_id : _get_children_node_ids_from_db(node_id))
-                nodes_from_db(child_node_id, ++child_sequence, new_iter);
+            for (const auto& [child_node_id, db_sequence] : _get_children_sequences_from_db(_pDb, node_id))
+            {
+                child_sequence = std::max(db_sequence, child_sequence + 1);
+                nodes_from_db(child_node_id, child_sequence, new_iter);
+            }
         };
         gint64 sequence = 0;
-        for (gint64 &top_node_id: _get_children_node_ids_from_db(0))
-            nodes_from_db(top_node_id, ++sequence, Gtk::TreeIter());
+        for (const auto& [top_node_id, db_sequence] : _get_children_sequences_from_db(_pDb, 0))
+        {
+            sequence = std::max(db_sequence, sequence + 1);
+            nodes_from_db(top_node_id, sequence, Gtk::TreeIter());
+        }
 
         // keep db open for lazy node buffer loading
         return true;
@@ -259,69 +349,7 @@ bool CtStorageSqlite::save_treestore(const fs::path& file_path, const CtStorageS
 {
     try
     {
-        // it's the first time, a new file will be created
-        if (_pDb == nullptr)
-        {
-            _open_db(file_path);
-            _file_path = file_path;
-
-            _create_all_tables_in_db();
-            _write_bookmarks_to_db(_pCtMainWin->get_tree_store().bookmarks_get());
-
-            CtStorageNodeState node_state;
-            node_state.upd = false; // no need to delete the prev data
-            node_state.prop = true;
-            node_state.buff = true;
-            node_state.hier = true;
-
-            CtStorageCache storage_cache;
-            storage_cache.generate_cache(_pCtMainWin, nullptr /* all nodes */, false);
-
-            // function to iterate through the tree
-            std::function<void(CtTreeIter, const gint64, const gint64)> save_node_fun;
-            save_node_fun = [&](CtTreeIter ct_tree_iter, const gint64 sequence, const gint64 father_id) {
-                _write_node_to_db(&ct_tree_iter, sequence, father_id, node_state, 0, -1, &storage_cache);
-                gint64 child_sequence{0};
-                CtTreeIter ct_tree_iter_child = ct_tree_iter.first_child();
-                while (ct_tree_iter_child) {
-                    ++child_sequence;
-                    save_node_fun(ct_tree_iter_child, child_sequence, ct_tree_iter.get_node_id());
-                    ++ct_tree_iter_child;
-                }
-            };
-
-            // saving nodes
-            gint64 sequence{0};
-            CtTreeIter ct_tree_iter = _pCtMainWin->get_tree_store().get_ct_iter_first();
-            while (ct_tree_iter) {
-                ++sequence;
-                save_node_fun(ct_tree_iter, sequence, 0);
-                ++ct_tree_iter;
-            }
-
-        }
-        // or need just update some info
-        else
-        {
-            CtStorageCache storage_cache;
-            storage_cache.generate_cache(_pCtMainWin, &syncPending, false);
-
-            // update bookmarks
-            if (syncPending.bookmarks_to_write)
-                _write_bookmarks_to_db(_pCtMainWin->get_tree_store().bookmarks_get());
-            // update changed nodes
-            for (const auto& node_pair : syncPending.nodes_to_write_dict)
-            {
-                CtTreeIter ct_tree_iter = _pCtMainWin->get_tree_store().get_node_from_node_id(node_pair.first);
-                CtTreeIter ct_tree_iter_parent = ct_tree_iter.parent();
-                _write_node_to_db(&ct_tree_iter, ct_tree_iter.get_node_sequence(),
-                                  ct_tree_iter_parent ? ct_tree_iter_parent.get_node_id() : 0, node_pair.second, 0, -1, &storage_cache);
-            }
-            // remove nodes and their sub nodes
-            for (const auto node_id : syncPending.nodes_to_rm_set)
-                _remove_db_node_with_children(node_id);
-        }
-
+        snapshot_treestore(file_path, syncPending, false/*need_vacuum*/)();
         return true;
     }
     catch (std::exception& e)
@@ -331,11 +359,89 @@ bool CtStorageSqlite::save_treestore(const fs::path& file_path, const CtStorageS
     }
 }
 
+std::function<void()> CtStorageSqlite::snapshot_treestore(const fs::path& file_path, const CtStorageSyncPending& syncPending, const bool need_vacuum)
+{
+    // the changes are written first into an in-memory database with the same tables,
+    // the connection writing the document attaches it and copies them over in one transaction
+    auto pStaging = std::make_shared<CtSqliteStaging>();
+    _create_all_tables_in_db(pStaging->pDb);
+    CtStorageSyncPending stagedPending;
+
+    // it's the first time, a new file will be created
+    if (_pDb == nullptr)
+    {
+        _open_db(file_path);
+        _file_path = file_path;
+        _create_all_tables_in_db(_pDb);
+
+        CtStorageNodeState node_state;
+        node_state.upd = false; // no need to delete the prev data
+        node_state.prop = true;
+        node_state.buff = true;
+        node_state.hier = true;
+
+        stagedPending.bookmarks_to_write = true;
+        _write_bookmarks_to_db(pStaging->pDb, _pCtMainWin->get_tree_store().bookmarks_get());
+
+        CtStorageCache storage_cache;
+        storage_cache.generate_cache(_pCtMainWin, nullptr /* all nodes */, false);
+
+        // function to iterate through the tree; the sequences in the tree are written as they are,
+        // the later saves in place only write the sequences of the nodes that changed
+        std::function<void(CtTreeIter, const gint64)> save_node_fun;
+        save_node_fun = [&](CtTreeIter ct_tree_iter, const gint64 father_id) {
+            _write_node_to_db(pStaging->pDb, &ct_tree_iter, ct_tree_iter.get_node_sequence(), father_id, node_state, &storage_cache);
+            stagedPending.nodes_to_write_dict[ct_tree_iter.get_node_id()] = node_state;
+            CtTreeIter ct_tree_iter_child = ct_tree_iter.first_child();
+            while (ct_tree_iter_child) {
+                save_node_fun(ct_tree_iter_child, ct_tree_iter.get_node_id());
+                ++ct_tree_iter_child;
+            }
+        };
+
+        // saving nodes
+        CtTreeIter ct_tree_iter = _pCtMainWin->get_tree_store().get_ct_iter_first();
+        while (ct_tree_iter) {
+            save_node_fun(ct_tree_iter, 0);
+            ++ct_tree_iter;
+        }
+    }
+    // or need just update some info
+    else
+    {
+        stagedPending = syncPending;
+
+        CtStorageCache storage_cache;
+        storage_cache.generate_cache(_pCtMainWin, &syncPending, false);
+
+        // update bookmarks
+        if (syncPending.bookmarks_to_write)
+            _write_bookmarks_to_db(pStaging->pDb, _pCtMainWin->get_tree_store().bookmarks_get());
+        // update changed nodes
+        for (const auto& node_pair : syncPending.nodes_to_write_dict)
+        {
+            // a node is edited only once loaded, which takes it out of the read ahead; any other
+            // way of changing the content of a node must forget it as well, as done here
+            if (node_pair.second.buff)
+                (void)_pPrefetchCache->take(node_pair.first);
+            CtTreeIter ct_tree_iter = _pCtMainWin->get_tree_store().get_node_from_node_id(node_pair.first);
+            CtTreeIter ct_tree_iter_parent = ct_tree_iter.parent();
+            _write_node_to_db(pStaging->pDb, &ct_tree_iter, ct_tree_iter.get_node_sequence(),
+                              ct_tree_iter_parent ? ct_tree_iter_parent.get_node_id() : 0, node_pair.second, &storage_cache);
+        }
+    }
+
+    return [pStaging, stagedPending, file_path, need_vacuum]() {
+        CT_TRACE_SCOPE("save write sqlite");
+        _write_staged_to_db(file_path, pStaging->uri, stagedPending, need_vacuum);
+    };
+}
+
 void CtStorageSqlite::vacuum()
 {
-    spdlog::debug("VACUUM");
-    _exec_no_callback("VACUUM");
-    _exec_no_callback("REINDEX");
+    SPDLOG_DEBUG("VACUUM");
+    _exec_no_callback(_pDb, "VACUUM");
+    _exec_no_callback(_pDb, "REINDEX");
 }
 
 void CtStorageSqlite::_open_db(const fs::path& path)
@@ -348,10 +454,14 @@ void CtStorageSqlite::_open_db(const fs::path& path)
         _pDb = nullptr;
         throw std::runtime_error(std::string("sqlite3_open: ") + error);
     }
+    sqlite3_busy_timeout(_pDb, BUSY_TIMEOUT_MS);
 }
 
 void CtStorageSqlite::_close_db()
 {
+    // the file can be moved or replaced while closed
+    _prefetchToken.cancel();
+    _pPrefetchCache->clear();
     if (!_pDb) return;
     sqlite3_close(_pDb);
     _pDb = nullptr;
@@ -360,7 +470,7 @@ void CtStorageSqlite::_close_db()
 
 Gtk::TreeIter CtStorageSqlite::_node_from_db(gint64 node_id, gint64 sequence, Gtk::TreeIter parent_iter, gint64 new_id)
 {
-    sqlite3_stmt_auto stmt(_pDb, "SELECT name, syntax, tags, is_ro, is_richtxt, ts_creation, ts_lastsave FROM node WHERE node_id=?");
+    sqlite3_stmt_auto stmt(_pDb, (std::string{"SELECT "} + NODE_PROPS_COLUMNS + " FROM node WHERE node_id=?").c_str());
     if (stmt.is_bad())
         throw std::runtime_error(ERR_SQLITE_PREPV2 + sqlite3_errmsg(_pDb));
 
@@ -369,24 +479,9 @@ Gtk::TreeIter CtStorageSqlite::_node_from_db(gint64 node_id, gint64 sequence, Gt
         throw std::runtime_error(std::string("CtDocSqliteStorage: missing node properties for id ") + std::to_string(node_id));
 
     CtNodeData nodeData;
+    _node_props_from_stmt(stmt, nodeData);
     nodeData.nodeId = new_id == -1 ? node_id : new_id;
-    nodeData.name = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 0));
-    nodeData.syntax = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 1));
-    nodeData.tags = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 2));
-    gint64 readonly_n_custom_icon_id = sqlite3_column_int64(stmt, 3);
-    nodeData.isRO = static_cast<bool>(readonly_n_custom_icon_id & 0x01);
-    nodeData.customIconId = readonly_n_custom_icon_id >> 1;
-    gint64 richtxt_bold_foreground = sqlite3_column_int64(stmt, 4);
-    nodeData.isBold = static_cast<bool>((richtxt_bold_foreground >> 1) & 0x01);
     nodeData.sequence = sequence;
-    if (static_cast<bool>((richtxt_bold_foreground >> 2) & 0x01))
-    {
-        char foregroundRgb24[8];
-        CtRgbUtil::set_rgb24str_from_rgb24int((richtxt_bold_foreground >> 3) & 0xffffff, foregroundRgb24);
-        nodeData.foregroundRgb24 = foregroundRgb24;
-    }
-    nodeData.tsCreation = sqlite3_column_int64(stmt, 5);
-    nodeData.tsLastSave = sqlite3_column_int64(stmt, 6);
 
     // buffer for imported node should be loaded now because file will be closed
     if (new_id != -1) {
@@ -400,37 +495,226 @@ Glib::RefPtr<Gsv::Buffer> CtStorageSqlite::get_delayed_text_buffer(const gint64&
                                                                       const std::string& syntax,
                                                                       std::list<CtAnchoredWidget*>& widgets) const
 {
-    sqlite3_stmt_auto stmt(_pDb, "SELECT txt, has_codebox, has_table, has_image FROM node WHERE node_id=?");
+    // read ahead by a worker, else read now
+    std::unique_ptr<CtSqliteNodeContent> pNodeContent = _pPrefetchCache->take(node_id);
+    if (not pNodeContent)
+    {
+        pNodeContent = _node_content_from_db(_pDb, node_id);
+        if (not pNodeContent) return Glib::RefPtr<Gsv::Buffer>();
+    }
+    return _buffer_from_node_content(*pNodeContent, syntax, widgets);
+}
+
+void CtStorageSqlite::prefetch_delayed_text_buffers(const std::vector<gint64>& node_ids)
+{
+    // the previous request is outdated by this one
+    _prefetchToken.cancel();
+    if (!_pDb) return;
+
+    std::vector<gint64> wanted_ids;
+    for (const gint64 node_id : node_ids)
+        if (_pPrefetchCache->is_wanted(node_id))
+            wanted_ids.push_back(node_id);
+    if (wanted_ids.empty()) return;
+
+    _prefetchToken = CtCancelToken{};
+    CtThreadPool::get().submit(_prefetchToken, [file_path = _file_path,
+                                                wanted_ids,
+                                                pPrefetchCache = _pPrefetchCache,
+                                                generation = _pPrefetchCache->get_generation(),
+                                                token = _prefetchToken]() {
+        _prefetch_from_db(file_path, wanted_ids, pPrefetchCache, generation, token);
+    });
+}
+
+size_t CtStorageSqlite::get_node_summary(const gint64& node_id, Glib::ustring& text, CtSummaryInfo& summaryInfo) const
+{
+    sqlite3_stmt_auto stmt(_pDb, "SELECT txt, syntax, has_codebox, has_table, has_image FROM node WHERE node_id=?");
     if (stmt.is_bad())
     {
         spdlog::error("{}: {}", ERR_SQLITE_PREPV2, sqlite3_errmsg(_pDb));
-        return Glib::RefPtr<Gsv::Buffer>();
+        return 0;
+    }
+    sqlite3_bind_int64(stmt, 1, node_id);
+    if (sqlite3_step(stmt) != SQLITE_ROW)
+    {
+        spdlog::error("!! missing node properties for id {}", node_id);
+        return 0;
+    }
+
+    const char* textContent = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 0));
+    const char* syntax = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 1));
+    if (not syntax or CtConst::RICH_TEXT_ID != syntax)
+    {
+        if (textContent) text = textContent;
+        return 0;
+    }
+    if (textContent)
+    {
+        std::unique_ptr<xmlpp::DomParser> pParser = CtStorageXmlHelper::parse_buffer_xml(textContent);
+        if (pParser and pParser->get_document() and pParser->get_document()->get_root_node())
+            (void)CtStorageXmlHelper::summary_from_xml(pParser->get_document()->get_root_node(), text, summaryInfo);
+    }
+
+    // the widgets are in their own tables, only counted
+    size_t widgets_num{0};
+    auto count_rows = [&](const char* query, std::function<void(sqlite3_stmt*)> on_row) {
+        sqlite3_stmt_auto widgetsStmt(_pDb, query);
+        if (widgetsStmt.is_bad())
+        {
+            spdlog::error("{}: {}", ERR_SQLITE_PREPV2, sqlite3_errmsg(_pDb));
+            return;
+        }
+        sqlite3_bind_int64(widgetsStmt, 1, node_id);
+        while (SQLITE_ROW == sqlite3_step(widgetsStmt))
+        {
+            on_row(widgetsStmt);
+            ++widgets_num;
+        }
+    };
+    if (sqlite3_column_int64(stmt, 2))
+        count_rows("SELECT offset FROM codebox WHERE node_id=?", [&](sqlite3_stmt*) { ++summaryInfo.codeboxes_num; });
+    if (sqlite3_column_int64(stmt, 3))
+        count_rows("SELECT offset FROM grid WHERE node_id=?", [&](sqlite3_stmt*) { ++summaryInfo.tables_num; });
+    if (sqlite3_column_int64(stmt, 4))
+        count_rows("SELECT anchor, filename FROM image WHERE node_id=?", [&](sqlite3_stmt* pImageStmt) {
+            const char* anchorName = reinterpret_cast<const char*>(sqlite3_column_text(pImageStmt, 0));
+            const char* fileName = reinterpret_cast<const char*>(sqlite3_column_text(pImageStmt, 1));
+            if (anchorName and anchorName[0])      ++summaryInfo.anchors_num;
+            else if (fileName and fileName[0])     ++summaryInfo.embfile_num;
+            else                                   ++summaryInfo.images_num;
+        });
+    return widgets_num;
+}
+
+/*static*/ void CtStorageSqlite::_prefetch_from_db(const fs::path& file_path,
+                                                   const std::vector<gint64>& node_ids,
+                                                   std::shared_ptr<CtSqlitePrefetchCache> pPrefetchCache,
+                                                   const size_t generation,
+                                                   const CtCancelToken& token)
+{
+    // a connection of its own, the one of the storage belongs to the main thread
+    sqlite3* pDb{nullptr};
+    if (sqlite3_open_v2(file_path.c_str(), &pDb, SQLITE_OPEN_READONLY, nullptr) != SQLITE_OK)
+    {
+        SPDLOG_DEBUG("prefetch sqlite3_open_v2: {}", sqlite3_errmsg(pDb));
+        sqlite3_close(pDb); // even after error, pDb is initialized
+        return;
+    }
+    // best effort, a node not read ahead is read on selection
+    sqlite3_busy_timeout(pDb, PREFETCH_BUSY_TIMEOUT_MS);
+
+    for (const gint64 node_id : node_ids)
+    {
+        if (token.is_cancelled()) break;
+        if (not pPrefetchCache->is_wanted(node_id)) continue; // selected meanwhile
+        try
+        {
+            if (std::unique_ptr<CtSqliteNodeContent> pNodeContent = _node_content_from_db(pDb, node_id))
+                pPrefetchCache->put(node_id, std::move(pNodeContent), generation);
+        }
+        catch (std::exception& e)
+        {
+            SPDLOG_DEBUG("prefetch node {}: {}", node_id, e.what());
+        }
+        catch (Glib::Error& e)
+        {
+            SPDLOG_DEBUG("prefetch node {}: {}", node_id, e.what());
+        }
+    }
+    sqlite3_close(pDb);
+}
+
+/*static*/ std::unique_ptr<CtSqliteNodeContent> CtStorageSqlite::_node_content_from_db(sqlite3* pDb, const gint64 node_id)
+{
+    sqlite3_stmt_auto stmt(pDb, "SELECT txt, syntax, has_codebox, has_table, has_image FROM node WHERE node_id=?");
+    if (stmt.is_bad())
+    {
+        spdlog::error("{}: {}", ERR_SQLITE_PREPV2, sqlite3_errmsg(pDb));
+        return nullptr;
     }
 
     sqlite3_bind_int64(stmt, 1, node_id);
     if (sqlite3_step(stmt) != SQLITE_ROW)
     {
         spdlog::error("!! missing node properties for id {}", node_id);
-        return Glib::RefPtr<Gsv::Buffer>();
+        return nullptr;
+    }
+
+    auto pNodeContent = std::make_unique<CtSqliteNodeContent>();
+    if (const char* textContent = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 0)))
+        pNodeContent->txt = textContent;
+    pNodeContent->bytesNum = pNodeContent->txt.size();
+    const char* syntax = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 1));
+    pNodeContent->isRichText = syntax and CtConst::RICH_TEXT_ID == syntax;
+    if (pNodeContent->isRichText)
+    {
+        pNodeContent->pRichTextParser = CtStorageXmlHelper::parse_buffer_xml(pNodeContent->txt.c_str());
+        // the parsed tree takes a few times the xml
+        pNodeContent->bytesNum += 3 * pNodeContent->txt.size();
+
+        if (sqlite3_column_int64(stmt, 2)) _codebox_from_db(pDb, node_id, *pNodeContent);
+        if (sqlite3_column_int64(stmt, 3)) _table_from_db(pDb, node_id, *pNodeContent);
+        if (sqlite3_column_int64(stmt, 4)) _image_from_db(pDb, node_id, *pNodeContent);
     }
+    return pNodeContent;
+}
 
+Glib::RefPtr<Gsv::Buffer> CtStorageSqlite::_buffer_from_node_content(CtSqliteNodeContent& nodeContent,
+                                                                     const std::string& syntax,
+                                                                     std::list<CtAnchoredWidget*>& widgets) const
+{
     Glib::RefPtr<Gsv::Buffer> rRetTextBuffer{nullptr};
-    const char* textContent = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 0));
     if (CtConst::RICH_TEXT_ID != syntax)
     {
-        rRetTextBuffer = _pCtMainWin->get_new_text_buffer(textContent);
+        rRetTextBuffer = _pCtMainWin->get_new_text_buffer(nodeContent.txt);
     }
     else
     {
-        rRetTextBuffer = CtStorageXmlHelper(_pCtMainWin).create_buffer_no_widgets(syntax, textContent);
+        if (not nodeContent.isRichText)
+        {
+            // the syntax in the tree differs from the one in the db
+            nodeContent.pRichTextParser = CtStorageXmlHelper::parse_buffer_xml(nodeContent.txt.c_str());
+        }
+        xmlpp::DomParser* pParser = nodeContent.pRichTextParser.get();
+        if (pParser and pParser->get_document() and pParser->get_document()->get_root_node())
+        {
+            std::list<CtAnchoredWidget*> noWidgets; // the widgets are in their own tables
+            rRetTextBuffer = CtStorageXmlHelper(_pCtMainWin).create_buffer_and_widgets_from_xml(pParser->get_document()->get_root_node(),
+                                                                                                syntax, noWidgets, nullptr, -1);
+        }
         if (!rRetTextBuffer)
         {
-            spdlog::error("!! xml read: {}", textContent);
+            spdlog::error("!! xml read: {}", nodeContent.txt);
             return rRetTextBuffer;
         }
-        if (sqlite3_column_int64(stmt, 1)) _codebox_from_db(node_id, widgets);
-        if (sqlite3_column_int64(stmt, 2)) _table_from_db(node_id, widgets);
-        if (sqlite3_column_int64(stmt, 3)) _image_from_db(node_id, widgets);
+
+        for (CtSqliteNodeContent::Codebox& codebox : nodeContent.codeboxes)
+        {
+            widgets.push_back(new CtCodebox(_pCtMainWin,
+                                            codebox.textContent,
+                                            codebox.syntaxHighlighting,
+                                            codebox.frameWidth,
+                                            codebox.frameHeight,
+                                            codebox.charOffset,
+                                            codebox.justification,
+                                            codebox.widthInPixels,
+                                            codebox.highlightBrackets,
+                                            codebox.showLineNumbers));
+        }
+        for (CtSqliteNodeContent::Table& table : nodeContent.tables)
+        {
+            widgets.push_back(CtTable::create(_pCtMainWin, std::move(table.tableTexts), table.colMin, table.colMax, table.charOffset, table.justification));
+        }
+        for (CtSqliteNodeContent::Image& image : nodeContent.images)
+        {
+            if (!image.anchorName.empty())
+                widgets.push_back(new CtImageAnchor(_pCtMainWin, image.anchorName, image.charOffset, image.justification));
+            else if (!image.fileName.empty())
+                widgets.push_back(new CtImageEmbFile(_pCtMainWin, image.fileName, image.rawBlob, image.timeDouble, image.charOffset, image.justification));
+            else
+                widgets.push_back(new CtImagePng(_pCtMainWin, image.rPixbuf, image.link, image.charOffset, image.justification));
+        }
 
         widgets.sort([](CtAnchoredWidget* w1, CtAnchoredWidget* w2) { return w1->getOffset() < w2->getOffset(); });
         rRetTextBuffer->begin_not_undoable_action();
@@ -442,111 +726,108 @@ Glib::RefPtr<Gsv::Buffer> CtStorageSqlite::get_delayed_text_buffer(const gint64&
     return rRetTextBuffer;
 }
 
-void CtStorageSqlite::_image_from_db(const gint64& nodeId, std::list<CtAnchoredWidget*>& anchoredWidgets) const
+/*static*/ void CtStorageSqlite::_image_from_db(sqlite3* pDb, const gint64& nodeId, CtSqliteNodeContent& nodeContent)
 {
-    sqlite3_stmt_auto stmt(_pDb, "SELECT * FROM image WHERE node_id=? ORDER BY offset ASC");
+    sqlite3_stmt_auto stmt(pDb, "SELECT * FROM image WHERE node_id=? ORDER BY offset ASC");
     if (stmt.is_bad())
     {
-        spdlog::error("{}: {}", ERR_SQLITE_PREPV2, sqlite3_errmsg(_pDb));
+        spdlog::error("{}: {}", ERR_SQLITE_PREPV2, sqlite3_errmsg(pDb));
         return;
     }
     sqlite3_bind_int64(stmt, 1, nodeId);
 
     while (SQLITE_ROW == sqlite3_step(stmt))
     {
-        int charOffset = sqlite3_column_int64(stmt, 1);
-        Glib::ustring justification = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 2));
-        if (justification.empty()) justification = CtConst::TAG_PROP_VAL_LEFT;
+        CtSqliteNodeContent::Image image;
+        image.charOffset = sqlite3_column_int64(stmt, 1);
+        image.justification = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 2));
+        if (image.justification.empty()) image.justification = CtConst::TAG_PROP_VAL_LEFT;
 
         // image
-        const Glib::ustring anchorName = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 3));
-        if (!anchorName.empty())
-        {
-            anchoredWidgets.push_back(new CtImageAnchor(_pCtMainWin, anchorName, charOffset, justification));
-        }
-        else
+        image.anchorName = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 3));
+        if (image.anchorName.empty())
         {
-            fs::path fileName = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 5));
+            image.fileName = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 5));
             const void* pBlob = sqlite3_column_blob(stmt, 4);
             const int blobSize = sqlite3_column_bytes(stmt, 4);
-            const std::string rawBlob(reinterpret_cast<const char*>(pBlob), static_cast<size_t>(blobSize));
-            if (!fileName.empty())
+            if (!image.fileName.empty())
             {
-                const double timeDouble = sqlite3_column_int64(stmt, 7);
-                anchoredWidgets.push_back(new CtImageEmbFile(_pCtMainWin, fileName, rawBlob, timeDouble, charOffset, justification));
+                image.rawBlob = std::string(reinterpret_cast<const char*>(pBlob), static_cast<size_t>(blobSize));
+                image.timeDouble = sqlite3_column_int64(stmt, 7);
+                nodeContent.bytesNum += image.rawBlob.size();
             }
             else
             {
-                const Glib::ustring link = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 6));
-                anchoredWidgets.push_back(new CtImagePng(_pCtMainWin, rawBlob, link, charOffset, justification));
+                // decoded here, off the main thread when read ahead
+                Glib::RefPtr<Gdk::PixbufLoader> rPixbufLoader = Gdk::PixbufLoader::create("image/png", true);
+                rPixbufLoader->write(reinterpret_cast<const guint8*>(pBlob), static_cast<gsize>(blobSize));
+                rPixbufLoader->close();
+                image.rPixbuf = rPixbufLoader->get_pixbuf();
+                image.link = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 6));
+                if (image.rPixbuf)
+                    nodeContent.bytesNum += static_cast<size_t>(image.rPixbuf->get_rowstride()) * image.rPixbuf->get_height();
             }
         }
-
+        nodeContent.images.push_back(std::move(image));
     }
 }
 
-void CtStorageSqlite::_codebox_from_db(const gint64& nodeId ,std::list<CtAnchoredWidget*>& anchoredWidgets) const
+/*static*/ void CtStorageSqlite::_codebox_from_db(sqlite3* pDb, const gint64& nodeId, CtSqliteNodeContent& nodeContent)
 {
-    sqlite3_stmt_auto stmt(_pDb, "SELECT * FROM codebox WHERE node_id=? ORDER BY offset ASC");
+    sqlite3_stmt_auto stmt(pDb, "SELECT * FROM codebox WHERE node_id=? ORDER BY offset ASC");
     if (stmt.is_bad())
     {
-        spdlog::error("{}: {}", ERR_SQLITE_PREPV2, sqlite3_errmsg(_pDb));
+        spdlog::error("{}: {}", ERR_SQLITE_PREPV2, sqlite3_errmsg(pDb));
         return;
     }
     sqlite3_bind_int64(stmt, 1, nodeId);
 
     while (SQLITE_ROW == sqlite3_step(stmt))
     {
-        int charOffset = sqlite3_column_int64(stmt, 1);
-        Glib::ustring justification = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 2));
-        if (justification.empty()) justification = CtConst::TAG_PROP_VAL_LEFT;
-
-        const Glib::ustring textContent = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 3));
-        const Glib::ustring syntaxHighlighting = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 4));
-        const int frameWidth = sqlite3_column_int64(stmt, 5);
-        const int frameHeight = sqlite3_column_int64(stmt, 6);
-        const bool widthInPixels = sqlite3_column_int64(stmt, 7);
-        const bool highlightBrackets = sqlite3_column_int64(stmt, 8);
-        const bool showLineNumbers = sqlite3_column_int64(stmt, 9);
-
-        anchoredWidgets.push_back(new CtCodebox(_pCtMainWin,
-                                                textContent,
-                                                syntaxHighlighting,
-                                                frameWidth,
-                                                frameHeight,
-                                                charOffset,
-                                                justification,
-                                                widthInPixels,
-                                                highlightBrackets,
-                                                showLineNumbers));
-
+        CtSqliteNodeContent::Codebox codebox;
+        codebox.charOffset = sqlite3_column_int64(stmt, 1);
+        codebox.justification = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 2));
+        if (codebox.justification.empty()) codebox.justification = CtConst::TAG_PROP_VAL_LEFT;
+
+        codebox.textContent = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 3));
+        codebox.syntaxHighlighting = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 4));
+        codebox.frameWidth = sqlite3_column_int64(stmt, 5);
+        codebox.frameHeight = sqlite3_column_int64(stmt, 6);
+        codebox.widthInPixels = sqlite3_column_int64(stmt, 7);
+        codebox.highlightBrackets = sqlite3_column_int64(stmt, 8);
+        codebox.showLineNumbers = sqlite3_column_int64(stmt, 9);
+
+        nodeContent.bytesNum += codebox.textContent.bytes();
+        nodeContent.codeboxes.push_back(std::move(codebox));
     }
 }
 
-void CtStorageSqlite::_table_from_db(const gint64& nodeId, std::list<CtAnchoredWidget*>& anchoredWidgets) const
+/*static*/ void CtStorageSqlite::_table_from_db(sqlite3* pDb, const gint64& nodeId, CtSqliteNodeContent& nodeContent)
 {
-    sqlite3_stmt_auto stmt(_pDb, "SELECT * FROM grid WHERE node_id=? ORDER BY offset ASC");
+    sqlite3_stmt_auto stmt(pDb, "SELECT * FROM grid WHERE node_id=? ORDER BY offset ASC");
     if (stmt.is_bad())
     {
-        spdlog::error("{}: {}", ERR_SQLITE_PREPV2, sqlite3_errmsg(_pDb));
+        spdlog::error("{}: {}", ERR_SQLITE_PREPV2, sqlite3_errmsg(pDb));
         return;
     }
     sqlite3_bind_int64(stmt, 1, nodeId);
 
     while (SQLITE_ROW == sqlite3_step(stmt))
     {
-        int charOffset = sqlite3_column_int64(stmt, 1);
-        Glib::ustring justification = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 2));
-        if (justification.empty()) justification = CtConst::TAG_PROP_VAL_LEFT;
+        CtSqliteNodeContent::Table table;
+        table.charOffset = sqlite3_column_int64(stmt, 1);
+        table.justification = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 2));
+        if (table.justification.empty()) table.justification = CtConst::TAG_PROP_VAL_LEFT;
 
         const char* textContent = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 3));
-        const int colMin = sqlite3_column_int64(stmt, 4);
-        const int colMax = sqlite3_column_int64(stmt, 5);
+        table.colMin = sqlite3_column_int64(stmt, 4);
+        table.colMax = sqlite3_column_int64(stmt, 5);
 
-        CtTableMatrix tableMatrix;
-        if (CtStorageXmlHelper(_pCtMainWin).populate_table_matrix(tableMatrix, textContent))
+        if (CtStorageXmlHelper::populate_table_matrix(table.tableTexts, textContent))
         {
-            anchoredWidgets.push_back(new CtTable(_pCtMainWin, tableMatrix, colMin, colMax, charOffset, justification));
+            // about the cells with their markup
+            nodeContent.bytesNum += static_cast<size_t>(sqlite3_column_bytes(stmt, 3));
+            nodeContent.tables.push_back(std::move(table));
         }
         else
         {
@@ -555,23 +836,23 @@ void CtStorageSqlite::_table_from_db(const gint64& nodeId, std::list<CtAnchoredW
     }
 }
 
-void CtStorageSqlite::_create_all_tables_in_db()
+/*static*/ void CtStorageSqlite::_create_all_tables_in_db(sqlite3* pDb)
 {
-    _exec_no_callback(TABLE_NODE_CREATE);
-    _exec_no_callback(TABLE_CODEBOX_CREATE);
-    _exec_no_callback(TABLE_TABLE_CREATE);
-    _exec_no_callback(TABLE_IMAGE_CREATE);
-    _exec_no_callback(TABLE_CHILDREN_CREATE);
-    _exec_no_callback(TABLE_BOOKMARK_CREATE);
+    _exec_no_callback(pDb, TABLE_NODE_CREATE);
+    _exec_no_callback(pDb, TABLE_CODEBOX_CREATE);
+    _exec_no_callback(pDb, TABLE_TABLE_CREATE);
+    _exec_no_callback(pDb, TABLE_IMAGE_CREATE);
+    _exec_no_callback(pDb, TABLE_CHILDREN_CREATE);
+    _exec_no_callback(pDb, TABLE_BOOKMARK_CREATE);
 }
 
-void CtStorageSqlite::_write_bookmarks_to_db(const std::list<gint64>& bookmarks)
+/*static*/ void CtStorageSqlite::_write_bookmarks_to_db(sqlite3* pDb, const std::list<gint64>& bookmarks)
 {
-    _exec_no_callback(TABLE_BOOKMARK_DELETE);
+    _exec_no_callback(pDb, TABLE_BOOKMARK_DELETE);
 
-    sqlite3_stmt_auto stmt(_pDb, TABLE_BOOKMARK_INSERT);
+    sqlite3_stmt_auto stmt(pDb, TABLE_BOOKMARK_INSERT);
     if (stmt.is_bad())
-        throw std::runtime_error(ERR_SQLITE_PREPV2 + sqlite3_errmsg(_pDb));
+        throw std::runtime_error(ERR_SQLITE_PREPV2 + sqlite3_errmsg(pDb));
 
     gint64 sequence{0};
     for (gint64 bookmark : bookmarks)
@@ -580,49 +861,21 @@ void CtStorageSqlite::_write_bookmarks_to_db(const std::list<gint64>& bookmarks)
         sqlite3_bind_int64(stmt, 1, bookmark);
         sqlite3_bind_int64(stmt, 2, sequence);
         if (sqlite3_step(stmt) != SQLITE_DONE)
-            throw std::runtime_error(ERR_SQLITE_STEP + sqlite3_errmsg(_pDb));
+            throw std::runtime_error(ERR_SQLITE_STEP + sqlite3_errmsg(pDb));
         sqlite3_reset(stmt);
     }
 }
 
-void CtStorageSqlite::_write_node_to_db(CtTreeIter* ct_tree_iter,
+void CtStorageSqlite::_write_node_to_db(sqlite3* pStagingDb,
+                                        CtTreeIter* ct_tree_iter,
                                         const gint64 sequence,
                                         const gint64 node_father_id,
                                         const CtStorageNodeState& node_state,
-                                        const int start_offset, const int end_offset,
                                         CtStorageCache* storage_cache)
 {
-    const gint64 node_id = ct_tree_iter->get_node_id();
-    // is_ro is packed with additional bitfield data
-    gint64 is_ro = ct_tree_iter->get_node_read_only() ? 0x01 : 0x00;
-    is_ro |= ct_tree_iter->get_node_custom_icon_id() << 1;
-    // is_richtxt is packed with additional bitfield data
-    gint64 is_richtxt = ct_tree_iter->get_node_is_rich_text() ? 0x01 : 0x00;
-    if (ct_tree_iter->get_node_is_bold())
-    {
-        is_richtxt |= 0x02;
-    }
-    if (!ct_tree_iter->get_node_foreground().empty())
-    {
-        is_richtxt |= 0x04;
-        is_richtxt |= CtRgbUtil::get_rgb24int_from_str_any(ct_tree_iter->get_node_foreground().c_str()+1) << 3;
-    }
-
-    bool remove_prev_widgets = node_state.upd && node_state.buff;
-    bool remove_prev_node = node_state.upd && node_state.buff && node_state.prop;
-    bool remove_prev_hier = node_state.upd && node_state.hier;
-
-    // remove previous data in case full update (skip when add new or partial update
-    if (remove_prev_widgets)
-    {
-        _exec_bind_int64(TABLE_CODEBOX_DELETE, node_id);
-        _exec_bind_int64(TABLE_TABLE_DELETE, node_id);
-        _exec_bind_int64(TABLE_IMAGE_DELETE, node_id);
-    }
-    if (remove_prev_node)
-        _exec_bind_int64(TABLE_NODE_DELETE, node_id);
-    if (remove_prev_hier)
-        _exec_bind_int64(TABLE_CHILDREN_DELETE, node_id);
+    CtNodeData nodeData;
+    _pCtMainWin->get_tree_store().get_node_data(*ct_tree_iter, nodeData);
+    const bool is_rich_text = ct_tree_iter->get_node_is_rich_text();
 
     bool has_codebox{false};
     bool has_table{false};
@@ -631,22 +884,22 @@ void CtStorageSqlite::_write_node_to_db(CtTreeIter* ct_tree_iter,
     // write hier
     if (node_state.hier)
     {
-        sqlite3_stmt_auto stmt(_pDb, TABLE_CHILDREN_INSERT);
+        sqlite3_stmt_auto stmt(pStagingDb, TABLE_CHILDREN_INSERT);
         if (stmt.is_bad())
-            throw std::runtime_error(ERR_SQLITE_PREPV2 + sqlite3_errmsg(_pDb));
-        sqlite3_bind_int64(stmt, 1, node_id);
+            throw std::runtime_error(ERR_SQLITE_PREPV2 + sqlite3_errmsg(pStagingDb));
+        sqlite3_bind_int64(stmt, 1, nodeData.nodeId);
         sqlite3_bind_int64(stmt, 2, node_father_id);
         sqlite3_bind_int64(stmt, 3, sequence);
         if (sqlite3_step(stmt) != SQLITE_DONE)
-            throw std::runtime_error(ERR_SQLITE_STEP + sqlite3_errmsg(_pDb));
+            throw std::runtime_error(ERR_SQLITE_STEP + sqlite3_errmsg(pStagingDb));
     }
 
     // write widgets
-    if (node_state.buff && (is_richtxt & 0x01))
+    if (node_state.buff && is_rich_text)
     {
-        for (CtAnchoredWidget* pAnchoredWidget : ct_tree_iter->get_embedded_pixbufs_tables_codeboxes(start_offset, end_offset))
+        for (CtAnchoredWidget* pAnchoredWidget : ct_tree_iter->get_embedded_pixbufs_tables_codeboxes(0, -1))
         {
-            if (!pAnchoredWidget->to_sqlite(_pDb, node_id, start_offset >= 0 ? -start_offset : 0, storage_cache))
+            if (!pAnchoredWidget->to_sqlite(pStagingDb, nodeData.nodeId, 0, storage_cache))
                 throw std::runtime_error("couldn't save widget");
             switch (pAnchoredWidget->get_type())
             {
@@ -657,95 +910,231 @@ void CtStorageSqlite::_write_node_to_db(CtTreeIter* ct_tree_iter,
         }
     }
 
-    // write node
-    if (node_state.buff)
+    // write node, the whole row also when only a part of it is copied into the document
+    if (node_state.buff || node_state.prop)
     {
-        // get buffer content
+        // get buffer content, not copied if only the properties changed
         std::string node_txt;
-        if (is_richtxt & 0x01)
+        if (node_state.buff && is_rich_text)
         {
             xmlpp::Document xml_doc;
             xml_doc.create_root_node("node");
-            CtStorageXmlHelper::save_buffer_no_widgets_to_xml(xml_doc.get_root_node(), ct_tree_iter->get_node_text_buffer(), start_offset, end_offset, 'n');
+            CtStorageXmlHelper::save_buffer_no_widgets_to_xml(xml_doc.get_root_node(), ct_tree_iter->get_node_text_buffer(), 0, -1, 'n');
             node_txt = xml_doc.write_to_string();
         }
-        else
+        else if (node_state.buff)
         {
             node_txt = ct_tree_iter->get_node_text_buffer()->get_text();
         }
 
-        // full node rewrite
-        if (node_state.buff && node_state.prop)
-        {
-            sqlite3_stmt_auto stmt(_pDb, TABLE_NODE_INSERT);
-            if (stmt.is_bad())
-                throw std::runtime_error(ERR_SQLITE_PREPV2 + sqlite3_errmsg(_pDb));
+        sqlite3_stmt_auto stmt(pStagingDb, TABLE_NODE_INSERT);
+        if (stmt.is_bad())
+            throw std::runtime_error(ERR_SQLITE_PREPV2 + sqlite3_errmsg(pStagingDb));
+        _write_node_row(pStagingDb, stmt, nodeData, node_txt, has_codebox, has_table, has_image);
+    }
+}
 
-            const std::string node_name = ct_tree_iter->get_node_name();
-            const std::string node_syntax = ct_tree_iter->get_node_syntax_highlighting();
-            const std::string node_tags = ct_tree_iter->get_node_tags();
-            sqlite3_bind_int64(stmt, 1, node_id);
-            sqlite3_bind_text(stmt, 2, node_name.c_str(), node_name.size(), SQLITE_STATIC);
-            sqlite3_bind_text(stmt, 3, node_txt.c_str(), node_txt.size(), SQLITE_STATIC);
-            sqlite3_bind_text(stmt, 4, node_syntax.c_str(), node_syntax.size(), SQLITE_STATIC);
-            sqlite3_bind_text(stmt, 5, node_tags.c_str(), node_tags.size(), SQLITE_STATIC);
-            sqlite3_bind_int64(stmt, 6, is_ro);
-            sqlite3_bind_int64(stmt, 7, is_richtxt);
-            sqlite3_bind_int64(stmt, 8, has_codebox);
-            sqlite3_bind_int64(stmt, 9, has_table);
-            sqlite3_bind_int64(stmt, 10, has_image);
-            sqlite3_bind_int64(stmt, 11, 0); // todo: get rid of unused column 'level'
-            sqlite3_bind_int64(stmt, 12, ct_tree_iter->get_node_creating_time());
-            sqlite3_bind_int64(stmt, 13, ct_tree_iter->get_node_modification_time());
-            if (sqlite3_step(stmt) != SQLITE_DONE)
-                throw std::runtime_error(ERR_SQLITE_STEP + sqlite3_errmsg(_pDb));
-        }
-        // only node buff rewrite
-        else if (node_state.buff)
+/*static*/ void CtStorageSqlite::_node_props_from_stmt(sqlite3_stmt* pStmt, CtNodeData& nodeData)
+{
+    nodeData.name = reinterpret_cast<const char*>(sqlite3_column_text(pStmt, 0));
+    nodeData.syntax = reinterpret_cast<const char*>(sqlite3_column_text(pStmt, 1));
+    nodeData.tags = reinterpret_cast<const char*>(sqlite3_column_text(pStmt, 2));
+    // is_ro and is_richtxt are packed with additional bitfield data
+    gint64 readonly_n_custom_icon_id = sqlite3_column_int64(pStmt, 3);
+    nodeData.isRO = static_cast<bool>(readonly_n_custom_icon_id & 0x01);
+    nodeData.customIconId = readonly_n_custom_icon_id >> 1;
+    gint64 richtxt_bold_foreground = sqlite3_column_int64(pStmt, 4);
+    nodeData.isBold = static_cast<bool>((richtxt_bold_foreground >> 1) & 0x01);
+    if (static_cast<bool>((richtxt_bold_foreground >> 2) & 0x01))
+    {
+        char foregroundRgb24[8];
+        CtRgbUtil::set_rgb24str_from_rgb24int((richtxt_bold_foreground >> 3) & 0xffffff, foregroundRgb24);
+        nodeData.foregroundRgb24 = foregroundRgb24;
+    }
+    nodeData.tsCreation = sqlite3_column_int64(pStmt, 5);
+    nodeData.tsLastSave = sqlite3_column_int64(pStmt, 6);
+}
+
+/*static*/ void CtStorageSqlite::_write_node_row(sqlite3* pDb,
+                                                 sqlite3_stmt* pStmt,
+                                                 const CtNodeData& nodeData,
+                                                 const std::string& node_txt,
+                                                 const bool has_codebox,
+                                                 const bool has_table,
+                                                 const bool has_image)
+{
+    // is_ro and is_richtxt are packed with additional bitfield data
+    gint64 is_ro = nodeData.isRO ? 0x01 : 0x00;
+    is_ro |= static_cast<gint64>(nodeData.customIconId) << 1;
+    gint64 is_richtxt = CtConst::RICH_TEXT_ID == nodeData.syntax ? 0x01 : 0x00;
+    if (nodeData.isBold)
+    {
+        is_richtxt |= 0x02;
+    }
+    if (!nodeData.foregroundRgb24.empty())
+    {
+        is_richtxt |= 0x04;
+        is_richtxt |= CtRgbUtil::get_rgb24int_from_str_any(nodeData.foregroundRgb24.c_str()+1) << 3;
+    }
+
+    const std::string node_name = nodeData.name;
+    const std::string node_tags = nodeData.tags;
+    sqlite3_bind_int64(pStmt, 1, nodeData.nodeId);
+    sqlite3_bind_text(pStmt, 2, node_name.c_str(), node_name.size(), SQLITE_STATIC);
+    sqlite3_bind_text(pStmt, 3, node_txt.c_str(), node_txt.size(), SQLITE_STATIC);
+    sqlite3_bind_text(pStmt, 4, nodeData.syntax.c_str(), nodeData.syntax.size(), SQLITE_STATIC);
+    sqlite3_bind_text(pStmt, 5, node_tags.c_str(), node_tags.size(), SQLITE_STATIC);
+    sqlite3_bind_int64(pStmt, 6, is_ro);
+    sqlite3_bind_int64(pStmt, 7, is_richtxt);
+    sqlite3_bind_int64(pStmt, 8, has_codebox);
+    sqlite3_bind_int64(pStmt, 9, has_table);
+    sqlite3_bind_int64(pStmt, 10, has_image);
+    sqlite3_bind_int64(pStmt, 11, 0); // todo: get rid of unused column 'level'
+    sqlite3_bind_int64(pStmt, 12, nodeData.tsCreation);
+    sqlite3_bind_int64(pStmt, 13, nodeData.tsLastSave);
+    if (sqlite3_step(pStmt) != SQLITE_DONE)
+        throw std::runtime_error(ERR_SQLITE_STEP + sqlite3_errmsg(pDb));
+    sqlite3_reset(pStmt);
+}
+
+/*static*/ void CtStorageSqlite::_write_staged_to_db(const fs::path& file_path,
+                                                     const std::string& staging_uri,
+                                                     const CtStorageSyncPending& syncPending,
+                                                     const bool need_vacuum)
+{
+    // own connection, the one of the storage keeps on reading the nodes in the meanwhile
+    sqlite3* pDb{nullptr};
+    if (sqlite3_open_v2(file_path.c_str(), &pDb, SQLITE_OPEN_READWRITE | SQLITE_OPEN_URI, nullptr) != SQLITE_OK)
+    {
+        const std::string error = sqlite3_errmsg(pDb);
+        sqlite3_close(pDb);
+        throw std::runtime_error(std::string("sqlite3_open: ") + error);
+    }
+    auto on_scope_exit = scope_guard([&](void*) { sqlite3_close(pDb); });
+    sqlite3_busy_timeout(pDb, BUSY_TIMEOUT_MS);
+
+    {
+        sqlite3_stmt_auto stmt(pDb, "ATTACH DATABASE ? AS staging");
+        if (stmt.is_bad())
+            throw std::runtime_error(ERR_SQLITE_PREPV2 + sqlite3_errmsg(pDb));
+        sqlite3_bind_text(stmt, 1, staging_uri.c_str(), staging_uri.size(), SQLITE_STATIC);
+        if (sqlite3_step(stmt) != SQLITE_DONE)
+            throw std::runtime_error(ERR_SQLITE_STEP + sqlite3_errmsg(pDb));
+    }
+
+    _exec_no_callback(pDb, "BEGIN TRANSACTION");
+    try
+    {
+        if (syncPending.bookmarks_to_write)
         {
-            sqlite3_stmt_auto stmt(_pDb, "UPDATE node SET txt=?, syntax=?, is_richtxt=?, has_codebox=?, has_table=?, has_image=?, ts_lastsave=? WHERE node_id=?");
-            if (stmt.is_bad())
-                throw std::runtime_error(ERR_SQLITE_PREPV2 + sqlite3_errmsg(_pDb));
+            _exec_no_callback(pDb, TABLE_BOOKMARK_DELETE);
+            _exec_no_callback(pDb, "INSERT INTO bookmark (node_id, sequence) SELECT node_id, sequence FROM staging.bookmark");
+        }
+        for (const auto& node_pair : syncPending.nodes_to_write_dict)
+        {
+            const gint64 node_id = node_pair.first;
+            const CtStorageNodeState& node_state = node_pair.second;
 
-            const std::string node_syntax = ct_tree_iter->get_node_syntax_highlighting();
-            sqlite3_bind_text(stmt, 1, node_txt.c_str(), node_txt.size(), SQLITE_STATIC);
-            sqlite3_bind_text(stmt, 2, node_syntax.c_str(), node_syntax.size(), SQLITE_STATIC);
-            sqlite3_bind_int64(stmt, 3, is_richtxt);
-            sqlite3_bind_int64(stmt, 4, has_codebox);
-            sqlite3_bind_int64(stmt, 5, has_table);
-            sqlite3_bind_int64(stmt, 6, has_image);
-            sqlite3_bind_int64(stmt, 7, ct_tree_iter->get_node_modification_time());
-            sqlite3_bind_int64(stmt, 8, node_id);
-            if (sqlite3_step(stmt) != SQLITE_DONE)
-                throw std::runtime_error(ERR_SQLITE_STEP + sqlite3_errmsg(_pDb));
-        }
-        // only node prop rewrite
-        else if (node_state.prop)
-        {
-            sqlite3_stmt_auto stmt(_pDb, "UPDATE node SET name=?, syntax=?, tags=?, is_ro=?, is_richtxt=? WHERE node_id=?");
-            if (stmt.is_bad())
-                throw std::runtime_error(ERR_SQLITE_PREPV2 + sqlite3_errmsg(_pDb));
+            // remove previous data in case full update (skip when add new or partial update
+            if (node_state.upd && node_state.buff)
+            {
+                _exec_bind_int64(pDb, TABLE_CODEBOX_DELETE, node_id);
+                _exec_bind_int64(pDb, TABLE_TABLE_DELETE, node_id);
+                _exec_bind_int64(pDb, TABLE_IMAGE_DELETE, node_id);
+            }
+            if (node_state.upd && node_state.buff && node_state.prop)
+                _exec_bind_int64(pDb, TABLE_NODE_DELETE, node_id);
+            if (node_state.upd && node_state.hier)
+                _exec_bind_int64(pDb, TABLE_CHILDREN_DELETE, node_id);
+
+            if (node_state.hier)
+                _exec_bind_int64(pDb, "INSERT INTO children (node_id, father_id, sequence) "
+                                      "SELECT node_id, father_id, sequence FROM staging.children WHERE node_id=?", node_id);
+            if (node_state.buff)
+            {
+                _exec_bind_int64(pDb, "INSERT INTO codebox (node_id, offset, justification, txt, syntax, width, height, is_width_pix, do_highl_bra, do_show_linenum) "
+                                      "SELECT node_id, offset, justification, txt, syntax, width, height, is_width_pix, do_highl_bra, do_show_linenum FROM staging.codebox WHERE node_id=?", node_id);
+                _exec_bind_int64(pDb, "INSERT INTO grid (node_id, offset, justification, txt, col_min, col_max) "
+                                      "SELECT node_id, offset, justification, txt, col_min, col_max FROM staging.grid WHERE node_id=?", node_id);
+                _exec_bind_int64(pDb, "INSERT INTO image (node_id, offset, justification, anchor, png, filename, link, time) "
+                                      "SELECT node_id, offset, justification, anchor, png, filename, link, time FROM staging.image WHERE node_id=?", node_id);
+            }
+            // full node rewrite
+            if (node_state.buff && node_state.prop)
+                _exec_bind_int64(pDb, "INSERT INTO node (node_id, name, txt, syntax, tags, is_ro, is_richtxt, has_codebox, has_table, has_image, level, ts_creation, ts_lastsave) "
+                                      "SELECT node_id, name, txt, syntax, tags, is_ro, is_richtxt, has_codebox, has_table, has_image, level, ts_creation, ts_lastsave FROM staging.node WHERE node_id=?", node_id);
+            // only node buff rewrite
+            else if (node_state.buff)
+                _exec_bind_int64(pDb, "UPDATE node SET (txt, syntax, is_richtxt, has_codebox, has_table, has_image, ts_lastsave)="
+                                      "(SELECT s.txt, s.syntax, s.is_richtxt, s.has_codebox, s.has_table, s.has_image, s.ts_lastsave FROM staging.node AS s WHERE s.node_id=?1) WHERE node_id=?1", node_id);
+            // only node prop rewrite
+            else if (node_state.prop)
+                _exec_bind_int64(pDb, "UPDATE node SET (name, syntax, tags, is_ro, is_richtxt)="
+                                      "(SELECT s.name, s.syntax, s.tags, s.is_ro, s.is_richtxt FROM staging.node AS s WHERE s.node_id=?1) WHERE node_id=?1", node_id);
+        }
+        // remove nodes and their sub nodes
+        for (const auto node_id : syncPending.nodes_to_rm_set)
+            _remove_db_node_with_children(pDb, node_id);
+
+        _exec_no_callback(pDb, "COMMIT");
+    }
+    catch (std::exception&)
+    {
+        sqlite3_exec(pDb, "ROLLBACK", nullptr, nullptr, nullptr);
+        throw;
+    }
+    _exec_no_callback(pDb, "DETACH DATABASE staging");
+
+    if (need_vacuum)
+    {
+        SPDLOG_DEBUG("VACUUM");
+        _exec_no_callback(pDb, "VACUUM");
+        _exec_no_callback(pDb, "REINDEX");
+    }
+}
 
-            const std::string node_name = ct_tree_iter->get_node_name();
-            const std::string node_syntax = ct_tree_iter->get_node_syntax_highlighting();
-            const std::string node_tags = ct_tree_iter->get_node_tags();
-            sqlite3_bind_text(stmt, 1, node_name.c_str(), node_name.size(), SQLITE_STATIC);
-            sqlite3_bind_text(stmt, 2, node_syntax.c_str(), node_syntax.size(), SQLITE_STATIC);
-            sqlite3_bind_text(stmt, 3, node_tags.c_str(), node_tags.size(), SQLITE_STATIC);
-            sqlite3_bind_int64(stmt, 4, is_ro);
-            sqlite3_bind_int64(stmt, 5, is_richtxt);
-            sqlite3_bind_int64(stmt, 6, node_id);
-            if (sqlite3_step(stmt) != SQLITE_DONE)
-                throw std::runtime_error(ERR_SQLITE_STEP + sqlite3_errmsg(_pDb));
+/*static*/ void CtStorageSqlite::backup_db_file(const fs::path& from, const fs::path& to)
+{
+    CT_TRACE_SCOPE("sqlite backup");
+    sqlite3* pDbFrom{nullptr};
+    sqlite3* pDbTo{nullptr};
+    auto on_scope_exit = scope_guard([&](void*) { sqlite3_close(pDbTo); sqlite3_close(pDbFrom); });
+    if (sqlite3_open_v2(from.c_str(), &pDbFrom, SQLITE_OPEN_READONLY, nullptr) != SQLITE_OK or
+        sqlite3_open_v2(to.c_str(), &pDbTo, SQLITE_OPEN_READWRITE | SQLITE_OPEN_CREATE, nullptr) != SQLITE_OK)
+    {
+        throw std::runtime_error(std::string("sqlite3_open: ") + sqlite3_errmsg(pDbTo ? pDbTo : pDbFrom));
+    }
+    sqlite3_backup* pBackup = sqlite3_backup_init(pDbTo, "main", pDbFrom, "main");
+    if (!pBackup)
+        throw std::runtime_error(std::string("sqlite3_backup_init: ") + sqlite3_errmsg(pDbTo));
+    int rc{SQLITE_OK};
+    // the source can stay locked for as long as the busy timeout of the connections, not more
+    int busy_steps{0};
+    do
+    {
+        rc = sqlite3_backup_step(pBackup, BACKUP_PAGES_PER_STEP);
+        if (rc == SQLITE_BUSY || rc == SQLITE_LOCKED)
+        {
+            if (++busy_steps * BACKUP_BUSY_SLEEP_MS > BUSY_TIMEOUT_MS)
+                break;
+            sqlite3_sleep(BACKUP_BUSY_SLEEP_MS);
+        }
+        else
+        {
+            busy_steps = 0;
         }
     }
+    while (rc == SQLITE_OK || rc == SQLITE_BUSY || rc == SQLITE_LOCKED);
+    sqlite3_backup_finish(pBackup);
+    if (rc != SQLITE_DONE)
+        throw std::runtime_error(std::string("sqlite3_backup_step: ") + sqlite3_errstr(rc));
 }
 
-std::list<gint64> CtStorageSqlite::_get_children_node_ids_from_db(gint64 father_id)
+/*static*/ std::list<gint64> CtStorageSqlite::_get_children_node_ids_from_db(sqlite3* pDb, gint64 father_id)
 {
-    sqlite3_stmt_auto stmt(_pDb, "SELECT node_id FROM children WHERE father_id=? ORDER BY sequence ASC");
+    sqlite3_stmt_auto stmt(pDb, "SELECT node_id FROM children WHERE father_id=? ORDER BY sequence ASC");
     if (stmt.is_bad())
-        throw std::runtime_error(ERR_SQLITE_PREPV2 + sqlite3_errmsg(_pDb));
+        throw std::runtime_error(ERR_SQLITE_PREPV2 + sqlite3_errmsg(pDb));
 
     std::list<gint64> node_children;
     sqlite3_bind_int64(stmt, 1, father_id);
@@ -755,22 +1144,36 @@ std::list<gint64> CtStorageSqlite::_get_children_node_ids_from_db(gint64 father_
     return node_children;
 }
 
-void CtStorageSqlite::_remove_db_node_with_children(const gint64 node_id)
+/*static*/ std::list<std::pair<gint64, gint64>> CtStorageSqlite::_get_children_sequences_from_db(sqlite3* pDb, gint64 father_id)
 {
-    _exec_bind_int64(TABLE_CODEBOX_DELETE, node_id);
-    _exec_bind_int64(TABLE_TABLE_DELETE, node_id);
-    _exec_bind_int64(TABLE_IMAGE_DELETE, node_id);
-    _exec_bind_int64(TABLE_NODE_DELETE, node_id);
-    _exec_bind_int64(TABLE_CHILDREN_DELETE, node_id);
+    sqlite3_stmt_auto stmt(pDb, "SELECT node_id, sequence FROM children WHERE father_id=? ORDER BY sequence ASC");
+    if (stmt.is_bad())
+        throw std::runtime_error(ERR_SQLITE_PREPV2 + sqlite3_errmsg(pDb));
 
-    for (const gint64 child_node_id: _get_children_node_ids_from_db(node_id))
-        _remove_db_node_with_children(child_node_id);
+    std::list<std::pair<gint64, gint64>> node_children;
+    sqlite3_bind_int64(stmt, 1, father_id);
+    while (sqlite3_step(stmt) == SQLITE_ROW)
+        node_children.emplace_back(sqlite3_column_int64(stmt, 0), sqlite3_column_int64(stmt, 1));
+
+    return node_children;
+}
+
+/*static*/ void CtStorageSqlite::_remove_db_node_with_children(sqlite3* pDb, const gint64 node_id)
+{
+    _exec_bind_int64(pDb, TABLE_CODEBOX_DELETE, node_id);
+    _exec_bind_int64(pDb, TABLE_TABLE_DELETE, node_id);
+    _exec_bind_int64(pDb, TABLE_IMAGE_DELETE, node_id);
+    _exec_bind_int64(pDb, TABLE_NODE_DELETE, node_id);
+    _exec_bind_int64(pDb, TABLE_CHILDREN_DELETE, node_id);
+
+    for (const gint64 child_node_id: _get_children_node_ids_from_db(pDb, node_id))
+        _remove_db_node_with_children(pDb, child_node_id);
 }
 
-void CtStorageSqlite::_exec_no_callback(const char* sqlCmd)
+/*static*/ void CtStorageSqlite::_exec_no_callback(sqlite3* pDb, const char* sqlCmd)
 {
     char *p_err_msg{nullptr};
-    if (SQLITE_OK != sqlite3_exec(_pDb, sqlCmd, nullptr, nullptr, &p_err_msg))
+    if (SQLITE_OK != sqlite3_exec(pDb, sqlCmd, nullptr, nullptr, &p_err_msg))
     {
         std::string msg = std::string("!! sqlite3 '") + sqlCmd + "': " + p_err_msg;
         sqlite3_free(p_err_msg);
@@ -778,14 +1181,14 @@ void CtStorageSqlite::_exec_no_callback(const char* sqlCmd)
     }
 }
 
-void CtStorageSqlite::_exec_bind_int64(const char* sqlCmd, const gint64 bind_int64)
+/*static*/ void CtStorageSqlite::_exec_bind_int64(sqlite3* pDb, const char* sqlCmd, const gint64 bind_int64)
 {
-    sqlite3_stmt_auto stmt(_pDb, sqlCmd);
+    sqlite3_stmt_auto stmt(pDb, sqlCmd);
     if (stmt.is_bad())
-        throw std::runtime_error(ERR_SQLITE_PREPV2 + sqlite3_errmsg(_pDb));
+        throw std::runtime_error(ERR_SQLITE_PREPV2 + sqlite3_errmsg(pDb));
     sqlite3_bind_int64(stmt, 1, bind_int64);
     if (sqlite3_step(stmt) != SQLITE_DONE)
-        throw std::runtime_error(ERR_SQLITE_STEP + sqlite3_errmsg(_pDb));
+        throw std::runtime_error(ERR_SQLITE_STEP + sqlite3_errmsg(pDb));
 }
 
 void CtStorageSqlite::import_nodes(const fs::path& path)
@@ -799,22 +1202,22 @@ void CtStorageSqlite::import_nodes(const fs::path& path)
         auto node_iter = _pCtMainWin->get_tree_store().to_ct_tree_iter(_node_from_db(nodeId, sequence, parent_iter, _pCtMainWin->get_tree_store().node_id_get()));
         node_iter.pending_new_db_node();
         gint64 child_sequence = 0;
-        for (auto child_id : _get_children_node_ids_from_db(nodeId)) {
+        for (auto child_id : _get_children_node_ids_from_db(_pDb, nodeId)) {
             add_node_func(child_id, ++child_sequence, node_iter);
         }
     };
     gint64 sequence = 0;
-    for (auto node_id : _get_children_node_ids_from_db(0))
+    for (auto node_id : _get_children_node_ids_from_db(_pDb, 0))
         add_node_func(node_id, ++sequence, Gtk::TreeIter());
 
     _close_db();
 }
 
-std::unordered_set<std::string> CtStorageSqlite::_get_table_field_names(std::string_view table_name) 
+/*static*/ std::unordered_set<std::string> CtStorageSqlite::_get_table_field_names(sqlite3* pDb, std::string_view table_name)
 {
     // Note, possible SQL injection - Table names passed to this should be hardcoded 
     auto fields_info_pragma = fmt::format("PRAGMA table_info({})", table_name);
-    sqlite3_stmt_auto stmt(_pDb, fields_info_pragma.c_str());
+    sqlite3_stmt_auto stmt(pDb, fields_info_pragma.c_str());
 
     std::unordered_set<std::string> fields;
     while(sqlite3_step(stmt) == SQLITE_ROW) {
@@ -826,27 +1229,335 @@ std::unordered_set<std::string> CtStorageSqlite::_get_table_field_names(std::str
     return fields;
 }
 
-void CtStorageSqlite::_fix_db_tables()
+/*static*/ std::vector<std::string> CtStorageSqlite::_get_db_tables_fixes(sqlite3* pDb)
 {
     const static std::vector<std::vector<std::string>> tables = {
         {"node", "ts_creation", "INTEGER", "ts_lastsave", "INTEGER"}, {"image", "filename", "TEXT", "link", "TEXT", "time", "TEXT"}
     };
-    
-    try {
-        for (const auto& table : tables) {
-            auto& table_name = table[0];
-            auto node_fields = _get_table_field_names(table_name);
-            for (auto field = table.begin() + 1; field != table.end(); field += 2) {
-                if (node_fields.find(*field) == node_fields.end()) {
-                    auto sql = fmt::format("ALTER TABLE {} ADD COLUMN {} {}", table_name, *field, *(field + 1));
-                    _exec_no_callback(sql.c_str());
-                }
-                // Stop us going off the end
-                if ((field + 1) == table.end()) break;
+
+    std::vector<std::string> fixes;
+    for (const auto& table : tables) {
+        auto& table_name = table[0];
+        auto node_fields = _get_table_field_names(pDb, table_name);
+        for (auto field = table.begin() + 1; field != table.end(); field += 2) {
+            if (node_fields.find(*field) == node_fields.end()) {
+                fixes.push_back(fmt::format("ALTER TABLE {} ADD COLUMN {} {}", table_name, *field, *(field + 1)));
             }
+            // Stop us going off the end
+            if ((field + 1) == table.end()) break;
+        }
+    }
+    return fixes;
+}
+
+/*static*/ void CtStorageSqlite::_fix_db_tables(sqlite3* pDb)
+{
+    try {
+        for (const std::string& sql : _get_db_tables_fixes(pDb)) {
+            _exec_no_callback(pDb, sql.c_str());
         }
 
     } catch(std::runtime_error& e) {
             throw std::runtime_error(fmt::format("Error while adding ts_creation and ts_lastsave to node table: {}", e.what()));
         }
 }
+
+// NULL as ""
+static std::string column_string(sqlite3_stmt* pStmt, const int iCol)
+{
+    const char* pText = reinterpret_cast<const char*>(sqlite3_column_text(pStmt, iCol));
+    return pText ? pText : "";
+}
+
+/**
+ * @brief Reads a .ctb one node at a time as populate_treestore and get_delayed_text_buffer do,
+ * the rich text and the widgets left as stored
+ */
+class CtStorageSqlite::ConvertReader : public CtConvertReader
+{
+public:
+    explicit ConvertReader(const fs::path& file_path)
+    {
+        if (sqlite3_open_v2(file_path.c_str(), &_pDb, SQLITE_OPEN_READONLY, nullptr) != SQLITE_OK)
+        {
+            const std::string error = sqlite3_errmsg(_pDb);
+            sqlite3_close(_pDb);
+            throw std::runtime_error(std::string("sqlite3_open: ") + error);
+        }
+        try
+        {
+            if (not _get_db_tables_fixes(_pDb).empty())
+            {
+                // a document of an older version, the source is not to be changed so the columns are added to a copy in memory
+                sqlite3* pMemDb{nullptr};
+                sqlite3_open(":memory:", &pMemDb);
+                sqlite3_backup* pBackup = sqlite3_backup_init(pMemDb, "main", _pDb, "main");
+                const int rc = pBackup ? sqlite3_backup_step(pBackup, -1) : SQLITE_ERROR;
+                sqlite3_backup_finish(pBackup);
+                sqlite3_close(_pDb);
+                _pDb = pMemDb;
+                if (rc != SQLITE_DONE)
+                    throw std::runtime_error(std::string("sqlite3_backup_step: ") + sqlite3_errstr(rc));
+                _fix_db_tables(_pDb);
+            }
+        }
+        catch (std::exception&)
+        {
+            sqlite3_close(_pDb);
+            throw;
+        }
+    }
+    ~ConvertReader() override { sqlite3_close(_pDb); }
+
+    std::list<gint64> read_bookmarks() override
+    {
+        sqlite3_stmt_auto stmt(_pDb, "SELECT node_id FROM bookmark ORDER BY sequence ASC");
+        if (stmt.is_bad())
+            throw std::runtime_error(ERR_SQLITE_PREPV2 + sqlite3_errmsg(_pDb));
+        std::list<gint64> bookmarks;
+        while (sqlite3_step(stmt) == SQLITE_ROW)
+            bookmarks.push_back(sqlite3_column_int64(stmt, 0));
+        return bookmarks;
+    }
+
+    void read_nodes(const std::function<void(CtConvertNode&)>& on_node) override
+    {
+        sqlite3_stmt_auto stmt(_pDb, (std::string{"SELECT "} + NODE_PROPS_COLUMNS + ", txt, has_codebox, has_table, has_image FROM node WHERE node_id=?").c_str());
+        if (stmt.is_bad())
+            throw std::runtime_error(ERR_SQLITE_PREPV2 + sqlite3_errmsg(_pDb));
+
+        std::function<void(const gint64, const gint64, const gint64)> nodes_from_db;
+        nodes_from_db = [&](const gint64 node_id, const gint64 sequence, const gint64 father_id) {
+            CtConvertNode node;
+            sqlite3_reset(stmt);
+            sqlite3_bind_int64(stmt, 1, node_id);
+            if (sqlite3_step(stmt) != SQLITE_ROW)
+                throw std::runtime_error(std::string("missing node properties for id ") + std::to_string(node_id));
+            _node_props_from_stmt(stmt, node.nodeData);
+            node.nodeData.nodeId = node_id;
+            node.nodeData.sequence = sequence;
+            node.fatherId = father_id;
+            node.text = column_string(stmt, 7);
+            if (node.is_rich_text())
+            {
+                if (sqlite3_column_int64(stmt, 8)) _codeboxes_from_db(node);
+                if (sqlite3_column_int64(stmt, 9)) _tables_from_db(node);
+                if (sqlite3_column_int64(stmt, 10)) _images_from_db(node);
+                std::stable_sort(node.widgets.begin(), node.widgets.end(), [](const CtConvertWidget& lhs, const CtConvertWidget& rhs) {
+                    return lhs.offset < rhs.offset;
+                });
+            }
+            on_node(node);
+
+            gint64 child_sequence{0};
+            for (const gint64 child_node_id : _get_children_node_ids_from_db(_pDb, node_id))
+                nodes_from_db(child_node_id, ++child_sequence, node_id);
+        };
+        gint64 sequence{0};
+        for (const gint64 top_node_id : _get_children_node_ids_from_db(_pDb, 0))
+            nodes_from_db(top_node_id, ++sequence, 0);
+    }
+
+private:
+    // the columns as in _image_from_db, _codebox_from_db and _table_from_db
+    void _images_from_db(CtConvertNode& node)
+    {
+        sqlite3_stmt_auto stmt(_pDb, "SELECT * FROM image WHERE node_id=? ORDER BY offset ASC");
+        if (stmt.is_bad())
+            throw std::runtime_error(ERR_SQLITE_PREPV2 + sqlite3_errmsg(_pDb));
+        sqlite3_bind_int64(stmt, 1, node.nodeData.nodeId);
+        while (SQLITE_ROW == sqlite3_step(stmt))
+        {
+            CtConvertWidget widget;
+            widget.type = CtConvertWidget::Type::Image;
+            widget.offset = sqlite3_column_int64(stmt, 1);
+            widget.justification = column_string(stmt, 2);
+            widget.anchor = column_string(stmt, 3);
+            if (const void* pBlob = sqlite3_column_blob(stmt, 4))
+                widget.rawBlob = std::string(reinterpret_cast<const char*>(pBlob), static_cast<size_t>(sqlite3_column_bytes(stmt, 4)));
+            widget.filename = column_string(stmt, 5);
+            widget.link = column_string(stmt, 6);
+            widget.time = sqlite3_column_double(stmt, 7);
+            node.widgets.push_back(std::move(widget));
+        }
+    }
+
+    void _codeboxes_from_db(CtConvertNode& node)
+    {
+        sqlite3_stmt_auto stmt(_pDb, "SELECT * FROM codebox WHERE node_id=? ORDER BY offset ASC");
+        if (stmt.is_bad())
+            throw std::runtime_error(ERR_SQLITE_PREPV2 + sqlite3_errmsg(_pDb));
+        sqlite3_bind_int64(stmt, 1, node.nodeData.nodeId);
+        while (SQLITE_ROW == sqlite3_step(stmt))
+        {
+            CtConvertWidget widget;
+            widget.type = CtConvertWidget::Type::Codebox;
+            widget.offset = sqlite3_column_int64(stmt, 1);
+            widget.justification = column_string(stmt, 2);
+            widget.text = column_string(stmt, 3);
+            widget.syntax = column_string(stmt, 4);
+            widget.frameWidth = sqlite3_column_int64(stmt, 5);
+            widget.frameHeight = sqlite3_column_int64(stmt, 6);
+            widget.widthInPixels = sqlite3_column_int64(stmt, 7);
+            widget.highlightBrackets = sqlite3_column_int64(stmt, 8);
+            widget.showLineNumbers = sqlite3_column_int64(stmt, 9);
+            node.widgets.push_back(std::move(widget));
+        }
+    }
+
+    void _tables_from_db(CtConvertNode& node)
+    {
+        sqlite3_stmt_auto stmt(_pDb, "SELECT * FROM grid WHERE node_id=? ORDER BY offset ASC");
+        if (stmt.is_bad())
+            throw std::runtime_error(ERR_SQLITE_PREPV2 + sqlite3_errmsg(_pDb));
+        sqlite3_bind_int64(stmt, 1, node.nodeData.nodeId);
+        while (SQLITE_ROW == sqlite3_step(stmt))
+        {
+            CtConvertWidget widget;
+            widget.type = CtConvertWidget::Type::Table;
+            widget.offset = sqlite3_column_int64(stmt, 1);
+            widget.justification = column_string(stmt, 2);
+            widget.text = column_string(stmt, 3);
+            widget.colMin = sqlite3_column_int64(stmt, 4);
+            widget.colMax = sqlite3_column_int64(stmt, 5);
+            node.widgets.push_back(std::move(widget));
+        }
+    }
+
+    sqlite3* _pDb{nullptr};
+};
+
+/**
+ * @brief Writes a .ctb as save_treestore does the first time, all in one transaction
+ */
+class CtStorageSqlite::ConvertWriter : public CtConvertWriter
+{
+public:
+    explicit ConvertWriter(const fs::path& file_path)
+    {
+        if (sqlite3_open_v2(file_path.c_str(), &_pDb, SQLITE_OPEN_READWRITE | SQLITE_OPEN_CREATE, nullptr) != SQLITE_OK)
+        {
+            const std::string error = sqlite3_errmsg(_pDb);
+            sqlite3_close(_pDb);
+            throw std::runtime_error(std::string("sqlite3_open: ") + error);
+        }
+        try
+        {
+            _create_all_tables_in_db(_pDb);
+            _exec_no_callback(_pDb, "BEGIN TRANSACTION");
+            if (not _stmtNode.prepare(_pDb, TABLE_NODE_INSERT) or
+                not _stmtChildren.prepare(_pDb, TABLE_CHILDREN_INSERT) or
+                not _stmtImage.prepare(_pDb, TABLE_IMAGE_INSERT) or
+                not _stmtTable.prepare(_pDb, TABLE_TABLE_INSERT) or
+                not _stmtCodebox.prepare(_pDb, TABLE_CODEBOX_INSERT))
+            {
+                throw std::runtime_error(ERR_SQLITE_PREPV2 + sqlite3_errmsg(_pDb));
+            }
+        }
+        catch (std::exception&)
+        {
+            sqlite3_close_v2(_pDb);
+            throw;
+        }
+    }
+    // closed once the statements are finalized
+    ~ConvertWriter() override { sqlite3_close_v2(_pDb); }
+
+    void write_bookmarks(const std::list<gint64>& bookmarks) override
+    {
+        _write_bookmarks_to_db(_pDb, bookmarks);
+    }
+
+    void write_node(const CtConvertNode& node) override
+    {
+        const gint64 node_id = node.nodeData.nodeId;
+        sqlite3_bind_int64(_stmtChildren, 1, node_id);
+        sqlite3_bind_int64(_stmtChildren, 2, node.fatherId);
+        sqlite3_bind_int64(_stmtChildren, 3, node.nodeData.sequence);
+        _step_done(_stmtChildren);
+
+        bool has_codebox{false};
+        bool has_table{false};
+        bool has_image{false};
+        for (const CtConvertWidget& widget : node.widgets)
+        {
+            switch (widget.type)
+            {
+                case CtConvertWidget::Type::Image: has_image = true; _write_image(node_id, widget); break;
+                case CtConvertWidget::Type::Table: has_table = true; _write_table(node_id, widget); break;
+                case CtConvertWidget::Type::Codebox: has_codebox = true; _write_codebox(node_id, widget); break;
+            }
+        }
+        _write_node_row(_pDb, _stmtNode, node.nodeData, node.text, has_codebox, has_table, has_image);
+    }
+
+    void finish() override
+    {
+        _exec_no_callback(_pDb, "COMMIT");
+    }
+
+private:
+    void _step_done(sqlite3_stmt_auto& stmt)
+    {
+        if (sqlite3_step(stmt) != SQLITE_DONE)
+            throw std::runtime_error(ERR_SQLITE_STEP + sqlite3_errmsg(_pDb));
+        sqlite3_reset(stmt);
+    }
+
+    // the columns as in the to_sqlite of the widgets
+    void _write_image(const gint64 node_id, const CtConvertWidget& widget)
+    {
+        sqlite3_bind_int64(_stmtImage, 1, node_id);
+        sqlite3_bind_int64(_stmtImage, 2, widget.offset);
+        sqlite3_bind_text(_stmtImage, 3, widget.justification.c_str(), widget.justification.size(), SQLITE_STATIC);
+        sqlite3_bind_text(_stmtImage, 4, widget.anchor.c_str(), widget.anchor.size(), SQLITE_STATIC);
+        sqlite3_bind_blob(_stmtImage, 5, widget.rawBlob.c_str(), widget.rawBlob.size(), SQLITE_STATIC);
+        sqlite3_bind_text(_stmtImage, 6, widget.filename.c_str(), widget.filename.size(), SQLITE_STATIC);
+        sqlite3_bind_text(_stmtImage, 7, widget.link.c_str(), widget.link.size(), SQLITE_STATIC);
+        sqlite3_bind_double(_stmtImage, 8, widget.time); // the fraction kept for a later conversion, _image_from_db drops it
+        _step_done(_stmtImage);
+    }
+
+    void _write_table(const gint64 node_id, const CtConvertWidget& widget)
+    {
+        sqlite3_bind_int64(_stmtTable, 1, node_id);
+        sqlite3_bind_int64(_stmtTable, 2, widget.offset);
+        sqlite3_bind_text(_stmtTable, 3, widget.justification.c_str(), widget.justification.size(), SQLITE_STATIC);
+        sqlite3_bind_text(_stmtTable, 4, widget.text.c_str(), widget.text.size(), SQLITE_STATIC);
+        sqlite3_bind_int64(_stmtTable, 5, widget.colMin);
+        sqlite3_bind_int64(_stmtTable, 6, widget.colMax);
+        _step_done(_stmtTable);
+    }
+
+    void _write_codebox(const gint64 node_id, const CtConvertWidget& widget)
+    {
+        sqlite3_bind_int64(_stmtCodebox, 1, node_id);
+        sqlite3_bind_int64(_stmtCodebox, 2, widget.offset);
+        sqlite3_bind_text(_stmtCodebox, 3, widget.justification.c_str(), widget.justification.size(), SQLITE_STATIC);
+        sqlite3_bind_text(_stmtCodebox, 4, widget.text.c_str(), widget.text.size(), SQLITE_STATIC);
+        sqlite3_bind_text(_stmtCodebox, 5, widget.syntax.c_str(), widget.syntax.size(), SQLITE_STATIC);
+        sqlite3_bind_int64(_stmtCodebox, 6, widget.frameWidth);
+        sqlite3_bind_int64(_stmtCodebox, 7, widget.frameHeight);
+        sqlite3_bind_int64(_stmtCodebox, 8, widget.widthInPixels);
+        sqlite3_bind_int64(_stmtCodebox, 9, widget.highlightBrackets);
+        sqlite3_bind_int64(_stmtCodebox, 10, widget.showLineNumbers);
+        _step_done(_stmtCodebox);
+    }
+
+    sqlite3*          _pDb{nullptr};
+    sqlite3_stmt_auto _stmtNode;
+    sqlite3_stmt_auto _stmtChildren;
+    sqlite3_stmt_auto _stmtImage;
+    sqlite3_stmt_auto _stmtTable;
+    sqlite3_stmt_auto _stmtCodebox;
+};
+
+/*static*/ std::unique_ptr<CtConvertReader> CtStorageSqlite::get_convert_reader(const fs::path& file_path)
+{
+    return std::make_unique<ConvertReader>(file_path);
+}
+
+/*static*/ std::unique_ptr<CtConvertWriter> CtStorageSqlite::get_convert_writer(const fs::path& file_path)
+{
+    return std::make_unique<ConvertWriter>(file_path);
+}
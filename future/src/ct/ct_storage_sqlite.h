@@ -23,6 +23,8 @@
 
 #include "ct_types.h"
 #include "ct_filesystem.h"
+#include "ct_thread_pool.h"
+#include "ct_prefetch_cache.h"
 #include <sqlite3.h>
 #include <glibmm/refptr.h>
 #include <gtksourceviewmm/buffer.h>
@@ -33,6 +35,10 @@ class CtMainWin;
 class CtAnchoredWidget;
 class CtTreeIter;
 class CtStorageCache;
+struct CtSqliteNodeContent;
+using CtSqlitePrefetchCache = CtPrefetchCache<CtSqliteNodeContent>;
+class CtConvertReader;
+class CtConvertWriter;
 
 class CtStorageSqlite : public CtStorageEntity
 {
@@ -46,54 +52,100 @@ public:
 
     bool populate_treestore(const fs::path& file_path, Glib::ustring& error) override;
     bool save_treestore(const fs::path& file_path, const CtStorageSyncPending& syncPending, Glib::ustring& error) override;
+    std::function<void()> snapshot_treestore(const fs::path& file_path, const CtStorageSyncPending& syncPending, const bool need_vacuum) override;
     void vacuum() override;
     void import_nodes(const fs::path& path) override;
 
     Glib::RefPtr<Gsv::Buffer> get_delayed_text_buffer(const gint64& node_id,
                                                       const std::string& syntax,
                                                       std::list<CtAnchoredWidget*>& widgets) const override;
+    void prefetch_delayed_text_buffers(const std::vector<gint64>& node_ids) override;
+    size_t get_node_summary(const gint64& node_id, Glib::ustring& text, CtSummaryInfo& summaryInfo) const override;
+
 private:
     void _open_db(const fs::path& path);
     void _close_db();
     bool _check_database_integrity();
 
     Gtk::TreeIter       _node_from_db(gint64 node_id, gint64 sequence, Gtk::TreeIter parent_iter, gint64 new_id);
+    // the columns NODE_PROPS_COLUMNS of the node table, shared with the reading and writing for the conversions
+    static void         _node_props_from_stmt(sqlite3_stmt* pStmt, CtNodeData& nodeData);
+    static void         _write_node_row(sqlite3* pDb,
+                                        sqlite3_stmt* pStmt,
+                                        const CtNodeData& nodeData,
+                                        const std::string& node_txt,
+                                        const bool has_codebox,
+                                        const bool has_table,
+                                        const bool has_image);
 
     
     /**
      * @brief Check that the database contains the required tables
      * 
-     * @param db 
+     * @param pDb 
+     */
+    static void         _fix_db_tables(sqlite3* pDb);
+    /**
+     * @brief Get the statements adding the columns missing in the documents of older versions
+     * @param pDb 
+     * @return std::vector<std::string> 
      */
-    void                _fix_db_tables();
+    static std::vector<std::string> _get_db_tables_fixes(sqlite3* pDb);
     /**
      * @brief Get a list of field names for a table
      * @warning Only hardcoded table names should be passed to this method
+     * @param pDb 
      * @param table_name 
      * @return std::unordered_set<std::string> 
      */
-    std::unordered_set<std::string> _get_table_field_names(std::string_view table_name);
-
-    void                _image_from_db(const gint64& nodeId, std::list<CtAnchoredWidget*>& anchoredWidgets) const;
-    void                _codebox_from_db(const gint64& nodeId, std::list<CtAnchoredWidget*>& anchoredWidgets) const;
-    void                _table_from_db(const gint64& nodeId, std::list<CtAnchoredWidget*>& anchoredWidgets) const;
-
-    void                _create_all_tables_in_db();
-    void                _write_bookmarks_to_db(const std::list<gint64>& bookmarks);
-    void                _write_node_to_db(CtTreeIter* ct_tree_iter,
+    static std::unordered_set<std::string> _get_table_field_names(sqlite3* pDb, std::string_view table_name);
+
+    // the reading and parsing of a node buffer, they run on the thread of pDb
+    static std::unique_ptr<CtSqliteNodeContent> _node_content_from_db(sqlite3* pDb, const gint64 node_id);
+    static void         _image_from_db(sqlite3* pDb, const gint64& nodeId, CtSqliteNodeContent& nodeContent);
+    static void         _codebox_from_db(sqlite3* pDb, const gint64& nodeId, CtSqliteNodeContent& nodeContent);
+    static void         _table_from_db(sqlite3* pDb, const gint64& nodeId, CtSqliteNodeContent& nodeContent);
+    // the text buffer and the widgets, on the main thread
+    Glib::RefPtr<Gsv::Buffer> _buffer_from_node_content(CtSqliteNodeContent& nodeContent,
+                                                        const std::string& syntax,
+                                                        std::list<CtAnchoredWidget*>& widgets) const;
+    static void         _prefetch_from_db(const fs::path& file_path,
+                                          const std::vector<gint64>& node_ids,
+                                          std::shared_ptr<CtSqlitePrefetchCache> pPrefetchCache,
+                                          const size_t generation,
+                                          const CtCancelToken& token);
+
+    static void         _create_all_tables_in_db(sqlite3* pDb);
+    static void         _write_bookmarks_to_db(sqlite3* pDb, const std::list<gint64>& bookmarks);
+    void                _write_node_to_db(sqlite3* pStagingDb,
+                                          CtTreeIter* ct_tree_iter,
                                           const gint64 sequence,
                                           const gint64 node_father_id,
                                           const CtStorageNodeState& write_dict,
-                                          const int start_offset, const int end_offset,
                                           CtStorageCache* storage_cache);
+    static void         _write_staged_to_db(const fs::path& file_path,
+                                            const std::string& staging_uri,
+                                            const CtStorageSyncPending& syncPending,
+                                            const bool need_vacuum);
 
-    std::list<gint64>   _get_children_node_ids_from_db(gint64 father_id);
-    void                _remove_db_node_with_children(const gint64 node_id);
+    static std::list<gint64> _get_children_node_ids_from_db(sqlite3* pDb, gint64 father_id);
+    static std::list<std::pair<gint64, gint64>> _get_children_sequences_from_db(sqlite3* pDb, gint64 father_id); // node_id, sequence
+    static void         _remove_db_node_with_children(sqlite3* pDb, const gint64 node_id);
 
-    void                _exec_no_callback(const char* sqlCmd);
-    void                _exec_bind_int64(const char* sqlCmd, const gint64 bind_int64);
+    static void         _exec_no_callback(sqlite3* pDb, const char* sqlCmd);
+    static void         _exec_bind_int64(sqlite3* pDb, const char* sqlCmd, const gint64 bind_int64);
+
+    // the nodes as stored, without text buffers nor widgets, for CtStorageConvert
+    class ConvertReader;
+    class ConvertWriter;
 
 public:
+    // consistent copy of a database also while in use, in steps that release the lock on the source in between
+    static void backup_db_file(const fs::path& from, const fs::path& to);
+
+    static std::unique_ptr<CtConvertReader> get_convert_reader(const fs::path& file_path);
+    static std::unique_ptr<CtConvertWriter> get_convert_writer(const fs::path& file_path);
+
     static const char TABLE_NODE_CREATE[];
     static const char TABLE_NODE_INSERT[];
     static const char TABLE_NODE_DELETE[];
@@ -120,4 +172,7 @@ private:
     CtMainWin*    _pCtMainWin;
     sqlite3*      _pDb{nullptr};
     fs::path      _file_path;
+
+    std::shared_ptr<CtSqlitePrefetchCache> _pPrefetchCache;
+    CtCancelToken _prefetchToken;
 };
@@ -28,7 +28,10 @@
 #include "ct_table.h"
 #include "ct_main_win.h"
 #include "ct_storage_control.h"
+#include "ct_storage_convert.h"
 #include "ct_logging.h"
+#include "ct_trace.h"
+#include <algorithm>
 #include <fstream>
 
 
@@ -88,33 +91,11 @@ bool CtStorageXml::populate_treestore(const fs::path& file_path, Glib::ustring&
     }
  }
 
-bool CtStorageXml::save_treestore(const fs::path& file_path, const CtStorageSyncPending&, Glib::ustring& error)
+bool CtStorageXml::save_treestore(const fs::path& file_path, const CtStorageSyncPending& syncPending, Glib::ustring& error)
 {
     try
     {
-        xmlpp::Document xml_doc;
-        xml_doc.create_root_node(CtConst::APP_NAME);
-
-        // save bookmarks
-        Glib::ustring rejoined;
-        str::join_numbers(_pCtMainWin->get_tree_store().bookmarks_get(), rejoined, ",");
-        xmlpp::Element* p_bookmarks_node = xml_doc.get_root_node()->add_child("bookmarks");
-        p_bookmarks_node->set_attribute("list", rejoined);
-
-        CtStorageCache storage_cache;
-        storage_cache.generate_cache(_pCtMainWin, nullptr, true);
-
-        // save nodes
-        auto ct_tree_iter = _pCtMainWin->get_tree_store().get_ct_iter_first();
-        while (ct_tree_iter)
-        {
-            _nodes_to_xml(&ct_tree_iter, xml_doc.get_root_node(), &storage_cache);
-            ct_tree_iter++;
-        }
-
-        // write file
-        xml_doc.write_to_file_formatted(file_path.string());
-
+        snapshot_treestore(file_path, syncPending, false/*need_vacuum*/)();
         return true;
     }
     catch (std::exception& e)
@@ -124,6 +105,35 @@ bool CtStorageXml::save_treestore(const fs::path& file_path, const CtStorageSync
     }
 }
 
+std::function<void()> CtStorageXml::snapshot_treestore(const fs::path& file_path, const CtStorageSyncPending&, const bool/*need_vacuum*/)
+{
+    auto pXmlDoc = std::make_shared<xmlpp::Document>();
+    pXmlDoc->create_root_node(CtConst::APP_NAME);
+
+    // save bookmarks
+    Glib::ustring rejoined;
+    str::join_numbers(_pCtMainWin->get_tree_store().bookmarks_get(), rejoined, ",");
+    xmlpp::Element* p_bookmarks_node = pXmlDoc->get_root_node()->add_child("bookmarks");
+    p_bookmarks_node->set_attribute("list", rejoined);
+
+    CtStorageCache storage_cache;
+    storage_cache.generate_cache(_pCtMainWin, nullptr, true);
+
+    // save nodes
+    auto ct_tree_iter = _pCtMainWin->get_tree_store().get_ct_iter_first();
+    while (ct_tree_iter)
+    {
+        _nodes_to_xml(&ct_tree_iter, pXmlDoc->get_root_node(), &storage_cache);
+        ct_tree_iter++;
+    }
+
+    // write file, the document is not shared with the tree
+    return [pXmlDoc, file_path]() {
+        CT_TRACE_SCOPE("save write xml");
+        pXmlDoc->write_to_file_formatted(file_path.string());
+    };
+}
+
 void CtStorageXml::vacuum()
 {
 }
@@ -161,22 +171,23 @@ Glib::RefPtr<Gsv::Buffer> CtStorageXml::get_delayed_text_buffer(const gint64& no
     return  CtStorageXmlHelper(_pCtMainWin).create_buffer_and_widgets_from_xml(xml_element, syntax, widgets, nullptr, -1);
 }
 
+size_t CtStorageXml::get_node_summary(const gint64& node_id, Glib::ustring& text, CtSummaryInfo& summaryInfo) const
+{
+    auto iter = _delayed_text_buffers.find(node_id);
+    if (iter == _delayed_text_buffers.end()) {
+        spdlog::error(" ! cannot found xml buffer in CtStorageXml::get_node_summary, node_id: {}", node_id);
+        return 0;
+    }
+    auto xml_element = dynamic_cast<xmlpp::Element*>(iter->second->get_root_node()->get_first_child());
+    return xml_element ? CtStorageXmlHelper::summary_from_xml(xml_element, text, summaryInfo) : 0;
+}
+
 Gtk::TreeIter CtStorageXml::_node_from_xml(xmlpp::Element* xml_element, gint64 sequence, Gtk::TreeIter parent_iter, gint64 new_id)
 {
     CtNodeData node_data;
-    if (new_id == -1)
-        node_data.nodeId = CtStrUtil::gint64_from_gstring(xml_element->get_attribute_value("unique_id").c_str());
-    else
+    CtStorageXmlHelper::node_props_from_xml(xml_element, node_data);
+    if (new_id != -1)
         node_data.nodeId = new_id;
-    node_data.name = xml_element->get_attribute_value("name");
-    node_data.syntax = xml_element->get_attribute_value("prog_lang");
-    node_data.tags = xml_element->get_attribute_value("tags");
-    node_data.isRO = CtStrUtil::is_str_true(xml_element->get_attribute_value("readonly"));
-    node_data.customIconId = (guint32)CtStrUtil::gint64_from_gstring(xml_element->get_attribute_value("custom_icon_id").c_str());
-    node_data.isBold = CtStrUtil::is_str_true(xml_element->get_attribute_value("is_bold"));
-    node_data.foregroundRgb24 = xml_element->get_attribute_value("foreground");
-    node_data.tsCreation = CtStrUtil::gint64_from_gstring(xml_element->get_attribute_value("ts_creation").c_str());
-    node_data.tsLastSave = CtStrUtil::gint64_from_gstring(xml_element->get_attribute_value("ts_lastSave").c_str());
     node_data.sequence = sequence;
     if (new_id == -1)
     {
@@ -205,7 +216,7 @@ void CtStorageXml::_nodes_to_xml(CtTreeIter* ct_tree_iter, xmlpp::Element* p_nod
     }
 }
 
-std::unique_ptr<xmlpp::DomParser> CtStorageXml::_get_parser(const fs::path& file_path)
+/*static*/ std::unique_ptr<xmlpp::DomParser> CtStorageXml::_get_parser(const fs::path& file_path)
 {
     // open file
     auto parser = std::make_unique<xmlpp::DomParser>();
@@ -241,17 +252,10 @@ CtStorageXmlHelper::CtStorageXmlHelper(CtMainWin* pCtMainWin) : _pCtMainWin(pCtM
 
 xmlpp::Element* CtStorageXmlHelper::node_to_xml(CtTreeIter* ct_tree_iter, xmlpp::Element* p_node_parent, bool with_widgets, CtStorageCache* storage_cache)
 {
+    CtNodeData node_data;
+    _pCtMainWin->get_tree_store().get_node_data(*ct_tree_iter, node_data);
     xmlpp::Element* p_node_node = p_node_parent->add_child("node");
-    p_node_node->set_attribute("name", ct_tree_iter->get_node_name());
-    p_node_node->set_attribute("unique_id", std::to_string(ct_tree_iter->get_node_id()));
-    p_node_node->set_attribute("prog_lang", ct_tree_iter->get_node_syntax_highlighting());
-    p_node_node->set_attribute("tags", ct_tree_iter->get_node_tags());
-    p_node_node->set_attribute("readonly", std::to_string(ct_tree_iter->get_node_read_only()));
-    p_node_node->set_attribute("custom_icon_id", std::to_string(ct_tree_iter->get_node_custom_icon_id()));
-    p_node_node->set_attribute("is_bold", std::to_string(ct_tree_iter->get_node_is_bold()));
-    p_node_node->set_attribute("foreground", ct_tree_iter->get_node_foreground());
-    p_node_node->set_attribute("ts_creation", std::to_string(ct_tree_iter->get_node_creating_time()));
-    p_node_node->set_attribute("ts_lastsave", std::to_string(ct_tree_iter->get_node_modification_time()));
+    node_props_to_xml(node_data, p_node_node);
 
     Glib::RefPtr<Gsv::Buffer> buffer = ct_tree_iter->get_node_text_buffer();
     save_buffer_no_widgets_to_xml(p_node_node, buffer, 0, -1, 'n');
@@ -263,6 +267,34 @@ xmlpp::Element* CtStorageXmlHelper::node_to_xml(CtTreeIter* ct_tree_iter, xmlpp:
     return p_node_node;
 }
 
+/*static*/ void CtStorageXmlHelper::node_props_from_xml(xmlpp::Element* xml_element, CtNodeData& nodeData)
+{
+    nodeData.nodeId = CtStrUtil::gint64_from_gstring(xml_element->get_attribute_value("unique_id").c_str());
+    nodeData.name = xml_element->get_attribute_value("name");
+    nodeData.syntax = xml_element->get_attribute_value("prog_lang");
+    nodeData.tags = xml_element->get_attribute_value("tags");
+    nodeData.isRO = CtStrUtil::is_str_true(xml_element->get_attribute_value("readonly"));
+    nodeData.customIconId = (guint32)CtStrUtil::gint64_from_gstring(xml_element->get_attribute_value("custom_icon_id").c_str());
+    nodeData.isBold = CtStrUtil::is_str_true(xml_element->get_attribute_value("is_bold"));
+    nodeData.foregroundRgb24 = xml_element->get_attribute_value("foreground");
+    nodeData.tsCreation = CtStrUtil::gint64_from_gstring(xml_element->get_attribute_value("ts_creation").c_str());
+    nodeData.tsLastSave = CtStrUtil::gint64_from_gstring(xml_element->get_attribute_value("ts_lastsave").c_str());
+}
+
+/*static*/ void CtStorageXmlHelper::node_props_to_xml(const CtNodeData& nodeData, xmlpp::Element* p_node_node)
+{
+    p_node_node->set_attribute("name", nodeData.name);
+    p_node_node->set_attribute("unique_id", std::to_string(nodeData.nodeId));
+    p_node_node->set_attribute("prog_lang", nodeData.syntax);
+    p_node_node->set_attribute("tags", nodeData.tags);
+    p_node_node->set_attribute("readonly", std::to_string(nodeData.isRO));
+    p_node_node->set_attribute("custom_icon_id", std::to_string(nodeData.customIconId));
+    p_node_node->set_attribute("is_bold", std::to_string(nodeData.isBold));
+    p_node_node->set_attribute("foreground", nodeData.foregroundRgb24);
+    p_node_node->set_attribute("ts_creation", std::to_string(nodeData.tsCreation));
+    p_node_node->set_attribute("ts_lastsave", std::to_string(nodeData.tsLastSave));
+}
+
 Glib::RefPtr<Gsv::Buffer> CtStorageXmlHelper::create_buffer_and_widgets_from_xml(xmlpp::Element* parent_xml_element, const Glib::ustring& /*syntax*/,
                                                                     std::list<CtAnchoredWidget*>& widgets, Gtk::TextIter* text_insert_pos, int force_offset)
 {
@@ -312,34 +344,68 @@ void CtStorageXmlHelper::get_text_buffer_one_slot_from_xml(Glib::RefPtr<Gsv::Buf
 }
 
 
+/*static*/ size_t CtStorageXmlHelper::summary_from_xml(xmlpp::Element* parent_xml_element, Glib::ustring& text, CtSummaryInfo& summaryInfo)
+{
+    size_t widgets_num{0};
+    for (xmlpp::Node* slot_node : parent_xml_element->get_children())
+    {
+        auto slot_element = dynamic_cast<xmlpp::Element*>(slot_node);
+        if (!slot_element) continue;
+        const Glib::ustring slot_element_name = slot_element->get_name();
+        if (slot_element_name == "rich_text")
+        {
+            if (xmlpp::TextNode* text_node = slot_element->get_child_text())
+                text += text_node->get_content();
+            continue;
+        }
+        if (slot_element_name == "encoded_png")
+        {
+            if (!slot_element->get_attribute_value("anchor").empty())        ++summaryInfo.anchors_num;
+            else if (!slot_element->get_attribute_value("filename").empty()) ++summaryInfo.embfile_num;
+            else                                                             ++summaryInfo.images_num;
+        }
+        else if (slot_element_name == "table")   ++summaryInfo.tables_num;
+        else if (slot_element_name == "codebox") ++summaryInfo.codeboxes_num;
+        else continue;
+        ++widgets_num;
+    }
+    return widgets_num;
+}
+
 Glib::RefPtr<Gsv::Buffer> CtStorageXmlHelper::create_buffer_no_widgets(const Glib::ustring& syntax, const char* xml_content)
 {
-    xmlpp::DomParser parser;
+    std::unique_ptr<xmlpp::DomParser> pParser = parse_buffer_xml(xml_content);
+    std::list<CtAnchoredWidget*> widgets;
+    if (pParser && pParser->get_document() && pParser->get_document()->get_root_node())
+        return create_buffer_and_widgets_from_xml(pParser->get_document()->get_root_node(), syntax, widgets, nullptr, -1);
+    return Glib::RefPtr<Gsv::Buffer>();
+}
+
+/*static*/ std::unique_ptr<xmlpp::DomParser> CtStorageXmlHelper::parse_buffer_xml(const char* xml_content)
+{
+    auto pParser = std::make_unique<xmlpp::DomParser>();
     try
     {
-        parser.parse_memory(xml_content);
+        pParser->parse_memory(xml_content);
     }
     catch (xmlpp::parse_error& e)
     {
-        spdlog::error("CtStorageXmlHelper:create_buffer_no_widgets: {}", e.what());
+        spdlog::error("CtStorageXmlHelper:parse_buffer_xml: {}", e.what());
         try
         {
-            parser.parse_memory(str::sanitize_bad_symbols(xml_content));
-            spdlog::info("CtStorageXmlHelper:create_buffer_no_widgets: xml is sanitized");
+            pParser->parse_memory(str::sanitize_bad_symbols(xml_content));
+            spdlog::info("CtStorageXmlHelper:parse_buffer_xml: xml is sanitized");
         }
         catch (std::exception& e)
         {
-            spdlog::error("CtStorageXmlHelper:create_buffer_no_widgets: sanitizing xml is failed, {}", e.what());
-            return Glib::RefPtr<Gsv::Buffer>();
+            spdlog::error("CtStorageXmlHelper:parse_buffer_xml: sanitizing xml is failed, {}", e.what());
+            return nullptr;
         }
     }
-    std::list<CtAnchoredWidget*> widgets;
-    if (parser.get_document() && parser.get_document()->get_root_node())
-        return create_buffer_and_widgets_from_xml(parser.get_document()->get_root_node(), syntax, widgets, nullptr, -1);
-    return Glib::RefPtr<Gsv::Buffer>();
+    return pParser;
 }
 
-bool CtStorageXmlHelper::populate_table_matrix(std::vector<std::vector<CtTableCell*>>& tableMatrix, const char* xml_content)
+/*static*/ bool CtStorageXmlHelper::populate_table_matrix(std::vector<std::vector<Glib::ustring>>& tableMatrix, const char* xml_content)
 {
     xmlpp::DomParser parser;
     parser.parse_memory(xml_content);
@@ -351,23 +417,21 @@ bool CtStorageXmlHelper::populate_table_matrix(std::vector<std::vector<CtTableCe
     return false;
 }
 
-void CtStorageXmlHelper::populate_table_matrix(std::vector<std::vector<CtTableCell*>>& tableMatrix, xmlpp::Element* xml_element)
+/*static*/ void CtStorageXmlHelper::populate_table_matrix(std::vector<std::vector<Glib::ustring>>& tableMatrix, xmlpp::Element* xml_element)
 {
     for (xmlpp::Node* pNodeRow : xml_element->get_children("row"))
     {
-        tableMatrix.push_back(CtTableRow{});
+        tableMatrix.push_back(std::vector<Glib::ustring>{});
         for (xmlpp::Node* pNodeCell : pNodeRow->get_children("cell"))
         {
             xmlpp::TextNode* pTextNode = static_cast<xmlpp::Element*>(pNodeCell)->get_child_text();
-            const Glib::ustring textContent = pTextNode ? pTextNode->get_content() : "";
-            tableMatrix.back().push_back(new CtTableCell(_pCtMainWin, textContent, CtConst::TABLE_CELL_TEXT_ID));
+            tableMatrix.back().push_back(pTextNode ? pTextNode->get_content() : "");
         }
     }
     bool head_back = xml_element->get_attribute_value("head_front").empty();
-    if (head_back)
+    if (head_back and not tableMatrix.empty())
     {
-        tableMatrix.insert(tableMatrix.begin(), tableMatrix.back());
-        tableMatrix.pop_back();
+        std::rotate(tableMatrix.rbegin(), tableMatrix.rbegin() + 1, tableMatrix.rend());
     }
 }
 
@@ -474,8 +538,247 @@ CtAnchoredWidget* CtStorageXmlHelper::_create_table_from_xml(xmlpp::Element* xml
     const int colMin = std::stoi(xml_element->get_attribute_value("col_min"));
     const int colMax = std::stoi(xml_element->get_attribute_value("col_max"));
 
-    CtTableMatrix tableMatrix;
-    populate_table_matrix(tableMatrix, xml_element);
+    CtTableTexts tableTexts;
+    populate_table_matrix(tableTexts, xml_element);
+
+    return CtTable::create(_pCtMainWin, std::move(tableTexts), colMin, colMax, charOffset, justification);
+}
+
+static std::string element_text(const xmlpp::Element* xml_element)
+{
+    const xmlpp::TextNode* pTextNode = xml_element->get_child_text();
+    return pTextNode ? pTextNode->get_content() : "";
+}
+
+/**
+ * @brief Reads a .ctd walking it as populate_treestore does, the rich text and the widgets left as stored
+ */
+class CtStorageXml::ConvertReader : public CtConvertReader
+{
+public:
+    explicit ConvertReader(const fs::path& file_path)
+     : _pParser{_get_parser(file_path)}
+    {}
+
+    std::list<gint64> read_bookmarks() override
+    {
+        std::list<gint64> bookmarks;
+        for (xmlpp::Node* xml_node : _pParser->get_document()->get_root_node()->get_children("bookmarks"))
+        {
+            const Glib::ustring bookmarks_csv = static_cast<xmlpp::Element*>(xml_node)->get_attribute_value("list");
+            for (gint64 node_id : CtStrUtil::gstring_split_to_int64(bookmarks_csv.c_str(), ","))
+                bookmarks.push_back(node_id);
+        }
+        return bookmarks;
+    }
+
+    void read_nodes(const std::function<void(CtConvertNode&)>& on_node) override
+    {
+        std::function<void(xmlpp::Element*, const gint64, const gint64)> nodes_from_xml;
+        nodes_from_xml = [&](xmlpp::Element* xml_element, const gint64 sequence, const gint64 father_id) {
+            CtConvertNode node;
+            CtStorageXmlHelper::node_props_from_xml(xml_element, node.nodeData);
+            node.nodeData.sequence = sequence;
+            node.fatherId = father_id;
+            _node_content_from_xml(xml_element, node);
+            on_node(node);
+
+            gint64 child_sequence{0};
+            for (xmlpp::Node* xml_node : xml_element->get_children("node"))
+                nodes_from_xml(static_cast<xmlpp::Element*>(xml_node), ++child_sequence, node.nodeData.nodeId);
+        };
+        gint64 sequence{0};
+        for (xmlpp::Node* xml_node : _pParser->get_document()->get_root_node()->get_children("node"))
+            nodes_from_xml(static_cast<xmlpp::Element*>(xml_node), ++sequence, 0);
+    }
+
+private:
+    // the rich text slots into one xml as in the sqlite node table, the widgets as in their to_xml
+    static void _node_content_from_xml(xmlpp::Element* xml_element, CtConvertNode& node)
+    {
+        if (not node.is_rich_text())
+        {
+            for (xmlpp::Node* xml_slot : xml_element->get_children("rich_text"))
+                node.text += element_text(static_cast<xmlpp::Element*>(xml_slot));
+            return;
+        }
+
+        xmlpp::Document rich_text_doc;
+        xmlpp::Element* p_rich_text_root = rich_text_doc.create_root_node("node");
+        for (xmlpp::Node* xml_slot : xml_element->get_children())
+        {
+            xmlpp::Element* slot_element = dynamic_cast<xmlpp::Element*>(xml_slot);
+            if (not slot_element) continue;
+            const Glib::ustring slot_name = slot_element->get_name();
+            if (slot_name == "rich_text")
+            {
+                p_rich_text_root->import_node(slot_element);
+                continue;
+            }
+            CtConvertWidget widget;
+            widget.offset = CtStrUtil::gint64_from_gstring(slot_element->get_attribute_value("char_offset").c_str());
+            widget.justification = slot_element->get_attribute_value(CtConst::TAG_JUSTIFICATION);
+            if (slot_name == "encoded_png")
+            {
+                widget.type = CtConvertWidget::Type::Image;
+                widget.anchor = slot_element->get_attribute_value("anchor");
+                widget.filename = slot_element->get_attribute_value("filename");
+                widget.link = slot_element->get_attribute_value("link");
+                const std::string time_str = slot_element->get_attribute_value("time");
+                widget.time = time_str.empty() ? 0 : g_ascii_strtod(time_str.c_str(), nullptr);
+                if (widget.anchor.empty())
+                    widget.rawBlob = Glib::Base64::decode(element_text(slot_element));
+            }
+            else if (slot_name == "table")
+            {
+                widget.type = CtConvertWidget::Type::Table;
+                widget.colMin = CtStrUtil::gint64_from_gstring(slot_element->get_attribute_value("col_min").c_str());
+                widget.colMax = CtStrUtil::gint64_from_gstring(slot_element->get_attribute_value("col_max").c_str());
+                xmlpp::Document table_doc;
+                xmlpp::Element* p_table_root = table_doc.create_root_node("table");
+                for (xmlpp::Node* xml_row : slot_element->get_children("row"))
+                    p_table_root->import_node(xml_row);
+                widget.text = table_doc.write_to_string();
+            }
+            else if (slot_name == "codebox")
+            {
+                widget.type = CtConvertWidget::Type::Codebox;
+                widget.text = element_text(slot_element);
+                widget.syntax = slot_element->get_attribute_value("syntax_highlighting");
+                widget.frameWidth = CtStrUtil::gint64_from_gstring(slot_element->get_attribute_value("frame_width").c_str());
+                widget.frameHeight = CtStrUtil::gint64_from_gstring(slot_element->get_attribute_value("frame_height").c_str());
+                widget.widthInPixels = CtStrUtil::is_str_true(slot_element->get_attribute_value("width_in_pixels"));
+                widget.highlightBrackets = CtStrUtil::is_str_true(slot_element->get_attribute_value("highlight_brackets"));
+                widget.showLineNumbers = CtStrUtil::is_str_true(slot_element->get_attribute_value("show_line_numbers"));
+            }
+            else
+            {
+                continue; // child node
+            }
+            node.widgets.push_back(std::move(widget));
+        }
+        node.text = rich_text_doc.write_to_string();
+        std::stable_sort(node.widgets.begin(), node.widgets.end(), [](const CtConvertWidget& lhs, const CtConvertWidget& rhs) {
+            return lhs.offset < rhs.offset;
+        });
+    }
+
+    std::unique_ptr<xmlpp::DomParser> _pParser;
+};
+
+/**
+ * @brief Writes a .ctd as save_treestore does
+ */
+class CtStorageXml::ConvertWriter : public CtConvertWriter
+{
+public:
+    explicit ConvertWriter(const fs::path& file_path)
+     : _file_path{file_path}
+    {
+        _xml_doc.create_root_node(CtConst::APP_NAME);
+    }
+
+    void write_bookmarks(const std::list<gint64>& bookmarks) override
+    {
+        Glib::ustring rejoined;
+        str::join_numbers(bookmarks, rejoined, ",");
+        _xml_doc.get_root_node()->add_child("bookmarks")->set_attribute("list", rejoined);
+    }
+
+    void write_node(const CtConvertNode& node) override
+    {
+        xmlpp::Element* p_node_parent = node.fatherId == 0 ? _xml_doc.get_root_node() : _node_elements.at(node.fatherId);
+        xmlpp::Element* p_node_node = p_node_parent->add_child("node");
+        _node_elements[node.nodeData.nodeId] = p_node_node;
+        CtStorageXmlHelper::node_props_to_xml(node.nodeData, p_node_node);
+
+        if (not node.is_rich_text())
+        {
+            if (not node.text.empty())
+                p_node_node->add_child("rich_text")->add_child_text(node.text);
+            return;
+        }
+        if (std::unique_ptr<xmlpp::DomParser> pRichTextParser = CtStorageXmlHelper::parse_buffer_xml(node.text.c_str()))
+        {
+            for (xmlpp::Node* xml_slot : pRichTextParser->get_document()->get_root_node()->get_children("rich_text"))
+                p_node_node->import_node(xml_slot);
+        }
+        else
+        {
+            throw std::runtime_error("bad rich text of node " + std::to_string(node.nodeData.nodeId));
+        }
+        for (const CtConvertWidget& widget : node.widgets)
+            _widget_to_xml(widget, p_node_node);
+    }
+
+    void finish() override
+    {
+        _xml_doc.write_to_file_formatted(_file_path.string());
+    }
+
+private:
+    // the elements as in the to_xml of the widgets
+    static void _widget_to_xml(const CtConvertWidget& widget, xmlpp::Element* p_node_node)
+    {
+        if (widget.type == CtConvertWidget::Type::Image)
+        {
+            xmlpp::Element* p_image_node = p_node_node->add_child("encoded_png");
+            p_image_node->set_attribute("char_offset", std::to_string(widget.offset));
+            p_image_node->set_attribute(CtConst::TAG_JUSTIFICATION, widget.justification);
+            if (not widget.anchor.empty())
+            {
+                p_image_node->set_attribute("anchor", widget.anchor);
+                return;
+            }
+            if (not widget.filename.empty())
+            {
+                p_image_node->set_attribute("filename", widget.filename);
+                p_image_node->set_attribute("time", std::to_string(widget.time));
+            }
+            else
+            {
+                p_image_node->set_attribute("link", widget.link);
+            }
+            p_image_node->add_child_text(Glib::Base64::encode(widget.rawBlob));
+        }
+        else if (widget.type == CtConvertWidget::Type::Table)
+        {
+            xmlpp::Element* p_table_node = p_node_node->add_child("table");
+            p_table_node->set_attribute("char_offset", std::to_string(widget.offset));
+            p_table_node->set_attribute(CtConst::TAG_JUSTIFICATION, widget.justification);
+            p_table_node->set_attribute("col_min", std::to_string(widget.colMin));
+            p_table_node->set_attribute("col_max", std::to_string(widget.colMax));
+            xmlpp::DomParser table_parser;
+            table_parser.parse_memory(widget.text);
+            for (xmlpp::Node* xml_row : table_parser.get_document()->get_root_node()->get_children("row"))
+                p_table_node->import_node(xml_row);
+        }
+        else
+        {
+            xmlpp::Element* p_codebox_node = p_node_node->add_child("codebox");
+            p_codebox_node->set_attribute("char_offset", std::to_string(widget.offset));
+            p_codebox_node->set_attribute(CtConst::TAG_JUSTIFICATION, widget.justification);
+            p_codebox_node->set_attribute("frame_width", std::to_string(widget.frameWidth));
+            p_codebox_node->set_attribute("frame_height", std::to_string(widget.frameHeight));
+            p_codebox_node->set_attribute("width_in_pixels", std::to_string(widget.widthInPixels));
+            p_codebox_node->set_attribute("syntax_highlighting", widget.syntax);
+            p_codebox_node->set_attribute("highlight_brackets", std::to_string(widget.highlightBrackets));
+            p_codebox_node->set_attribute("show_line_numbers", std::to_string(widget.showLineNumbers));
+            p_codebox_node->add_child_text(widget.text);
+        }
+    }
+
+    const fs::path                              _file_path;
+    xmlpp::Document                             _xml_doc;
+    std::unordered_map<gint64, xmlpp::Element*> _node_elements;
+};
 
-    return new CtTable(_pCtMainWin, tableMatrix, colMin, colMax, charOffset, justification);
+/*static*/ std::unique_ptr<CtConvertReader> CtStorageXml::get_convert_reader(const fs::path& file_path)
+{
+    return std::make_unique<ConvertReader>(file_path);
+}
+
+/*static*/ std::unique_ptr<CtConvertWriter> CtStorageXml::get_convert_writer(const fs::path& file_path)
+{
+    return std::make_unique<ConvertWriter>(file_path);
 }
@@ -38,6 +38,8 @@ class CtMainWin;
 class CtTreeIter;
 class CtTableCell;
 class CtStorageCache;
+class CtConvertReader;
+class CtConvertWriter;
 
 class CtStorageXml : public CtStorageEntity
 {    
@@ -51,16 +53,26 @@ public:
 
     bool populate_treestore(const fs::path& file_path, Glib::ustring& error) override;
     bool save_treestore(const fs::path& file_path, const CtStorageSyncPending& syncPending, Glib::ustring& error) override;
+    std::function<void()> snapshot_treestore(const fs::path& file_path, const CtStorageSyncPending& syncPending, const bool need_vacuum) override;
     void vacuum() override;
     void import_nodes(const fs::path& path) override;
 
     Glib::RefPtr<Gsv::Buffer> get_delayed_text_buffer(const gint64& node_id,
                                                       const std::string& syntax,
                                                       std::list<CtAnchoredWidget*>& widgets) const override;
+    size_t get_node_summary(const gint64& node_id, Glib::ustring& text, CtSummaryInfo& summaryInfo) const override;
 private:
     Gtk::TreeIter  _node_from_xml(xmlpp::Element* xml_element, gint64 sequence, Gtk::TreeIter parent_iter, gint64 new_id);
     void           _nodes_to_xml(CtTreeIter* ct_tree_iter, xmlpp::Element* p_node_parent, CtStorageCache* storage_cache);
-    std::unique_ptr<xmlpp::DomParser> _get_parser(const fs::path& file_path);
+    static std::unique_ptr<xmlpp::DomParser> _get_parser(const fs::path& file_path);
+
+    // the nodes as stored, without text buffers nor widgets, for CtStorageConvert
+    class ConvertReader;
+    class ConvertWriter;
+
+public:
+    static std::unique_ptr<CtConvertReader> get_convert_reader(const fs::path& file_path);
+    static std::unique_ptr<CtConvertWriter> get_convert_writer(const fs::path& file_path);
 
 private:
     CtMainWin* _pCtMainWin{nullptr};
@@ -74,6 +86,9 @@ public:
     CtStorageXmlHelper(CtMainWin* pCtMainWin);
 
     xmlpp::Element*           node_to_xml(CtTreeIter* ct_tree_iter, xmlpp::Element* p_node_parent, bool with_widgets, CtStorageCache* storage_cache);
+    // the attributes of a node element, shared with the reading and writing for the conversions
+    static void               node_props_from_xml(xmlpp::Element* xml_element, CtNodeData& nodeData);
+    static void               node_props_to_xml(const CtNodeData& nodeData, xmlpp::Element* p_node_node);
 
     Glib::RefPtr<Gsv::Buffer> create_buffer_and_widgets_from_xml(xmlpp::Element* parent_xml_element, const Glib::ustring& syntax,
                                                           std::list<CtAnchoredWidget*>& widgets, Gtk::TextIter* text_insert_pos, int force_offset);
@@ -81,10 +96,15 @@ public:
     void                      get_text_buffer_one_slot_from_xml(Glib::RefPtr<Gsv::Buffer> buffer, xmlpp::Node* slot_node,
                                                        std::list<CtAnchoredWidget*>& widgets, Gtk::TextIter* text_insert_pos, int force_offset);
 
+    // the text and the widgets of the slots, as create_buffer_and_widgets_from_xml would add them; returns the widgets number
+    static size_t             summary_from_xml(xmlpp::Element* parent_xml_element, Glib::ustring& text, CtSummaryInfo& summaryInfo);
+
     Glib::RefPtr<Gsv::Buffer> create_buffer_no_widgets(const Glib::ustring& syntax, const char* xml_content);
+    // parses the xml of a node buffer, sanitized if needed; nullptr on failure, it can run on any thread
+    static std::unique_ptr<xmlpp::DomParser> parse_buffer_xml(const char* xml_content);
 
-    bool populate_table_matrix(std::vector<std::vector<CtTableCell*>>& tableMatrix, const char* xml_content);
-    void populate_table_matrix(std::vector<std::vector<CtTableCell*>>& tableMatrix, xmlpp::Element* xml_element);
+    static bool populate_table_matrix(std::vector<std::vector<Glib::ustring>>& tableMatrix, const char* xml_content);
+    static void populate_table_matrix(std::vector<std::vector<Glib::ustring>>& tableMatrix, xmlpp::Element* xml_element);
 
     static void save_buffer_no_widgets_to_xml(xmlpp::Element* p_node_parent, Glib::RefPtr<Gtk::TextBuffer> buffer,
                                        int start_offset, int end_offset, const gchar change_case);
@@ -25,6 +25,9 @@
 #include "ct_storage_sqlite.h"
 #include "ct_logging.h"
 #include "ct_misc_utils.h"
+#include "ct_thread_pool.h"
+#include <atomic>
+#include <mutex>
 
 CtTableCell::CtTableCell(CtMainWin* pCtMainWin,
                          const Glib::ustring& textContent,
@@ -41,7 +44,6 @@ CtTableCell::~CtTableCell()
 
 
 CtTable::CtTable(CtMainWin* pCtMainWin,
-                 CtTableMatrix tableMatrix,
                  const int colMin,
                  const int colMax,
                  const int charOffset,
@@ -50,69 +52,36 @@ CtTable::CtTable(CtMainWin* pCtMainWin,
    _colMin(colMin),
    _colMax(colMax)
 {
-    _setup_new_matrix(tableMatrix, false /* apply style when node shows */);
-
-    _grid.set_column_spacing(1);
-    _grid.set_row_spacing(1);
     _frame.get_style_context()->add_class("ct-table");
-    //_frame.set_border_width(0);
-    _frame.add(_grid);
-    show_all();
 }
 
 CtTable::~CtTable()
 {
-    // no need for deleting cells, _grid will clean up cells
 }
 
-void CtTable::_setup_new_matrix(const CtTableMatrix& tableMatrix, bool apply_style /* = true*/)
+/*static*/ CtTable* CtTable::create(CtMainWin* pCtMainWin,
+                                    CtTableTexts tableTexts,
+                                    const int colMin,
+                                    const int colMax,
+                                    const int charOffset,
+                                    const std::string& justification)
 {
-    for (auto widget: _grid.get_children())
-        _grid.remove(*widget);
-
-    _tableMatrix = tableMatrix;
-    for (int row = 0; row < (int)_tableMatrix.size(); ++row)
+    pad_rows(tableTexts);
+    const size_t numCells = tableTexts.empty() ? 0 : tableTexts.size() * tableTexts.front().size();
+    if (numCells > (size_t)pCtMainWin->get_ct_config()->tableCellsGoLight)
     {
-        for (int col = 0; col < (int)_tableMatrix[row].size(); ++col)
-        {
-            CtTableCell* pTableCell = _tableMatrix[row][col];
-            bool is_header = row == 0;
-            // todo: don't know how to use colMax and colMin, so use just colMax
-            pTableCell->get_text_view().set_size_request(_colMax, -1);
-            pTableCell->get_text_view().set_highlight_current_line(false);
-            if (is_header)
-            {
-                pTableCell->get_text_view().get_style_context()->add_class("ct-table-header-cell");
-                pTableCell->get_text_view().set_wrap_mode(Gtk::WrapMode::WRAP_NONE);
-                pTableCell->get_text_view().signal_populate_popup().connect(
-                            sigc::bind(sigc::mem_fun(*this, &CtTable::_on_populate_popup_header_cell), row, col));
-            }
-            else
-            {
-                pTableCell->get_text_view().signal_populate_popup().connect(
-                        sigc::bind(sigc::mem_fun(*this, &CtTable::_on_populate_popup_cell), row, col));
-            }
-            pTableCell->get_text_view().signal_key_press_event().connect(
-                        sigc::bind(sigc::mem_fun(*this, &CtTable::_on_key_press_event_cell), row, col), false);
-
-            _grid.attach(*pTableCell, col, row, 1 /*1 cell horiz*/, 1 /*1 cell vert*/);
-        }
+        return new CtTableLight(pCtMainWin, std::move(tableTexts), colMin, colMax, charOffset, justification);
     }
-    if (apply_style)
-        _apply_styles_to_cells();
-    _grid.show_all();
+    return new CtTableHeavy(pCtMainWin, tableTexts, colMin, colMax, charOffset, justification);
 }
 
-void CtTable::_apply_styles_to_cells()
+/*static*/ void CtTable::pad_rows(CtTableTexts& tableTexts)
 {
-    for (CtTableRow& tableRow : _tableMatrix)
-        for (CtTableCell* pTableCell : tableRow)
-            _pCtMainWin->apply_syntax_highlighting(pTableCell->get_buffer(), pTableCell->get_syntax_highlighting());
-}
-
-void CtTable::apply_syntax_highlighting()
-{
-    _apply_styles_to_cells();
+    size_t numColumns{0};
+    for (const auto& rowTexts : tableTexts)
+        numColumns = std::max(numColumns, rowTexts.size());
+    for (auto& rowTexts : tableTexts)
+        rowTexts.resize(numColumns);
 }
 
 void CtTable::to_xml(xmlpp::Element* p_node_parent, const int offset_adjustment, CtStorageCache*)
@@ -128,23 +97,25 @@ void CtTable::to_xml(xmlpp::Element* p_node_parent, const int offset_adjustment,
 
 void CtTable::_populate_xml_rows_cells(xmlpp::Element* p_table_node)
 {
-    auto row_to_xml = [&](const CtTableRow& tableRow) {
+    CtTableTexts tableTexts;
+    write_strings_matrix(tableTexts);
+    auto row_to_xml = [&](const std::vector<Glib::ustring>& rowTexts) {
         xmlpp::Element* p_row_node = p_table_node->add_child("row");
-        for (const CtTableCell* pTableCell : tableRow)
+        for (const Glib::ustring& cellText : rowTexts)
         {
             xmlpp::Element* p_cell_node = p_row_node->add_child("cell");
-            p_cell_node->add_child_text(pTableCell->get_text_content());
+            p_cell_node->add_child_text(cellText);
         }
     };
 
     // put header at the end
     bool is_header = true;
-    for (const CtTableRow& tableRow : _tableMatrix)
+    for (const auto& rowTexts : tableTexts)
     {
         if (is_header) { is_header = false; continue; }
-        row_to_xml(tableRow);
+        row_to_xml(rowTexts);
     }
-    row_to_xml(_tableMatrix.front());
+    row_to_xml(tableTexts.front());
 }
 
 bool CtTable::to_sqlite(sqlite3* pDb, const gint64 node_id, const int offset_adjustment, CtStorageCache*)
@@ -181,33 +152,77 @@ bool CtTable::to_sqlite(sqlite3* pDb, const gint64 node_id, const int offset_adj
 
 
 void CtTable::to_csv(std::ostream& output) const {
-    CtCSV::CtStringTable tbl;
-    for (const CtTableRow& ct_row : _tableMatrix) {
-        std::vector<std::string> row;
-
-        for (const auto* ct_cell : ct_row) {
-            row.emplace_back(ct_cell->get_text_content());
+    // row by row, no copy of the whole table
+    CtCSV::CtCsvWriter writer(output);
+    std::vector<Glib::ustring> row_texts;
+    for (size_t row = 0; row < get_num_rows(); ++row) {
+        row_texts.clear();
+        for (size_t col = 0; col < get_num_columns(); ++col) {
+            row_texts.push_back(get_cell_text(row, col));
         }
-        tbl.emplace_back(row);
+        writer.write_row(row_texts);
     }
-    CtCSV::table_to_csv(tbl, output);
 }
 
 
-std::unique_ptr<CtTable> CtTable::from_csv(std::istream& input, CtMainWin* main_win, const Glib::ustring& syntax_highlighting, int col_min, int col_max, int offset, const Glib::ustring& justification) {
-    CtCSV::CtStringTable str_tbl = CtCSV::table_from_csv(input);
+std::unique_ptr<CtTable> CtTable::from_csv(std::istream& input, CtMainWin* main_win, int col_min, int col_max, int offset, const Glib::ustring& justification,
+                                           const std::function<bool(size_t, double)>& progress_cb /*= nullptr*/) {
+    // the size of the input, if it can be known, for the progress
+    std::streamoff input_size{-1};
+    const std::streampos start_pos = input.tellg();
+    if (start_pos != std::streampos(-1)) {
+        input.seekg(0, std::ios::end);
+        if (input) input_size = input.tellg() - start_pos;
+        input.clear();
+        input.seekg(start_pos);
+    }
 
-    CtTableMatrix tbl_matrix;
-    for (const auto& row : str_tbl) {
-        CtTableRow tbl_row;
-        for (const auto& cell : row) {
-            auto* ct_cell = new CtTableCell(main_win, cell, syntax_highlighting);
-            tbl_row.emplace_back(ct_cell);
+    constexpr size_t BATCH_ROWS{1000};
+    const size_t max_rows = (size_t)std::max(0, main_win->get_ct_config()->tableCsvMaxRows);
+    CtTableTexts table_texts;
+    CtTableTexts batch;
+    std::mutex batch_mutex;
+    std::atomic<std::streamoff> bytes_read{0};
+    std::atomic<bool> cancelled{false};
+    bool truncated{false};
+    // the worker parses, the rows are moved to table_texts on this thread a batch at a time
+    auto worker = CtThreadPool::get().submit([&]() {
+        CtCSV::CtCsvReader reader(input, max_rows);
+        std::vector<std::string> row;
+        CtTableTexts parsed;
+        auto hand_over = [&]() {
+            std::lock_guard<std::mutex> lock(batch_mutex);
+            std::move(parsed.begin(), parsed.end(), std::back_inserter(batch));
+            parsed.clear();
+            bytes_read = reader.get_bytes_read();
+        };
+        while (!cancelled && reader.next_row(row)) {
+            parsed.emplace_back(std::make_move_iterator(row.begin()), std::make_move_iterator(row.end()));
+            if (parsed.size() == BATCH_ROWS) hand_over();
         }
-        tbl_matrix.emplace_back(tbl_row);
+        hand_over();
+        truncated = reader.is_truncated();
+    });
+    auto take_batch = [&]() {
+        std::lock_guard<std::mutex> lock(batch_mutex);
+        std::move(batch.begin(), batch.end(), std::back_inserter(table_texts));
+        batch.clear();
+    };
+    while (worker.wait_for(std::chrono::milliseconds(100)) != std::future_status::ready) {
+        take_batch();
+        const double fraction = input_size > 0 ? double(bytes_read)/double(input_size) : 0.;
+        if (progress_cb && !progress_cb(table_texts.size(), fraction)) cancelled = true;
     }
-    
-    return std::make_unique<CtTable>(main_win, tbl_matrix, col_min, col_max, offset, justification);
+    worker.get();
+    take_batch();
+    if (cancelled) return nullptr;
+    if (truncated) {
+        spdlog::warn("csv import: only the first {} rows were read", max_rows);
+    }
+    if (progress_cb) progress_cb(table_texts.size(), 1.);
+
+    // the rows have as many cells as in the csv, create pads them to the widest
+    return std::unique_ptr<CtTable>(create(main_win, std::move(table_texts), col_min, col_max, offset, justification));
 }
 
 std::shared_ptr<CtAnchoredWidgetState> CtTable::get_state()
@@ -215,7 +230,121 @@ std::shared_ptr<CtAnchoredWidgetState> CtTable::get_state()
     return std::shared_ptr<CtAnchoredWidgetState>(new CtAnchoredWidgetState_Table(this));
 }
 
-void CtTable::set_modified_false()
+void CtTable::_set_current_cell(int row, int col)
+{
+    _pCtMainWin->get_ct_actions()->curr_table_anchor = this;
+    _currentRow = row;
+    _currentColumn = col;
+}
+
+
+
+CtTableHeavy::CtTableHeavy(CtMainWin* pCtMainWin,
+                           const CtTableTexts& tableTexts,
+                           const int colMin,
+                           const int colMax,
+                           const int charOffset,
+                           const std::string& justification)
+ : CtTable(pCtMainWin, colMin, colMax, charOffset, justification)
+{
+    // the style is applied when the node shows
+    _tableMatrix.reserve(tableTexts.size());
+    for (int row = 0; row < (int)tableTexts.size(); ++row)
+    {
+        _tableMatrix.push_back(CtTableRow{});
+        for (int col = 0; col < (int)tableTexts[row].size(); ++col)
+        {
+            CtTableCell* pTableCell = _new_cell(tableTexts[row][col], row == 0);
+            _tableMatrix.back().push_back(pTableCell);
+            _grid.attach(*pTableCell, col, row, 1 /*1 cell horiz*/, 1 /*1 cell vert*/);
+        }
+    }
+
+    _grid.set_column_spacing(1);
+    _grid.set_row_spacing(1);
+    //_frame.set_border_width(0);
+    _frame.add(_grid);
+    show_all();
+}
+
+CtTableHeavy::~CtTableHeavy()
+{
+    // no need for deleting cells, _grid will clean up cells
+}
+
+void CtTableHeavy::write_strings_matrix(CtTableTexts& tableTexts) const
+{
+    tableTexts.clear();
+    tableTexts.reserve(_tableMatrix.size());
+    for (const CtTableRow& tableRow : _tableMatrix)
+    {
+        tableTexts.push_back(std::vector<Glib::ustring>{});
+        tableTexts.back().reserve(tableRow.size());
+        for (const CtTableCell* pTableCell : tableRow)
+            tableTexts.back().push_back(pTableCell->get_text_content());
+    }
+}
+
+CtTableCell* CtTableHeavy::_new_cell(const Glib::ustring& textContent, const bool is_header)
+{
+    CtTableCell* pTableCell = Gtk::manage(new CtTableCell(_pCtMainWin, textContent, CtConst::TABLE_CELL_TEXT_ID));
+    // todo: don't know how to use colMax and colMin, so use just colMax
+    pTableCell->get_text_view().set_size_request(_colMax, -1);
+    pTableCell->get_text_view().set_highlight_current_line(false);
+    if (is_header)
+        _set_cell_header(pTableCell, true);
+    // the handlers get the cell position from the grid, cells can move
+    pTableCell->get_text_view().signal_populate_popup().connect(
+                sigc::bind(sigc::mem_fun(*this, &CtTableHeavy::_on_populate_popup_cell), pTableCell));
+    pTableCell->get_text_view().signal_key_press_event().connect(
+                sigc::bind(sigc::mem_fun(*this, &CtTableHeavy::_on_key_press_event_cell), pTableCell), false);
+    return pTableCell;
+}
+
+void CtTableHeavy::_set_cell_header(CtTableCell* pTableCell, const bool is_header)
+{
+    if (is_header)
+    {
+        pTableCell->get_text_view().get_style_context()->add_class("ct-table-header-cell");
+        pTableCell->get_text_view().set_wrap_mode(Gtk::WrapMode::WRAP_NONE);
+    }
+    else
+    {
+        pTableCell->get_text_view().get_style_context()->remove_class("ct-table-header-cell");
+        // as a cell created as not header
+        pTableCell->get_text_view().set_wrap_mode(_pCtMainWin->get_ct_config()->lineWrapping ? Gtk::WrapMode::WRAP_WORD_CHAR : Gtk::WrapMode::WRAP_NONE);
+    }
+}
+
+void CtTableHeavy::_get_cell_pos(CtTableCell* pTableCell, int& row, int& col)
+{
+    gtk_container_child_get(GTK_CONTAINER(_grid.gobj()), GTK_WIDGET(pTableCell->gobj()), "top-attach", &row, "left-attach", &col, nullptr);
+}
+
+void CtTableHeavy::_set_cell_pos(CtTableCell* pTableCell, const int row, const int col)
+{
+    gtk_container_child_set(GTK_CONTAINER(_grid.gobj()), GTK_WIDGET(pTableCell->gobj()), "top-attach", row, "left-attach", col, nullptr);
+}
+
+void CtTableHeavy::_apply_styles_to_cells()
+{
+    for (CtTableRow& tableRow : _tableMatrix)
+        for (CtTableCell* pTableCell : tableRow)
+            _apply_styles_to_cell(pTableCell);
+}
+
+void CtTableHeavy::_apply_styles_to_cell(CtTableCell* pTableCell)
+{
+    // the table is already showing, the cells added later need the style scheme now
+    _pCtMainWin->apply_syntax_highlighting(pTableCell->get_buffer(), pTableCell->get_syntax_highlighting());
+}
+
+void CtTableHeavy::apply_syntax_highlighting()
+{
+    _apply_styles_to_cells();
+}
+
+void CtTableHeavy::set_modified_false()
 {
     for (CtTableRow& tableRow : _tableMatrix)
     {
@@ -226,143 +355,162 @@ void CtTable::set_modified_false()
     }
 }
 
-void CtTable::column_add(int after_column)
+void CtTableHeavy::column_add(int after_column)
 {
-    auto matrix = _copy_matrix(after_column, -1, -1, -1, -1, -1);
-    _setup_new_matrix(matrix);
+    const int column = after_column + 1;
+    _grid.insert_column(column);
+    for (int row = 0; row < (int)_tableMatrix.size(); ++row)
+    {
+        CtTableCell* pTableCell = _new_cell("", row == 0);
+        _tableMatrix[row].insert(_tableMatrix[row].begin() + column, pTableCell);
+        _grid.attach(*pTableCell, column, row, 1 /*1 cell horiz*/, 1 /*1 cell vert*/);
+        _apply_styles_to_cell(pTableCell);
+        pTableCell->show_all();
+    }
 }
 
-void CtTable::column_delete(int column)
+void CtTableHeavy::column_delete(int column)
 {
     if (_tableMatrix[0].size() == 1) return;
-    auto matrix = _copy_matrix(-1, column, -1, -1, -1, -1);
-    _setup_new_matrix(matrix);
+    for (CtTableRow& tableRow : _tableMatrix)
+        tableRow.erase(tableRow.begin() + column);
+    // the removed cells are managed, the grid deletes them
+    _grid.remove_column(column);
 }
 
-void CtTable::column_move_left(int column)
+void CtTableHeavy::column_move_left(int column)
 {
     if (column == 0) return;
-    auto matrix = _copy_matrix(-1, -1, -1, -1, column, -1);
-    _setup_new_matrix(matrix);
+    for (int row = 0; row < (int)_tableMatrix.size(); ++row)
+    {
+        std::swap(_tableMatrix[row][column-1], _tableMatrix[row][column]);
+        _set_cell_pos(_tableMatrix[row][column-1], row, column-1);
+        _set_cell_pos(_tableMatrix[row][column], row, column);
+    }
 }
 
-void CtTable::column_move_right(int column)
+void CtTableHeavy::column_move_right(int column)
 {
     if (column == (int)_tableMatrix[0].size()-1) return;
     // moving to right is same as moving to left for other column
-    auto matrix = _copy_matrix(-1, -1, -1, -1, column + 1, -1);
-    _setup_new_matrix(matrix);
+    column_move_left(column + 1);
 }
 
-void CtTable::row_add(int after_row, std::vector<Glib::ustring>* row /*= nullptr*/)
+void CtTableHeavy::row_add(int after_row, std::vector<Glib::ustring>* row /*= nullptr*/)
 {
-    auto matrix = _copy_matrix(-1, -1, after_row, -1, -1, -1);
-    if (row && row->size() == matrix[0].size())
-        for (int col = 0; col < (int)matrix[0].size(); ++col)
-            matrix[after_row + 1][col]->get_text_view().get_buffer()->set_text(row->at(col));
-    _setup_new_matrix(matrix);
+    const int new_row = after_row + 1;
+    const size_t num_columns = _tableMatrix[0].size();
+    const bool with_texts = row && row->size() == num_columns;
+    _grid.insert_row(new_row);
+    _tableMatrix.insert(_tableMatrix.begin() + new_row, CtTableRow{});
+    CtTableRow& tableRow = _tableMatrix[new_row];
+    for (size_t col = 0; col < num_columns; ++col)
+    {
+        CtTableCell* pTableCell = _new_cell(with_texts ? row->at(col) : "", false/*is_header*/);
+        tableRow.push_back(pTableCell);
+        _grid.attach(*pTableCell, col, new_row, 1 /*1 cell horiz*/, 1 /*1 cell vert*/);
+        _apply_styles_to_cell(pTableCell);
+        pTableCell->show_all();
+    }
 }
 
-void CtTable::row_delete(int row)
+void CtTableHeavy::row_delete(int row)
 {
     if ((int)_tableMatrix.size() == 1) return;
-    auto matrix = _copy_matrix(-1, -1, -1, row, -1, -1);
-    _setup_new_matrix(matrix);
+    _tableMatrix.erase(_tableMatrix.begin() + row);
+    // the removed cells are managed, the grid deletes them
+    _grid.remove_row(row);
+    if (row == 0)
+        for (CtTableCell* pTableCell : _tableMatrix[0])
+            _set_cell_header(pTableCell, true);
 }
 
-void CtTable::row_move_up(int row)
+void CtTableHeavy::row_move_up(int row)
 {
     if (row == 0) return;
-    auto matrix = _copy_matrix(-1, -1, -1, -1, -1, row);
-    _setup_new_matrix(matrix);
+    std::swap(_tableMatrix[row-1], _tableMatrix[row]);
+    for (int r : {row-1, row})
+    {
+        for (int col = 0; col < (int)_tableMatrix[r].size(); ++col)
+        {
+            _set_cell_pos(_tableMatrix[r][col], r, col);
+            if (row == 1)
+                _set_cell_header(_tableMatrix[r][col], r == 0);
+        }
+    }
 }
 
-void CtTable::row_move_down(int row)
+void CtTableHeavy::row_move_down(int row)
 {
     if (row == (int)_tableMatrix.size()-1) return;
     // moving up is same as moving down for other row
-    auto matrix = _copy_matrix(-1, -1, -1, -1, -1, row + 1);
-    _setup_new_matrix(matrix);
-}
-
-bool CtTable::row_sort_asc()
-{
-    auto matrix = _copy_matrix(-1, -1, -1, -1, -1, -1);
-    std::sort(matrix.begin()+1, matrix.end(), [](CtTableRow& l, CtTableRow& r) { return CtStrUtil::natural_compare(l[0]->get_text_content(), r[0]->get_text_content()) < 0; });
-    auto prev_state = get_state();
-    _setup_new_matrix(matrix);
-    return !prev_state->equal(get_state());
+    row_move_up(row + 1);
 }
 
-bool CtTable::row_sort_desc()
+bool CtTableHeavy::row_sort_asc()
 {
-    auto matrix = _copy_matrix(-1, -1, -1, -1, -1, -1);
-    std::sort(matrix.begin()+1, matrix.end(), [](CtTableRow& l, CtTableRow& r) { return CtStrUtil::natural_compare(l[0]->get_text_content(), r[0]->get_text_content()) > 0; });
-    auto prev_state = get_state();
-    _setup_new_matrix(matrix);
-    return !prev_state->equal(get_state());
+    return _row_sort(true/*ascending*/);
 }
 
-void CtTable::set_col_min_max(int col_min, int col_max)
+bool CtTableHeavy::row_sort_desc()
 {
-    _colMin = col_min;
-    _colMax = col_max;
-    auto matrix = _copy_matrix(-1, -1, -1, -1, -1, -1);
-    _setup_new_matrix(matrix);
+    return _row_sort(false/*ascending*/);
 }
 
-CtTableMatrix CtTable::_copy_matrix(int col_add, int col_del, int row_add, int row_del, int col_move_left, int row_move_up)
+bool CtTableHeavy::_row_sort(const bool ascending)
 {
-    // don't check input indexes, it's already checked
-    CtTableMatrix matrix;
-    for (int row = 0; row < (int)_tableMatrix.size(); ++row)
+    // the keys are computed once, the header stays in place
+    std::vector<std::pair<std::string, int>> keys;
+    keys.reserve(_tableMatrix.size());
+    for (int row = 1; row < (int)_tableMatrix.size(); ++row)
+        keys.emplace_back(CtStrUtil::natural_sort_key(_tableMatrix[row][0]->get_text_content()), row);
+    std::stable_sort(keys.begin(), keys.end(), [ascending](const auto& l, const auto& r) {
+        return ascending ? l.first < r.first : r.first < l.first;
+    });
+    CtTableMatrix sortedMatrix;
+    sortedMatrix.reserve(_tableMatrix.size());
+    sortedMatrix.push_back(std::move(_tableMatrix[0]));
+    bool changed{false};
+    for (const auto& key : keys)
     {
-        if (row == row_del) continue;
-        matrix.push_back(CtTableRow());
-        for (int col = 0; col < (int)_tableMatrix[row].size(); ++col) {
-            if (col == col_del) continue;
-            matrix.back().push_back(new CtTableCell(_pCtMainWin, _tableMatrix[row][col]->get_text_content(), CtConst::TABLE_CELL_TEXT_ID));
-            if (col == col_add) {
-                matrix.back().push_back(new CtTableCell(_pCtMainWin, "", CtConst::TABLE_CELL_TEXT_ID));
-            }
-            if (col == col_move_left) std::swap(matrix[row][col-1], matrix[row][col]);
-        }
-        if (row == row_add) {
-            matrix.push_back(CtTableRow());
-            while (matrix.back().size() != _tableMatrix[0].size())
-                matrix.back().push_back(new CtTableCell(_pCtMainWin, "", CtConst::TABLE_CELL_TEXT_ID));
-        }
-        if (row == row_move_up) std::swap(matrix[row-1], matrix[row]);
+        const int new_row = (int)sortedMatrix.size();
+        sortedMatrix.push_back(std::move(_tableMatrix[key.second]));
+        if (key.second == new_row) continue;
+        // only the rows that moved are re-attached
+        changed = true;
+        for (int col = 0; col < (int)sortedMatrix.back().size(); ++col)
+            _set_cell_pos(sortedMatrix.back()[col], new_row, col);
     }
-    return matrix;
+    _tableMatrix = std::move(sortedMatrix);
+    return changed;
 }
 
-void CtTable::_on_populate_popup_header_cell(Gtk::Menu* menu, int row, int col)
+void CtTableHeavy::set_col_min_max(int col_min, int col_max)
 {
-    if (not _pCtMainWin->get_ct_actions()->getCtMainWin()->user_active()) return;
-    for (auto iter : menu->get_children()) menu->remove(*iter);
-    _pCtMainWin->get_ct_actions()->curr_table_anchor = this;
-    _currentRow = row;
-    _currentColumn = col;
-    _pCtMainWin->get_ct_actions()->getCtMainWin()->get_ct_menu().build_popup_menu(GTK_WIDGET(menu->gobj()), CtMenu::POPUP_MENU_TYPE::TableHeaderCell);
+    _colMin = col_min;
+    _colMax = col_max;
+    for (CtTableRow& tableRow : _tableMatrix)
+        for (CtTableCell* pTableCell : tableRow)
+            pTableCell->get_text_view().set_size_request(_colMax, -1);
 }
 
-void CtTable::_on_populate_popup_cell(Gtk::Menu* menu, int row, int col)
+void CtTableHeavy::_on_populate_popup_cell(Gtk::Menu* menu, CtTableCell* pTableCell)
 {
     if (not _pCtMainWin->get_ct_actions()->getCtMainWin()->user_active()) return;
     for (auto iter : menu->get_children()) menu->remove(*iter);
-    _pCtMainWin->get_ct_actions()->curr_table_anchor = this;
-    _currentRow = row;
-    _currentColumn = col;
-    _pCtMainWin->get_ct_actions()->getCtMainWin()->get_ct_menu().build_popup_menu(GTK_WIDGET(menu->gobj()), CtMenu::POPUP_MENU_TYPE::TableCell);
+    int row, col;
+    _get_cell_pos(pTableCell, row, col);
+    _set_current_cell(row, col);
+    auto menuType = row == 0 ? CtMenu::POPUP_MENU_TYPE::TableHeaderCell : CtMenu::POPUP_MENU_TYPE::TableCell;
+    _pCtMainWin->get_ct_actions()->getCtMainWin()->get_ct_menu().build_popup_menu(GTK_WIDGET(menu->gobj()), menuType);
 }
 
-bool CtTable::_on_key_press_event_cell(GdkEventKey* event, int row, int col)
+bool CtTableHeavy::_on_key_press_event_cell(GdkEventKey* event, CtTableCell* pTableCell)
 {
     if (not _pCtMainWin->get_ct_actions()->getCtMainWin()->user_active()) return false;
-    _pCtMainWin->get_ct_actions()->curr_table_anchor = this;
-    _currentRow = row;
-    _currentColumn = col;
+    int row, col;
+    _get_cell_pos(pTableCell, row, col);
+    _set_current_cell(row, col);
     // Ctrl+Return for multilines
     if (event->state & Gdk::CONTROL_MASK && event->keyval == GDK_KEY_Return)
         return false;
@@ -392,3 +540,233 @@ bool CtTable::_on_key_press_event_cell(GdkEventKey* event, int row, int col)
     }
     return false;
 }
+
+
+CtTableLight::CtTableLight(CtMainWin* pCtMainWin,
+                           CtTableTexts tableTexts,
+                           const int colMin,
+                           const int colMax,
+                           const int charOffset,
+                           const std::string& justification)
+ : CtTable(pCtMainWin, colMin, colMax, charOffset, justification)
+{
+    _setup_new_model(std::move(tableTexts));
+
+    _treeView.set_headers_visible(false);
+    _treeView.set_grid_lines(Gtk::TREE_VIEW_GRID_LINES_BOTH);
+    _treeView.get_selection()->set_mode(Gtk::SELECTION_NONE);
+    _treeView.signal_button_press_event().connect(sigc::mem_fun(*this, &CtTableLight::_on_button_press_event), false);
+    _frame.add(_treeView);
+    show_all();
+}
+
+CtTableLight::~CtTableLight()
+{
+}
+
+void CtTableLight::_setup_new_model(CtTableTexts tableTexts)
+{
+    size_t numColumns{1};
+    for (const auto& rowTexts : tableTexts)
+        numColumns = std::max(numColumns, rowTexts.size());
+
+    // the model is filled before being attached, no per row view update
+    _treeView.unset_model();
+    _uColumns = std::make_unique<CtTableLightColumns>(numColumns);
+    _rListStore = Gtk::ListStore::create(*_uColumns);
+    if (tableTexts.empty())
+        tableTexts.emplace_back();
+    for (auto& rowTexts : tableTexts)
+    {
+        Gtk::TreeRow treeRow = *_rListStore->append();
+        for (size_t col = 0; col < rowTexts.size(); ++col)
+            treeRow.set_value(_uColumns->columnsText[col], std::move(rowTexts[col]));
+    }
+    _setup_tree_view_columns();
+    _treeView.set_model(_rListStore);
+}
+
+void CtTableLight::_setup_tree_view_columns()
+{
+    _treeView.remove_all_columns();
+    for (size_t col = 0; col < _uColumns->columnsText.size(); ++col)
+    {
+        auto pRendererText = Gtk::manage(new Gtk::CellRendererText{});
+        pRendererText->property_editable() = true;
+        pRendererText->property_wrap_mode() = Pango::WRAP_WORD_CHAR;
+        pRendererText->property_wrap_width() = _colMax;
+        pRendererText->signal_edited().connect(sigc::bind(sigc::mem_fun(*this, &CtTableLight::_on_cell_edited), (int)col));
+
+        auto pTreeViewColumn = Gtk::manage(new Gtk::TreeViewColumn{});
+        pTreeViewColumn->pack_start(*pRendererText, true);
+        pTreeViewColumn->set_min_width(_colMin);
+        pTreeViewColumn->set_cell_data_func(*pRendererText, [this, pRendererText, col](Gtk::CellRenderer*, const Gtk::TreeIter& iter){
+            pRendererText->property_text() = iter->get_value(_uColumns->columnsText[col]);
+            // the first row is the header
+            pRendererText->property_weight() = iter == _rListStore->children().begin() ? Pango::WEIGHT_BOLD : Pango::WEIGHT_NORMAL;
+        });
+        _treeView.append_column(*pTreeViewColumn);
+    }
+}
+
+Gtk::TreeIter CtTableLight::_get_row_iter(int row) const
+{
+    return _rListStore->children()[row];
+}
+
+Glib::ustring CtTableLight::get_cell_text(const size_t row, const size_t col) const
+{
+    return _get_row_iter(row)->get_value(_uColumns->columnsText[col]);
+}
+
+void CtTableLight::write_strings_matrix(CtTableTexts& tableTexts) const
+{
+    tableTexts.clear();
+    tableTexts.reserve(get_num_rows());
+    for (const Gtk::TreeRow& treeRow : _rListStore->children())
+    {
+        tableTexts.push_back(std::vector<Glib::ustring>{});
+        tableTexts.back().reserve(_uColumns->columnsText.size());
+        for (const auto& columnText : _uColumns->columnsText)
+            tableTexts.back().push_back(treeRow.get_value(columnText));
+    }
+}
+
+void CtTableLight::column_add(int after_column)
+{
+    // the columns of a list store are fixed, a new model is needed
+    CtTableTexts tableTexts;
+    write_strings_matrix(tableTexts);
+    for (auto& rowTexts : tableTexts)
+        rowTexts.insert(rowTexts.begin() + after_column + 1, "");
+    _setup_new_model(std::move(tableTexts));
+}
+
+void CtTableLight::column_delete(int column)
+{
+    if (get_num_columns() == 1) return;
+    CtTableTexts tableTexts;
+    write_strings_matrix(tableTexts);
+    for (auto& rowTexts : tableTexts)
+        rowTexts.erase(rowTexts.begin() + column);
+    _setup_new_model(std::move(tableTexts));
+}
+
+void CtTableLight::column_move_left(int column)
+{
+    if (column == 0) return;
+    CtTableTexts tableTexts;
+    write_strings_matrix(tableTexts);
+    for (auto& rowTexts : tableTexts)
+        std::swap(rowTexts[column-1], rowTexts[column]);
+    _setup_new_model(std::move(tableTexts));
+}
+
+void CtTableLight::column_move_right(int column)
+{
+    if (column == (int)get_num_columns()-1) return;
+    // moving to right is same as moving to left for other column
+    column_move_left(column + 1);
+}
+
+void CtTableLight::row_add(int after_row, std::vector<Glib::ustring>* row /*= nullptr*/)
+{
+    Gtk::TreeRow treeRow = *_rListStore->insert_after(_get_row_iter(after_row));
+    if (row && row->size() == get_num_columns())
+        for (size_t col = 0; col < row->size(); ++col)
+            treeRow.set_value(_uColumns->columnsText[col], row->at(col));
+}
+
+void CtTableLight::row_delete(int row)
+{
+    if (get_num_rows() == 1) return;
+    _rListStore->erase(_get_row_iter(row));
+}
+
+void CtTableLight::row_move_up(int row)
+{
+    if (row == 0) return;
+    _rListStore->iter_swap(_get_row_iter(row-1), _get_row_iter(row));
+}
+
+void CtTableLight::row_move_down(int row)
+{
+    if (row == (int)get_num_rows()-1) return;
+    // moving up is same as moving down for other row
+    row_move_up(row + 1);
+}
+
+bool CtTableLight::row_sort_asc()
+{
+    return _row_sort(true/*ascending*/);
+}
+
+bool CtTableLight::row_sort_desc()
+{
+    return _row_sort(false/*ascending*/);
+}
+
+bool CtTableLight::_row_sort(const bool ascending)
+{
+    // the keys are computed once, the header stays in place
+    std::vector<std::pair<std::string, int>> keys;
+    keys.reserve(get_num_rows());
+    int row{0};
+    for (const Gtk::TreeRow& treeRow : _rListStore->children())
+    {
+        if (row > 0)
+            keys.emplace_back(CtStrUtil::natural_sort_key(treeRow.get_value(_uColumns->columnsText[0])), row);
+        ++row;
+    }
+    std::stable_sort(keys.begin(), keys.end(), [ascending](const auto& l, const auto& r) {
+        return ascending ? l.first < r.first : r.first < l.first;
+    });
+    std::vector<int> new_order{0};
+    new_order.reserve(keys.size()+1);
+    bool changed{false};
+    for (const auto& key : keys)
+    {
+        if (key.second != (int)new_order.size()) changed = true;
+        new_order.push_back(key.second);
+    }
+    if (changed)
+        _rListStore->reorder(new_order);
+    return changed;
+}
+
+void CtTableLight::set_col_min_max(int col_min, int col_max)
+{
+    _colMin = col_min;
+    _colMax = col_max;
+    _setup_tree_view_columns();
+}
+
+void CtTableLight::_on_cell_edited(const Glib::ustring& path, const Glib::ustring& new_text, int col)
+{
+    if (_pCtMainWin->curr_tree_iter().get_node_read_only()) return;
+    Gtk::TreeIter iter = _rListStore->get_iter(path);
+    if (not iter or iter->get_value(_uColumns->columnsText[col]) == new_text) return;
+    iter->set_value(_uColumns->columnsText[col], new_text);
+    _pCtMainWin->update_window_save_needed(CtSaveNeededUpdType::nbuf, true/*new_machine_state*/);
+}
+
+bool CtTableLight::_on_button_press_event(GdkEventButton* event)
+{
+    if (not _pCtMainWin->user_active()) return false;
+    Gtk::TreePath path;
+    Gtk::TreeViewColumn* pColumn{nullptr};
+    int cell_x, cell_y;
+    if (not _treeView.get_path_at_pos((int)event->x, (int)event->y, path, pColumn, cell_x, cell_y) or not pColumn)
+        return false;
+    const auto columns = _treeView.get_columns();
+    const int col = std::find(columns.begin(), columns.end(), pColumn) - columns.begin();
+    const int row = path[0];
+    _set_current_cell(row, col);
+    if (event->button == 3)
+    {
+        auto menuType = row == 0 ? CtMenu::POPUP_MENU_TYPE::TableHeaderCell : CtMenu::POPUP_MENU_TYPE::TableCell;
+        _pCtMainWin->get_ct_menu().get_popup_menu(menuType)->popup(event->button, event->time);
+        return true;
+    }
+    return false;
+}
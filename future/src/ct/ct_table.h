@@ -24,6 +24,7 @@
 #include "ct_codebox.h"
 #include "ct_widgets.h"
 #include <ostream>
+#include <functional>
 #include <istream>
 
 
@@ -39,27 +40,42 @@ public:
 
 typedef std::vector<CtTableCell*> CtTableRow;
 typedef std::vector<CtTableRow> CtTableMatrix;
+typedef std::vector<std::vector<Glib::ustring>> CtTableTexts;
+
+// row 0 is the header; CtTableHeavy has a text view per cell, CtTableLight draws the cells
+// of a tree view over a list store and only creates an editor for the cell being edited
 class CtTable : public CtAnchoredWidget
 {
 public:
     CtTable(CtMainWin* pCtMainWin,
-            CtTableMatrix tableMatrix,
             const int colMin,
             const int colMax,
             const int charOffset,
             const std::string& justification);
     virtual ~CtTable();
 
+    // light or heavy according to the number of cells
+    static CtTable* create(CtMainWin* pCtMainWin,
+                           CtTableTexts tableTexts,
+                           const int colMin,
+                           const int colMax,
+                           const int charOffset,
+                           const std::string& justification);
+    // the cells are indexed by column, the short rows get empty cells up to the widest one
+    static void pad_rows(CtTableTexts& tableTexts);
+
     /**
      * @brief Build a table from csv
      * The input csv should be compatable with the excel csv format
+     * The parsing runs on a worker thread, the rows reach the caller in batches
      * @param input 
-     * @return CtTable 
+     * @param progress_cb called on the caller thread with the rows read and the fraction of the input, false to cancel
+     * @return CtTable, nullptr if cancelled
      */
-    static std::unique_ptr<CtTable> from_csv(std::istream& input, CtMainWin* main_win, const Glib::ustring& syntax_highlighting, int col_min, int col_max, int offset, const Glib::ustring& justification);
+    static std::unique_ptr<CtTable> from_csv(std::istream& input, CtMainWin* main_win, int col_min, int col_max, int offset, const Glib::ustring& justification,
+                                             const std::function<bool(size_t, double)>& progress_cb = nullptr);
 
     void apply_width_height(const int /*parentTextWidth*/) override {}
-    void apply_syntax_highlighting() override;
     void to_xml(xmlpp::Element* p_node_parent, const int offset_adjustment, CtStorageCache* cache) override;
     bool to_sqlite(sqlite3* pDb, const gint64 node_id, const int offset_adjustment, CtStorageCache* cache) override;
     /**
@@ -68,49 +84,150 @@ public:
      * @param output 
      */
     void to_csv(std::ostream& output) const;
-    void set_modified_false() override;
     CtAnchWidgType get_type() override { return CtAnchWidgType::Table; }
     std::shared_ptr<CtAnchoredWidgetState> get_state() override;
 
-    const CtTableMatrix& get_table_matrix() const { return _tableMatrix; }
+    virtual size_t get_num_rows() const = 0;
+    virtual size_t get_num_columns() const = 0;
+    virtual Glib::ustring get_cell_text(const size_t row, const size_t col) const = 0;
+    virtual void write_strings_matrix(CtTableTexts& tableTexts) const = 0;
+
     int get_col_max() const { return _colMax; }
     int get_col_min() const { return _colMin; }
 public:
-    int  current_row() { return _currentRow < (int)_tableMatrix.size() ? _currentRow : 0; }
-    int  current_column() { return _currentColumn < (int)_tableMatrix[0].size() ? _currentColumn : 0; }
-
-    void column_add(int after_column);
-    void column_delete(int column);
-    void column_move_left(int column);
-    void column_move_right(int column);
-    void row_add(int after_row, std::vector<Glib::ustring>* row = nullptr);
-    void row_delete(int row);
-    void row_move_up(int row);
-    void row_move_down(int row);
-    bool row_sort_asc();
-    bool row_sort_desc();
-
-    void set_col_min_max(int col_min, int col_max);
+    int  current_row() { return _currentRow < (int)get_num_rows() ? _currentRow : 0; }
+    int  current_column() { return _currentColumn < (int)get_num_columns() ? _currentColumn : 0; }
 
-private:
-    void _setup_new_matrix(const CtTableMatrix& tableMatrix, bool apply_style = true);
-    void _apply_styles_to_cells();
+    virtual void column_add(int after_column) = 0;
+    virtual void column_delete(int column) = 0;
+    virtual void column_move_left(int column) = 0;
+    virtual void column_move_right(int column) = 0;
+    virtual void row_add(int after_row, std::vector<Glib::ustring>* row = nullptr) = 0;
+    virtual void row_delete(int row) = 0;
+    virtual void row_move_up(int row) = 0;
+    virtual void row_move_down(int row) = 0;
+    virtual bool row_sort_asc() = 0;
+    virtual bool row_sort_desc() = 0;
 
-    CtTableMatrix _copy_matrix(int col_add, int col_del, int row_add, int row_del, int col_move_left, int row_move_up);
+    virtual void set_col_min_max(int col_min, int col_max) = 0;
 
 protected:
     void _populate_xml_rows_cells(xmlpp::Element* p_table_node);
-
-private:
-    void _on_populate_popup_header_cell(Gtk::Menu* menu, int row, int col);
-    void _on_populate_popup_cell(Gtk::Menu* menu, int row, int col);
-    bool _on_key_press_event_cell(GdkEventKey* event, int row, int co);
+    void _set_current_cell(int row, int col);
 
 protected:
-    CtTableMatrix _tableMatrix;
-    Gtk::Grid     _grid;
     int           _colMin;
     int           _colMax;
     int           _currentRow = 0;
     int           _currentColumn = 0;
 };
+
+class CtTableHeavy : public CtTable
+{
+public:
+    CtTableHeavy(CtMainWin* pCtMainWin,
+                 const CtTableTexts& tableTexts,
+                 const int colMin,
+                 const int colMax,
+                 const int charOffset,
+                 const std::string& justification);
+    virtual ~CtTableHeavy();
+
+    void apply_syntax_highlighting() override;
+    void set_modified_false() override;
+
+    size_t get_num_rows() const override { return _tableMatrix.size(); }
+    size_t get_num_columns() const override { return _tableMatrix.empty() ? 0 : _tableMatrix.front().size(); }
+    Glib::ustring get_cell_text(const size_t row, const size_t col) const override { return _tableMatrix[row][col]->get_text_content(); }
+    void write_strings_matrix(CtTableTexts& tableTexts) const override;
+
+    const CtTableMatrix& get_table_matrix() const { return _tableMatrix; }
+
+    void column_add(int after_column) override;
+    void column_delete(int column) override;
+    void column_move_left(int column) override;
+    void column_move_right(int column) override;
+    void row_add(int after_row, std::vector<Glib::ustring>* row = nullptr) override;
+    void row_delete(int row) override;
+    void row_move_up(int row) override;
+    void row_move_down(int row) override;
+    bool row_sort_asc() override;
+    bool row_sort_desc() override;
+
+    void set_col_min_max(int col_min, int col_max) override;
+
+private:
+    CtTableCell* _new_cell(const Glib::ustring& textContent, const bool is_header);
+    void _set_cell_header(CtTableCell* pTableCell, const bool is_header);
+    void _get_cell_pos(CtTableCell* pTableCell, int& row, int& col);
+    void _set_cell_pos(CtTableCell* pTableCell, const int row, const int col);
+    void _apply_styles_to_cells();
+    void _apply_styles_to_cell(CtTableCell* pTableCell);
+    bool _row_sort(const bool ascending);
+
+private:
+    void _on_populate_popup_cell(Gtk::Menu* menu, CtTableCell* pTableCell);
+    bool _on_key_press_event_cell(GdkEventKey* event, CtTableCell* pTableCell);
+
+protected:
+    CtTableMatrix _tableMatrix;
+    Gtk::Grid     _grid;
+};
+
+class CtTableLight : public CtTable
+{
+public:
+    CtTableLight(CtMainWin* pCtMainWin,
+                 CtTableTexts tableTexts,
+                 const int colMin,
+                 const int colMax,
+                 const int charOffset,
+                 const std::string& justification);
+    virtual ~CtTableLight();
+
+    void apply_syntax_highlighting() override {}
+    void set_modified_false() override {}
+
+    size_t get_num_rows() const override { return _rListStore->children().size(); }
+    size_t get_num_columns() const override { return _uColumns->columnsText.size(); }
+    Glib::ustring get_cell_text(const size_t row, const size_t col) const override;
+    void write_strings_matrix(CtTableTexts& tableTexts) const override;
+
+    void column_add(int after_column) override;
+    void column_delete(int column) override;
+    void column_move_left(int column) override;
+    void column_move_right(int column) override;
+    void row_add(int after_row, std::vector<Glib::ustring>* row = nullptr) override;
+    void row_delete(int row) override;
+    void row_move_up(int row) override;
+    void row_move_down(int row) override;
+    bool row_sort_asc() override;
+    bool row_sort_desc() override;
+
+    void set_col_min_max(int col_min, int col_max) override;
+
+private:
+    struct CtTableLightColumns : public Gtk::TreeModelColumnRecord
+    {
+        CtTableLightColumns(const size_t numColumns)
+        {
+            columnsText.resize(numColumns);
+            for (auto& columnText : columnsText)
+                add(columnText);
+        }
+        std::vector<Gtk::TreeModelColumn<Glib::ustring>> columnsText;
+    };
+
+    void _setup_new_model(CtTableTexts tableTexts);
+    void _setup_tree_view_columns();
+    Gtk::TreeIter _get_row_iter(int row) const;
+    bool _row_sort(const bool ascending);
+
+    void _on_cell_edited(const Glib::ustring& path, const Glib::ustring& new_text, int col);
+    bool _on_button_press_event(GdkEventButton* event);
+
+private:
+    std::unique_ptr<CtTableLightColumns> _uColumns;
+    Glib::RefPtr<Gtk::ListStore>         _rListStore;
+    Gtk::TreeView                        _treeView;
+};
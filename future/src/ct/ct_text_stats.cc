@@ -0,0 +1,231 @@
+/*
+ * ct_text_stats.cc
+ *
+ * Copyright 2009-2020
+ * Giuseppe Penone <giuspen@gmail.com>
+ * Evgenii Gurianov <https://github.com/txe>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA 02110-1301, USA.
+ */
+
+#include "ct_text_stats.h"
+#include "ct_misc_utils.h"
+#include "ct_thread_pool.h"
+#include <algorithm>
+
+CtTextStats::CtTextStats(Glib::RefPtr<Gtk::TextBuffer> rTextBuffer)
+ : _rTextBuffer{rTextBuffer}
+{
+    _connect_buffer();
+    _start_full_count();
+}
+
+CtTextStats::CtTextStats(Glib::RefPtr<Gtk::TextBuffer> rTextBuffer, int words)
+ : _rTextBuffer{rTextBuffer},
+   _words{words},
+   _ready{true}
+{
+    _connect_buffer();
+}
+
+CtTextStats::~CtTextStats()
+{
+    for (sigc::connection& connection : _bufferConnections)
+    {
+        connection.disconnect();
+    }
+    // a still running worker only owns its text snapshot and its result slot
+    if (_pAsyncCount) _pAsyncCount->pOwner = nullptr;
+}
+
+void CtTextStats::_connect_buffer()
+{
+    // the 'before' handlers see the text that is going to change, the 'after' ones the changed text
+    _bufferConnections.push_back(_rTextBuffer->signal_insert().connect(sigc::mem_fun(*this, &CtTextStats::_on_insert_before), false/*after*/));
+    _bufferConnections.push_back(_rTextBuffer->signal_insert().connect(sigc::mem_fun(*this, &CtTextStats::_on_insert_after), true/*after*/));
+    _bufferConnections.push_back(_rTextBuffer->signal_erase().connect(sigc::mem_fun(*this, &CtTextStats::_on_erase_before), false/*after*/));
+    _bufferConnections.push_back(_rTextBuffer->signal_erase().connect(sigc::mem_fun(*this, &CtTextStats::_on_erase_after), true/*after*/));
+}
+
+CtTextStatsCounts CtTextStats::get_counts() const
+{
+    CtTextStatsCounts counts;
+    counts.words = _ready ? _words : -1;
+    counts.chars = _rTextBuffer->get_char_count();
+    counts.lines = _rTextBuffer->get_line_count();
+    return counts;
+}
+
+CtTextStatsCounts CtTextStats::get_counts_sync()
+{
+    if (not _ready)
+    {
+        if (not _pAsyncCount->claimed.exchange(true))
+        {
+            // the worker did not start yet, no point in waiting for it
+            _pAsyncCount->words = CtStrUtil::get_words_count(_pAsyncCount->text);
+        }
+        else
+        {
+            std::unique_lock<std::mutex> lock(_pAsyncCount->mutex);
+            _pAsyncCount->cv.wait(lock, [this]() { return _pAsyncCount->done; });
+        }
+        _on_full_count_done(_pAsyncCount);
+    }
+    return get_counts();
+}
+
+/*static*/ CtTextStatsCounts CtTextStats::count_text(const Glib::ustring& text, const size_t widgets_num)
+{
+    CtTextStatsCounts counts;
+    counts.words = CtStrUtil::get_words_count(text);
+    counts.chars = static_cast<int>(text.size() + widgets_num);
+    counts.lines = 1 + static_cast<int>(std::count(text.begin(), text.end(), '\n'));
+    return counts;
+}
+
+void CtTextStats::_start_full_count()
+{
+    // the deltas of the edits following the snapshot add up from zero
+    _words = 0;
+    _ready = false;
+    if (_pAsyncCount) _pAsyncCount->pOwner = nullptr;
+    _pAsyncCount = std::make_shared<CtAsyncCount>();
+    _pAsyncCount->pOwner = this;
+    _pAsyncCount->text = _rTextBuffer->get_text(true/*include_hidden_chars*/);
+    (void)CtThreadPool::get().submit([pAsyncCount = _pAsyncCount]() {
+        if (pAsyncCount->claimed.exchange(true)) return; // counted by get_counts_sync()
+        const int words = CtStrUtil::get_words_count(pAsyncCount->text);
+        {
+            std::lock_guard<std::mutex> lock(pAsyncCount->mutex);
+            pAsyncCount->words = words;
+            pAsyncCount->done = true;
+        }
+        pAsyncCount->cv.notify_all();
+        CtThreadPool::get().post_to_main_loop([pAsyncCount]() {
+            // the owner may be gone or may have started a newer count
+            if (pAsyncCount->pOwner)
+            {
+                pAsyncCount->pOwner->_on_full_count_done(pAsyncCount);
+            }
+        });
+    });
+}
+
+void CtTextStats::_on_full_count_done(std::shared_ptr<CtAsyncCount> pAsyncCount)
+{
+    if (pAsyncCount != _pAsyncCount)
+    {
+        return; // already taken by get_counts_sync()
+    }
+    _words += _pAsyncCount->words;
+    _pAsyncCount->pOwner = nullptr;
+    _pAsyncCount.reset();
+    _ready = true;
+    _signalReady.emit();
+}
+
+int CtTextStats::_count_lines_words(Gtk::TextIter iter_start, Gtk::TextIter iter_end)
+{
+    iter_start.set_line_offset(0);
+    if (not iter_end.ends_line())
+    {
+        iter_end.forward_to_line_end();
+    }
+    return CtStrUtil::get_words_count(_rTextBuffer->get_text(iter_start, iter_end, true/*include_hidden_chars*/));
+}
+
+bool CtTextStats::_on_edit_before_nested()
+{
+    if (++_editDepth == 1)
+    {
+        return false;
+    }
+    // an edit made by another handler of this edit: the line of the outer delta may be changed
+    // under it, the outermost 'after' counts everything again
+    _deltaLineStartOffset = -1;
+    return true;
+}
+
+bool CtTextStats::_on_edit_after_nested()
+{
+    if (_editDepth > 0)
+    {
+        --_editDepth;
+    }
+    return _editDepth > 0;
+}
+
+void CtTextStats::_on_insert_before(const Gtk::TextBuffer::iterator& pos, const Glib::ustring& text, int /*bytes*/)
+{
+    if (_on_edit_before_nested()) return;
+    Gtk::TextIter iter_line_start = pos;
+    iter_line_start.set_line_offset(0);
+    Gtk::TextIter iter_line_end = pos;
+    if (not iter_line_end.ends_line())
+    {
+        iter_line_end.forward_to_line_end();
+    }
+    if (iter_line_end.get_offset() - iter_line_start.get_offset() + (int)text.size() > FULL_COUNT_MIN_CHARS)
+    {
+        _deltaLineStartOffset = -1;
+        return;
+    }
+    _words -= _count_lines_words(iter_line_start, iter_line_end);
+    _deltaLineStartOffset = iter_line_start.get_offset();
+}
+
+void CtTextStats::_on_insert_after(const Gtk::TextBuffer::iterator& pos, const Glib::ustring& /*text*/, int /*bytes*/)
+{
+    if (_on_edit_after_nested()) return;
+    if (_deltaLineStartOffset < 0)
+    {
+        _start_full_count();
+        return;
+    }
+    // pos was revalidated to the end of the inserted text
+    _words += _count_lines_words(_rTextBuffer->get_iter_at_offset(_deltaLineStartOffset), pos);
+}
+
+void CtTextStats::_on_erase_before(const Gtk::TextBuffer::iterator& range_start, const Gtk::TextBuffer::iterator& range_end)
+{
+    if (_on_edit_before_nested()) return;
+    Gtk::TextIter iter_line_start = range_start;
+    iter_line_start.set_line_offset(0);
+    Gtk::TextIter iter_line_end = range_end;
+    if (not iter_line_end.ends_line())
+    {
+        iter_line_end.forward_to_line_end();
+    }
+    if (iter_line_end.get_offset() - iter_line_start.get_offset() > FULL_COUNT_MIN_CHARS)
+    {
+        _deltaLineStartOffset = -1;
+        return;
+    }
+    _words -= _count_lines_words(iter_line_start, iter_line_end);
+    _deltaLineStartOffset = iter_line_start.get_offset();
+}
+
+void CtTextStats::_on_erase_after(const Gtk::TextBuffer::iterator& range_start, const Gtk::TextBuffer::iterator& /*range_end*/)
+{
+    if (_on_edit_after_nested()) return;
+    if (_deltaLineStartOffset < 0)
+    {
+        _start_full_count();
+        return;
+    }
+    _words += _count_lines_words(_rTextBuffer->get_iter_at_offset(_deltaLineStartOffset), range_start);
+}
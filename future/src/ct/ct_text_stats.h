@@ -0,0 +1,105 @@
+/*
+ * ct_text_stats.h
+ *
+ * Copyright 2009-2020
+ * Giuseppe Penone <giuspen@gmail.com>
+ * Evgenii Gurianov <https://github.com/txe>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA 02110-1301, USA.
+ */
+
+#pragma once
+
+#include <gtkmm/textbuffer.h>
+#include <atomic>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+struct CtTextStatsCounts
+{
+    int words{0};
+    int chars{0};
+    int lines{0};
+};
+
+/**
+ * @brief Words, characters and lines of a node text buffer
+ * The first words count runs on a worker thread on a snapshot of the text,
+ * afterwards every insert/erase only recounts the lines it touched
+ * (pango never joins words across a newline)
+ */
+class CtTextStats
+{
+public:
+    explicit CtTextStats(Glib::RefPtr<Gtk::TextBuffer> rTextBuffer);
+    // words already counted on the current buffer text
+    CtTextStats(Glib::RefPtr<Gtk::TextBuffer> rTextBuffer, int words);
+    CtTextStats(const CtTextStats&) = delete;
+    CtTextStats& operator=(const CtTextStats&) = delete;
+    ~CtTextStats();
+
+    Glib::RefPtr<Gtk::TextBuffer> get_text_buffer() const { return _rTextBuffer; }
+    bool              is_ready() const { return _ready; }
+    CtTextStatsCounts get_counts() const;
+    // blocks until the words count is complete, for the tree summary
+    CtTextStatsCounts get_counts_sync();
+    // emitted on the main thread when the words count becomes available
+    sigc::signal<void>& signal_ready() { return _signalReady; }
+
+    // the counts of a text not in a text buffer, the widgets take one char each; it can run on any thread
+    static CtTextStatsCounts count_text(const Glib::ustring& text, const size_t widgets_num);
+
+private:
+    struct CtAsyncCount
+    {
+        Glib::ustring           text;
+        std::atomic<bool>       claimed{false}; // by the worker or by get_counts_sync(), whichever comes first
+        std::mutex              mutex;
+        std::condition_variable cv;
+        bool                    done{false};
+        int                     words{0};
+        CtTextStats*            pOwner{nullptr}; // only touched on the main thread
+    };
+
+    void _connect_buffer();
+    void _start_full_count();
+    void _on_full_count_done(std::shared_ptr<CtAsyncCount> pAsyncCount);
+    int  _count_lines_words(Gtk::TextIter iter_start, Gtk::TextIter iter_end);
+
+    // true for an edit nested in the emission of another one, the outermost one takes care of the counts
+    bool _on_edit_before_nested();
+    bool _on_edit_after_nested();
+
+    void _on_insert_before(const Gtk::TextBuffer::iterator& pos, const Glib::ustring& text, int bytes);
+    void _on_insert_after(const Gtk::TextBuffer::iterator& pos, const Glib::ustring& text, int bytes);
+    void _on_erase_before(const Gtk::TextBuffer::iterator& range_start, const Gtk::TextBuffer::iterator& range_end);
+    void _on_erase_after(const Gtk::TextBuffer::iterator& range_start, const Gtk::TextBuffer::iterator& range_end);
+
+private:
+    // deltas above this size are cheaper to count again from scratch off the main thread
+    static const int FULL_COUNT_MIN_CHARS{65536};
+
+    Glib::RefPtr<Gtk::TextBuffer>    _rTextBuffer;
+    std::vector<sigc::connection>    _bufferConnections;
+    sigc::signal<void>               _signalReady;
+    std::shared_ptr<CtAsyncCount>    _pAsyncCount;
+    int                              _words{0}; // the deltas only while the full count is running
+    int                              _deltaLineStartOffset{-1};
+    int                              _editDepth{0}; // above 1 while a handler of an edit edits the buffer again
+    bool                             _ready{false};
+};
@@ -0,0 +1,181 @@
+/*
+ * ct_thread_pool.cc
+ *
+ * Copyright 2009-2020
+ * Giuseppe Penone <giuspen@gmail.com>
+ * Evgenii Gurianov <https://github.com/txe>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA 02110-1301, USA.
+ */
+
+
+#include "ct_thread_pool.h"
+#include <algorithm>
+
+namespace {
+
+// the pool and the queue of the worker running on this thread
+thread_local CtThreadPool* tl_pool{nullptr};
+thread_local size_t tl_workerIdx{0};
+
+} // namespace (anonymous)
+
+/*static*/ CtThreadPool& CtThreadPool::get()
+{
+    // never deleted, the workers may still be busy when the application exits
+    static CtThreadPool* pThreadPool = new CtThreadPool(std::max(1u, std::thread::hardware_concurrency()));
+    return *pThreadPool;
+}
+
+CtThreadPool::CtThreadPool(const size_t workersNum)
+ : _workersNum{std::max<size_t>(1, workersNum)}
+{
+    for (size_t i = 0; i < _workersNum; ++i)
+    {
+        _queues.push_back(std::make_unique<CtWorkQueue>());
+    }
+    _mainLoopDispatcher.connect(sigc::mem_fun(*this, &CtThreadPool::_on_main_loop_dispatch));
+}
+
+CtThreadPool::~CtThreadPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(_wakeMutex);
+        _stopping = true;
+    }
+    _wakeCond.notify_all();
+    for (std::thread& thread : _threads)
+    {
+        thread.join();
+    }
+}
+
+std::future<void> CtThreadPool::submit(const CtCancelToken& token, std::function<void()> f)
+{
+    return submit([token, f = std::move(f)]() {
+        if (not token.is_cancelled()) f();
+    });
+}
+
+void CtThreadPool::_push(CtTask task)
+{
+    // a worker keeps its subtasks, the others are spread
+    const size_t queueIdx = tl_pool == this ? tl_workerIdx : _nextQueue++ % _workersNum;
+    {
+        std::lock_guard<std::mutex> lock(_queues[queueIdx]->mutex);
+        _queues[queueIdx]->tasks.push_back(std::move(task));
+    }
+    ++_queuedNum;
+    std::call_once(_startFlag, [this]() {
+        for (size_t i = 0; i < _workersNum; ++i)
+        {
+            _threads.emplace_back(&CtThreadPool::_worker_loop, this, i);
+        }
+    });
+    {
+        // the worker checks _queuedNum under this lock before sleeping
+        std::lock_guard<std::mutex> lock(_wakeMutex);
+    }
+    _wakeCond.notify_one();
+}
+
+bool CtThreadPool::_pop(std::function<void()>& task, const size_t group)
+{
+    const bool isWorker = tl_pool == this;
+    const size_t firstIdx = isWorker ? tl_workerIdx : 0;
+    for (size_t i = 0; i < _workersNum; ++i)
+    {
+        CtWorkQueue& queue = *_queues[(firstIdx + i) % _workersNum];
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        if (queue.tasks.empty()) continue;
+        if (group != NO_GROUP)
+        {
+            // only a task of the group waited for, a queue holds a few tasks at a time
+            auto it = std::find_if(queue.tasks.begin(), queue.tasks.end(), [group](const CtTask& t) { return t.group == group; });
+            if (it == queue.tasks.end()) continue;
+            task = std::move(it->f);
+            queue.tasks.erase(it);
+        }
+        else if (isWorker and i == 0)
+        {
+            // the newest of its own, still hot in cache
+            task = std::move(queue.tasks.back().f);
+            queue.tasks.pop_back();
+        }
+        else
+        {
+            // the oldest of another queue, likely the biggest
+            task = std::move(queue.tasks.front().f);
+            queue.tasks.pop_front();
+        }
+        --_queuedNum;
+        return true;
+    }
+    return false;
+}
+
+bool CtThreadPool::run_one_task(const size_t group)
+{
+    std::function<void()> task;
+    if (not _pop(task, group))
+    {
+        return false;
+    }
+    task();
+    return true;
+}
+
+void CtThreadPool::_worker_loop(const size_t workerIdx)
+{
+    tl_pool = this;
+    tl_workerIdx = workerIdx;
+    while (true)
+    {
+        if (run_one_task(NO_GROUP))
+        {
+            continue;
+        }
+        std::unique_lock<std::mutex> lock(_wakeMutex);
+        _wakeCond.wait(lock, [this]() { return _stopping or _queuedNum > 0; });
+        if (_stopping and _queuedNum == 0)
+        {
+            return;
+        }
+    }
+}
+
+void CtThreadPool::post_to_main_loop(std::function<void()> f)
+{
+    {
+        std::lock_guard<std::mutex> lock(_mainLoopMutex);
+        _mainLoopTasks.push_back(std::move(f));
+    }
+    _mainLoopDispatcher.emit();
+}
+
+void CtThreadPool::_on_main_loop_dispatch()
+{
+    std::vector<std::function<void()>> tasks;
+    {
+        std::lock_guard<std::mutex> lock(_mainLoopMutex);
+        tasks.swap(_mainLoopTasks);
+    }
+    // one emit may bring more tasks, the following emits then find none
+    for (auto& task : tasks)
+    {
+        task();
+    }
+}
@@ -0,0 +1,144 @@
+/*
+ * ct_thread_pool.h
+ *
+ * Copyright 2009-2020
+ * Giuseppe Penone <giuspen@gmail.com>
+ * Evgenii Gurianov <https://github.com/txe>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA 02110-1301, USA.
+ */
+
+
+#pragma once
+
+#include <glibmm/dispatcher.h>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+/**
+ * @brief Flag to stop a job queued or running on the thread pool
+ * The copies share the same flag, the job checks is_cancelled() at its own pace
+ */
+class CtCancelToken
+{
+public:
+    CtCancelToken() : _pCancelled{std::make_shared<std::atomic<bool>>(false)} {}
+
+    void cancel() { *_pCancelled = true; }
+    bool is_cancelled() const { return *_pCancelled; }
+
+private:
+    std::shared_ptr<std::atomic<bool>> _pCancelled;
+};
+
+/**
+ * @brief Worker threads shared by the whole application
+ * The workers are started with the first task, one per core. Every worker has its own queue
+ * and steals from the others when it is empty. A thread waiting for a group of tasks runs the
+ * queued tasks of that group meanwhile, so nested parallel work doesn't oversubscribe nor deadlock,
+ * and the main thread never picks up an unrelated long job
+ */
+class CtThreadPool
+{
+public:
+    // the shared pool, to be first called by the main thread that owns the main loop dispatcher
+    static CtThreadPool& get();
+
+    explicit CtThreadPool(const size_t workersNum);
+    CtThreadPool(const CtThreadPool&) = delete;
+    CtThreadPool& operator=(const CtThreadPool&) = delete;
+    ~CtThreadPool();
+
+    size_t get_workers_num() const { return _workersNum; }
+
+    // the tasks not submitted to a group are only run by the workers
+    static constexpr size_t NO_GROUP{0};
+    size_t new_group() { return ++_lastGroup; }
+
+    template<class F> auto submit(F&& f) -> std::future<std::invoke_result_t<std::decay_t<F>>>
+    {
+        return submit_to_group(NO_GROUP, std::forward<F>(f));
+    }
+    template<class F> auto submit_to_group(const size_t group, F&& f) -> std::future<std::invoke_result_t<std::decay_t<F>>>
+    {
+        using R = std::invoke_result_t<std::decay_t<F>>;
+        auto pTask = std::make_shared<std::packaged_task<R()>>(std::forward<F>(f));
+        std::future<R> future = pTask->get_future();
+        _push(CtTask{[pTask](){ (*pTask)(); }, group});
+        return future;
+    }
+    // the task doesn't run if the token is cancelled before it starts
+    std::future<void> submit(const CtCancelToken& token, std::function<void()> f);
+
+    // runs the queued tasks of the group on the calling thread until the future is ready
+    template<class R> void wait(const std::future<R>& future, const size_t group)
+    {
+        while (future.wait_for(std::chrono::seconds{0}) != std::future_status::ready)
+        {
+            if (not run_one_task(group))
+            {
+                // what is left is running on other threads
+                future.wait();
+            }
+        }
+    }
+    // false if no task of the group was queued, NO_GROUP for any task
+    bool run_one_task(const size_t group);
+
+    // f runs on the main thread from the main loop
+    void post_to_main_loop(std::function<void()> f);
+
+private:
+    struct CtTask
+    {
+        std::function<void()> f;
+        size_t                group;
+    };
+    struct CtWorkQueue
+    {
+        std::mutex         mutex;
+        std::deque<CtTask> tasks;
+    };
+
+    void _push(CtTask task);
+    bool _pop(std::function<void()>& task, const size_t group);
+    void _worker_loop(const size_t workerIdx);
+    void _on_main_loop_dispatch();
+
+private:
+    const size_t                              _workersNum;
+    std::vector<std::unique_ptr<CtWorkQueue>> _queues;
+    std::vector<std::thread>                  _threads;
+    std::once_flag                            _startFlag;
+    std::mutex                                _wakeMutex;
+    std::condition_variable                   _wakeCond;
+    std::atomic<size_t>                       _queuedNum{0};
+    std::atomic<size_t>                       _nextQueue{0};
+    std::atomic<size_t>                       _lastGroup{NO_GROUP};
+    bool                                      _stopping{false};
+
+    Glib::Dispatcher                          _mainLoopDispatcher;
+    std::mutex                                _mainLoopMutex;
+    std::vector<std::function<void()>>        _mainLoopTasks;
+};
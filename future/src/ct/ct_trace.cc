@@ -0,0 +1,179 @@
+/*
+ * ct_trace.cc
+ *
+ * Copyright 2009-2020
+ * Giuseppe Penone <giuspen@gmail.com>
+ * Evgenii Gurianov <https://github.com/txe>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA 02110-1301, USA.
+ */
+
+#include "ct_trace.h"
+
+#ifdef CT_TRACING
+
+#include "ct_misc_utils.h"
+#include "ct_logging.h"
+#include <glib.h>
+#include <algorithm>
+#include <atomic>
+#include <map>
+#include <mutex>
+#include <vector>
+
+namespace {
+
+struct CtTraceEvent
+{
+    const char* name;
+    int64_t     ts_us;
+    int64_t     dur_us; // counter value for counter events
+    int         tid;
+    bool        is_counter;
+};
+
+struct CtTraceSummary
+{
+    int64_t calls{0};
+    int64_t total_us{0};
+    int64_t max_us{0};
+};
+
+// beyond this the events are only summarised, not kept for the JSON
+constexpr size_t MAX_EVENTS{1000000};
+
+struct CtTraceData
+{
+    std::mutex                          mutex;
+    const CtTrace::clock_t::time_point  origin{CtTrace::clock_t::now()};
+    std::vector<CtTraceEvent>           events;
+    size_t                              dropped_events{0};
+    std::map<std::string, CtTraceSummary> summaries;
+    std::map<std::string, int64_t>      counters;
+};
+
+CtTraceData& trace_data()
+{
+    static CtTraceData data;
+    return data;
+}
+
+int trace_thread_id()
+{
+    static std::atomic<int> next_id{1};
+    thread_local const int id = next_id++;
+    return id;
+}
+
+int64_t to_us(CtTrace::clock_t::duration duration)
+{
+    return std::chrono::duration_cast<std::chrono::microseconds>(duration).count();
+}
+
+void append_event_json(CtStringBuilder& json, const CtTraceEvent& event)
+{
+    // the names are literals in the code, no escaping needed
+    json << "{\"name\":\"" << event.name << "\",\"pid\":1,\"tid\":" << std::to_string(event.tid) << ",\"ts\":" << std::to_string(event.ts_us);
+    if (event.is_counter)
+    {
+        json << ",\"ph\":\"C\",\"args\":{\"value\":" << std::to_string(event.dur_us) << "}}";
+    }
+    else
+    {
+        json << ",\"ph\":\"X\",\"dur\":" << std::to_string(event.dur_us) << "}";
+    }
+}
+
+} // namespace (anonymous)
+
+void CtTrace::add_duration(const char* name, clock_t::time_point start, clock_t::time_point end)
+{
+    CtTraceData& data = trace_data();
+    const int64_t dur_us = to_us(end - start);
+    std::lock_guard<std::mutex> lock(data.mutex);
+    CtTraceSummary& summary = data.summaries[name];
+    ++summary.calls;
+    summary.total_us += dur_us;
+    summary.max_us = std::max(summary.max_us, dur_us);
+    if (data.events.size() < MAX_EVENTS)
+        data.events.push_back(CtTraceEvent{name, to_us(start - data.origin), dur_us, trace_thread_id(), false});
+    else
+        ++data.dropped_events;
+}
+
+void CtTrace::add_count(const char* name, int64_t value)
+{
+    CtTraceData& data = trace_data();
+    const int64_t ts_us = to_us(clock_t::now() - data.origin);
+    std::lock_guard<std::mutex> lock(data.mutex);
+    const int64_t total = (data.counters[name] += value);
+    if (data.events.size() < MAX_EVENTS)
+        data.events.push_back(CtTraceEvent{name, ts_us, total, trace_thread_id(), true});
+    else
+        ++data.dropped_events;
+}
+
+void CtTrace::dump()
+{
+    CtTraceData& data = trace_data();
+    std::lock_guard<std::mutex> lock(data.mutex);
+
+    std::vector<std::pair<std::string, CtTraceSummary>> sorted_summaries(data.summaries.begin(), data.summaries.end());
+    std::sort(sorted_summaries.begin(), sorted_summaries.end(), [](const auto& lhs, const auto& rhs) {
+        return lhs.second.total_us > rhs.second.total_us;
+    });
+    spdlog::info("trace: {:<32} {:>8} {:>12} {:>12} {:>12}", "scope", "calls", "total ms", "avg ms", "max ms");
+    for (const auto& [name, summary] : sorted_summaries)
+    {
+        spdlog::info("trace: {:<32} {:>8} {:>12.3f} {:>12.3f} {:>12.3f}", name, summary.calls,
+                     summary.total_us/1000., summary.total_us/1000./summary.calls, summary.max_us/1000.);
+    }
+    for (const auto& [name, value] : data.counters)
+    {
+        spdlog::info("trace: {:<32} {:>8}", name, value);
+    }
+    if (data.dropped_events > 0)
+    {
+        spdlog::warn("trace: {} events not kept for the JSON output", data.dropped_events);
+    }
+
+    const char* json_filepath = g_getenv("CHERRYTREE_TRACE_FILE");
+    if (not json_filepath or not *json_filepath)
+    {
+        return;
+    }
+    CtStringBuilder json;
+    json.reserve(data.events.size() * 96);
+    json << "{\"traceEvents\":[\n";
+    for (size_t i = 0; i < data.events.size(); ++i)
+    {
+        if (i > 0) json << ",\n";
+        append_event_json(json, data.events[i]);
+    }
+    json << "\n],\"displayTimeUnit\":\"ms\"}\n";
+    GError* pError{nullptr};
+    if (g_file_set_contents(json_filepath, json.c_str(), json.size(), &pError))
+    {
+        spdlog::info("trace: {} events written to {}", data.events.size(), json_filepath);
+    }
+    else
+    {
+        spdlog::error("trace: failed to write {}: {}", json_filepath, pError->message);
+        g_error_free(pError);
+    }
+}
+
+#endif // CT_TRACING
@@ -0,0 +1,74 @@
+/*
+ * ct_trace.h
+ *
+ * Copyright 2009-2020
+ * Giuseppe Penone <giuspen@gmail.com>
+ * Evgenii Gurianov <https://github.com/txe>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA 02110-1301, USA.
+ */
+
+#pragma once
+
+// timing of the main operations, built only with cmake -DUSE_TRACING=ON
+// CT_TRACE_SCOPE("name");         time from here to the end of the scope
+// CT_TRACE_COUNT("name", value);  add value to a counter
+// CT_TRACE_DUMP();                summary table to spdlog and, if the environment
+//                                 variable CHERRYTREE_TRACE_FILE is set, Chrome
+//                                 trace-event JSON (chrome://tracing) to that file
+
+#ifdef CT_TRACING
+
+#include <chrono>
+#include <cstdint>
+
+class CtTrace
+{
+public:
+    using clock_t = std::chrono::steady_clock;
+
+    class Scope
+    {
+    public:
+        explicit Scope(const char* name) : _name{name}, _start{clock_t::now()} {}
+        ~Scope() { CtTrace::add_duration(_name, _start, clock_t::now()); }
+        Scope(const Scope&) = delete;
+        Scope& operator=(const Scope&) = delete;
+
+    private:
+        const char*       _name;
+        clock_t::time_point _start;
+    };
+
+    // name must be a string literal (or anyway outlive the trace)
+    static void add_duration(const char* name, clock_t::time_point start, clock_t::time_point end);
+    static void add_count(const char* name, int64_t value);
+    static void dump();
+};
+
+#define CT_TRACE_CONCAT_IMPL(a, b) a##b
+#define CT_TRACE_CONCAT(a, b) CT_TRACE_CONCAT_IMPL(a, b)
+#define CT_TRACE_SCOPE(name) CtTrace::Scope CT_TRACE_CONCAT(ctTraceScope_, __LINE__){name}
+#define CT_TRACE_COUNT(name, value) CtTrace::add_count(name, value)
+#define CT_TRACE_DUMP() CtTrace::dump()
+
+#else // CT_TRACING
+
+#define CT_TRACE_SCOPE(name) do {} while (false)
+#define CT_TRACE_COUNT(name, value) do {} while (false)
+#define CT_TRACE_DUMP() do {} while (false)
+
+#endif // CT_TRACING
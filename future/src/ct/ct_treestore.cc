@@ -26,9 +26,116 @@
 #include "ct_misc_utils.h"
 #include "ct_main_win.h"
 #include "ct_storage_control.h"
+#include "ct_storage_xml.h"
 #include "ct_actions.h"
 #include "ct_logging.h"
 
+// distance between the sequences of siblings renumbered, to leave room for later insertions
+constexpr gint64 NODE_SEQUENCE_STEP{1024};
+
+CtAnchorIndex::~CtAnchorIndex()
+{
+    _disconnect_buffer();
+}
+
+std::list<CtAnchoredWidget*> CtAnchorIndex::get_range(Glib::RefPtr<Gsv::Buffer> rTextBuffer,
+                                                      const std::list<CtAnchoredWidget*>& anchoredWidgets,
+                                                      int start_offset,
+                                                      int end_offset)
+{
+    if (not _valid or _rTextBuffer != rTextBuffer or _numWidgets != anchoredWidgets.size())
+    {
+        _rebuild(rTextBuffer, anchoredWidgets);
+    }
+    auto itStart = _offsetWidgets.begin();
+    if (start_offset >= 0)
+    {
+        itStart = std::lower_bound(_offsetWidgets.begin(), _offsetWidgets.end(), start_offset, [](const std::pair<int, CtAnchoredWidget*>& element, int offset) {
+            return element.first < offset;
+        });
+    }
+    auto itEnd = _offsetWidgets.end();
+    if (end_offset >= 0)
+    {
+        itEnd = std::upper_bound(itStart, _offsetWidgets.end(), end_offset, [](int offset, const std::pair<int, CtAnchoredWidget*>& element) {
+            return offset < element.first;
+        });
+    }
+    std::list<CtAnchoredWidget*> retAnchoredWidgetsList;
+    for (auto it = itStart; it != itEnd; ++it)
+    {
+        CtAnchoredWidget* pCtAnchoredWidget = it->second;
+        pCtAnchoredWidget->updateOffset(it->first);
+        // justification is a tag, it can change without moving the anchor
+        pCtAnchoredWidget->updateJustification(rTextBuffer->get_iter_at_offset(it->first));
+        retAnchoredWidgetsList.push_back(pCtAnchoredWidget);
+    }
+    return retAnchoredWidgetsList;
+}
+
+void CtAnchorIndex::_rebuild(Glib::RefPtr<Gsv::Buffer> rTextBuffer, const std::list<CtAnchoredWidget*>& anchoredWidgets)
+{
+    if (_rTextBuffer != rTextBuffer)
+    {
+        _disconnect_buffer();
+        _connect_buffer(rTextBuffer);
+    }
+    _offsetWidgets.clear();
+    _offsetWidgets.reserve(anchoredWidgets.size());
+    for (CtAnchoredWidget* pCtAnchoredWidget : anchoredWidgets)
+    {
+        // widgets whose anchor was removed from the buffer (or never inserted) are left out
+        Glib::RefPtr<Gtk::TextChildAnchor> rChildAnchor = pCtAnchoredWidget->getTextChildAnchor();
+        if (not rChildAnchor or rChildAnchor->get_deleted())
+        {
+            continue;
+        }
+        Gtk::TextIter anchorIter = rTextBuffer->get_iter_at_child_anchor(rChildAnchor);
+        if (anchorIter.get_buffer().get() != rTextBuffer.get())
+        {
+            continue;
+        }
+        _offsetWidgets.emplace_back(anchorIter.get_offset(), pCtAnchoredWidget);
+    }
+    std::stable_sort(_offsetWidgets.begin(), _offsetWidgets.end(), [](const std::pair<int, CtAnchoredWidget*>& lhs, const std::pair<int, CtAnchoredWidget*>& rhs) {
+        return lhs.first < rhs.first;
+    });
+    _numWidgets = anchoredWidgets.size();
+    _valid = true;
+}
+
+void CtAnchorIndex::_connect_buffer(Glib::RefPtr<Gsv::Buffer> rTextBuffer)
+{
+    _rTextBuffer = rTextBuffer;
+    if (not _rTextBuffer)
+    {
+        return;
+    }
+    // any of these shift the offsets of the following anchors
+    _bufferConnections.push_back(rTextBuffer->signal_insert().connect([this](const Gtk::TextBuffer::iterator&, const Glib::ustring&, int) {
+        _valid = false;
+    }));
+    _bufferConnections.push_back(rTextBuffer->signal_erase().connect([this](const Gtk::TextBuffer::iterator&, const Gtk::TextBuffer::iterator&) {
+        _valid = false;
+    }));
+    _bufferConnections.push_back(rTextBuffer->signal_insert_child_anchor().connect([this](const Gtk::TextBuffer::iterator&, const Glib::RefPtr<Gtk::TextChildAnchor>&) {
+        _valid = false;
+    }));
+    _bufferConnections.push_back(rTextBuffer->signal_insert_pixbuf().connect([this](const Gtk::TextBuffer::iterator&, const Glib::RefPtr<Gdk::Pixbuf>&) {
+        _valid = false;
+    }));
+}
+
+void CtAnchorIndex::_disconnect_buffer()
+{
+    for (sigc::connection& connection : _bufferConnections)
+    {
+        connection.disconnect();
+    }
+    _bufferConnections.clear();
+    _rTextBuffer.reset();
+}
+
 CtTreeIter::CtTreeIter(Gtk::TreeIter iter, const CtTreeModelColumns* pColumns, CtMainWin* pCtMainWin)
  : Gtk::TreeIter(iter),
    _pColumns(pColumns),
@@ -152,6 +259,8 @@ void CtTreeIter::set_node_sequence(gint64 num)
 void CtTreeIter::set_node_text_buffer(Glib::RefPtr<Gsv::Buffer> new_buffer, const std::string& new_syntax_hilighting)
 {
     remove_all_embedded_widgets();
+    _invalidate_anchor_index();
+    (*this)->set_value(_pColumns->colTextStats, std::shared_ptr<CtTextStats>());
     (*this)->set_value(_pColumns->rColTextBuffer, new_buffer);
     (*this)->set_value(_pColumns->colSyntaxHighlighting, new_syntax_hilighting);
     pending_edit_db_node_buff();
@@ -166,11 +275,20 @@ Glib::RefPtr<Gsv::Buffer> CtTreeIter::get_node_text_buffer() const
         rRetTextBuffer = (*this)->get_value(_pColumns->rColTextBuffer);
         if (not rRetTextBuffer)
         {
-            // SQLite text buffer not yet populated
             std::list<CtAnchoredWidget*> anchoredWidgetList;
-            rRetTextBuffer = _pCtMainWin->get_ct_storage()->get_delayed_text_buffer((*this)->get_value(_pColumns->colNodeUniqueId),
-                                                                                    (*this)->get_value(_pColumns->colSyntaxHighlighting),
-                                                                                    anchoredWidgetList);
+            if (std::shared_ptr<CtNodeState> pCloneSource = (*this)->get_value(_pColumns->colCloneSource))
+            {
+                // duplicated node, text buffer not yet created
+                rRetTextBuffer = _pCtMainWin->get_new_text_buffer_from_state(pCloneSource, anchoredWidgetList);
+                (*this)->set_value(_pColumns->colCloneSource, std::shared_ptr<CtNodeState>());
+            }
+            else
+            {
+                // SQLite text buffer not yet populated
+                rRetTextBuffer = _pCtMainWin->get_ct_storage()->get_delayed_text_buffer((*this)->get_value(_pColumns->colNodeUniqueId),
+                                                                                        (*this)->get_value(_pColumns->colSyntaxHighlighting),
+                                                                                        anchoredWidgetList);
+            }
             (*this)->set_value(_pColumns->colAnchoredWidgets, anchoredWidgetList);
             (*this)->set_value(_pColumns->rColTextBuffer, rRetTextBuffer);
         }
@@ -178,6 +296,29 @@ Glib::RefPtr<Gsv::Buffer> CtTreeIter::get_node_text_buffer() const
     return rRetTextBuffer;
 }
 
+bool CtTreeIter::get_node_buffer_already_loaded() const
+{
+    // a duplicated node has its buffer in the clone source
+    return (*this) and ((*this)->get_value(_pColumns->rColTextBuffer) or (*this)->get_value(_pColumns->colCloneSource));
+}
+
+std::shared_ptr<CtTextStats> CtTreeIter::get_node_text_stats() const
+{
+    std::shared_ptr<CtTextStats> pTextStats;
+    if (*this)
+    {
+        Glib::RefPtr<Gsv::Buffer> rTextBuffer = get_node_text_buffer();
+        pTextStats = (*this)->get_value(_pColumns->colTextStats);
+        if (not pTextStats or pTextStats->get_text_buffer().get() != rTextBuffer.get())
+        {
+            // first request or the node buffer was replaced
+            pTextStats = std::make_shared<CtTextStats>(rTextBuffer);
+            (*this)->set_value(_pColumns->colTextStats, pTextStats);
+        }
+    }
+    return pTextStats;
+}
+
 int CtTreeIter::get_pango_weight_from_is_bold(bool isBold)
 {
     return isBold ? PANGO_WEIGHT_HEAVY : PANGO_WEIGHT_NORMAL;
@@ -196,6 +337,7 @@ void CtTreeIter::remove_all_embedded_widgets()
         for (auto widget: (*this)->get_value(_pColumns->colAnchoredWidgets))
             delete widget;
         (*this)->set_value(_pColumns->colAnchoredWidgets, std::list<CtAnchoredWidget*>());
+        _invalidate_anchor_index();
     }
 }
 
@@ -212,35 +354,25 @@ std::list<CtAnchoredWidget*> CtTreeIter::get_embedded_pixbufs_tables_codeboxes_f
 std::list<CtAnchoredWidget*> CtTreeIter::get_embedded_pixbufs_tables_codeboxes(int start_offset /*= -1*/, int end_offset /*= -1*/)
 {
     get_node_text_buffer(); // to load buffer\widgets if not loaded
-    std::list<CtAnchoredWidget*> retAnchoredWidgetsList;
-    if ((*this) and (*this)->get_value(_pColumns->colAnchoredWidgets).size() > 0)
+    if (not (*this) or (*this)->get_value(_pColumns->colAnchoredWidgets).empty())
     {
-        Glib::RefPtr<Gsv::Buffer> rTextBuffer = get_node_text_buffer();
-        Gtk::TextIter curr_iter = start_offset >= 0 ? rTextBuffer->get_iter_at_offset(start_offset) : rTextBuffer->begin();
-        do
-        {
-            if ((end_offset >= 0) and (curr_iter.get_offset() > end_offset))
-            {
-                break;
-            }
-            Glib::RefPtr<Gtk::TextChildAnchor> rChildAnchor = curr_iter.get_child_anchor();
-            if (rChildAnchor)
-            {
-                for (CtAnchoredWidget* pCtAnchoredWidget : (*this)->get_value(_pColumns->colAnchoredWidgets))
-                {
-                    if (rChildAnchor == pCtAnchoredWidget->getTextChildAnchor())
-                    {
-                        pCtAnchoredWidget->updateOffset(curr_iter.get_offset());
-                        pCtAnchoredWidget->updateJustification(curr_iter);
-                        retAnchoredWidgetsList.push_back(pCtAnchoredWidget);
-                        break;
-                    }
-                }
-            }
-        }
-        while (curr_iter.forward_char());
+        return std::list<CtAnchoredWidget*>();
+    }
+    std::shared_ptr<CtAnchorIndex> pAnchorIndex = (*this)->get_value(_pColumns->colAnchorIndex);
+    if (not pAnchorIndex)
+    {
+        pAnchorIndex = std::make_shared<CtAnchorIndex>();
+        (*this)->set_value(_pColumns->colAnchorIndex, pAnchorIndex);
+    }
+    return pAnchorIndex->get_range(get_node_text_buffer(), (*this)->get_value(_pColumns->colAnchoredWidgets), start_offset, end_offset);
+}
+
+void CtTreeIter::_invalidate_anchor_index()
+{
+    if (std::shared_ptr<CtAnchorIndex> pAnchorIndex = (*this)->get_value(_pColumns->colAnchorIndex))
+    {
+        pAnchorIndex->invalidate();
     }
-    return retAnchoredWidgetsList;
 }
 
 void CtTreeIter::pending_edit_db_node_prop()
@@ -384,41 +516,61 @@ void CtTreeStore::treeview_set_tree_path_n_text_cursor(Gtk::TreeView* pTreeView,
 
 std::string CtTreeStore::treeview_get_tree_expanded_collapsed_string(Gtk::TreeView& treeView)
 {
-    std::vector<std::string> expanded_collapsed_vec;
-    _rTreeStore->foreach(
-        [this, &treeView, &expanded_collapsed_vec](const Gtk::TreePath& path, const Gtk::TreeIter& iter)->bool
+    // only the expanded nodes are kept, as ranges of node ids
+    std::vector<gint64> expanded_node_ids;
+    treeView.map_expanded_rows(
+        [this, &expanded_node_ids](Gtk::TreeView* /*pTreeView*/, const Gtk::TreePath& path)
         {
-            expanded_collapsed_vec.push_back(std::to_string(iter->get_value(_columns.colNodeUniqueId))
-                                             + ","
-                                             + (treeView.row_expanded(path) ? "True" : "False"));
-            return false; /* false for continue */
+            expanded_node_ids.push_back(_rTreeStore->get_iter(path)->get_value(_columns.colNodeUniqueId));
         }
     );
-    return str::join(expanded_collapsed_vec, "_");
+    return CtStrUtil::ids_to_ranges(std::move(expanded_node_ids));
 }
 
 void CtTreeStore::treeview_set_tree_expanded_collapsed_string(const std::string& expanded_collapsed_string, Gtk::TreeView& treeView, bool nodes_bookm_exp)
 {
-    std::map<gint64, bool> expanded_collapsed_dict;
-    auto expand_collapsed_vec = str::split(expanded_collapsed_string, "_");
-    for (const std::string& element: expand_collapsed_vec)
+    std::unordered_set<gint64> expanded_node_ids;
+    if (expanded_collapsed_string.find("True") != std::string::npos or expanded_collapsed_string.find("False") != std::string::npos)
     {
-        auto couple = str::split(element, ",");
-        if (couple.size() == 2)
+        // older versions: "id,True_id,False_..." with every node
+        for (const std::string& element: str::split(expanded_collapsed_string, "_"))
         {
-            expanded_collapsed_dict[std::stoll(couple[0])] = CtStrUtil::is_str_true(couple[1]);
+            auto couple = str::split(element, ",");
+            if (couple.size() == 2 and CtStrUtil::is_str_true(couple[1]))
+            {
+                expanded_node_ids.insert(std::stoll(couple[0]));
+            }
         }
     }
+    else
+    {
+        gint64 max_node_id{0};
+        _rTreeStore->foreach_iter([&max_node_id, this](const Gtk::TreeIter& iter)
+        {
+            max_node_id = std::max(max_node_id, iter->get_value(_columns.colNodeUniqueId));
+            return false; /* continue */
+        });
+        expanded_node_ids = CtStrUtil::ranges_to_ids(expanded_collapsed_string, max_node_id);
+    }
+    std::unordered_set<gint64> bookmarks_to_expand;
+    if (nodes_bookm_exp)
+    {
+        bookmarks_to_expand.insert(_bookmarks.begin(), _bookmarks.end());
+    }
     treeView.collapse_all();
+    if (expanded_node_ids.empty() and bookmarks_to_expand.empty())
+    {
+        return;
+    }
     _rTreeStore->foreach(
-        [this, &treeView, &expanded_collapsed_dict, &nodes_bookm_exp](const Gtk::TreePath& path, const Gtk::TreeIter& iter)->bool
+        [this, &treeView, &expanded_node_ids, &bookmarks_to_expand](const Gtk::TreePath& path, const Gtk::TreeIter& iter)->bool
         {
-            gint64 node_id = iter->get_value(_columns.colNodeUniqueId);
-            if (map::exists(expanded_collapsed_dict, node_id) and expanded_collapsed_dict.at(node_id))
+            const gint64 node_id = iter->get_value(_columns.colNodeUniqueId);
+            if (expanded_node_ids.count(node_id))
             {
                 treeView.expand_row(path, false);
             }
-            else if (nodes_bookm_exp and vec::exists(_bookmarks, node_id) and iter->parent())
+            else if (bookmarks_to_expand.count(node_id) and iter->parent())
             {
                 treeView.expand_to_path(_rTreeStore->get_path(iter->parent()));
             }
@@ -429,6 +581,7 @@ void CtTreeStore::treeview_set_tree_expanded_collapsed_string(const std::string&
 
 void CtTreeStore::tree_view_connect(Gtk::TreeView* pTreeView)
 {
+    _pTreeView = pTreeView;
     pTreeView->set_model(_rTreeStore);
 
     // if change column num, then change CtTreeView::TITLE_COL_NUM
@@ -481,7 +634,7 @@ void CtTreeStore::text_view_apply_textbuffer(CtTreeIter& treeIter, CtTextView* p
     }
     _curr_node_sigc_conn.clear();
 
-    spdlog::debug("Node name: {}", treeIter.get_node_name());
+    SPDLOG_DEBUG("Node name: {}", treeIter.get_node_name());
 
     Glib::RefPtr<Gsv::Buffer> rTextBuffer = treeIter.get_node_text_buffer();
     _pCtMainWin->apply_syntax_highlighting(rTextBuffer, treeIter.get_node_syntax_highlighting());
@@ -535,6 +688,20 @@ void CtTreeStore::text_view_apply_textbuffer(CtTreeIter& treeIter, CtTextView* p
 
 Glib::RefPtr<Gdk::Pixbuf> CtTreeStore::_get_node_icon(int nodeDepth, const std::string &syntax, guint32 customIconId)
 {
+    if (_bulkLoadDepth > 0)
+    {
+        // the icon depends only on these while loading, the config cannot change
+        const auto cacheKey = std::make_tuple(nodeDepth, syntax, customIconId);
+        auto cacheIt = _bulkLoadIconsCache.find(cacheKey);
+        if (cacheIt == _bulkLoadIconsCache.end())
+        {
+            --_bulkLoadDepth;
+            cacheIt = _bulkLoadIconsCache.emplace(cacheKey, _get_node_icon(nodeDepth, syntax, customIconId)).first;
+            ++_bulkLoadDepth;
+        }
+        return cacheIt->second;
+    }
+
     Glib::RefPtr<Gdk::Pixbuf> rPixbuf;
 
     if (0 != customIconId)
@@ -593,6 +760,7 @@ void CtTreeStore::get_node_data(const Gtk::TreeIter& treeIter, CtNodeData& nodeD
     nodeData.tsCreation = row[_columns.colTsCreation];
     nodeData.tsLastSave = row[_columns.colTsLastSave];
     nodeData.anchoredWidgets = row[_columns.colAnchoredWidgets];
+    nodeData.cloneSource = row[_columns.colCloneSource];
 }
 
 void CtTreeStore::update_node_data(const Gtk::TreeIter& treeIter, const CtNodeData& nodeData)
@@ -615,6 +783,11 @@ void CtTreeStore::update_node_data(const Gtk::TreeIter& treeIter, const CtNodeDa
     row[_columns.colTsCreation] = nodeData.tsCreation;
     row[_columns.colTsLastSave] = nodeData.tsLastSave;
     row[_columns.colAnchoredWidgets] = nodeData.anchoredWidgets;
+    row[_columns.colCloneSource] = nodeData.rTextBuffer ? nullptr : nodeData.cloneSource;
+    if (std::shared_ptr<CtAnchorIndex> pAnchorIndex = row[_columns.colAnchorIndex])
+    {
+        pAnchorIndex->invalidate();
+    }
 
     update_node_aux_icon(treeIter);
     add_used_tags(nodeData.tags);
@@ -685,6 +858,45 @@ Gtk::TreeIter CtTreeStore::insert_node(CtNodeData* pNodeData, const Gtk::TreeIte
     return newIter;
 }
 
+void CtTreeStore::bulk_load_begin()
+{
+    if (_bulkLoadDepth++ > 0)
+    {
+        return;
+    }
+    if (_pTreeView and _pTreeView->get_model())
+    {
+        // every row inserted/changed would be processed by the tree view
+        _bulkLoadExpCollStr = treeview_get_tree_expanded_collapsed_string(*_pTreeView);
+        Gtk::TreeViewColumn* pColumn{nullptr};
+        _pTreeView->get_cursor(_bulkLoadCursorPath, pColumn);
+        _pTreeView->unset_model();
+    }
+}
+
+void CtTreeStore::bulk_load_end()
+{
+    if (_bulkLoadDepth == 0 or --_bulkLoadDepth > 0)
+    {
+        return;
+    }
+    _bulkLoadIconsCache.clear();
+    if (_pTreeView and not _pTreeView->get_model())
+    {
+        _pTreeView->set_model(_rTreeStore);
+        if (not _bulkLoadExpCollStr.empty())
+        {
+            treeview_set_tree_expanded_collapsed_string(_bulkLoadExpCollStr, *_pTreeView, _pCtMainWin->get_ct_config()->nodesBookmExp);
+        }
+        if (not _bulkLoadCursorPath.empty())
+        {
+            _pTreeView->set_cursor(_bulkLoadCursorPath);
+        }
+    }
+    _bulkLoadExpCollStr.clear();
+    _bulkLoadCursorPath.clear();
+}
+
 void CtTreeStore::_on_textbuffer_modified_changed(Glib::RefPtr<Gtk::TextBuffer> rTextBuffer)
 {
     if (_pCtMainWin->user_active() and rTextBuffer->get_modified())
@@ -711,6 +923,10 @@ void CtTreeStore::addAnchoredWidgets(Gtk::TreeIter treeIter, std::list<CtAnchore
     for (auto new_widget: anchoredWidgetList)
         widgets.push_back(new_widget);
     treeIter->set_value(_columns.colAnchoredWidgets, widgets);
+    if (std::shared_ptr<CtAnchorIndex> pAnchorIndex = treeIter->get_value(_columns.colAnchorIndex))
+    {
+        pAnchorIndex->invalidate();
+    }
 
     for (CtAnchoredWidget* pCtAnchoredWidget : anchoredWidgetList)
     {
@@ -895,13 +1111,56 @@ CtTreeIter CtTreeStore::to_ct_tree_iter(Gtk::TreeIter tree_iter)
     return CtTreeIter(tree_iter, &get_columns(), _pCtMainWin);
 }
 
+void CtTreeStore::node_sequence_fix(Gtk::TreeIter node_iter)
+{
+    Gtk::TreeIter prev_iter = get_tree_iter_prev_sibling(node_iter);
+    Gtk::TreeIter next_iter = node_iter;
+    ++next_iter;
+    const gint64 prev_sequence = prev_iter ? to_ct_tree_iter(prev_iter).get_node_sequence() : 0;
+    const gint64 next_sequence = next_iter ? to_ct_tree_iter(next_iter).get_node_sequence() : 0;
+    CtTreeIter ct_node_iter = to_ct_tree_iter(node_iter);
+    const gint64 node_sequence = ct_node_iter.get_node_sequence();
+    if (node_sequence > prev_sequence and (not next_iter or node_sequence < next_sequence))
+    {
+        return; // already in order
+    }
+    if (next_iter and next_sequence - prev_sequence >= 2)
+    {
+        ct_node_iter.set_node_sequence(prev_sequence + (next_sequence - prev_sequence)/2);
+        ct_node_iter.pending_edit_db_node_hier();
+        return;
+    }
+    // no free sequence: shift the following siblings up to the first one already in order
+    gint64 sequence = prev_sequence;
+    for (Gtk::TreeIter iter = node_iter; iter; ++iter)
+    {
+        CtTreeIter ct_iter = to_ct_tree_iter(iter);
+        if (iter != node_iter and ct_iter.get_node_sequence() > sequence)
+        {
+            break;
+        }
+        sequence += NODE_SEQUENCE_STEP;
+        ct_iter.set_node_sequence(sequence);
+        ct_iter.pending_edit_db_node_hier();
+    }
+}
+
 void CtTreeStore::nodes_sequences_fix(Gtk::TreeIter father_iter,  bool process_children)
 {
     auto children = father_iter ? father_iter->children() : _rTreeStore->children();
-    gint64 node_sequence = 0;
+    // the sequences already there are handed out again in the new order of the siblings,
+    // so only the nodes that changed position are touched
+    std::vector<gint64> sequences;
+    for (auto& child: children)
+        sequences.push_back(to_ct_tree_iter(child).get_node_sequence());
+    std::sort(sequences.begin(), sequences.end());
+    const bool reuse_sequences = not sequences.empty() and sequences.front() > 0 and
+                                 std::adjacent_find(sequences.begin(), sequences.end()) == sequences.end();
+    size_t child_idx{0};
     for (auto& child: children)
     {
-        ++node_sequence;
+        const gint64 node_sequence = reuse_sequences ? sequences[child_idx] : static_cast<gint64>(child_idx + 1) * NODE_SEQUENCE_STEP;
+        ++child_idx;
         auto ct_child = to_ct_tree_iter(child);
         if (ct_child.get_node_sequence() != node_sequence)
         {
@@ -915,6 +1174,12 @@ void CtTreeStore::nodes_sequences_fix(Gtk::TreeIter father_iter,  bool process_c
 
 void CtTreeStore::populateSummaryInfo(CtSummaryInfo& summaryInfo)
 {
+    // nodes whose words were never counted, counted all together below
+    std::vector<Gtk::TreeIter> uncountedIters;
+    std::vector<Glib::ustring> uncountedTexts;
+    // nodes not loaded, their content is read from the storage or from the clone source without building their buffers
+    std::vector<Glib::ustring> unloadedTexts;
+    std::vector<size_t> unloadedWidgetsNums;
     _rTreeStore->foreach(
         [&](const Gtk::TreePath& /*treePath*/, const Gtk::TreeIter& treeIter)->bool
         {
@@ -929,7 +1194,18 @@ void CtTreeStore::populateSummaryInfo(CtSummaryInfo& summaryInfo)
             else {
                 ++summaryInfo.nodes_code_num;
             }
-            (void)ctTreeIter.get_node_text_buffer(); // ensure the node content is populated
+            if (not treeIter->get_value(_columns.rColTextBuffer)) {
+                unloadedTexts.emplace_back();
+                if (std::shared_ptr<CtNodeState> pCloneSource = treeIter->get_value(_columns.colCloneSource)) {
+                    unloadedWidgetsNums.push_back(_summary_from_node_state(*pCloneSource, unloadedTexts.back(), summaryInfo));
+                }
+                else {
+                    unloadedWidgetsNums.push_back(_pCtMainWin->get_ct_storage()->get_node_summary(ctTreeIter.get_node_id(),
+                                                                                                  unloadedTexts.back(),
+                                                                                                  summaryInfo));
+                }
+                return false; /* false for continue */
+            }
             for (CtAnchoredWidget* pAnchoredWidget : ctTreeIter.get_embedded_pixbufs_tables_codeboxes_fast()) {
                 switch (pAnchoredWidget->get_type()) {
                     case CtAnchWidgType::CodeBox: ++summaryInfo.codeboxes_num; break;
@@ -939,7 +1215,60 @@ void CtTreeStore::populateSummaryInfo(CtSummaryInfo& summaryInfo)
                     case CtAnchWidgType::Table: ++summaryInfo.tables_num; break;
                 }
             }
+            std::shared_ptr<CtTextStats> pTextStats = treeIter->get_value(_columns.colTextStats);
+            if (pTextStats and pTextStats->get_text_buffer().get() == ctTreeIter.get_node_text_buffer().get())
+            {
+                const CtTextStatsCounts counts = pTextStats->get_counts_sync();
+                summaryInfo.words_num += counts.words;
+                summaryInfo.chars_num += counts.chars;
+                summaryInfo.lines_num += counts.lines;
+            }
+            else
+            {
+                uncountedIters.push_back(treeIter);
+                uncountedTexts.push_back(ctTreeIter.get_node_text_buffer()->get_text(true/*include_hidden_chars*/));
+            }
             return false; /* false for continue */
         }
     );
+    std::vector<int> uncountedWords(uncountedTexts.size(), 0);
+    CtMiscUtil::parallel_for(0, uncountedTexts.size(), [&](size_t idx) {
+        uncountedWords[idx] = CtStrUtil::get_words_count(uncountedTexts[idx]);
+    });
+    for (size_t idx = 0; idx < uncountedIters.size(); ++idx)
+    {
+        // cache for the next time, kept current by the buffer edits from now on
+        Glib::RefPtr<Gsv::Buffer> rTextBuffer = to_ct_tree_iter(uncountedIters[idx]).get_node_text_buffer();
+        auto pTextStats = std::make_shared<CtTextStats>(rTextBuffer, uncountedWords[idx]);
+        uncountedIters[idx]->set_value(_columns.colTextStats, pTextStats);
+        const CtTextStatsCounts counts = pTextStats->get_counts();
+        summaryInfo.words_num += counts.words;
+        summaryInfo.chars_num += counts.chars;
+        summaryInfo.lines_num += counts.lines;
+    }
+    std::vector<CtTextStatsCounts> unloadedCounts(unloadedTexts.size());
+    CtMiscUtil::parallel_for(0, unloadedTexts.size(), [&](size_t idx) {
+        unloadedCounts[idx] = CtTextStats::count_text(unloadedTexts[idx], unloadedWidgetsNums[idx]);
+    });
+    for (const CtTextStatsCounts& counts : unloadedCounts)
+    {
+        summaryInfo.words_num += counts.words;
+        summaryInfo.chars_num += counts.chars;
+        summaryInfo.lines_num += counts.lines;
+    }
+}
+
+/*static*/ size_t CtTreeStore::_summary_from_node_state(const CtNodeState& nodeState, Glib::ustring& text, CtSummaryInfo& summaryInfo)
+{
+    // the xml of the state has no widgets, they are apart
+    (void)CtStorageXmlHelper::summary_from_xml(nodeState.buffer_xml.get_root_node(), text, summaryInfo);
+    for (const std::shared_ptr<CtAnchoredWidgetState>& pWidgetState : nodeState.widgetStates)
+    {
+        if (dynamic_cast<CtAnchoredWidgetState_Codebox*>(pWidgetState.get()))      ++summaryInfo.codeboxes_num;
+        else if (dynamic_cast<CtAnchoredWidgetState_Table*>(pWidgetState.get()))   ++summaryInfo.tables_num;
+        else if (dynamic_cast<CtAnchoredWidgetState_Anchor*>(pWidgetState.get()))  ++summaryInfo.anchors_num;
+        else if (dynamic_cast<CtAnchoredWidgetState_EmbFile*>(pWidgetState.get())) ++summaryInfo.embfile_num;
+        else                                                                       ++summaryInfo.images_num;
+    }
+    return nodeState.widgetStates.size();
 }
@@ -24,13 +24,16 @@
 #pragma once
 
 #include "ct_types.h"
+#include "ct_text_stats.h"
 #include <gtkmm.h>
 #include <gtksourceviewmm.h>
 #include <set>
+#include <tuple>
 #include <unordered_map>
 
 class CtMainWin;
 class CtAnchoredWidget;
+struct CtNodeState;
 
 struct CtNodeData
 {
@@ -47,6 +50,35 @@ struct CtNodeData
     gint64         sequence{-1};
     Glib::RefPtr<Gsv::Buffer>  rTextBuffer{nullptr};
     std::list<CtAnchoredWidget*> anchoredWidgets;
+    std::shared_ptr<CtNodeState> cloneSource; // rTextBuffer not yet created from this duplicated content
+};
+
+// node anchored widgets sorted by offset, rebuilt only after the text buffer changed
+class CtAnchorIndex
+{
+public:
+    CtAnchorIndex() = default;
+    CtAnchorIndex(const CtAnchorIndex&) = delete;
+    CtAnchorIndex& operator=(const CtAnchorIndex&) = delete;
+    ~CtAnchorIndex();
+
+    std::list<CtAnchoredWidget*> get_range(Glib::RefPtr<Gsv::Buffer> rTextBuffer,
+                                           const std::list<CtAnchoredWidget*>& anchoredWidgets,
+                                           int start_offset,
+                                           int end_offset);
+    void invalidate() { _valid = false; }
+
+private:
+    void _rebuild(Glib::RefPtr<Gsv::Buffer> rTextBuffer, const std::list<CtAnchoredWidget*>& anchoredWidgets);
+    void _connect_buffer(Glib::RefPtr<Gsv::Buffer> rTextBuffer);
+    void _disconnect_buffer();
+
+private:
+    std::vector<std::pair<int, CtAnchoredWidget*>> _offsetWidgets;
+    std::vector<sigc::connection>                  _bufferConnections;
+    Glib::RefPtr<Gsv::Buffer>                      _rTextBuffer;
+    size_t                                         _numWidgets{0};
+    bool                                           _valid{false};
 };
 
 class CtTreeModelColumns final : public Gtk::TreeModel::ColumnRecord
@@ -57,7 +89,8 @@ public:
         add(rColPixbuf); add(colNodeName); add(rColTextBuffer); add(colNodeUniqueId);
         add(colSyntaxHighlighting); add(colNodeSequence); add(colNodeTags); add(colNodeRO);
         add(rColPixbufAux); add(colCustomIconId); add(colWeight); add(colForeground);
-        add(colTsCreation); add(colTsLastSave); add(colAnchoredWidgets);
+        add(colTsCreation); add(colTsLastSave); add(colAnchoredWidgets); add(colAnchorIndex);
+        add(colTextStats); add(colCloneSource);
     }
     ~CtTreeModelColumns() final {}
     Gtk::TreeModelColumn<Glib::RefPtr<Gdk::Pixbuf>>  rColPixbuf;
@@ -75,6 +108,9 @@ public:
     Gtk::TreeModelColumn<gint64>                     colTsCreation;
     Gtk::TreeModelColumn<gint64>                     colTsLastSave;
     Gtk::TreeModelColumn<std::list<CtAnchoredWidget*>> colAnchoredWidgets;
+    Gtk::TreeModelColumn<std::shared_ptr<CtAnchorIndex>> colAnchorIndex;
+    Gtk::TreeModelColumn<std::shared_ptr<CtTextStats>> colTextStats;
+    Gtk::TreeModelColumn<std::shared_ptr<CtNodeState>> colCloneSource; // content of a duplicated node not yet opened
 };
 
 class CtMainWin;
@@ -109,6 +145,9 @@ public:
 
     void                      set_node_text_buffer(Glib::RefPtr<Gsv::Buffer> new_buffer, const std::string& new_syntax_hilighting);
     Glib::RefPtr<Gsv::Buffer> get_node_text_buffer() const;
+    // false if get_node_text_buffer() would read the buffer from the storage
+    bool                      get_node_buffer_already_loaded() const;
+    std::shared_ptr<CtTextStats> get_node_text_stats() const;
 
     void                         remove_all_embedded_widgets();
     std::list<CtAnchoredWidget*> get_embedded_pixbufs_tables_codeboxes_fast();
@@ -122,6 +161,9 @@ public:
     static int  get_pango_weight_from_is_bold(bool isBold);
     static bool get_is_bold_from_pango_weight(int pangoWeight);
 
+private:
+    void _invalidate_anchor_index();
+
 private:
     const CtTreeModelColumns* _pColumns{nullptr};
     CtMainWin*                _pCtMainWin{nullptr};
@@ -167,6 +209,12 @@ public:
     Gtk::TreeIter append_node(CtNodeData* pNodeData, const Gtk::TreeIter* pParentIter=nullptr);
     Gtk::TreeIter insert_node(CtNodeData* pNodeData, const Gtk::TreeIter& afterIter);
 
+    // to add many nodes: the model is detached from the tree view and the nodes icons are cached
+    // until the matching bulk_load_end(), then the expanded nodes and the cursor are restored
+    void          bulk_load_begin();
+    void          bulk_load_end();
+    bool          is_bulk_loading() const { return _bulkLoadDepth > 0; }
+
     void addAnchoredWidgets(Gtk::TreeIter treeIter, std::list<CtAnchoredWidget*> anchoredWidgetList, Gtk::TextView* pTextView);
 
     void treevew_expand_to_tree_row(Gtk::TreeView* pTreeView, Gtk::TreeRow& row);
@@ -201,6 +249,9 @@ public:
     CtTreeIter                      get_iter(Gtk::TreePath& path);
     CtTreeIter                      to_ct_tree_iter(Gtk::TreeIter tree_iter);
 
+    // the siblings sequences only have to be increasing, gaps are left so that a node inserted or moved
+    // usually takes a free sequence and the following siblings are shifted only when there is none
+    void node_sequence_fix(Gtk::TreeIter node_iter);
     void nodes_sequences_fix(Gtk::TreeIter father_iter,  bool process_children);
 
     const CtTreeModelColumns& get_columns() { return _columns; }
@@ -216,6 +267,9 @@ protected:
     void _on_textbuffer_insert(const Gtk::TextBuffer::iterator& pos, const Glib::ustring& text, int bytes); // pygtk: on_text_insertion
     void _on_textbuffer_erase(const Gtk::TextBuffer::iterator& range_start, const Gtk::TextBuffer::iterator& range_end); // pygtk: on_text_removal
 
+    // the content of a duplicated node not yet opened, for populateSummaryInfo; returns the number of widgets
+    static size_t _summary_from_node_state(const CtNodeState& nodeState, Glib::ustring& text, CtSummaryInfo& summaryInfo);
+
 private:
     CtTreeModelColumns              _columns;
     Glib::RefPtr<CtDragStore>       _rTreeStore;
@@ -224,4 +278,10 @@ private:
     std::map<gint64, Glib::ustring> _nodes_names_dict; // for link tooltips
     std::list<sigc::connection>     _curr_node_sigc_conn;
     CtMainWin*                      _pCtMainWin;
+    Gtk::TreeView*                  _pTreeView{nullptr};
+
+    int                             _bulkLoadDepth{0};
+    std::string                     _bulkLoadExpCollStr;
+    Gtk::TreePath                   _bulkLoadCursorPath;
+    std::map<std::tuple<int, std::string, guint32>, Glib::RefPtr<Gdk::Pixbuf>> _bulkLoadIconsCache;
 };
@@ -25,6 +25,8 @@
 
 #include <string>
 #include <list>
+#include <vector>
+#include <functional>
 #include <set>
 #include <unordered_map>
 #include <glibmm/ustring.h>
@@ -130,6 +132,21 @@ struct CtStorageSyncPending
     std::set<gint64>                               nodes_to_rm_set;
 };
 
+struct CtSummaryInfo
+{
+    size_t nodes_rich_text_num{0};
+    size_t nodes_plain_text_num{0};
+    size_t nodes_code_num{0};
+    size_t images_num{0};
+    size_t embfile_num{0};
+    size_t tables_num{0};
+    size_t codeboxes_num{0};
+    size_t anchors_num{0};
+    size_t words_num{0};
+    size_t chars_num{0};
+    size_t lines_num{0};
+};
+
 struct CtNodeData;
 class CtAnchoredWidget;
 class CtStorageEntity
@@ -144,12 +161,21 @@ public:
 
     virtual bool populate_treestore(const fs::path& file_path, Glib::ustring& error) = 0;
     virtual bool save_treestore(const fs::path& file_path, const CtStorageSyncPending& syncPending, Glib::ustring& error) = 0;
+    // save_treestore in two steps: the snapshot of the changes is taken here, already serialized, so the
+    // returned function can write them (and vacuum) from another thread while the tree is edited; it throws on error
+    virtual std::function<void()> snapshot_treestore(const fs::path& file_path, const CtStorageSyncPending& syncPending, const bool need_vacuum) = 0;
     virtual void vacuum() = 0;
     virtual void import_nodes(const fs::path& path) = 0;
 
     virtual Glib::RefPtr<Gsv::Buffer> get_delayed_text_buffer(const gint64& node_id,
                                                               const std::string& syntax,
                                                               std::list<CtAnchoredWidget*>& widgets) const = 0;
+    // reads ahead in the background what get_delayed_text_buffer needs for these nodes, in order of
+    // likelihood; nothing to do where the whole document is already parsed in memory
+    virtual void prefetch_delayed_text_buffers(const std::vector<gint64>& /*node_ids*/) {}
+    // for the tree summary of a node not loaded: its text as the text buffer would hold it and its widgets
+    // added to summaryInfo, without building the buffer nor the widgets; returns the number of widgets
+    virtual size_t get_node_summary(const gint64& node_id, Glib::ustring& text, CtSummaryInfo& summaryInfo) const = 0;
 
 };
 
@@ -159,15 +185,3 @@ struct CtExportOptions
     bool new_node_page{false};
     bool index_in_page{true};
 };
-
-struct CtSummaryInfo
-{
-    size_t nodes_rich_text_num{0};
-    size_t nodes_plain_text_num{0};
-    size_t nodes_code_num{0};
-    size_t images_num{0};
-    size_t embfile_num{0};
-    size_t tables_num{0};
-    size_t codeboxes_num{0};
-    size_t anchors_num{0};
-};
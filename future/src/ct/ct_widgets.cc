@@ -182,6 +182,8 @@ CtTextView::CtTextView(CtMainWin* pCtMainWin)
 
 CtTextView::~CtTextView()
 {
+    if (_hoverTickId) remove_tick_callback(_hoverTickId);
+    for (auto& connection : _hoverBufferConnections) connection.disconnect();
 }
 
 void CtTextView::setup_for_syntax(const std::string& syntax)
@@ -354,7 +356,21 @@ bool CtTextView::_markdown_filter_active() {
 void CtTextView::set_buffer(const Glib::RefPtr<Gtk::TextBuffer>& buffer)
 {
     Gsv::View::set_buffer(buffer);
-    
+
+    // any edit or tag change can move or remove the hovered link
+    for (auto& connection : _hoverBufferConnections) connection.disconnect();
+    _hoverBufferConnections.clear();
+    cursor_and_tooltips_invalidate();
+    if (buffer)
+    {
+        auto hover_cache_invalidate = [this](){ cursor_and_tooltips_invalidate(); };
+        _hoverBufferConnections.push_back(buffer->signal_changed().connect(hover_cache_invalidate));
+        _hoverBufferConnections.push_back(buffer->signal_apply_tag().connect(
+            [hover_cache_invalidate](const Glib::RefPtr<Gtk::TextTag>&, const Gtk::TextIter&, const Gtk::TextIter&){ hover_cache_invalidate(); }));
+        _hoverBufferConnections.push_back(buffer->signal_remove_tag().connect(
+            [hover_cache_invalidate](const Glib::RefPtr<Gtk::TextTag>&, const Gtk::TextIter&, const Gtk::TextIter&){ hover_cache_invalidate(); }));
+    }
+
     // Setup the markdown filter for a new buffer
     if (_markdown_filter_active()) _md_handler->buffer(get_buffer());
 }
@@ -639,6 +655,20 @@ void CtTextView::cursor_and_tooltips_handler(int x, int y)
     Gtk::TextIter text_iter;
     get_iter_at_location(text_iter, x, y);
 
+    // cursor and tooltip are already set while the pointer stays on the same link or char
+    const int iter_offset = text_iter.get_offset();
+    if (_hoverCache.valid and _hoverCache.pBuffer == get_buffer()->gobj()
+        and iter_offset >= _hoverCache.startOffset and iter_offset < _hoverCache.endOffset)
+    {
+        _pCtMainWin->hovering_link_iter_offset() = _hoverCache.isLink ? iter_offset : -1;
+        return;
+    }
+    _hoverCache.valid = true;
+    _hoverCache.pBuffer = get_buffer()->gobj();
+    _hoverCache.startOffset = iter_offset;
+    _hoverCache.endOffset = iter_offset + 1;
+    _hoverCache.isLink = false;
+
     if (CtList(_pCtMainWin, get_buffer()).is_list_todo_beginning(text_iter))
     {
         get_window(Gtk::TEXT_WINDOW_TEXT)->set_cursor(Gdk::Cursor::create(Gdk::X_CURSOR));
@@ -655,6 +685,13 @@ void CtTextView::cursor_and_tooltips_handler(int x, int y)
             find_link = true;
             hovering_link_iter_offset = text_iter.get_offset();
             tooltip = _pCtMainWin->sourceview_hovering_link_get_tooltip(tag_name.substr(5));
+            // the same tooltip for the whole link
+            Gtk::TextIter iter_start = text_iter;
+            Gtk::TextIter iter_end = text_iter;
+            if (not iter_start.starts_tag(tag)) iter_start.backward_to_tag_toggle(tag);
+            iter_end.forward_to_tag_toggle(tag);
+            _hoverCache.startOffset = iter_start.get_offset();
+            _hoverCache.endOffset = std::max(iter_end.get_offset(), iter_offset + 1);
             break;
         }
     }
@@ -664,6 +701,8 @@ void CtTextView::cursor_and_tooltips_handler(int x, int y)
         for (int i: {0, 1})
         {
             if (i == 1) iter_anchor.backward_char();
+            // no widget lookup unless there is an anchor
+            if (not iter_anchor.get_child_anchor()) continue;
             auto widgets = _pCtMainWin->curr_tree_iter().get_embedded_pixbufs_tables_codeboxes(iter_anchor.get_offset(), iter_anchor.get_offset());
             if (not widgets.empty())
                 if (CtImagePng* image = dynamic_cast<CtImagePng*>(widgets.front()))
@@ -675,6 +714,7 @@ void CtTextView::cursor_and_tooltips_handler(int x, int y)
                     }
         }
     }
+    _hoverCache.isLink = hovering_link_iter_offset >= 0;
     if (_pCtMainWin->get_ct_actions()->getCtMainWin()->hovering_link_iter_offset() != hovering_link_iter_offset)
     {
         _pCtMainWin->get_ct_actions()->getCtMainWin()->hovering_link_iter_offset() = hovering_link_iter_offset;
@@ -694,6 +734,18 @@ void CtTextView::cursor_and_tooltips_handler(int x, int y)
     }
 }
 
+void CtTextView::cursor_and_tooltips_queue(int x, int y)
+{
+    _hoverPendingX = x;
+    _hoverPendingY = y;
+    if (_hoverTickId) return;
+    _hoverTickId = add_tick_callback([this](const Glib::RefPtr<Gdk::FrameClock>&){
+        _hoverTickId = 0;
+        cursor_and_tooltips_handler(_hoverPendingX, _hoverPendingY);
+        return false; // once per queue
+    });
+}
+
 // Increase or Decrease Text Font
 void CtTextView::zoom_text(bool is_increase)
 {
@@ -122,6 +122,10 @@ public:
     void for_event_after_key_press(GdkEvent* event, const Glib::ustring& syntaxHighlighting);
 
     void cursor_and_tooltips_handler(int x, int y);
+    // the motion events are coalesced, cursor_and_tooltips_handler runs at most once per frame
+    void cursor_and_tooltips_queue(int x, int y);
+    // the next cursor_and_tooltips_handler recomputes, e.g. after the window cursor was set elsewhere
+    void cursor_and_tooltips_invalidate() { _hoverCache.valid = false; }
     void zoom_text(bool is_increase);
     void set_spell_check(bool allow_on);
 
@@ -149,4 +153,19 @@ private:
     std::unique_ptr<CtMarkdownFilter> _md_handler;
 
     CtMainWin* _pCtMainWin;
+
+    // result of the last cursor_and_tooltips_handler, still right for any offset in [startOffset, endOffset)
+    struct CtHoverCache
+    {
+        bool           valid{false};
+        GtkTextBuffer* pBuffer{nullptr};
+        int            startOffset{0};
+        int            endOffset{0};
+        bool           isLink{false};
+    };
+    CtHoverCache                  _hoverCache;
+    std::vector<sigc::connection> _hoverBufferConnections;
+    guint                         _hoverTickId{0};
+    int                           _hoverPendingX{0};
+    int                           _hoverPendingY{0};
 };
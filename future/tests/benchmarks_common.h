@@ -0,0 +1,227 @@
+/*
+ * benchmarks_common.h
+ *
+ * Copyright 2009-2020
+ * Giuseppe Penone <giuspen@gmail.com>
+ * Evgenii Gurianov <https://github.com/txe>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA 02110-1301, USA.
+ */
+
+#pragma once
+
+#include "tests_common.h"
+
+#include <gdkmm/pixbuf.h>
+#include <glibmm/base64.h>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+
+namespace UT {
+
+struct BenchDocParams
+{
+    int nodesNum{10};
+    int depth{1};         // rich text nodes nested in chains of up to this depth
+    int textBytes{0};     // plain words after the anchored widgets of each rich text node
+    int imageEvery{0};    // an image in one rich text node every imageEvery, 0 = no images
+    int imageSide{64};
+    int tableEvery{1};    // a table in one rich text node every tableEvery
+    int tableRows{0};     // 0 = no tables
+    int tableCols{0};
+    int codeboxEvery{1};  // a codebox in one rich text node every codeboxEvery
+    int codeboxLines{0};  // 0 = no codeboxes
+    int codeNodeLines{0}; // 0 = no code node after each rich text node
+};
+
+// the word that ends the text of every rich text node, to search for
+const char benchSearchWord[]{"needle"};
+
+// Integer from the environment variable, to scale the benchmarks without rebuilding
+inline int bench_env_int(const char* varname, const int defaultValue)
+{
+    const char* value = g_getenv(varname);
+    return value and *value ? std::atoi(value) : defaultValue;
+}
+
+// Base64 of a side x side png with a gradient, so that it does not compress to nothing
+inline std::string bench_generate_png_base64(const int side)
+{
+    Glib::RefPtr<Gdk::Pixbuf> rPixbuf = Gdk::Pixbuf::create(Gdk::COLORSPACE_RGB, false/*has_alpha*/, 8, side, side);
+    guint8* pPixels = rPixbuf->get_pixels();
+    for (int y = 0; y < side; ++y) {
+        guint8* pRow = pPixels + y * rPixbuf->get_rowstride();
+        for (int x = 0; x < side; ++x) {
+            pRow[3*x] = static_cast<guint8>(x * 255 / side);
+            pRow[3*x + 1] = static_cast<guint8>(y * 255 / side);
+            pRow[3*x + 2] = static_cast<guint8>((x ^ y) & 0xff);
+        }
+    }
+    gchar* pBuffer{nullptr};
+    gsize bufferSize{0};
+    rPixbuf->save_to_buffer(pBuffer, bufferSize, "png");
+    const std::string encoded = Glib::Base64::encode(std::string(pBuffer, bufferSize));
+    g_free(pBuffer);
+    return encoded;
+}
+
+// Synthetic .ctd document: rich text nodes with images, tables and codeboxes, each
+// on its own line, followed by plain words; optionally each with a child code node
+inline std::string bench_generate_ctd(const BenchDocParams& params)
+{
+    static const char* words[]{"lorem", "ipsum", "dolor", "sit", "amet", "consectetur", "adipiscing", "elit", "sed", "do"};
+    const std::string png_base64 = params.imageEvery > 0 ? bench_generate_png_base64(params.imageSide) : "";
+    std::string xml{"<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n<cherrytree>\n"};
+    int node_id{0};
+    int open_rich_nodes{0};
+    auto add_node_open = [&](const std::string& name, const char* syntax) {
+        xml += "<node name=\"" + name + "\" unique_id=\"" + std::to_string(++node_id) + "\" prog_lang=\"" + syntax +
+               "\" tags=\"\" readonly=\"0\" custom_icon_id=\"0\" is_bold=\"0\" foreground=\"\" ts_creation=\"0\" ts_lastsave=\"0\">\n";
+    };
+    for (int n = 0; n < params.nodesNum; ++n) {
+        // the first of every depth nodes is top level, the following ones each a child of the previous
+        const int level = params.depth > 1 ? n % params.depth : 0;
+        for (; open_rich_nodes > level; --open_rich_nodes) {
+            xml += "</node>\n";
+        }
+        const bool with_image = params.imageEvery > 0 and n % params.imageEvery == 0;
+        const bool with_table = params.tableRows > 0 and params.tableCols > 0 and params.tableEvery > 0 and n % params.tableEvery == 0;
+        const bool with_codebox = params.codeboxLines > 0 and params.codeboxEvery > 0 and n % params.codeboxEvery == 0;
+        const int widgets_num = with_image + with_table + with_codebox;
+
+        add_node_open("rich " + std::to_string(n), "custom-colors");
+        ++open_rich_nodes;
+        // ascii only, so that bytes are chars for the widgets offsets
+        std::string text{"widgets:\n"};
+        text.append(widgets_num, '\n');
+        for (size_t w = 0; text.size() < static_cast<size_t>(params.textBytes); ++w) {
+            text += words[(n + w) % 10];
+            text += (w % 12 == 11) ? '\n' : ' ';
+        }
+        text += benchSearchWord;
+        text += '\n';
+        xml += "<rich_text>" + text + "</rich_text>\n";
+        // every anchor ends up at the start of one of the empty lines
+        int char_offset{9};
+        if (with_image) {
+            xml += "<encoded_png char_offset=\"" + std::to_string(char_offset) + "\" justification=\"left\" link=\"\">" + png_base64 + "</encoded_png>\n";
+            char_offset += 2;
+        }
+        if (with_table) {
+            xml += "<table char_offset=\"" + std::to_string(char_offset) + "\" justification=\"left\" col_min=\"40\" col_max=\"120\">\n";
+            for (int r = 0; r < params.tableRows; ++r) {
+                xml += "<row>";
+                for (int c = 0; c < params.tableCols; ++c) {
+                    xml += "<cell>cell " + std::to_string(r) + "." + std::to_string(c) + " some words to wrap</cell>";
+                }
+                xml += "</row>\n";
+            }
+            xml += "</table>\n";
+            char_offset += 2;
+        }
+        if (with_codebox) {
+            xml += "<codebox char_offset=\"" + std::to_string(char_offset) + "\" justification=\"left\" frame_width=\"500\" frame_height=\"100\" width_in_pixels=\"1\""
+                   " syntax_highlighting=\"c\" highlight_brackets=\"1\" show_line_numbers=\"0\">";
+            for (int l = 0; l < params.codeboxLines; ++l) {
+                xml += "for (int i = 0; i &lt; " + std::to_string(l) + "; ++i) { sum += values[i] * 2; }\n";
+            }
+            xml += "</codebox>\n";
+        }
+        if (params.codeNodeLines > 0) {
+            add_node_open("code " + std::to_string(n), "python3");
+            xml += "<rich_text>";
+            for (int l = 0; l < params.codeNodeLines; ++l) {
+                xml += "def function_" + std::to_string(l) + "(a, b):\n    return a * b + " + std::to_string(l) + "\n";
+            }
+            xml += "</rich_text>\n</node>\n";
+        }
+    }
+    for (; open_rich_nodes > 0; --open_rich_nodes) {
+        xml += "</node>\n";
+    }
+    xml += "</cherrytree>\n";
+    return xml;
+}
+
+// Synthetic markdown text, a header and a mix of paragraphs, formatting, links, lists, code blocks and tables per section
+inline std::string bench_generate_md(const int sectionsNum)
+{
+    std::string md;
+    for (int n = 0; n < sectionsNum; ++n) {
+        const std::string num = std::to_string(n);
+        md += "## Section " + num + "\n\n";
+        md += "Some **bold text** and some _italic text_ with `inline code` and ~~strikethrough~~, "
+              "then a [link number " + num + "](https://example.com/page" + num + ") and an escaped \\*star\\*.\n";
+        md += "A longer paragraph of plain words that goes on for a while to look like real prose, "
+              "with nothing special in it apart from being long enough to matter for the tokenizer.\n\n";
+        md += "* first item " + num + "\n* second item with **bold**\n- third item\n\n";
+        md += "```cpp\nint main() { return " + num + "; }\n```\n\n";
+        md += "| col a | col b |\n| --- | --- |\n| a" + num + " | b" + num + " |\n\n";
+    }
+    return md;
+}
+
+class BenchTimer
+{
+public:
+    BenchTimer() : _start{std::chrono::steady_clock::now()} {}
+    double elapsed_ms() const
+    {
+        return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - _start).count();
+    }
+private:
+    std::chrono::steady_clock::time_point _start;
+};
+
+// one json object per line appended to the file in the environment variable CHERRYTREE_BENCH_FILE,
+// to compare the results of different builds/machines over time
+inline void bench_append_result(const char* name, const double elapsed_ms, const double mb_per_s)
+{
+    const char* results_filepath = g_getenv("CHERRYTREE_BENCH_FILE");
+    if (not results_filepath or not *results_filepath) {
+        return;
+    }
+    if (FILE* pFile = g_fopen(results_filepath, "a")) {
+        fprintf(pFile, "{\"name\":\"%s\",\"time\":%" G_GINT64_FORMAT ",\"ms\":%.3f", name, g_get_real_time() / G_USEC_PER_SEC, elapsed_ms);
+        if (mb_per_s >= 0) {
+            fprintf(pFile, ",\"mb_per_s\":%.3f", mb_per_s);
+        }
+        fprintf(pFile, "}\n");
+        fclose(pFile);
+    }
+}
+
+inline void bench_report(const char* name, const double elapsed_ms)
+{
+    printf("\nBENCH %s: %.1f ms\n", name, elapsed_ms);
+    bench_append_result(name, elapsed_ms, -1);
+}
+
+inline void bench_report(const std::string& name, const double elapsed_ms)
+{
+    bench_report(name.c_str(), elapsed_ms);
+}
+
+inline void bench_report_throughput(const char* name, const double elapsed_ms, const size_t bytes)
+{
+    const double mb_per_s = elapsed_ms > 0 ? (bytes / (1024.0 * 1024.0)) / (elapsed_ms / 1000.0) : 0.0;
+    printf("\nBENCH %s: %.1f ms, %.2f MB/s\n", name, elapsed_ms, mb_per_s);
+    bench_append_result(name, elapsed_ms, mb_per_s);
+}
+
+} // namespace UT
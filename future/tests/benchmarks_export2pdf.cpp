@@ -0,0 +1,82 @@
+/*
+ * benchmarks_export2pdf.cpp
+ *
+ * Copyright 2009-2020
+ * Giuseppe Penone <giuspen@gmail.com>
+ * Evgenii Gurianov <https://github.com/txe>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA 02110-1301, USA.
+ */
+
+#include "ct_app.h"
+#include "ct_misc_utils.h"
+#include "benchmarks_common.h"
+#include "CppUTest/CommandLineTestRunner.h"
+
+class BenchExport2PdfApp : public CtApp
+{
+public:
+    BenchExport2PdfApp(const UT::BenchDocParams& docParams)
+     : CtApp{},
+       _docParams{docParams}
+    {}
+
+private:
+    void on_activate() final;
+
+    const UT::BenchDocParams& _docParams;
+};
+
+void BenchExport2PdfApp::on_activate()
+{
+    CtMainWin* pWin = _create_window(true/*no_gui*/);
+    const fs::path tmp_dirpath = pWin->get_ct_tmp()->getHiddenDirPath("BENCH");
+    const fs::path doc_filepath = tmp_dirpath / "bench_export2pdf.ctd";
+    const fs::path pdf_filepath = tmp_dirpath / "bench_export2pdf.pdf";
+    Glib::file_set_contents(doc_filepath.string(), UT::bench_generate_ctd(_docParams));
+    CHECK(pWin->file_open(doc_filepath, ""));
+
+    UT::BenchTimer timer;
+    pWin->get_ct_actions()->export_to_pdf_auto(pdf_filepath.string(), true/*overwrite*/);
+    UT::bench_report("export2pdf_tables_codeboxes", timer.elapsed_ms());
+    CHECK(fs::is_regular_file(pdf_filepath));
+
+    pWin->force_exit() = true;
+    remove_window(*pWin);
+}
+
+TEST_GROUP(Export2PdfBenchGroup)
+{
+};
+
+#if !defined(__APPLE__) // CtApp causes crash on macos
+
+TEST(Export2PdfBenchGroup, tables_and_codeboxes)
+{
+    UT::BenchDocParams docParams;
+    docParams.nodesNum = 20;
+    docParams.tableRows = 200;
+    docParams.tableCols = 6;
+    docParams.codeboxLines = 1000;
+    docParams.codeNodeLines = 2000;
+    const std::vector<std::string> vec_args{"cherrytree"};
+    gchar** pp_args = CtStrUtil::vector_to_array(vec_args);
+    BenchExport2PdfApp benchApp{docParams};
+    benchApp.run(vec_args.size(), pp_args);
+    g_strfreev(pp_args);
+}
+
+#endif // __APPLE__
@@ -0,0 +1,49 @@
+/*
+ * benchmarks_import_md.cpp
+ *
+ * Copyright 2009-2020
+ * Giuseppe Penone <giuspen@gmail.com>
+ * Evgenii Gurianov <https://github.com/txe>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA 02110-1301, USA.
+ */
+
+#include "ct_imports.h"
+#include "ct_config.h"
+#include "benchmarks_common.h"
+#include "CppUTest/CommandLineTestRunner.h"
+
+TEST_GROUP(ImportMdBenchGroup)
+{
+};
+
+TEST(ImportMdBenchGroup, large_md_file)
+{
+    g_autofree gchar* pTmpDir = g_dir_make_tmp("ct_bench_md_XXXXXX", nullptr);
+    const fs::path md_filepath = fs::path{pTmpDir} / "bench_import.md";
+    const std::string md_text = UT::bench_generate_md(20000);
+    Glib::file_set_contents(md_filepath.string(), md_text);
+
+    CtConfig ctConfig;
+    CtMDImport importer{&ctConfig};
+    UT::BenchTimer timer;
+    std::unique_ptr<ct_imported_node> node = importer.import_file(md_filepath);
+    UT::bench_report_throughput("import_md_large_file", timer.elapsed_ms(), md_text.size());
+    CHECK(node);
+    CHECK(node->has_content());
+
+    fs::remove_all(pTmpDir);
+}
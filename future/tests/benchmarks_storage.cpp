@@ -0,0 +1,170 @@
+/*
+ * benchmarks_storage.cpp
+ *
+ * Copyright 2009-2020
+ * Giuseppe Penone <giuspen@gmail.com>
+ * Evgenii Gurianov <https://github.com/txe>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA 02110-1301, USA.
+ */
+
+
+#include "ct_app.h"
+#include "ct_misc_utils.h"
+#include "benchmarks_common.h"
+#include "CppUTest/CommandLineTestRunner.h"
+
+class BenchStorageApp : public CtApp
+{
+public:
+    BenchStorageApp(const UT::BenchDocParams& docParams)
+     : CtApp{},
+       _docParams{docParams}
+    {}
+
+private:
+    void on_activate() final;
+
+    void _run_doc_type(const fs::path& ctd_filepath, const fs::path& tmp_dirpath, const std::string& doc_ext);
+    int  _search_all_nodes(CtMainWin* pWin);
+
+    const UT::BenchDocParams& _docParams;
+};
+
+void BenchStorageApp::on_activate()
+{
+    CtMainWin* pWin = _create_window(true/*no_gui*/);
+    const fs::path tmp_dirpath = pWin->get_ct_tmp()->getHiddenDirPath("BENCH");
+    pWin->force_exit() = true;
+    remove_window(*pWin);
+
+    const fs::path ctd_filepath = tmp_dirpath / "bench_generated.ctd";
+    Glib::file_set_contents(ctd_filepath.string(), UT::bench_generate_ctd(_docParams));
+    for (const std::string doc_ext : {"ctb", "ctd", "ctz", "ctx"}) {
+        _run_doc_type(ctd_filepath, tmp_dirpath, doc_ext);
+    }
+}
+
+// what the search in all nodes does, short of the dialogs: the text of every node through a regex
+int BenchStorageApp::_search_all_nodes(CtMainWin* pWin)
+{
+    Glib::RefPtr<Glib::Regex> rRegex = Glib::Regex::create(UT::benchSearchWord, Glib::REGEX_MULTILINE);
+    int matches_num{0};
+    pWin->get_tree_store().get_store()->foreach_iter([&](const Gtk::TreeIter& iter) {
+        CtTreeIter ctTreeIter = pWin->get_tree_store().to_ct_tree_iter(iter);
+        const Glib::ustring text = ctTreeIter.get_node_text_buffer()->get_text();
+        Glib::MatchInfo matchInfo;
+        for (bool found = rRegex->match(text, matchInfo); found; found = matchInfo.next()) {
+            ++matches_num;
+        }
+        return false; /* false for continue */
+    });
+    return matches_num;
+}
+
+void BenchStorageApp::_run_doc_type(const fs::path& ctd_filepath, const fs::path& tmp_dirpath, const std::string& doc_ext)
+{
+    const fs::path doc_filepath = tmp_dirpath / ("bench_storage." + doc_ext);
+    const fs::path doc_filepath_bis = tmp_dirpath / ("bench_storage_bis." + doc_ext);
+    const Glib::ustring password = fs::get_doc_encrypt(doc_filepath) == CtDocEncrypt::True ? UT::testPassword : "";
+    {
+        // conversion from the generated document, not measured
+        CtMainWin* pWin = _create_window(true/*no_gui*/);
+        CHECK(pWin->file_open(ctd_filepath, ""));
+        pWin->file_save_as(doc_filepath.string(), password);
+        pWin->force_exit() = true;
+        remove_window(*pWin);
+    }
+    CtMainWin* pWin = _create_window(true/*no_gui*/);
+    UT::BenchTimer timer_load;
+    CHECK(pWin->file_open(doc_filepath, "", password));
+    UT::bench_report("load_" + doc_ext, timer_load.elapsed_ms());
+
+    UT::BenchTimer timer_load_nodes;
+    pWin->get_tree_store().get_store()->foreach_iter([&](const Gtk::TreeIter& iter) {
+        CHECK(static_cast<bool>(pWin->get_tree_store().to_ct_tree_iter(iter).get_node_text_buffer()));
+        return false; /* false for continue */
+    });
+    UT::bench_report("load_all_nodes_" + doc_ext, timer_load_nodes.elapsed_ms());
+
+    UT::BenchTimer timer_search;
+    const int matches_num = _search_all_nodes(pWin);
+    UT::bench_report("search_all_nodes_" + doc_ext, timer_search.elapsed_ms());
+    CHECK_EQUAL(_docParams.nodesNum, matches_num);
+
+    UT::BenchTimer timer_html;
+    pWin->get_ct_actions()->export_to_html_auto((tmp_dirpath / ("html_" + doc_ext)).string(), true/*overwrite*/);
+    UT::bench_report("export_html_" + doc_ext, timer_html.elapsed_ms());
+
+    UT::BenchTimer timer_txt;
+    pWin->get_ct_actions()->export_to_txt_auto((tmp_dirpath / ("txt_" + doc_ext)).string(), true/*overwrite*/);
+    UT::bench_report("export_txt_" + doc_ext, timer_txt.elapsed_ms());
+
+    UT::BenchTimer timer_pdf;
+    pWin->get_ct_actions()->export_to_pdf_auto((tmp_dirpath / ("bench_storage_" + doc_ext + ".pdf")).string(), true/*overwrite*/);
+    UT::bench_report("export_pdf_" + doc_ext, timer_pdf.elapsed_ms());
+
+    // one node changed
+    CtTreeIter firstIter = pWin->get_tree_store().to_ct_tree_iter(pWin->get_tree_store().get_iter_first());
+    Glib::RefPtr<Gsv::Buffer> rTextBuffer = firstIter.get_node_text_buffer();
+    rTextBuffer->insert(rTextBuffer->end(), "one more line\n");
+    pWin->update_window_save_needed(CtSaveNeededUpdType::nbuf, true/*new_machine_state*/, &firstIter);
+    UT::BenchTimer timer_save_incremental;
+    pWin->file_save(false/*need_vacuum*/);
+    UT::bench_report("save_incremental_" + doc_ext, timer_save_incremental.elapsed_ms());
+
+    UT::BenchTimer timer_save_full;
+    pWin->file_save_as(doc_filepath_bis.string(), password);
+    UT::bench_report("save_full_" + doc_ext, timer_save_full.elapsed_ms());
+
+    if (doc_ext == "ctb") {
+        // only sqlite has something to vacuum
+        UT::BenchTimer timer_vacuum;
+        pWin->file_save(true/*need_vacuum*/);
+        UT::bench_report("save_vacuum_" + doc_ext, timer_vacuum.elapsed_ms());
+    }
+
+    pWin->force_exit() = true;
+    remove_window(*pWin);
+}
+
+TEST_GROUP(StorageBenchGroup)
+{
+};
+
+#if !defined(__APPLE__) // CtApp causes crash on macos
+
+// scale with the environment variables CHERRYTREE_BENCH_NODES, CHERRYTREE_BENCH_DEPTH, CHERRYTREE_BENCH_TEXT_BYTES
+TEST(StorageBenchGroup, load_save_search_export)
+{
+    UT::BenchDocParams docParams;
+    docParams.nodesNum = UT::bench_env_int("CHERRYTREE_BENCH_NODES", 300);
+    docParams.depth = UT::bench_env_int("CHERRYTREE_BENCH_DEPTH", 4);
+    docParams.textBytes = UT::bench_env_int("CHERRYTREE_BENCH_TEXT_BYTES", 4000);
+    docParams.imageEvery = 5;
+    docParams.tableEvery = 10;
+    docParams.tableRows = 20;
+    docParams.tableCols = 4;
+    docParams.codeboxEvery = 10;
+    docParams.codeboxLines = 50;
+    const std::vector<std::string> vec_args{"cherrytree"};
+    gchar** pp_args = CtStrUtil::vector_to_array(vec_args);
+    BenchStorageApp benchApp{docParams};
+    benchApp.run(vec_args.size(), pp_args);
+    g_strfreev(pp_args);
+}
+
+#endif // __APPLE__
@@ -0,0 +1,233 @@
+/*
+ * tests_imports.cpp
+ *
+ * Copyright 2009-2020
+ * Giuseppe Penone <giuspen@gmail.com>
+ * Evgenii Gurianov <https://github.com/txe>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA 02110-1301, USA.
+ */
+
+#include "ct_imports.h"
+#include "ct_parser.h"
+#include "CppUTest/CommandLineTestRunner.h"
+#include <glib/gstdio.h>
+#include <atomic>
+#include <set>
+#include <thread>
+
+namespace {
+
+fs::path create_plain_text_dir()
+{
+    g_autofree gchar* pTmpDir = g_dir_make_tmp("ct_ut_import_XXXXXX", nullptr);
+    const fs::path root_dir{pTmpDir};
+    g_mkdir(fs::path{root_dir / "sub"}.c_str(), 0755);
+    g_mkdir(fs::path{root_dir / "empty"}.c_str(), 0755);
+    for (const fs::path& filepath : {root_dir / "a.txt", root_dir / "b.txt", root_dir / "sub" / "c.txt", root_dir / "sub" / "d.txt"})
+        g_file_set_contents(filepath.c_str(), filepath.stem().c_str(), -1, nullptr);
+    return root_dir;
+}
+
+std::set<std::string> children_names(const ct_imported_node* node)
+{
+    std::set<std::string> names;
+    for (const auto& child : node->children)
+        names.insert(child->node_name);
+    return names;
+}
+
+// an importer whose files are done only once released
+class CtBlockingImport : public CtImporterInterface
+{
+public:
+    CtBlockingImport(const std::atomic<bool>& released, std::atomic<size_t>& files_imported, std::atomic<size_t>& clones)
+     : _released{released}, _files_imported{files_imported}, _clones{clones} {}
+
+    std::unique_ptr<ct_imported_node> import_file(const fs::path& file) override
+    {
+        while (!_released)
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        ++_files_imported;
+        return std::make_unique<ct_imported_node>(file, file.stem().string());
+    }
+    std::unique_ptr<CtImporterInterface> clone_for_thread() override
+    {
+        ++_clones;
+        return std::make_unique<CtBlockingImport>(_released, _files_imported, _clones);
+    }
+
+private:
+    const std::atomic<bool>& _released;
+    std::atomic<size_t>&     _files_imported;
+    std::atomic<size_t>&     _clones;
+};
+
+std::vector<CtTextParser::token_schema> md_token_schemas()
+{
+    // a subset of the ones of CtMDParser, tokenize and parse_tokens don't call the actions
+    return {
+        {"*", true, true, nullptr},
+        {"**", true, true, nullptr},
+        {"`", true, true, nullptr, "`", true},
+    };
+}
+
+bool is_view_on(std::string_view token, std::string_view text)
+{
+    return token.data() >= text.data() and token.data() + token.size() <= text.data() + text.size();
+}
+
+} // namespace (anonymous)
+
+TEST_GROUP(ImportsGroup)
+{
+};
+
+TEST(ImportsGroup, traverse_dir)
+{
+    const fs::path root_dir = create_plain_text_dir();
+    CtPlainTextImport importer{nullptr};
+
+    size_t last_files_done{0};
+    size_t last_files_total{0};
+    std::unique_ptr<ct_imported_node> root_node = CtImports::traverse_dir(root_dir, &importer, [&](size_t files_done, size_t files_total) {
+        last_files_done = files_done;
+        last_files_total = files_total;
+        return true;
+    });
+    CHECK(root_node);
+    CHECK_EQUAL(4, last_files_total);
+    CHECK_EQUAL(4, last_files_done);
+    CHECK(std::set<std::string>({"a", "b", "sub"}) == children_names(root_node.get())); // empty dir skipped
+    for (const auto& child : root_node->children)
+    {
+        if (child->node_name == "sub")
+        {
+            CHECK_FALSE(child->has_content());
+            CHECK(std::set<std::string>({"c", "d"}) == children_names(child.get()));
+        }
+        else
+        {
+            CHECK(child->has_content());
+            STRCMP_EQUAL(CtConst::PLAIN_TEXT_ID, child->node_syntax.c_str());
+        }
+    }
+
+    // cancelled from the progress callback
+    const fs::path single_file_dir = root_dir / "sub";
+    fs::remove(single_file_dir / "d.txt");
+    CHECK_FALSE(CtImports::traverse_dir(single_file_dir, &importer, [](size_t, size_t) { return false; }));
+
+    fs::remove_all(root_dir);
+}
+
+TEST(ImportsGroup, traverse_dir_cancel_parallel)
+{
+    g_autofree gchar* pTmpDir = g_dir_make_tmp("ct_ut_import_XXXXXX", nullptr);
+    const fs::path root_dir{pTmpDir};
+    // more files than threads, so that some are still to start when cancelled
+    const size_t files_num = 2 * std::max(1u, std::thread::hardware_concurrency()) + 2;
+    for (size_t i = 0; i < files_num; ++i)
+    {
+        const fs::path filepath = root_dir / (std::to_string(i) + ".txt");
+        g_file_set_contents(filepath.c_str(), "text", -1, nullptr);
+    }
+
+    bool cancelled{false};
+    std::atomic<bool> released{false};
+    std::atomic<size_t> files_imported{0};
+    std::atomic<size_t> clones{0};
+    CtBlockingImport importer{released, files_imported, clones};
+    std::unique_ptr<ct_imported_node> root_node = CtImports::traverse_dir(root_dir, &importer, [&](size_t, size_t files_total) {
+        CHECK_EQUAL(files_num, files_total);
+        // the workers are let go at the call following the cancel, when the import is already flagged as cancelled
+        if (cancelled) released = true;
+        cancelled = true;
+        return false;
+    });
+    CHECK_FALSE(root_node);
+    if (std::thread::hardware_concurrency() > 1)
+    {
+        // the workers stopped after the file each was importing
+        CHECK(clones > 1);
+        CHECK(files_imported <= clones);
+    }
+    else
+    {
+        CHECK_EQUAL(0, files_imported.load());
+    }
+    CHECK(files_imported < files_num);
+
+    fs::remove_all(root_dir);
+}
+
+TEST(ImportsGroup, md_tokenize)
+{
+    CtTextParser text_parser{md_token_schemas()};
+
+    const std::string text{"a **bold** and *it*"};
+    const std::vector<std::string_view> tokens = text_parser.tokenize(text);
+    // the longest of the possible tokens wins, "**" over "*"
+    CHECK(std::vector<std::string_view>({"a", " ", "**", "bold", "**", " and", " ", "*", "it", "*"}) == tokens);
+    for (const std::string_view token : tokens)
+        CHECK(is_view_on(token, text));
+
+    // an escaped char is not a token, it is kept with the text following it
+    const std::string escaped{"a \\*b*"};
+    CHECK(std::vector<std::string_view>({"a", " ", "*b", "*"}) == text_parser.tokenize(escaped));
+
+    CHECK(text_parser.tokenize("").empty());
+    CHECK(std::vector<std::string_view>({"end"}) == text_parser.tokenize("end\\"));
+}
+
+TEST(ImportsGroup, md_parse_tokens)
+{
+    CtTextParser text_parser{md_token_schemas()};
+    const auto& open_tokens = text_parser.open_tokens_map();
+
+    // the captured contents are views on the text
+    const std::string text{"a **bold** and *it*"};
+    std::list<std::string> captures_storage;
+    CtTextParser::token_stream_t token_stream = text_parser.parse_tokens(text_parser.tokenize(text), captures_storage);
+    CHECK_EQUAL(6, token_stream.size());
+    CHECK(nullptr == token_stream[0].first);
+    CHECK(open_tokens.at("**") == token_stream[2].first);
+    CHECK(std::string_view{"bold"} == token_stream[2].second);
+    CHECK(open_tokens.at("*") == token_stream[5].first);
+    CHECK(std::string_view{"it"} == token_stream[5].second);
+    for (const auto& token : token_stream)
+        CHECK(is_view_on(token.second, text));
+    CHECK(captures_storage.empty());
+
+    // a capture spanning an escaped char is not contiguous in the text, it is copied
+    const std::string escaped{"x `a\\*b` y"};
+    token_stream = text_parser.parse_tokens(text_parser.tokenize(escaped), captures_storage);
+    CHECK_EQUAL(4, token_stream.size());
+    CHECK(open_tokens.at("`") == token_stream[2].first);
+    CHECK(std::string_view{"a*b"} == token_stream[2].second);
+    CHECK_EQUAL(1, captures_storage.size());
+    CHECK(std::string_view{captures_storage.back()} == token_stream[2].second);
+    CHECK(std::string_view{" y"} == token_stream[3].second);
+
+    // the code captures the formatting tokens as they are
+    const std::string code{"x `a *b` y"};
+    token_stream = text_parser.parse_tokens(text_parser.tokenize(code), captures_storage);
+    CHECK_EQUAL(4, token_stream.size());
+    CHECK(std::string_view{"a *b"} == token_stream[2].second);
+    CHECK(is_view_on(token_stream[2].second, code));
+    CHECK_EQUAL(1, captures_storage.size());
+}
@@ -24,6 +24,10 @@
 #include "ct_misc_utils.h"
 #include "ct_const.h"
 #include "ct_filesystem.h"
+#include "ct_thread_pool.h"
+#include "ct_prefetch_cache.h"
+#include "ct_table.h"
+#include <sstream>
 #include "tests_common.h"
 #include "CppUTest/CommandLineTestRunner.h"
 
@@ -44,6 +48,21 @@ TEST(MiscUtilsGroup, is_str_true)
     CHECK(not CtStrUtil::is_str_true("0"));
 }
 
+TEST(MiscUtilsGroup, get_words_count)
+{
+    CHECK_EQUAL(0, CtStrUtil::get_words_count(""));
+    CHECK_EQUAL(0, CtStrUtil::get_words_count(" \n\t "));
+    CHECK_EQUAL(3, CtStrUtil::get_words_count("one two, three"));
+    CHECK_EQUAL(2, CtStrUtil::get_words_count("città già"));
+    // the text statistics sum the words line by line
+    const Glib::ustring multiline{"first line here\nsecond\n\nthird line"};
+    int lines_sum{0};
+    for (const auto& line : str::split(multiline, "\n"))
+        lines_sum += CtStrUtil::get_words_count(line);
+    CHECK_EQUAL(6, CtStrUtil::get_words_count(multiline));
+    CHECK_EQUAL(6, lines_sum);
+}
+
 TEST(MiscUtilsGroup, str__replace)
 {
     {
@@ -200,6 +219,89 @@ TEST(MiscUtilsGroup, natural_compare)
     CHECK(CtStrUtil::natural_compare("Alpha 2 B","Alpha 2") > 0);
 }
 
+TEST(MiscUtilsGroup, natural_sort_key)
+{
+    const std::vector<Glib::ustring> texts{"", "a", "aa", "aaa", "9", "1", "01", "2", "134", "122", "a1", "a2", "a10",
+                                           "a1a2", "a1a3", "a1a0", "12a3", "12a1", "Alpha 2", "Alpha 2A", "Alpha 2 B"};
+    auto sign = [](int value) { return value < 0 ? -1 : (value > 0 ? 1 : 0); };
+    for (const Glib::ustring& left : texts)
+    {
+        for (const Glib::ustring& right : texts)
+        {
+            CHECK_EQUAL(sign(CtStrUtil::natural_compare(left, right)),
+                        sign(CtStrUtil::natural_sort_key(left).compare(CtStrUtil::natural_sort_key(right))));
+        }
+    }
+}
+
+TEST(MiscUtilsGroup, ids_to_ranges)
+{
+    STRCMP_EQUAL("", CtStrUtil::ids_to_ranges({}).c_str());
+    STRCMP_EQUAL("7", CtStrUtil::ids_to_ranges({7}).c_str());
+    STRCMP_EQUAL("2,5-9,12", CtStrUtil::ids_to_ranges({12, 5, 6, 2, 9, 7, 8, 6}).c_str());
+    const std::unordered_set<gint64> ids{2, 5, 6, 7, 8, 9, 12};
+    CHECK(ids == CtStrUtil::ranges_to_ids("2,5-9,12", 12));
+    CHECK(CtStrUtil::ranges_to_ids("", 12).empty());
+    CHECK(std::unordered_set<gint64>{3} == CtStrUtil::ranges_to_ids("3,x", 12));
+    // corrupt ranges are clamped to the ids that can be there, or skipped
+    CHECK(std::unordered_set<gint64>({2, 5, 6, 7}) == CtStrUtil::ranges_to_ids("2,5-9999999999,12", 7));
+    CHECK(std::unordered_set<gint64>({0, 1}) == CtStrUtil::ranges_to_ids("-9999999999-1", 7));
+    CHECK(std::unordered_set<gint64>{4} == CtStrUtil::ranges_to_ids("9-3,4,8-9999999999", 7));
+}
+
+TEST(MiscUtilsGroup, csv_reader_writer)
+{
+    const CtCSV::CtStringTable table{{"h1", "h,2"}, {"a \"b\"", "c\\d"}, {"multi\nline", ""}};
+    std::ostringstream output;
+    CtCSV::table_to_csv(table, output);
+    STRCMP_EQUAL("\"h1\",\"h,2\"\n\"a \\\"b\\\"\",\"c\\\\d\"\n\"multi\nline\",\"\"\n", output.str().c_str());
+    {
+        std::istringstream input(output.str());
+        CHECK(table == CtCSV::table_from_csv(input));
+    }
+    {
+        // the last record may miss the newline, windows newlines are accepted
+        std::istringstream input("a,b\r\nc,d");
+        CHECK(CtCSV::CtStringTable({{"a", "b"}, {"c", "d"}}) == CtCSV::table_from_csv(input));
+    }
+    {
+        // blank lines, as a trailing newline, are no records; the rows can be uneven
+        std::istringstream input("\nh1,h2\r\n\na\nb,c,d\n\n\n");
+        CHECK(CtCSV::CtStringTable({{"h1", "h2"}, {"a"}, {"b", "c", "d"}}) == CtCSV::table_from_csv(input));
+    }
+    {
+        // but a line with an escape or an empty quoted cell is
+        std::istringstream input("\\x\n\"\"\n");
+        CHECK(CtCSV::CtStringTable({{"x"}, {""}}) == CtCSV::table_from_csv(input));
+    }
+    {
+        std::istringstream input(output.str());
+        CtCSV::CtCsvReader reader(input, 2/*max_rows*/);
+        std::vector<std::string> row;
+        CHECK(reader.next_row(row));
+        CHECK(reader.next_row(row));
+        CHECK(table[1] == row);
+        CHECK_FALSE(reader.next_row(row));
+        CHECK(reader.is_truncated());
+    }
+}
+
+TEST(MiscUtilsGroup, table_pad_rows)
+{
+    // the rows of a csv can have any number of cells
+    std::istringstream input("h1,h2\na\nb,c,d\n");
+    CtTableTexts tableTexts;
+    for (const auto& row : CtCSV::table_from_csv(input))
+        tableTexts.emplace_back(row.begin(), row.end());
+    CHECK_EQUAL(1, tableTexts[1].size());
+    CtTable::pad_rows(tableTexts);
+    CHECK(CtTableTexts({{"h1", "h2", ""}, {"a", "", ""}, {"b", "c", "d"}}) == tableTexts);
+
+    CtTableTexts emptyTexts;
+    CtTable::pad_rows(emptyTexts);
+    CHECK(emptyTexts.empty());
+}
+
 TEST(MiscUtilsGroup, str__startswith)
 {
     CHECK(str::startswith("", ""));
@@ -285,6 +387,34 @@ TEST(MiscUtilsGroup, str__repeat)
     STRCMP_EQUAL("******", str::repeat("**", 3).c_str());
 }
 
+TEST(MiscUtilsGroup, string_builder)
+{
+    CtStringBuilder builder;
+    CHECK(builder.empty());
+    builder << "a" << std::string{"b"} << Glib::ustring{"€"} << 'c';
+    builder.append_unichar(g_utf8_get_char("ä"));
+    STRCMP_EQUAL("ab€cä", builder.c_str());
+    CHECK_EQUAL(8, builder.size());
+
+    builder.clear();
+    builder.append_xml_escaped("<a href=\"x\">'&'</a>");
+    STRCMP_EQUAL("&lt;a href=&quot;x&quot;&gt;&apos;&amp;&apos;&lt;/a&gt;", builder.c_str());
+    STRCMP_EQUAL(str::xml_escape("<a>'&'\"").c_str(), "&lt;a&gt;&apos;&amp;&apos;&quot;");
+
+    builder.clear();
+    builder.append_xml_escaped("a b\n<c>", true/*newline_to_br*/, true/*space_to_nbsp*/);
+    builder.append_xml_escaped_unichar('\n', true/*newline_to_br*/);
+    builder.append_xml_escaped_unichar(' ');
+    STRCMP_EQUAL("a&nbsp;b<br />&lt;c&gt;<br /> ", builder.c_str());
+
+    builder.clear();
+    builder << "<br/><p x></p><br/></h1><h1 >t";
+    builder.replace_all({{"<br/><p ", "<p "}, {"</p><br/>", "</p>"}, {"</h1><h1 >", ""}});
+    STRCMP_EQUAL("<p x></p>t", builder.c_str());
+    const std::string released = builder.release();
+    STRCMP_EQUAL("<p x></p>t", released.c_str());
+}
+
 TEST(MiscUtilsGroup, vec_remove)
 {
     std::vector<int> empty_v;
@@ -368,6 +498,89 @@ TEST(MiscUtilsGroup, parallel_for)
         }
 }
 
+TEST(MiscUtilsGroup, thread_pool)
+{
+    CtThreadPool threadPool(3);
+    std::future<int> future = threadPool.submit([]() { return 42; });
+    CHECK_EQUAL(42, future.get());
+
+    CtCancelToken token;
+    token.cancel();
+    bool cancelled_ran{false};
+    threadPool.submit(token, [&]() { cancelled_ran = true; }).get();
+    CHECK_FALSE(cancelled_ran);
+
+    // nested parallel_for on the shared pool, the waiting threads run the queued slices
+    std::atomic<int> count{0};
+    CtMiscUtil::parallel_for(0, 16, [&](size_t) {
+        CtMiscUtil::parallel_for(0, 16, [&](size_t) {
+            ++count;
+        });
+    });
+    CHECK_EQUAL(16*16, count.load());
+
+    // a thread waiting for a group runs only the queued tasks of that group
+    CtThreadPool singleWorkerPool(1);
+    std::promise<void> busyStarted, busyRelease;
+    std::shared_future<void> busyReleased = busyRelease.get_future().share();
+    auto busy = singleWorkerPool.submit([&]() { busyStarted.set_value(); busyReleased.wait(); });
+    busyStarted.get_future().wait();
+    std::thread::id unrelatedThreadId;
+    auto unrelated = singleWorkerPool.submit([&]() { unrelatedThreadId = std::this_thread::get_id(); });
+    const size_t group = singleWorkerPool.new_group();
+    std::thread::id groupThreadId;
+    auto grouped = singleWorkerPool.submit_to_group(group, [&]() { groupThreadId = std::this_thread::get_id(); });
+    singleWorkerPool.wait(grouped, group);
+    CHECK(std::this_thread::get_id() == groupThreadId);
+    CHECK(std::future_status::timeout == unrelated.wait_for(std::chrono::seconds{0}));
+    busyRelease.set_value();
+    busy.get();
+    unrelated.get();
+    CHECK(std::this_thread::get_id() != unrelatedThreadId);
+}
+
+TEST(MiscUtilsGroup, prefetch_cache)
+{
+    struct Content
+    {
+        size_t bytesNum;
+    };
+    auto new_content = [](const size_t bytesNum) { return std::make_unique<Content>(Content{bytesNum}); };
+    CtPrefetchCache<Content> cache(100);
+
+    // over the budget the least recently read go first
+    cache.put(1, new_content(40), cache.get_generation());
+    cache.put(2, new_content(40), cache.get_generation());
+    cache.put(3, new_content(40), cache.get_generation());
+    CHECK_EQUAL(80, cache.get_bytes_num());
+    CHECK(cache.is_wanted(1));
+    CHECK_FALSE(cache.is_wanted(2));
+    CHECK(nullptr == cache.take(1));
+    std::unique_ptr<Content> pContent = cache.take(2);
+    CHECK(pContent);
+    CHECK_EQUAL(40, pContent->bytesNum);
+    CHECK_EQUAL(40, cache.get_bytes_num());
+    // bigger than the whole budget
+    cache.put(4, new_content(101), cache.get_generation());
+    CHECK(nullptr == cache.take(4));
+
+    // a node is handed out once, a put after take is ignored
+    CHECK_FALSE(cache.is_wanted(2));
+    cache.put(2, new_content(10), cache.get_generation());
+    CHECK(nullptr == cache.take(2));
+
+    // a put read before a clear is dropped
+    const size_t stale_generation = cache.get_generation();
+    cache.clear();
+    CHECK_EQUAL(0, cache.get_bytes_num());
+    CHECK(nullptr == cache.take(3));
+    cache.put(5, new_content(10), stale_generation);
+    CHECK(cache.is_wanted(5));
+    CHECK(nullptr == cache.take(5));
+    cache.put(6, new_content(10), cache.get_generation());
+    CHECK(cache.take(6));
+}
+
 TEST(MiscUtilsGroup, external_uri_from_internal) 
 {
     STRCMP_EQUAL("https://example.com", CtStrUtil::external_uri_from_internal("webs https://example.com").c_str());
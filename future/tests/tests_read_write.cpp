@@ -22,9 +22,16 @@
  */
 
 #include "ct_app.h"
+#include "ct_dialogs.h"
 #include "ct_misc_utils.h"
+#include "ct_storage_control.h"
+#include "ct_storage_convert.h"
+#include "ct_table.h"
+#include "ct_text_stats.h"
 #include "tests_common.h"
 #include "CppUTest/CommandLineTestRunner.h"
+#include <spdlog/sinks/ostream_sink.h>
+#include <sstream>
 
 class TestCtApp : public CtApp
 {
@@ -445,7 +452,7 @@ void TestCtApp::_assert_tree_data(CtMainWin* pWin)
                 case CtAnchWidgType::Table: {
                     CHECK_EQUAL(49, pAnchWidget->getOffset());
                     STRCMP_EQUAL(CtConst::TAG_PROP_VAL_LEFT, pAnchWidget->getJustification().c_str());
-                    auto pTable = dynamic_cast<CtTable*>(pAnchWidget);
+                    auto pTable = dynamic_cast<CtTableHeavy*>(pAnchWidget);
                     CHECK(pTable);
                     CHECK_EQUAL(40, pTable->get_col_min());
                     CHECK_EQUAL(60, pTable->get_col_max());
@@ -517,6 +524,36 @@ void TestCtApp::_assert_tree_data(CtMainWin* pWin)
     }
 }
 
+// runs a check on an empty hidden window, for the objects that need one
+class TestCtWinApp : public CtApp
+{
+public:
+    TestCtWinApp(std::function<void(CtMainWin*)> test)
+     : CtApp{},
+       _test{std::move(test)}
+    {}
+
+    static void run_test(std::function<void(CtMainWin*)> test)
+    {
+        const std::vector<std::string> vec_args{"cherrytree"};
+        gchar** pp_args = CtStrUtil::vector_to_array(vec_args);
+        TestCtWinApp testCtWinApp{std::move(test)};
+        testCtWinApp.run(vec_args.size(), pp_args);
+        g_strfreev(pp_args);
+    }
+
+private:
+    void on_activate() final
+    {
+        CtMainWin* pWin = _create_window(true/*start_hidden*/);
+        _test(pWin);
+        pWin->force_exit() = true;
+        remove_window(*pWin);
+    }
+
+    std::function<void(CtMainWin*)> _test;
+};
+
 TEST_GROUP(CtDocRWGroup)
 {
 };
@@ -536,4 +573,638 @@ TEST(CtDocRWGroup, CtDocRW_all_variants)
     }
 }
 
+TEST(CtDocRWGroup, CtDocConvert_ctd_ctb_ctd)
+{
+    g_autofree gchar* pTmpDir = g_dir_make_tmp("ct_ut_convert_XXXXXX", nullptr);
+    const fs::path tmp_dir{pTmpDir};
+    const fs::path direct_ctd = tmp_dir / "direct.ctd";
+    const fs::path via_ctb = tmp_dir / "via.ctb";
+    const fs::path round_trip_ctd = tmp_dir / "round_trip.ctd";
+    Glib::ustring error;
+    CHECK(CtStorageConvert::convert(UT::testCtdDocPath, "", direct_ctd, "", error));
+    CHECK(CtStorageConvert::convert(UT::testCtdDocPath, "", via_ctb, "", error));
+    CHECK(CtStorageConvert::convert(via_ctb, "", round_trip_ctd, "", error));
+    STRCMP_EQUAL("", error.c_str());
+    // nothing lost or changed going through the sqlite rows
+    STRCMP_EQUAL(Glib::file_get_contents(direct_ctd.string()).c_str(), Glib::file_get_contents(round_trip_ctd.string()).c_str());
+
+    // and the content is the one of the source document
+    const std::vector<std::string> vec_args{"cherrytree", round_trip_ctd.string(), "-t", fs::path{tmp_dir / "saved.ctb"}.string()};
+    gchar** pp_args = CtStrUtil::vector_to_array(vec_args);
+    TestCtApp testCtApp{vec_args};
+    testCtApp.run(vec_args.size(), pp_args);
+    g_strfreev(pp_args);
+
+    fs::remove_all(tmp_dir);
+}
+
+TEST(CtDocRWGroup, CtDocConvert_same_file)
+{
+    g_autofree gchar* pTmpDir = g_dir_make_tmp("ct_ut_convert_XXXXXX", nullptr);
+    const fs::path tmp_dir{pTmpDir};
+    const fs::path source_ctb = tmp_dir / "source.ctb";
+    Glib::ustring error;
+    CHECK(CtStorageConvert::convert(UT::testCtdDocPath, "", source_ctb, "", error));
+    const std::string source_content = Glib::file_get_contents(source_ctb.string());
+
+    // the destination would be removed before the source is read
+    CHECK_FALSE(CtStorageConvert::convert(source_ctb, "", source_ctb, "", error));
+    CHECK_FALSE(error.empty());
+    error.clear();
+    CHECK_FALSE(CtStorageConvert::convert(source_ctb, "", tmp_dir / "." / "source.ctb", "", error));
+    CHECK_FALSE(error.empty());
+
+    // and the source is left as it was
+    CHECK(fs::is_regular_file(source_ctb));
+    CHECK(source_content == Glib::file_get_contents(source_ctb.string()));
+
+    fs::remove_all(tmp_dir);
+}
+
+static void assert_table_heavy(CtMainWin* pWin, const CtTableHeavy& table, const CtTableTexts& expectedTexts)
+{
+    // the wrap mode of a cell created as not header
+    const Gtk::WrapMode cellWrapMode = pWin->get_ct_config()->lineWrapping ? Gtk::WRAP_WORD_CHAR : Gtk::WRAP_NONE;
+    CtTableTexts tableTexts;
+    table.write_strings_matrix(tableTexts);
+    CHECK(expectedTexts == tableTexts);
+    const CtTableMatrix& tableMatrix = table.get_table_matrix();
+    for (size_t row = 0; row < tableMatrix.size(); ++row) {
+        for (CtTableCell* pCell : tableMatrix[row]) {
+            // only the first row is the header
+            CHECK_EQUAL(row == 0, pCell->get_text_view().get_style_context()->has_class("ct-table-header-cell"));
+            CHECK(pCell->get_text_view().get_wrap_mode() == (row == 0 ? Gtk::WRAP_NONE : cellWrapMode));
+            // styled as the cells of a showing table, the new ones included
+            CHECK(pCell->get_buffer()->get_data(CtConst::STYLE_APPLIED_ID));
+        }
+    }
+}
+
+TEST(CtDocRWGroup, CtTableHeavy_in_place_operations)
+{
+    TestCtWinApp::run_test([](CtMainWin* pWin){
+        auto new_table = [pWin](){
+            auto pTable = std::make_unique<CtTableHeavy>(pWin, CtTableTexts{{"h1", "h2"}, {"b", "2"}, {"a", "1"}}, 40, 60, 0, "");
+            // as when the node shows
+            pTable->apply_syntax_highlighting();
+            return pTable;
+        };
+        {
+            auto pTable = new_table();
+            assert_table_heavy(pWin, *pTable, {{"h1", "h2"}, {"b", "2"}, {"a", "1"}});
+            pTable->column_add(0);
+            assert_table_heavy(pWin, *pTable, {{"h1", "", "h2"}, {"b", "", "2"}, {"a", "", "1"}});
+            pTable->column_add(-1);
+            assert_table_heavy(pWin, *pTable, {{"", "h1", "", "h2"}, {"", "b", "", "2"}, {"", "a", "", "1"}});
+        }
+        {
+            auto pTable = new_table();
+            pTable->column_delete(0);
+            assert_table_heavy(pWin, *pTable, {{"h2"}, {"2"}, {"1"}});
+            // the last column stays
+            pTable->column_delete(0);
+            assert_table_heavy(pWin, *pTable, {{"h2"}, {"2"}, {"1"}});
+        }
+        {
+            auto pTable = new_table();
+            pTable->column_move_left(1);
+            assert_table_heavy(pWin, *pTable, {{"h2", "h1"}, {"2", "b"}, {"1", "a"}});
+            pTable->column_move_right(0);
+            assert_table_heavy(pWin, *pTable, {{"h1", "h2"}, {"b", "2"}, {"a", "1"}});
+            pTable->column_move_right(1);
+            assert_table_heavy(pWin, *pTable, {{"h1", "h2"}, {"b", "2"}, {"a", "1"}});
+        }
+        {
+            auto pTable = new_table();
+            pTable->row_add(0);
+            assert_table_heavy(pWin, *pTable, {{"h1", "h2"}, {"", ""}, {"b", "2"}, {"a", "1"}});
+            std::vector<Glib::ustring> row{"c", "3"};
+            pTable->row_add(3, &row);
+            assert_table_heavy(pWin, *pTable, {{"h1", "h2"}, {"", ""}, {"b", "2"}, {"a", "1"}, {"c", "3"}});
+        }
+        {
+            auto pTable = new_table();
+            pTable->row_delete(1);
+            assert_table_heavy(pWin, *pTable, {{"h1", "h2"}, {"a", "1"}});
+            // the next row becomes the header
+            pTable->row_delete(0);
+            assert_table_heavy(pWin, *pTable, {{"a", "1"}});
+            // the last row stays
+            pTable->row_delete(0);
+            assert_table_heavy(pWin, *pTable, {{"a", "1"}});
+        }
+        {
+            auto pTable = new_table();
+            pTable->row_move_up(2);
+            assert_table_heavy(pWin, *pTable, {{"h1", "h2"}, {"a", "1"}, {"b", "2"}});
+            // swapping with the header swaps the header flags too
+            pTable->row_move_up(1);
+            assert_table_heavy(pWin, *pTable, {{"a", "1"}, {"h1", "h2"}, {"b", "2"}});
+            pTable->row_move_down(0);
+            assert_table_heavy(pWin, *pTable, {{"h1", "h2"}, {"a", "1"}, {"b", "2"}});
+            pTable->row_move_down(2);
+            assert_table_heavy(pWin, *pTable, {{"h1", "h2"}, {"a", "1"}, {"b", "2"}});
+        }
+        {
+            auto pTable = new_table();
+            CHECK(pTable->row_sort_asc());
+            assert_table_heavy(pWin, *pTable, {{"h1", "h2"}, {"a", "1"}, {"b", "2"}});
+            CHECK_FALSE(pTable->row_sort_asc());
+            CHECK(pTable->row_sort_desc());
+            assert_table_heavy(pWin, *pTable, {{"h1", "h2"}, {"b", "2"}, {"a", "1"}});
+        }
+    });
+}
+
+TEST(CtDocRWGroup, CtMainWin_no_gui)
+{
+    TestCtWinApp::run_test([](CtMainWin* pWin){
+        CHECK(pWin->no_gui());
+
+        // the text view width from the saved geometry, the view is never realized
+        CtConfig* pConfig = pWin->get_ct_config();
+        const int winWidth = pConfig->winRect[2];
+        const int hpanedPos = pConfig->hpanedPos;
+        const bool treeVisible = pConfig->treeVisible;
+        const bool treeRightSide = pConfig->treeRightSide;
+        pConfig->winRect[2] = 900;
+        pConfig->hpanedPos = 200;
+        pConfig->treeVisible = true;
+        pConfig->treeRightSide = false;
+        CHECK_EQUAL(700, pWin->get_text_view_width());
+        pConfig->treeRightSide = true;
+        CHECK_EQUAL(200, pWin->get_text_view_width());
+        pConfig->treeVisible = false;
+        CHECK_EQUAL(900, pWin->get_text_view_width());
+        pConfig->treeVisible = true;
+        pConfig->treeRightSide = false;
+        pConfig->hpanedPos = 1000;
+        CHECK_EQUAL(1, pWin->get_text_view_width());
+        pConfig->winRect[2] = winWidth;
+        pConfig->hpanedPos = hpanedPos;
+        pConfig->treeVisible = treeVisible;
+        pConfig->treeRightSide = treeRightSide;
+
+        // the dialogs log and return instead of waiting for an answer
+        std::ostringstream logStream;
+        auto pLogger = std::make_shared<spdlog::logger>("UT", std::make_shared<spdlog::sinks::ostream_sink_st>(logStream));
+        pLogger->set_level(spdlog::level::trace);
+        auto pDefaultLogger = spdlog::default_logger();
+        spdlog::set_default_logger(pLogger);
+        CtDialogs::info_dialog("no gui info", *pWin);
+        CtDialogs::warning_dialog("no gui warning", *pWin);
+        CtDialogs::error_dialog("no gui error", *pWin);
+        spdlog::set_default_logger(pDefaultLogger);
+        const std::string logged = logStream.str();
+        CHECK(logged.find("[info] no gui info") != std::string::npos);
+        CHECK(logged.find("[warning] no gui warning") != std::string::npos);
+        CHECK(logged.find("[error] no gui error") != std::string::npos);
+    });
+}
+
+// the document as saved, through a conversion to xml
+static std::string saved_doc_text(const fs::path& doc_path, const fs::path& tmp_dir)
+{
+    const fs::path saved_ctd = tmp_dir / "saved.ctd";
+    Glib::ustring error;
+    CHECK(CtStorageConvert::convert(doc_path, "", saved_ctd, "", error));
+    const std::string saved_text = Glib::file_get_contents(saved_ctd.string());
+    fs::remove(saved_ctd);
+    return saved_text;
+}
+
+TEST(CtDocRWGroup, CtStorageControl_save_in_background)
+{
+    g_autofree gchar* pTmpDir = g_dir_make_tmp("ct_ut_save_XXXXXX", nullptr);
+    const fs::path tmp_dir{pTmpDir};
+    const fs::path doc_ctb = tmp_dir / "doc.ctb";
+    Glib::ustring error;
+    CHECK(CtStorageConvert::convert(UT::testCtdDocPath, "", doc_ctb, "", error));
+
+    TestCtWinApp::run_test([&](CtMainWin* pWin){
+        CHECK(pWin->file_open(doc_ctb, ""));
+        CtStorageControl* pStorage = pWin->get_ct_storage();
+        CtTreeIter treeIter1 = pWin->get_tree_store().get_ct_iter_first();
+        CtTreeIter treeIter2 = treeIter1;
+        ++treeIter2;
+        CHECK(treeIter2);
+        auto edit_node = [pWin](CtTreeIter& treeIter, const Glib::ustring& text) {
+            treeIter.get_node_text_buffer()->set_text(text);
+            pWin->update_window_save_needed(CtSaveNeededUpdType::nbuf, false/*new_machine_state*/, &treeIter);
+        };
+        std::vector<bool> savesDone;
+        auto on_done = [&savesDone](bool success, const Glib::ustring&) { savesDone.push_back(success); };
+
+        // what is written is the snapshot taken when the save starts
+        edit_node(treeIter1, "ut first edit");
+        pStorage->save_in_background(false/*need_vacuum*/, on_done);
+        CHECK(pStorage->is_saving_in_background());
+        edit_node(treeIter1, "ut edit during save");
+        CHECK(pStorage->wait_save_in_background());
+        CHECK(std::vector<bool>({true}) == savesDone);
+        std::string savedText = saved_doc_text(doc_ctb, tmp_dir);
+        CHECK(savedText.find("ut first edit") != std::string::npos);
+        CHECK(savedText.find("ut edit during save") == std::string::npos);
+
+        // the edit done during the save is written by the next one, here a synchronous one
+        CHECK(pStorage->save(false/*need_vacuum*/, error));
+        savedText = saved_doc_text(doc_ctb, tmp_dir);
+        CHECK(savedText.find("ut edit during save") != std::string::npos);
+
+        // a synchronous save waits for the one running and then writes the edits that followed it
+        edit_node(treeIter1, "ut edit before sync save");
+        pStorage->save_in_background(false/*need_vacuum*/, on_done);
+        edit_node(treeIter2, "ut edit during save before sync save");
+        CHECK(pStorage->save(false/*need_vacuum*/, error));
+        CHECK_FALSE(pStorage->is_saving_in_background());
+        CHECK(std::vector<bool>({true, true}) == savesDone);
+        savedText = saved_doc_text(doc_ctb, tmp_dir);
+        CHECK(savedText.find("ut edit before sync save") != std::string::npos);
+        CHECK(savedText.find("ut edit during save before sync save") != std::string::npos);
+
+        // a failed write gives back its changes, merged with the ones done in the meanwhile
+        const fs::path doc_ctb_away = tmp_dir / "doc_away.ctb";
+        CHECK(fs::move_file(doc_ctb, doc_ctb_away));
+        edit_node(treeIter1, "ut edit of failed save");
+        pStorage->save_in_background(false/*need_vacuum*/, on_done);
+        edit_node(treeIter2, "ut edit during failed save");
+        CHECK_FALSE(pStorage->wait_save_in_background());
+        CHECK(std::vector<bool>({true, true, false}) == savesDone);
+        CHECK(fs::move_file(doc_ctb_away, doc_ctb));
+        CHECK(pStorage->save(false/*need_vacuum*/, error));
+        savedText = saved_doc_text(doc_ctb, tmp_dir);
+        CHECK(savedText.find("ut edit of failed save") != std::string::npos);
+        CHECK(savedText.find("ut edit during failed save") != std::string::npos);
+    });
+
+    fs::remove_all(tmp_dir);
+}
+
+TEST(CtDocRWGroup, CtTextStats_incremental)
+{
+    TestCtWinApp::run_test([](CtMainWin* /*pWin*/){
+        Glib::RefPtr<Gtk::TextBuffer> rTextBuffer = Gtk::TextBuffer::create();
+        // another handler editing the buffer from within an edit, as the auto indent and the auto links do
+        Glib::ustring nestedText;
+        auto insert_nested = [&rTextBuffer, &nestedText]() {
+            if (nestedText.empty()) return;
+            const Glib::ustring text = nestedText;
+            nestedText.clear();
+            rTextBuffer->insert(rTextBuffer->end(), text);
+        };
+        rTextBuffer->signal_insert().connect([&insert_nested](const Gtk::TextBuffer::iterator&, const Glib::ustring&, int){ insert_nested(); }, true/*after*/);
+        rTextBuffer->signal_erase().connect([&insert_nested](const Gtk::TextBuffer::iterator&, const Gtk::TextBuffer::iterator&){ insert_nested(); }, true/*after*/);
+
+        rTextBuffer->set_text("one two three\nfour five\n\nsix seven");
+        CtTextStats textStats{rTextBuffer};
+        // the same as a full recount
+        auto check_counts = [&rTextBuffer, &textStats]() {
+            const CtTextStatsCounts counts = textStats.get_counts_sync();
+            CHECK(textStats.is_ready());
+            CHECK_EQUAL(CtStrUtil::get_words_count(rTextBuffer->get_text(true/*include_hidden_chars*/)), counts.words);
+            CHECK_EQUAL(rTextBuffer->get_char_count(), counts.chars);
+            CHECK_EQUAL(rTextBuffer->get_line_count(), counts.lines);
+        };
+        check_counts();
+        CHECK_EQUAL(7, textStats.get_counts().words);
+
+        // the small edits only recount the lines they touch, no full count is started
+        auto iter_at = [&rTextBuffer](const int offset) { return rTextBuffer->get_iter_at_offset(offset); };
+        rTextBuffer->insert(iter_at(5), "x");           // inside a word
+        CHECK(textStats.is_ready());
+        check_counts();
+        rTextBuffer->insert(iter_at(10), " ");          // splitting a word
+        CHECK(textStats.is_ready());
+        check_counts();
+        rTextBuffer->insert(iter_at(21), "\n");         // splitting a line
+        CHECK(textStats.is_ready());
+        check_counts();
+        rTextBuffer->insert(rTextBuffer->end(), " eight\nnine ten\n eleven");
+        CHECK(textStats.is_ready());
+        check_counts();
+        rTextBuffer->erase(iter_at(2), iter_at(17));    // across lines, joining two words
+        CHECK(textStats.is_ready());
+        check_counts();
+        Gtk::TextIter iter_newline = rTextBuffer->begin();
+        iter_newline.forward_to_line_end();
+        rTextBuffer->erase(iter_newline, iter_at(iter_newline.get_offset() + 1)); // joining two lines
+        CHECK(textStats.is_ready());
+        check_counts();
+
+        // an edit nested in another one, the outer one counts everything again
+        nestedText = " nested words\nand a line";
+        rTextBuffer->insert(iter_at(3), " outer");
+        CHECK(nestedText.empty());
+        CHECK_FALSE(textStats.is_ready());
+        check_counts();
+        nestedText = "\nnested at erase";
+        rTextBuffer->erase(iter_at(0), iter_at(4));
+        CHECK(nestedText.empty());
+        CHECK_FALSE(textStats.is_ready());
+        check_counts();
+
+        // a big edit is counted from scratch off the main thread
+        Glib::ustring bigText;
+        for (int i = 0; i < 20000; ++i) bigText += "big text ";
+        rTextBuffer->insert(iter_at(1), bigText);
+        CHECK_FALSE(textStats.is_ready());
+        check_counts();
+        rTextBuffer->erase(iter_at(1), iter_at(1 + (int)bigText.size()));
+        CHECK_FALSE(textStats.is_ready());
+        check_counts();
+
+        rTextBuffer->erase(rTextBuffer->begin(), rTextBuffer->end());
+        check_counts();
+        CHECK_EQUAL(0, textStats.get_counts().words);
+    });
+}
+
+static void check_summary_info_equal(const CtSummaryInfo& expected, const CtSummaryInfo& actual)
+{
+    CHECK_EQUAL(expected.nodes_rich_text_num, actual.nodes_rich_text_num);
+    CHECK_EQUAL(expected.nodes_plain_text_num, actual.nodes_plain_text_num);
+    CHECK_EQUAL(expected.nodes_code_num, actual.nodes_code_num);
+    CHECK_EQUAL(expected.images_num, actual.images_num);
+    CHECK_EQUAL(expected.embfile_num, actual.embfile_num);
+    CHECK_EQUAL(expected.tables_num, actual.tables_num);
+    CHECK_EQUAL(expected.codeboxes_num, actual.codeboxes_num);
+    CHECK_EQUAL(expected.anchors_num, actual.anchors_num);
+    CHECK_EQUAL(expected.words_num, actual.words_num);
+    CHECK_EQUAL(expected.chars_num, actual.chars_num);
+    CHECK_EQUAL(expected.lines_num, actual.lines_num);
+}
+
+TEST(CtDocRWGroup, CtTreeStore_summary_of_unloaded_nodes)
+{
+    for (const std::string& doc_path : {UT::testCtbDocPath, UT::testCtdDocPath}) {
+        TestCtWinApp::run_test([&doc_path](CtMainWin* pWin){
+            CHECK(pWin->file_open(doc_path, ""));
+            CtTreeStore& treeStore = pWin->get_tree_store();
+            const CtTreeModelColumns& columns = treeStore.get_columns();
+            auto get_unloaded_num = [&treeStore, &columns]() {
+                size_t unloadedNum{0};
+                treeStore.get_store()->foreach_iter([&](const Gtk::TreeIter& treeIter){
+                    if (not treeIter->get_value(columns.rColTextBuffer)) ++unloadedNum;
+                    return false; /* false for continue */
+                });
+                return unloadedNum;
+            };
+            const size_t unloadedNum = get_unloaded_num();
+            CHECK(unloadedNum > 0);
+
+            // the unloaded nodes are summarized from the storage, without building their buffers
+            CtSummaryInfo summaryUnloaded;
+            treeStore.populateSummaryInfo(summaryUnloaded);
+            CHECK_EQUAL(unloadedNum, get_unloaded_num());
+
+            // the same as from all the buffers, counted the first time and then kept by their text stats
+            treeStore.get_store()->foreach_iter([&](const Gtk::TreeIter& treeIter){
+                CHECK(treeStore.to_ct_tree_iter(treeIter).get_node_text_buffer());
+                return false; /* false for continue */
+            });
+            CtSummaryInfo summaryCounted;
+            treeStore.populateSummaryInfo(summaryCounted);
+            check_summary_info_equal(summaryCounted, summaryUnloaded);
+            CtSummaryInfo summaryCached;
+            treeStore.populateSummaryInfo(summaryCached);
+            check_summary_info_equal(summaryCounted, summaryCached);
+            CHECK(summaryCounted.words_num > 0);
+        });
+    }
+}
+
+// more cells than the light table threshold, the last row short
+static CtTableTexts get_light_table_texts(const int tableCellsGoLight)
+{
+    const size_t numColumns{4};
+    const size_t numRows = tableCellsGoLight/numColumns + 2;
+    CtTableTexts tableTexts(numRows);
+    for (size_t row = 0; row < numRows; ++row) {
+        const size_t rowColumns = row + 1 == numRows ? 2 : numColumns;
+        for (size_t col = 0; col < rowColumns; ++col) {
+            tableTexts[row].push_back(fmt::format("r{}c{}", row, col));
+        }
+    }
+    tableTexts[1][1] = "йцукенгшщз\nline";
+    tableTexts[2][2] = "a, \"quoted\"";
+    return tableTexts;
+}
+
+TEST(CtDocRWGroup, CtTable_create_light_or_heavy)
+{
+    TestCtWinApp::run_test([](CtMainWin* pWin){
+        const int tableCellsGoLight = pWin->get_ct_config()->tableCellsGoLight;
+        auto create = [pWin](const CtTableTexts& tableTexts) {
+            return std::unique_ptr<CtTable>(CtTable::create(pWin, tableTexts, 40, 60, 0, ""));
+        };
+        // up to the threshold the cells are widgets, above it they are drawn
+        {
+            auto pTable = create({std::vector<Glib::ustring>(tableCellsGoLight, "x")});
+            CHECK(dynamic_cast<CtTableHeavy*>(pTable.get()));
+            CHECK_EQUAL((size_t)tableCellsGoLight, pTable->get_num_columns());
+        }
+        {
+            auto pTable = create({std::vector<Glib::ustring>(tableCellsGoLight + 1, "x")});
+            CHECK(dynamic_cast<CtTableLight*>(pTable.get()));
+            CHECK_EQUAL((size_t)tableCellsGoLight + 1, pTable->get_num_columns());
+        }
+        // the cells are counted once the short rows are padded
+        {
+            auto pTable = create({{"h"}, std::vector<Glib::ustring>(tableCellsGoLight, "x")});
+            CHECK(dynamic_cast<CtTableLight*>(pTable.get()));
+            CHECK_EQUAL(2, pTable->get_num_rows());
+            CHECK_EQUAL((size_t)tableCellsGoLight, pTable->get_num_columns());
+            STRCMP_EQUAL("h", pTable->get_cell_text(0, 0).c_str());
+            STRCMP_EQUAL("", pTable->get_cell_text(0, 1).c_str());
+        }
+        {
+            const CtTableTexts tableTexts = get_light_table_texts(tableCellsGoLight);
+            auto pTable = create(tableTexts);
+            CHECK(dynamic_cast<CtTableLight*>(pTable.get()));
+            CtTableTexts paddedTexts = tableTexts;
+            CtTable::pad_rows(paddedTexts);
+            CtTableTexts lightTexts;
+            pTable->write_strings_matrix(lightTexts);
+            CHECK(paddedTexts == lightTexts);
+            STRCMP_EQUAL("", pTable->get_cell_text(tableTexts.size() - 1, 3).c_str());
+        }
+    });
+}
+
+TEST(CtDocRWGroup, CtTable_from_to_csv)
+{
+    TestCtWinApp::run_test([](CtMainWin* pWin){
+        // the short rows of the csv are padded
+        {
+            std::istringstream input{"h1,h2,h3\na\n\"b,\"\"c\"\"\",d\n"};
+            std::unique_ptr<CtTable> pTable = CtTable::from_csv(input, pWin, 40, 60, 0, "");
+            CHECK(dynamic_cast<CtTableHeavy*>(pTable.get()));
+            CtTableTexts tableTexts;
+            pTable->write_strings_matrix(tableTexts);
+            CHECK(CtTableTexts({{"h1", "h2", "h3"}, {"a", "", ""}, {"b,\"c\"", "d", ""}}) == tableTexts);
+            std::ostringstream output;
+            pTable->to_csv(output);
+            std::istringstream input2{output.str()};
+            CHECK(CtCSV::CtStringTable({{"h1", "h2", "h3"}, {"a", "", ""}, {"b,\"c\"", "d", ""}}) == CtCSV::table_from_csv(input2));
+        }
+        // a light table goes to csv and back unchanged
+        {
+            CtTableTexts tableTexts = get_light_table_texts(pWin->get_ct_config()->tableCellsGoLight);
+            std::unique_ptr<CtTable> pTable{CtTable::create(pWin, tableTexts, 40, 60, 0, "")};
+            CHECK(dynamic_cast<CtTableLight*>(pTable.get()));
+            std::ostringstream output;
+            pTable->to_csv(output);
+            std::istringstream input{output.str()};
+            std::unique_ptr<CtTable> pTableFromCsv = CtTable::from_csv(input, pWin, 40, 60, 0, "");
+            CHECK(dynamic_cast<CtTableLight*>(pTableFromCsv.get()));
+            CtTable::pad_rows(tableTexts);
+            CtTableTexts tableTextsFromCsv;
+            pTableFromCsv->write_strings_matrix(tableTextsFromCsv);
+            CHECK(tableTexts == tableTextsFromCsv);
+        }
+    });
+}
+
+TEST(CtDocRWGroup, CtTableLight_save_load)
+{
+    g_autofree gchar* pTmpDir = g_dir_make_tmp("ct_ut_table_XXXXXX", nullptr);
+    const fs::path tmp_dir{pTmpDir};
+    const fs::path doc_ctb = tmp_dir / "light.ctb";
+    const fs::path doc_ctd = tmp_dir / "light.ctd";
+    CtTableTexts tableTexts;
+    int tableOffset{-1};
+
+    // a light table added to the rich text node "b", as by the insert table action
+    TestCtWinApp::run_test([&](CtMainWin* pWin){
+        CHECK(pWin->file_open(UT::testCtdDocPath, "b"));
+        CtTreeIter treeIter = pWin->curr_tree_iter();
+        STRCMP_EQUAL("b", treeIter.get_node_name().c_str());
+        Glib::RefPtr<Gsv::Buffer> rTextBuffer = Glib::RefPtr<Gsv::Buffer>::cast_dynamic(pWin->curr_buffer());
+        tableTexts = get_light_table_texts(pWin->get_ct_config()->tableCellsGoLight);
+        tableOffset = rTextBuffer->end().get_offset();
+        CtTable* pTable = CtTable::create(pWin, tableTexts, 40, 60, tableOffset, "");
+        CHECK(dynamic_cast<CtTableLight*>(pTable));
+        pTable->insertInTextBuffer(rTextBuffer);
+        pWin->get_tree_store().addAnchoredWidgets(treeIter, {pTable}, &pWin->get_text_view());
+        pWin->update_window_save_needed(CtSaveNeededUpdType::nbuf, true/*new_machine_state*/);
+        pWin->file_save_as(doc_ctb.string(), "");
+        pWin->file_save_as(doc_ctd.string(), "");
+    });
+    CtTable::pad_rows(tableTexts);
+
+    for (const fs::path& doc_path : {doc_ctb, doc_ctd}) {
+        TestCtWinApp::run_test([&](CtMainWin* pWin){
+            CHECK(pWin->file_open(doc_path, ""));
+            CtTreeIter treeIter = pWin->get_tree_store().get_node_from_node_name("b");
+            CHECK(treeIter);
+            CHECK(treeIter.get_node_text_buffer());
+            CtTableLight* pTableLight{nullptr};
+            for (CtAnchoredWidget* pAnchoredWidget : treeIter.get_embedded_pixbufs_tables_codeboxes()) {
+                if (pAnchoredWidget->getOffset() == tableOffset) {
+                    pTableLight = dynamic_cast<CtTableLight*>(pAnchoredWidget);
+                }
+            }
+            CHECK(pTableLight);
+            CtTableTexts loadedTexts;
+            pTableLight->write_strings_matrix(loadedTexts);
+            CHECK(tableTexts == loadedTexts);
+        });
+    }
+
+    fs::remove_all(tmp_dir);
+}
+
+using CtNodesSequences = std::vector<std::pair<std::string, gint64>>;
+
+// the names and sequences of the top level nodes, in the tree order
+static CtNodesSequences get_top_nodes_sequences(CtTreeStore& treeStore)
+{
+    CtNodesSequences nodesSequences;
+    for (CtTreeIter treeIter = treeStore.get_ct_iter_first(); treeIter; ++treeIter) {
+        nodesSequences.emplace_back(treeIter.get_node_name(), treeIter.get_node_sequence());
+    }
+    return nodesSequences;
+}
+
+TEST(CtDocRWGroup, CtTreeStore_nodes_sequences)
+{
+    g_autofree gchar* pTmpDir = g_dir_make_tmp("ct_ut_sequences_XXXXXX", nullptr);
+    const fs::path tmp_dir{pTmpDir};
+    const fs::path doc_ctb = tmp_dir / "sequences.ctb";
+    CtNodesSequences savedSequences;
+
+    TestCtWinApp::run_test([&](CtMainWin* pWin){
+        CtTreeStore& treeStore = pWin->get_tree_store();
+        // a new node as added by the tree actions, after the given one or as the last/first top level
+        auto new_node_data = [pWin, &treeStore](const Glib::ustring& name) {
+            CtNodeData nodeData;
+            nodeData.name = name;
+            nodeData.syntax = CtConst::RICH_TEXT_ID;
+            nodeData.rTextBuffer = pWin->get_new_text_buffer();
+            nodeData.nodeId = treeStore.node_id_get();
+            return nodeData;
+        };
+        auto add_node = [&](const Glib::ustring& name, const Gtk::TreeIter& afterIter) {
+            CtNodeData nodeData = new_node_data(name);
+            Gtk::TreeIter nodeIter = afterIter ? treeStore.insert_node(&nodeData, afterIter) : treeStore.append_node(&nodeData);
+            treeStore.to_ct_tree_iter(nodeIter).pending_new_db_node();
+            treeStore.node_sequence_fix(nodeIter);
+            return nodeIter;
+        };
+        auto add_node_first = [&](const Glib::ustring& name) {
+            CtNodeData nodeData = new_node_data(name);
+            Gtk::TreeIter nodeIter = treeStore.get_store()->prepend();
+            treeStore.update_node_data(nodeIter, nodeData);
+            treeStore.to_ct_tree_iter(nodeIter).pending_new_db_node();
+            treeStore.node_sequence_fix(nodeIter);
+            return nodeIter;
+        };
+
+        // the last node goes one step after the previous one, a node in between takes the midpoint
+        Gtk::TreeIter iterA = add_node("a", Gtk::TreeIter{});
+        Gtk::TreeIter iterC = add_node("c", iterA);
+        Gtk::TreeIter iterB = add_node("b", iterA);
+        CHECK(CtNodesSequences({{"a", 1024}, {"b", 1536}, {"c", 2048}}) == get_top_nodes_sequences(treeStore));
+
+        // no gap left between adjacent sequences: the node and the following siblings are shifted
+        // up to the first one already after them, the ones before are not touched
+        Gtk::TreeIter iterD = add_node("d", iterC);
+        treeStore.to_ct_tree_iter(iterA).set_node_sequence(1);
+        treeStore.to_ct_tree_iter(iterB).set_node_sequence(2);
+        treeStore.to_ct_tree_iter(iterC).set_node_sequence(3);
+        treeStore.to_ct_tree_iter(iterD).set_node_sequence(10000);
+        add_node("x", iterA);
+        CHECK(CtNodesSequences({{"a", 1}, {"x", 1025}, {"b", 2049}, {"c", 3073}, {"d", 10000}}) == get_top_nodes_sequences(treeStore));
+
+        // inserted last, and first with no gap before the first sibling
+        add_node("last", iterD);
+        add_node_first("first");
+        CHECK(CtNodesSequences({{"first", 1024}, {"a", 2048}, {"x", 3072}, {"b", 4096}, {"c", 5120}, {"d", 10000}, {"last", 11024}}) == get_top_nodes_sequences(treeStore));
+        // inserted first with a gap before the first sibling
+        add_node_first("very first");
+        CHECK(CtNodesSequences({{"very first", 512}, {"first", 1024}, {"a", 2048}, {"x", 3072}, {"b", 4096}, {"c", 5120}, {"d", 10000}, {"last", 11024}}) == get_top_nodes_sequences(treeStore));
+
+        // the siblings reordered keep the sequences there were, handed out in the new order
+        treeStore.get_store()->iter_swap(iterA, iterC);
+        treeStore.nodes_sequences_fix(Gtk::TreeIter{}, false/*process_children*/);
+        CHECK(CtNodesSequences({{"very first", 512}, {"first", 1024}, {"c", 2048}, {"x", 3072}, {"b", 4096}, {"a", 5120}, {"d", 10000}, {"last", 11024}}) == get_top_nodes_sequences(treeStore));
+        // unless they are not usable, then they are given again a step apart
+        treeStore.to_ct_tree_iter(iterD).set_node_sequence(5120);
+        treeStore.nodes_sequences_fix(Gtk::TreeIter{}, false/*process_children*/);
+        CHECK(CtNodesSequences({{"very first", 1024}, {"first", 2048}, {"c", 3072}, {"x", 4096}, {"b", 5120}, {"a", 6144}, {"d", 7168}, {"last", 8192}}) == get_top_nodes_sequences(treeStore));
+        treeStore.to_ct_tree_iter(iterD).set_node_sequence(7000);
+        savedSequences = get_top_nodes_sequences(treeStore);
+
+        // sequences with gaps and out of step survive the sqlite rows
+        pWin->file_save_as(doc_ctb.string(), "");
+    });
+
+    TestCtWinApp::run_test([&](CtMainWin* pWin){
+        CHECK(pWin->file_open(doc_ctb, ""));
+        CHECK(savedSequences == get_top_nodes_sequences(pWin->get_tree_store()));
+    });
+
+    fs::remove_all(tmp_dir);
+}
+
 #endif // __APPLE__